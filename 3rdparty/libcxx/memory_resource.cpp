@@ -0,0 +1,380 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <memory_resource>
+#include <cstdint>
+#include <limits>
+
+_LIBCPP_BEGIN_NAMESPACE_STD
+
+namespace pmr {
+
+static const size_t __max_alignment = alignof(max_align_t);
+
+// Blocks larger than this are never carved from a single chunk.
+static const size_t __default_largest_pool_block = 4096;
+
+static const size_t __default_max_blocks_per_chunk = 1024;
+
+static const size_t __max_blocks_per_chunk = 1 << 20;
+
+// Pools start with chunks of about this many bytes and double them each
+// time they run out, up to max_blocks_per_chunk blocks.
+static const size_t __initial_chunk_bytes = 4096;
+
+static size_t __round_up(size_t __n, size_t __align)
+{
+    return (__n + __align - 1) & ~(__align - 1);
+}
+
+static unsigned __log2(size_t __n)
+{
+    unsigned __r = 0;
+
+    while (__n >>= 1)
+        __r++;
+
+    return __r;
+}
+
+static size_t __round_up_pow2(size_t __n)
+{
+    size_t __r = 1;
+
+    while (__r < __n)
+        __r <<= 1;
+
+    return __r;
+}
+
+// __pool_resource_imp
+
+struct __pool_resource_imp::__chunk
+{
+    __chunk* __next_;
+    size_t __size_;
+};
+
+struct __pool_resource_imp::__oversized
+{
+    __oversized* __prev_;
+    __oversized* __next_;
+    void* __start_;
+    size_t __size_;
+    size_t __align_;
+};
+
+__pool_resource_imp::__pool_resource_imp(const pool_options& __opts,
+                                         memory_resource* __upstream)
+    : __upstream_(__upstream), __opts_(__opts), __num_pools_(0),
+      __oversized_(nullptr)
+{
+    if (__opts_.largest_required_pool_block == 0)
+        __opts_.largest_required_pool_block = __default_largest_pool_block;
+    else if (__opts_.largest_required_pool_block > __max_block_size)
+        __opts_.largest_required_pool_block = __max_block_size;
+    else if (__opts_.largest_required_pool_block < __min_block_size)
+        __opts_.largest_required_pool_block = __min_block_size;
+
+    __opts_.largest_required_pool_block =
+        __round_up_pow2(__opts_.largest_required_pool_block);
+
+    if (__opts_.max_blocks_per_chunk == 0)
+        __opts_.max_blocks_per_chunk = __default_max_blocks_per_chunk;
+    else if (__opts_.max_blocks_per_chunk > __max_blocks_per_chunk)
+        __opts_.max_blocks_per_chunk = __max_blocks_per_chunk;
+
+    __num_pools_ = static_cast<int>(
+        __log2(__opts_.largest_required_pool_block) -
+        __log2(__min_block_size) + 1);
+
+    for (int __i = 0; __i < __num_pools_; __i++)
+    {
+        size_t __block_size = __min_block_size << __i;
+        size_t __blocks = __initial_chunk_bytes / __block_size;
+
+        if (__blocks == 0)
+            __blocks = 1;
+
+        if (__blocks > __opts_.max_blocks_per_chunk)
+            __blocks = __opts_.max_blocks_per_chunk;
+
+        __pools_[__i].__free_list_ = nullptr;
+        __pools_[__i].__bump_ = nullptr;
+        __pools_[__i].__bump_end_ = nullptr;
+        __pools_[__i].__chunks_ = nullptr;
+        __pools_[__i].__next_blocks_ = __blocks;
+    }
+}
+
+__pool_resource_imp::~__pool_resource_imp()
+{
+    __release();
+}
+
+int __pool_resource_imp::__pool_index(size_t __bytes, size_t __align) const
+{
+    if (__align > __max_alignment ||
+        __bytes > __opts_.largest_required_pool_block)
+        return -1;
+
+    if (__bytes < __align)
+        __bytes = __align;
+
+    if (__bytes <= __min_block_size)
+        return 0;
+
+    return static_cast<int>(__log2(__bytes - 1) + 1 - __log2(__min_block_size));
+}
+
+void* __pool_resource_imp::__refill(int __index)
+{
+    __pool& __p = __pools_[__index];
+    size_t __block_size = __min_block_size << __index;
+    size_t __data_size = __p.__next_blocks_ * __block_size;
+    size_t __size = __data_size + sizeof(__chunk);
+    char* __start =
+        static_cast<char*>(__upstream_->allocate(__size, __max_alignment));
+    __chunk* __c = reinterpret_cast<__chunk*>(__start + __data_size);
+
+    __c->__next_ = __p.__chunks_;
+    __c->__size_ = __size;
+    __p.__chunks_ = __c;
+
+    if (__p.__next_blocks_ < __opts_.max_blocks_per_chunk)
+    {
+        __p.__next_blocks_ *= 2;
+
+        if (__p.__next_blocks_ > __opts_.max_blocks_per_chunk)
+            __p.__next_blocks_ = __opts_.max_blocks_per_chunk;
+    }
+
+    // Blocks are carved lazily so that a large chunk is not touched in full.
+    __p.__bump_ = __start + __block_size;
+    __p.__bump_end_ = __start + __data_size;
+    return __start;
+}
+
+void* __pool_resource_imp::__allocate(size_t __bytes, size_t __align)
+{
+    int __index = __pool_index(__bytes, __align);
+
+    if (__index < 0)
+    {
+        // Place the bookkeeping after the block so that the block keeps the
+        // alignment of the upstream allocation.
+        size_t __offset = __round_up(__bytes, alignof(__oversized));
+
+        if (__offset < __bytes ||
+            __offset > numeric_limits<size_t>::max() - sizeof(__oversized))
+            __throw_bad_alloc();
+
+        size_t __size = __offset + sizeof(__oversized);
+        char* __start =
+            static_cast<char*>(__upstream_->allocate(__size, __align));
+        __oversized* __o = reinterpret_cast<__oversized*>(__start + __offset);
+
+        __o->__prev_ = nullptr;
+        __o->__next_ = __oversized_;
+        __o->__start_ = __start;
+        __o->__size_ = __size;
+        __o->__align_ = __align;
+
+        if (__oversized_)
+            __oversized_->__prev_ = __o;
+
+        __oversized_ = __o;
+        return __start;
+    }
+
+    __pool& __p = __pools_[__index];
+
+    if (__p.__free_list_)
+    {
+        void* __block = __p.__free_list_;
+        __p.__free_list_ = *static_cast<void**>(__block);
+        return __block;
+    }
+
+    if (__p.__bump_ != __p.__bump_end_)
+    {
+        void* __block = __p.__bump_;
+        __p.__bump_ += __min_block_size << __index;
+        return __block;
+    }
+
+    return __refill(__index);
+}
+
+void __pool_resource_imp::__deallocate(void* __ptr, size_t __bytes,
+                                       size_t __align)
+{
+    int __index = __pool_index(__bytes, __align);
+
+    if (__index < 0)
+    {
+        size_t __offset = __round_up(__bytes, alignof(__oversized));
+        __oversized* __o = reinterpret_cast<__oversized*>(
+            static_cast<char*>(__ptr) + __offset);
+
+        if (__o->__prev_)
+            __o->__prev_->__next_ = __o->__next_;
+        else
+            __oversized_ = __o->__next_;
+
+        if (__o->__next_)
+            __o->__next_->__prev_ = __o->__prev_;
+
+        __upstream_->deallocate(__o->__start_, __o->__size_, __o->__align_);
+        return;
+    }
+
+    __pool& __p = __pools_[__index];
+
+    *static_cast<void**>(__ptr) = __p.__free_list_;
+    __p.__free_list_ = __ptr;
+}
+
+void __pool_resource_imp::__release()
+{
+    for (int __i = 0; __i < __num_pools_; __i++)
+    {
+        __pool& __p = __pools_[__i];
+        __chunk* __c = __p.__chunks_;
+
+        while (__c)
+        {
+            __chunk* __next = __c->__next_;
+            char* __start = reinterpret_cast<char*>(__c) + sizeof(__chunk) -
+                            __c->__size_;
+
+            __upstream_->deallocate(__start, __c->__size_, __max_alignment);
+            __c = __next;
+        }
+
+        __p.__free_list_ = nullptr;
+        __p.__bump_ = nullptr;
+        __p.__bump_end_ = nullptr;
+        __p.__chunks_ = nullptr;
+    }
+
+    while (__oversized_)
+    {
+        __oversized* __next = __oversized_->__next_;
+
+        __upstream_->deallocate(__oversized_->__start_,
+                                __oversized_->__size_,
+                                __oversized_->__align_);
+        __oversized_ = __next;
+    }
+}
+
+// monotonic_buffer_resource
+
+struct monotonic_buffer_resource::__chunk
+{
+    __chunk* __next_;
+    size_t __size_;
+    size_t __align_;
+};
+
+monotonic_buffer_resource::monotonic_buffer_resource(
+    size_t __initial_size, memory_resource* __upstream)
+    : __upstream_(__upstream), __initial_buffer_(nullptr),
+      __initial_size_(__initial_size ? __initial_size : 1), __cur_(nullptr),
+      __end_(nullptr), __next_size_(__initial_size_), __chunks_(nullptr)
+{
+}
+
+monotonic_buffer_resource::monotonic_buffer_resource(
+    void* __buffer, size_t __buffer_size, memory_resource* __upstream)
+    : __upstream_(__upstream), __initial_buffer_(__buffer),
+      __initial_size_(__buffer_size), __cur_(static_cast<char*>(__buffer)),
+      __end_(static_cast<char*>(__buffer) + __buffer_size),
+      __next_size_(__buffer_size ? __buffer_size * 2 : __default_initial_size),
+      __chunks_(nullptr)
+{
+}
+
+monotonic_buffer_resource::~monotonic_buffer_resource()
+{
+    release();
+}
+
+void monotonic_buffer_resource::release()
+{
+    while (__chunks_)
+    {
+        __chunk* __next = __chunks_->__next_;
+        char* __start = reinterpret_cast<char*>(__chunks_) + sizeof(__chunk) -
+                        __chunks_->__size_;
+
+        __upstream_->deallocate(__start, __chunks_->__size_,
+                                __chunks_->__align_);
+        __chunks_ = __next;
+    }
+
+    if (__initial_buffer_)
+    {
+        __cur_ = static_cast<char*>(__initial_buffer_);
+        __end_ = __cur_ + __initial_size_;
+        __next_size_ =
+            __initial_size_ ? __initial_size_ * 2 : __default_initial_size;
+    }
+    else
+    {
+        __cur_ = nullptr;
+        __end_ = nullptr;
+        __next_size_ = __initial_size_;
+    }
+}
+
+void* monotonic_buffer_resource::do_allocate(size_t __bytes, size_t __align)
+{
+    if (__cur_)
+    {
+        uintptr_t __addr = reinterpret_cast<uintptr_t>(__cur_);
+        size_t __padding = __round_up(__addr, __align) - __addr;
+
+        if (__padding <= static_cast<size_t>(__end_ - __cur_) &&
+            __bytes <= static_cast<size_t>(__end_ - __cur_) - __padding)
+        {
+            char* __p = __cur_ + __padding;
+            __cur_ = __p + __bytes;
+            return __p;
+        }
+    }
+
+    // Start a new chunk that holds at least this block. The bookkeeping is
+    // placed at the end of the chunk so that the chunk keeps the alignment
+    // of the upstream allocation.
+    size_t __data_size = __next_size_ > __bytes ? __next_size_ : __bytes;
+    size_t __offset = __round_up(__data_size, alignof(__chunk));
+
+    if (__offset < __data_size ||
+        __offset > numeric_limits<size_t>::max() - sizeof(__chunk))
+        __throw_bad_alloc();
+
+    size_t __size = __offset + sizeof(__chunk);
+    size_t __chunk_align =
+        __align > __max_alignment ? __align : __max_alignment;
+    char* __start =
+        static_cast<char*>(__upstream_->allocate(__size, __chunk_align));
+    __chunk* __c = reinterpret_cast<__chunk*>(__start + __offset);
+
+    __c->__next_ = __chunks_;
+    __c->__size_ = __size;
+    __c->__align_ = __chunk_align;
+    __chunks_ = __c;
+
+    if (__next_size_ <= numeric_limits<size_t>::max() / 2)
+        __next_size_ *= 2;
+
+    __cur_ = __start + __bytes;
+    __end_ = __start + __offset;
+    return __start;
+}
+
+} // namespace pmr
+
+_LIBCPP_END_NAMESPACE_STD
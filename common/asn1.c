@@ -4,6 +4,21 @@
 #include "asn1.h"
 #include <openenclave/internal/asn1.h>
 #include <openenclave/internal/raise.h>
+#include "common.h"
+
+/*
+ * The readers below work directly on the caller's DER buffer. They never
+ * allocate or copy, and they check every length against the end of the
+ * enclosing element before it is used. Only an extension index with more
+ * than OE_ASN1_INLINE_EXTENSIONS entries allocates, for the overflow.
+ */
+
+/* Identifier octets of the universal types read by this file */
+#define ASN1_BOOLEAN OE_ASN1_TAG_BOOLEAN
+#define ASN1_INTEGER OE_ASN1_TAG_INTEGER
+#define ASN1_OCTET_STRING OE_ASN1_TAG_OCTET_STRING
+#define ASN1_OID OE_ASN1_TAG_OID
+#define ASN1_SEQUENCE (OE_ASN1_TAG_CONSTRUCTED | OE_ASN1_TAG_SEQUENCE)
 
 oe_result_t oe_asn1_get_tag(
     oe_asn1_t* asn1,
@@ -85,3 +100,536 @@ oe_result_t oe_asn1_peek_tag(const oe_asn1_t* asn1, oe_asn1_tag_t* tag)
 done:
     return result;
 }
+
+oe_result_t oe_asn1_get_length(oe_asn1_t* asn1, size_t* length)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t n = 0;
+    uint8_t first;
+
+    if (length)
+        *length = 0;
+
+    if (!oe_asn1_is_valid(asn1) || !length)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (oe_asn1_remaining(asn1) < 1)
+        OE_RAISE(OE_FAILURE);
+
+    first = *asn1->ptr++;
+
+    if (first < 0x80)
+    {
+        n = first;
+    }
+    else
+    {
+        size_t count = first & 0x7f;
+
+        /* DER forbids the indefinite form (0x80) */
+        if (count == 0 || count > sizeof(size_t))
+            OE_RAISE(OE_FAILURE);
+
+        if (oe_asn1_remaining(asn1) < count)
+            OE_RAISE(OE_FAILURE);
+
+        /* DER requires the shortest form: no leading zero octets, and the
+         * long form only for lengths of 128 or more */
+        if (asn1->ptr[0] == 0)
+            OE_RAISE(OE_FAILURE);
+
+        while (count--)
+            n = (n << 8) | *asn1->ptr++;
+
+        if (n < 0x80)
+            OE_RAISE(OE_FAILURE);
+    }
+
+    if (n > oe_asn1_remaining(asn1))
+        OE_RAISE(OE_FAILURE);
+
+    *length = n;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Reads an element whose identifier is the given single octet */
+static oe_result_t _get_element(
+    oe_asn1_t* asn1,
+    uint8_t identifier,
+    const uint8_t** data,
+    size_t* length)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_asn1_t tmp = *asn1;
+
+    if (oe_asn1_remaining(&tmp) < 1 || *tmp.ptr != identifier)
+        OE_RAISE_NO_TRACE(OE_FAILURE);
+
+    tmp.ptr++;
+    OE_CHECK(oe_asn1_get_length(&tmp, length));
+
+    *data = tmp.ptr;
+    asn1->ptr = tmp.ptr + *length;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_asn1_get_raw(
+    oe_asn1_t* asn1,
+    oe_asn1_tag_t* tag,
+    const uint8_t** data,
+    size_t* length)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    bool constructed;
+
+    if (data)
+        *data = NULL;
+
+    if (length)
+        *length = 0;
+
+    if (!oe_asn1_is_valid(asn1) || !tag || !data || !length)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_asn1_get_tag(asn1, &constructed, tag));
+    OE_CHECK(oe_asn1_get_length(asn1, length));
+    *data = asn1->ptr;
+    asn1->ptr += *length;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_asn1_get_sequence(oe_asn1_t* asn1, oe_asn1_t* sequence)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const uint8_t* data;
+    size_t length;
+
+    if (sequence)
+        memset(sequence, 0, sizeof(oe_asn1_t));
+
+    if (!oe_asn1_is_valid(asn1) || !sequence)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_element(asn1, ASN1_SEQUENCE, &data, &length));
+
+    oe_asn1_init(sequence, data, length);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_asn1_get_integer(oe_asn1_t* asn1, int* value)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const uint8_t* data;
+    size_t length;
+    unsigned int n = 0;
+
+    if (value)
+        *value = 0;
+
+    if (!oe_asn1_is_valid(asn1) || !value)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_element(asn1, ASN1_INTEGER, &data, &length));
+
+    /* Only non-negative values that fit in an int are supported */
+    if (length == 0 || length > sizeof(int) || (data[0] & 0x80))
+        OE_RAISE(OE_FAILURE);
+
+    while (length--)
+        n = (n << 8) | *data++;
+
+    *value = (int)n;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Appends the decimal form of **value** to the OID string at **pos** */
+static oe_result_t _append_arc(
+    oe_oid_string_t* oid,
+    size_t* pos,
+    uint64_t value)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    char digits[20];
+    size_t n = 0;
+
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    /* Leave room for the separator and the zero-terminator */
+    if (*pos + n + 2 > sizeof(oid->buf))
+        OE_RAISE(OE_FAILURE);
+
+    if (*pos)
+        oid->buf[(*pos)++] = '.';
+
+    while (n)
+        oid->buf[(*pos)++] = digits[--n];
+
+    oid->buf[*pos] = '\0';
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _oid_to_string(
+    const uint8_t* data,
+    size_t length,
+    oe_oid_string_t* oid)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t pos = 0;
+    bool first = true;
+    uint64_t value = 0;
+
+    if (length == 0)
+        OE_RAISE(OE_FAILURE);
+
+    for (size_t i = 0; i < length; i++)
+    {
+        /* Reject non-minimal encodings and values beyond 64 bits */
+        if (value == 0 && data[i] == 0x80)
+            OE_RAISE(OE_FAILURE);
+
+        if (value > (OE_UINT64_MAX >> 7))
+            OE_RAISE(OE_FAILURE);
+
+        value = (value << 7) | (data[i] & 0x7f);
+
+        if (data[i] & 0x80)
+            continue;
+
+        /* The first subidentifier encodes the first two arcs */
+        if (first)
+        {
+            uint64_t arc = value < 80 ? value / 40 : 2;
+            OE_CHECK(_append_arc(oid, &pos, arc));
+            OE_CHECK(_append_arc(oid, &pos, value - arc * 40));
+            first = false;
+        }
+        else
+        {
+            OE_CHECK(_append_arc(oid, &pos, value));
+        }
+
+        value = 0;
+    }
+
+    /* The last subidentifier must be complete */
+    if (data[length - 1] & 0x80)
+        OE_RAISE(OE_FAILURE);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_asn1_get_oid(oe_asn1_t* asn1, oe_oid_string_t* oid)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_asn1_t tmp;
+    const uint8_t* data;
+    size_t length;
+
+    if (oid)
+        memset(oid, 0, sizeof(oe_oid_string_t));
+
+    if (!oe_asn1_is_valid(asn1) || !oid)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Only advance the stream if the OID can be converted */
+    tmp = *asn1;
+    OE_CHECK(_get_element(&tmp, ASN1_OID, &data, &length));
+    OE_CHECK(_oid_to_string(data, length, oid));
+    asn1->ptr = tmp.ptr;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_asn1_get_octet_string(
+    oe_asn1_t* asn1,
+    const uint8_t** data,
+    size_t* length)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (data)
+        *data = NULL;
+
+    if (length)
+        *length = 0;
+
+    if (!oe_asn1_is_valid(asn1) || !data || !length)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_get_element(asn1, ASN1_OCTET_STRING, data, length));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Encodes a dotted OID string as the contents of a DER OID element */
+static oe_result_t _oid_from_string(
+    const char* str,
+    uint8_t* data,
+    size_t size,
+    size_t* length)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t arcs[2] = {0, 0};
+    size_t index = 0;
+    size_t n = 0;
+
+    for (const char* p = str;; p++)
+    {
+        uint64_t value = 0;
+        uint8_t bytes[10];
+        size_t count = 0;
+
+        if (*p < '0' || *p > '9')
+            OE_RAISE_NO_TRACE(OE_INVALID_PARAMETER);
+
+        for (; *p >= '0' && *p <= '9'; p++)
+        {
+            if (value > (OE_UINT64_MAX - 9) / 10)
+                OE_RAISE_NO_TRACE(OE_INVALID_PARAMETER);
+
+            value = value * 10 + (uint64_t)(*p - '0');
+        }
+
+        if (*p != '.' && *p != '\0')
+            OE_RAISE_NO_TRACE(OE_INVALID_PARAMETER);
+
+        /* The first two arcs share the first subidentifier */
+        if (index < 2)
+        {
+            arcs[index++] = value;
+
+            if (index == 1)
+            {
+                if (value > 2 || *p == '\0')
+                    OE_RAISE_NO_TRACE(OE_INVALID_PARAMETER);
+
+                continue;
+            }
+
+            if (arcs[0] < 2 && arcs[1] >= 40)
+                OE_RAISE_NO_TRACE(OE_INVALID_PARAMETER);
+
+            if (arcs[1] > OE_UINT64_MAX - 80)
+                OE_RAISE_NO_TRACE(OE_INVALID_PARAMETER);
+
+            value = arcs[0] * 40 + arcs[1];
+        }
+
+        do
+        {
+            bytes[count++] = (uint8_t)(value & 0x7f);
+            value >>= 7;
+        } while (value);
+
+        if (n + count > size)
+            OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+
+        while (count--)
+            data[n++] = (uint8_t)(bytes[count] | (count ? 0x80 : 0));
+
+        if (*p == '\0')
+            break;
+    }
+
+    *length = n;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Counts the elements left in a SEQUENCE without consuming them */
+static size_t _count_remaining(const oe_asn1_t* sequence)
+{
+    oe_asn1_t copy = *sequence;
+    oe_asn1_t element;
+    size_t count = 0;
+
+    /* Malformed data stops the count; the caller fails on it later */
+    while (oe_asn1_more(&copy) &&
+           oe_asn1_get_sequence(&copy, &element) == OE_OK)
+        count++;
+
+    return count;
+}
+
+oe_result_t oe_asn1_index_extensions(
+    const uint8_t* der,
+    size_t der_size,
+    oe_asn1_extensions_t* extensions)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_asn1_t asn1;
+    oe_asn1_t sequence;
+    size_t capacity = OE_ASN1_INLINE_EXTENSIONS;
+
+    if (extensions)
+        memset(extensions, 0, sizeof(oe_asn1_extensions_t));
+
+    if (!der || !der_size || !extensions)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Extensions ::= SEQUENCE SIZE (1..MAX) OF Extension */
+    oe_asn1_init(&asn1, der, der_size);
+    OE_CHECK(oe_asn1_get_sequence(&asn1, &sequence));
+
+    while (oe_asn1_more(&sequence))
+    {
+        const size_t i = extensions->count;
+        oe_asn1_t ext;
+        oe_asn1_extension_t* entry;
+        const uint8_t* data;
+        size_t length;
+
+        /* Size the overflow once the inline entries are used up */
+        if (i == capacity)
+        {
+            size_t remaining = _count_remaining(&sequence);
+
+            if (extensions->overflow || !remaining)
+                OE_RAISE(OE_FAILURE);
+
+            if (!(extensions->overflow = (oe_asn1_extension_t*)oe_calloc(
+                      remaining, sizeof(oe_asn1_extension_t))))
+                OE_RAISE(OE_OUT_OF_MEMORY);
+
+            capacity += remaining;
+        }
+
+        if (i < OE_ASN1_INLINE_EXTENSIONS)
+            entry = &extensions->entries[i];
+        else
+            entry = &extensions->overflow[i - OE_ASN1_INLINE_EXTENSIONS];
+
+        /* Extension ::= SEQUENCE { extnID OBJECT IDENTIFIER,
+         *     critical BOOLEAN DEFAULT FALSE, extnValue OCTET STRING } */
+        OE_CHECK(oe_asn1_get_sequence(&sequence, &ext));
+        OE_CHECK(_get_element(&ext, ASN1_OID, &entry->oid, &entry->oid_size));
+
+        if (oe_asn1_more(&ext) && *ext.ptr == ASN1_BOOLEAN)
+        {
+            OE_CHECK(_get_element(&ext, ASN1_BOOLEAN, &data, &length));
+
+            if (length != 1)
+                OE_RAISE(OE_FAILURE);
+
+            entry->critical = data[0] != 0;
+        }
+
+        if (!oe_asn1_more(&ext))
+            OE_RAISE(OE_FAILURE);
+
+        OE_CHECK(oe_asn1_get_octet_string(&ext, &entry->data, &entry->size));
+
+        if (oe_asn1_more(&ext))
+            OE_RAISE(OE_FAILURE);
+
+        extensions->count++;
+    }
+
+    /* Nothing may follow the extensions */
+    if (oe_asn1_more(&asn1))
+        OE_RAISE(OE_FAILURE);
+
+    result = OE_OK;
+
+done:
+    if (result != OE_OK && extensions)
+        oe_asn1_free_extensions(extensions);
+
+    return result;
+}
+
+void oe_asn1_free_extensions(oe_asn1_extensions_t* extensions)
+{
+    if (!extensions)
+        return;
+
+    oe_free(extensions->overflow);
+    memset(extensions, 0, sizeof(oe_asn1_extensions_t));
+}
+
+const oe_asn1_extension_t* oe_asn1_get_extension(
+    const oe_asn1_extensions_t* extensions,
+    size_t index)
+{
+    if (!extensions || index >= extensions->count)
+        return NULL;
+
+    if (index < OE_ASN1_INLINE_EXTENSIONS)
+        return &extensions->entries[index];
+
+    return &extensions->overflow[index - OE_ASN1_INLINE_EXTENSIONS];
+}
+
+oe_result_t oe_asn1_find_extension(
+    const oe_asn1_extensions_t* extensions,
+    const char* oid,
+    const oe_asn1_extension_t** extension)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t oid_der[sizeof(oe_oid_string_t)];
+    size_t oid_size;
+
+    if (extension)
+        *extension = NULL;
+
+    if (!extensions || !oid || !extension)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Encode the OID once so that entries are matched by their raw bytes */
+    if (_oid_from_string(oid, oid_der, sizeof(oid_der), &oid_size) != OE_OK)
+        OE_RAISE_NO_TRACE(OE_NOT_FOUND);
+
+    for (size_t i = 0; i < extensions->count; i++)
+    {
+        const oe_asn1_extension_t* entry = oe_asn1_get_extension(extensions, i);
+
+        if (entry->oid_size == oid_size &&
+            memcmp(entry->oid, oid_der, oid_size) == 0)
+        {
+            *extension = entry;
+            result = OE_OK;
+            goto done;
+        }
+    }
+
+    result = OE_NOT_FOUND;
+
+done:
+    return result;
+}
@@ -0,0 +1,441 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/compress.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/sha.h>
+#include <openenclave/internal/utils.h>
+
+#include "common.h"
+
+/*
+**==============================================================================
+**
+** LZ4 block format:
+**
+**     A block is a series of sequences. Each sequence is:
+**
+**         token (literal length:4 | match length - 4:4)
+**         [literal length extension bytes]
+**         literals
+**         offset (2 bytes, little endian)
+**         [match length extension bytes]
+**
+**     A nibble of 15 is followed by extension bytes that are added to it
+**     until a byte less than 255 is found. The last sequence only contains
+**     literals and the last 5 bytes of the input are always literals.
+**
+**==============================================================================
+*/
+
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_LOG 12
+#define LZ4_HASH_SIZE (1 << LZ4_HASH_LOG)
+
+static uint32_t _read32(const uint8_t* p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t _hash(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - LZ4_HASH_LOG);
+}
+
+static uint8_t* _write_length(uint8_t* p, size_t n)
+{
+    while (n >= 255)
+    {
+        *p++ = 255;
+        n -= 255;
+    }
+
+    *p++ = (uint8_t)n;
+    return p;
+}
+
+static oe_result_t _write_sequence(
+    uint8_t** op,
+    const uint8_t* oend,
+    const uint8_t* literals,
+    size_t literal_length,
+    size_t offset,
+    size_t match_length)
+{
+    uint8_t* p = *op;
+    size_t ml = match_length ? match_length - LZ4_MIN_MATCH : 0;
+    size_t needed = 1 + literal_length + literal_length / 255 + 1;
+    uint8_t token;
+
+    if (match_length)
+        needed += 2 + ml / 255 + 1;
+
+    if (needed > (size_t)(oend - p))
+        return OE_BUFFER_TOO_SMALL;
+
+    token = (uint8_t)((literal_length < 15 ? literal_length : 15) << 4);
+    token |= (uint8_t)(ml < 15 ? ml : 15);
+    *p++ = token;
+
+    if (literal_length >= 15)
+        p = _write_length(p, literal_length - 15);
+
+    /* The literals of an empty input may be NULL */
+    if (literal_length)
+        memcpy(p, literals, literal_length);
+
+    p += literal_length;
+
+    if (match_length)
+    {
+        *p++ = (uint8_t)(offset & 0xff);
+        *p++ = (uint8_t)(offset >> 8);
+
+        if (ml >= 15)
+            p = _write_length(p, ml - 15);
+    }
+
+    *op = p;
+    return OE_OK;
+}
+
+size_t oe_lz4_compress_bound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+oe_result_t oe_lz4_compress(
+    const void* src,
+    size_t src_size,
+    void* dest,
+    size_t dest_size,
+    size_t* compressed_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const uint8_t* base = (const uint8_t*)src;
+    const uint8_t* ip = base;
+    const uint8_t* anchor = base;
+    const uint8_t* end = base + src_size;
+    uint8_t* op = (uint8_t*)dest;
+    const uint8_t* oend = op + dest_size;
+    uint32_t* table = NULL;
+
+    if (compressed_size)
+        *compressed_size = 0;
+
+    if ((!src && src_size) || !dest || !compressed_size ||
+        src_size > OE_UINT32_MAX)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Positions are stored plus one so that zero means empty */
+    if (!(table = (uint32_t*)oe_calloc(LZ4_HASH_SIZE, sizeof(uint32_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (src_size > LZ4_MATCH_FIND_LIMIT)
+    {
+        const uint8_t* mflimit = end - LZ4_MATCH_FIND_LIMIT;
+        const uint8_t* matchlimit = end - LZ4_LAST_LITERALS;
+
+        while (ip <= mflimit)
+        {
+            uint32_t sequence = _read32(ip);
+            uint32_t h = _hash(sequence);
+            uint32_t candidate = table[h];
+            size_t pos = (size_t)(ip - base);
+
+            table[h] = (uint32_t)(pos + 1);
+
+            if (candidate && pos - (candidate - 1) <= LZ4_MAX_OFFSET &&
+                _read32(base + candidate - 1) == sequence)
+            {
+                const uint8_t* match = base + candidate - 1;
+                size_t length = LZ4_MIN_MATCH;
+
+                while (ip + length < matchlimit && ip[length] == match[length])
+                    length++;
+
+                OE_CHECK(_write_sequence(
+                    &op,
+                    oend,
+                    anchor,
+                    (size_t)(ip - anchor),
+                    (size_t)(ip - match),
+                    length));
+
+                ip += length;
+                anchor = ip;
+                continue;
+            }
+
+            ip++;
+        }
+    }
+
+    /* Final literals */
+    OE_CHECK(_write_sequence(&op, oend, anchor, (size_t)(end - anchor), 0, 0));
+
+    *compressed_size = (size_t)(op - (uint8_t*)dest);
+    result = OE_OK;
+
+done:
+    oe_free(table);
+    return result;
+}
+
+static oe_result_t _read_length(
+    const uint8_t** ip,
+    const uint8_t* iend,
+    size_t* length)
+{
+    uint8_t b;
+
+    do
+    {
+        if (*ip >= iend)
+            return OE_INVALID_PARAMETER;
+
+        b = *(*ip)++;
+
+        if (oe_safe_add_u64(*length, b, length) != OE_OK)
+            return OE_INVALID_PARAMETER;
+    } while (b == 255);
+
+    return OE_OK;
+}
+
+oe_result_t oe_lz4_decompress(
+    const void* src,
+    size_t src_size,
+    void* dest,
+    size_t dest_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const uint8_t* ip = (const uint8_t*)src;
+    const uint8_t* iend = ip + src_size;
+    uint8_t* op = (uint8_t*)dest;
+    uint8_t* oend = op + dest_size;
+
+    if (!src || !src_size || (!dest && dest_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (;;)
+    {
+        uint8_t token;
+        size_t length;
+        size_t offset;
+        const uint8_t* match;
+
+        if (ip >= iend)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        token = *ip++;
+
+        /* Copy literals */
+        length = token >> 4;
+
+        if (length == 15)
+            OE_CHECK(_read_length(&ip, iend, &length));
+
+        if (length > (size_t)(iend - ip) || length > (size_t)(oend - op))
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        memcpy(op, ip, length);
+        ip += length;
+        op += length;
+
+        /* The last sequence ends after its literals */
+        if (ip == iend)
+            break;
+
+        /* Copy match */
+        if (iend - ip < 2)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+
+        if (offset == 0 || offset > (size_t)(op - (uint8_t*)dest))
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        length = token & 0x0f;
+
+        if (length == 15)
+            OE_CHECK(_read_length(&ip, iend, &length));
+
+        length += LZ4_MIN_MATCH;
+
+        if (length > (size_t)(oend - op))
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        /* Matches may overlap the output, so copy forward byte by byte
+         * unless the source is far enough behind */
+        match = op - offset;
+
+        if (offset >= length)
+        {
+            memcpy(op, match, length);
+            op += length;
+        }
+        else
+        {
+            while (length--)
+                *op++ = *match++;
+        }
+    }
+
+    if (op != oend)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _sha256(const void* data, size_t size, OE_SHA256* hash)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context = {{0}};
+
+    OE_CHECK(oe_sha256_init(&context));
+
+    /* The enclave rejects a NULL update even when it is empty */
+    if (size)
+        OE_CHECK(oe_sha256_update(&context, data, size));
+
+    OE_CHECK(oe_sha256_final(&context, hash));
+
+    result = OE_OK;
+
+done:
+    oe_sha256_free(&context);
+    return result;
+}
+
+oe_result_t oe_compress_image(
+    const void* data,
+    size_t size,
+    uint8_t** image,
+    size_t* image_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_compressed_header_t header;
+    uint8_t* buffer = NULL;
+    size_t bound;
+    size_t compressed_size;
+    OE_SHA256 hash;
+
+    if (image)
+        *image = NULL;
+
+    if (image_size)
+        *image_size = 0;
+
+    if ((!data && size) || !image || !image_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_add_u64(
+        sizeof(header), oe_lz4_compress_bound(size), &bound));
+
+    if (!(buffer = (uint8_t*)oe_malloc(bound)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_lz4_compress(
+        data,
+        size,
+        buffer + sizeof(header),
+        bound - sizeof(header),
+        &compressed_size));
+
+    OE_CHECK(_sha256(data, size, &hash));
+
+    memset(&header, 0, sizeof(header));
+    header.magic = OE_COMPRESSED_MAGIC;
+    header.version = OE_COMPRESSED_VERSION;
+    header.algorithm = OE_COMPRESSED_ALGORITHM_LZ4;
+    header.uncompressed_size = size;
+    header.compressed_size = compressed_size;
+    OE_CHECK(oe_memcpy_s(
+        header.sha256, sizeof(header.sha256), hash.buf, sizeof(hash.buf)));
+    OE_CHECK(oe_memcpy_s(buffer, bound, &header, sizeof(header)));
+
+    *image = buffer;
+    *image_size = sizeof(header) + compressed_size;
+    buffer = NULL;
+    result = OE_OK;
+
+done:
+    oe_free(buffer);
+    return result;
+}
+
+oe_result_t oe_get_compressed_header(
+    const void* image,
+    size_t image_size,
+    oe_compressed_header_t* header)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t total;
+
+    if (!image || !header || image_size < sizeof(*header))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_memcpy_s(header, sizeof(*header), image, sizeof(*header)));
+
+    if (header->magic != OE_COMPRESSED_MAGIC ||
+        header->version != OE_COMPRESSED_VERSION ||
+        header->algorithm != OE_COMPRESSED_ALGORITHM_LZ4)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (oe_safe_add_u64(sizeof(*header), header->compressed_size, &total) !=
+            OE_OK ||
+        total > image_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_decompress_image(
+    const void* image,
+    size_t image_size,
+    void* dest,
+    size_t dest_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_compressed_header_t header;
+    OE_SHA256 hash;
+
+    OE_CHECK(oe_get_compressed_header(image, image_size, &header));
+
+    if (!dest || dest_size != header.uncompressed_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_lz4_decompress(
+        (const uint8_t*)image + sizeof(header),
+        header.compressed_size,
+        dest,
+        dest_size));
+
+    OE_CHECK(_sha256(dest, dest_size, &hash));
+
+    if (!oe_constant_time_mem_equal(
+            hash.buf, header.sha256, sizeof(header.sha256)))
+        OE_RAISE(OE_VERIFY_FAILED);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
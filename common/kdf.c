@@ -5,7 +5,7 @@
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/bits/safemath.h>
 #include <openenclave/bits/types.h>
-#include <openenclave/internal/hmac.h>
+#include <openenclave/internal/defs.h>
 #include <openenclave/internal/kdf.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sha.h>
@@ -24,9 +24,115 @@ static inline uint32_t _to_big_endian(uint32_t x)
            ((x & 0x0000FF00U) << 8) | ((x & 0x000000FFU) << 24);
 }
 
-static oe_result_t kdf_hmac_sha256_ctr(
+#define HMAC_SHA256_BLOCK_SIZE 64
+
+typedef struct _oe_kdf_key_impl
+{
+    oe_kdf_mode_t mode;
+
+    /* SHA-256 states after hashing the padded inner and outer HMAC key
+     * blocks. Each counter block clones them instead of rehashing the key. */
+    oe_sha256_context_t inner;
+    oe_sha256_context_t outer;
+} oe_kdf_key_impl_t;
+
+OE_STATIC_ASSERT(sizeof(oe_kdf_key_impl_t) <= sizeof(oe_kdf_key_t));
+
+static oe_result_t _hash_key_block(
     const uint8_t* key,
     size_t key_size,
+    uint8_t pad,
+    oe_sha256_context_t* ctx)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t block[HMAC_SHA256_BLOCK_SIZE];
+
+    for (size_t i = 0; i < sizeof(block); i++)
+        block[i] = (uint8_t)((i < key_size ? key[i] : 0) ^ pad);
+
+    OE_CHECK(oe_sha256_init(ctx));
+    OE_CHECK(oe_sha256_update(ctx, block, sizeof(block)));
+
+    result = OE_OK;
+
+done:
+    if (result != OE_OK)
+        oe_sha256_free(ctx);
+
+    oe_secure_zero_fill(block, sizeof(block));
+    return result;
+}
+
+static void _free_key(oe_kdf_key_impl_t* impl)
+{
+    oe_sha256_free(&impl->inner);
+    oe_sha256_free(&impl->outer);
+}
+
+static oe_result_t _hmac_sha256_init_key(
+    oe_kdf_key_impl_t* impl,
+    const uint8_t* key,
+    size_t key_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t ctx = {{0}};
+    OE_SHA256 hashed_key;
+
+    /* Keys longer than a block are replaced by their hash (RFC 2104) */
+    if (key_size > HMAC_SHA256_BLOCK_SIZE)
+    {
+        OE_CHECK(oe_sha256_init(&ctx));
+        OE_CHECK(oe_sha256_update(&ctx, key, key_size));
+        OE_CHECK(oe_sha256_final(&ctx, &hashed_key));
+
+        key = hashed_key.buf;
+        key_size = sizeof(hashed_key.buf);
+    }
+
+    OE_CHECK(_hash_key_block(key, key_size, 0x36, &impl->inner));
+    OE_CHECK(_hash_key_block(key, key_size, 0x5c, &impl->outer));
+
+    result = OE_OK;
+
+done:
+    oe_sha256_free(&ctx);
+    oe_secure_zero_fill(&ctx, sizeof(ctx));
+    oe_secure_zero_fill(hashed_key.buf, sizeof(hashed_key.buf));
+    return result;
+}
+
+/* Computes HMAC-SHA256(key, ctr || fixed_data) from the precomputed states */
+static oe_result_t _hmac_sha256_block(
+    const oe_kdf_key_impl_t* impl,
+    uint32_t ctr,
+    const uint8_t* fixed_data,
+    size_t fixed_data_size,
+    OE_SHA256* sha256)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t ctx = {{0}};
+
+    OE_CHECK(oe_sha256_clone(&ctx, &impl->inner));
+    OE_CHECK(oe_sha256_update(&ctx, &ctr, sizeof(ctr)));
+    if (fixed_data && fixed_data_size)
+        OE_CHECK(oe_sha256_update(&ctx, fixed_data, fixed_data_size));
+    OE_CHECK(oe_sha256_final(&ctx, sha256));
+    OE_CHECK(oe_sha256_free(&ctx));
+
+    OE_CHECK(oe_sha256_clone(&ctx, &impl->outer));
+    OE_CHECK(oe_sha256_update(&ctx, sha256->buf, sizeof(sha256->buf)));
+    OE_CHECK(oe_sha256_final(&ctx, sha256));
+
+    result = OE_OK;
+
+done:
+    oe_sha256_free(&ctx);
+    oe_secure_zero_fill(&ctx, sizeof(ctx));
+    return result;
+}
+
+static oe_result_t kdf_hmac_sha256_ctr(
+    const oe_kdf_key_impl_t* impl,
     const uint8_t* fixed_data,
     size_t fixed_data_size,
     uint8_t* derived_key,
@@ -34,12 +140,11 @@ static oe_result_t kdf_hmac_sha256_ctr(
 {
     oe_result_t result = OE_UNEXPECTED;
     size_t derived_key_size_rounded;
-    oe_hmac_sha256_context_t ctx;
     OE_SHA256 sha256;
     size_t iters;
     uint32_t ctr;
 
-    if (!key || !derived_key)
+    if (!derived_key)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /*
@@ -63,12 +168,8 @@ static oe_result_t kdf_hmac_sha256_ctr(
         /* Counter must be in big endian. Assume we're little endian. */
         ctr = _to_big_endian((uint32_t)i);
 
-        OE_CHECK(oe_hmac_sha256_init(&ctx, key, key_size));
-        OE_CHECK(oe_hmac_sha256_update(&ctx, (uint8_t*)&ctr, sizeof(ctr)));
-        if (fixed_data)
-            OE_CHECK(oe_hmac_sha256_update(&ctx, fixed_data, fixed_data_size));
-        OE_CHECK(oe_hmac_sha256_final(&ctx, &sha256));
-        OE_CHECK(oe_hmac_sha256_free(&ctx));
+        OE_CHECK(_hmac_sha256_block(
+            impl, ctr, fixed_data, fixed_data_size, &sha256));
 
         OE_CHECK(
             oe_memcpy_s(derived_key, bytes_to_copy, sha256.buf, bytes_to_copy));
@@ -158,26 +259,60 @@ done:
     return result;
 }
 
-oe_result_t oe_kdf_derive_key(
+oe_result_t oe_kdf_key_init(
     oe_kdf_mode_t mode,
     const uint8_t* key,
     size_t key_size,
+    oe_kdf_key_t* kdf_key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_kdf_key_impl_t* impl = (oe_kdf_key_impl_t*)kdf_key;
+
+    if (!key || !kdf_key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_secure_zero_fill(kdf_key, sizeof(*kdf_key));
+
+    switch (mode)
+    {
+        case OE_KDF_HMAC_SHA256_CTR:
+            OE_CHECK(_hmac_sha256_init_key(impl, key, key_size));
+            break;
+        default:
+            OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+    impl->mode = mode;
+    result = OE_OK;
+
+done:
+    if (result != OE_OK && kdf_key)
+    {
+        _free_key(impl);
+        oe_secure_zero_fill(kdf_key, sizeof(*kdf_key));
+    }
+
+    return result;
+}
+
+oe_result_t oe_kdf_key_derive(
+    const oe_kdf_key_t* kdf_key,
     const uint8_t* fixed_data,
     size_t fixed_data_size,
     uint8_t* derived_key,
     size_t derived_key_size)
 {
     oe_result_t result = OE_UNEXPECTED;
+    const oe_kdf_key_impl_t* impl = (const oe_kdf_key_impl_t*)kdf_key;
 
-    if (!key || !derived_key)
+    if (!kdf_key || !derived_key)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    switch (mode)
+    switch (impl->mode)
     {
         case OE_KDF_HMAC_SHA256_CTR:
             OE_CHECK(kdf_hmac_sha256_ctr(
-                key,
-                key_size,
+                impl,
                 fixed_data,
                 fixed_data_size,
                 derived_key,
@@ -192,3 +327,82 @@ oe_result_t oe_kdf_derive_key(
 done:
     return result;
 }
+
+oe_result_t oe_kdf_key_derive_many(
+    const oe_kdf_key_t* kdf_key,
+    const uint8_t* const* fixed_data,
+    const size_t* fixed_data_sizes,
+    size_t count,
+    uint8_t* derived_keys,
+    size_t derived_key_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t total_size;
+    bool sized = false;
+
+    if (!kdf_key || !fixed_data || !fixed_data_sizes || !derived_keys)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_sizet(count, derived_key_size, &total_size));
+    sized = true;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        OE_CHECK(oe_kdf_key_derive(
+            kdf_key,
+            fixed_data[i],
+            fixed_data_sizes[i],
+            derived_keys + i * derived_key_size,
+            derived_key_size));
+    }
+
+    result = OE_OK;
+
+done:
+    /* Do not hand out a partial set of keys */
+    if (result != OE_OK && sized)
+        oe_secure_zero_fill(derived_keys, total_size);
+
+    return result;
+}
+
+oe_result_t oe_kdf_key_free(oe_kdf_key_t* kdf_key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!kdf_key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    _free_key((oe_kdf_key_impl_t*)kdf_key);
+    oe_secure_zero_fill(kdf_key, sizeof(*kdf_key));
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_kdf_derive_key(
+    oe_kdf_mode_t mode,
+    const uint8_t* key,
+    size_t key_size,
+    const uint8_t* fixed_data,
+    size_t fixed_data_size,
+    uint8_t* derived_key,
+    size_t derived_key_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_kdf_key_t kdf_key = {{0}};
+
+    if (!key || !derived_key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_kdf_key_init(mode, key, key_size, &kdf_key));
+    OE_CHECK(oe_kdf_key_derive(
+        &kdf_key, fixed_data, fixed_data_size, derived_key, derived_key_size));
+
+    result = OE_OK;
+
+done:
+    oe_kdf_key_free(&kdf_key);
+    return result;
+}
@@ -99,6 +99,8 @@ const char* oe_result_str(oe_result_t result)
             return "OE_UNSUPPORTED_ENCLAVE_IMAGE";
         case OE_VERIFY_CRL_EXPIRED:
             return "OE_VERIFY_CRL_EXPIRED";
+        case OE_CANCELED:
+            return "OE_CANCELED";
         case __OE_RESULT_MAX:
             break;
     }
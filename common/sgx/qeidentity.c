@@ -37,8 +37,6 @@ oe_result_t oe_enforce_qe_identity(sgx_report_body_t* qe_report_body)
 {
     oe_result_t result = OE_FAILURE;
     oe_get_qe_identity_info_args_t qe_id_args = {0};
-    const uint8_t* pem_pck_certificate = NULL;
-    size_t pem_pck_certificate_size = 0;
     oe_cert_chain_t pck_cert_chain = {0};
     oe_parsed_qe_identity_info_t parsed_info = {0};
 
@@ -77,13 +75,14 @@ oe_result_t oe_enforce_qe_identity(sgx_report_body_t* qe_report_body)
 
     // Use QE Identity info to validate QE
     // Check against fetched qe identityinfo
-    OE_TRACE_INFO("qe_identity.issuer_chain:[%s]\n", qe_id_args.issuer_chain);
-    pem_pck_certificate = qe_id_args.issuer_chain;
-    pem_pck_certificate_size = qe_id_args.issuer_chain_size;
-
-    // validate the cert chain.
-    OE_CHECK(oe_cert_chain_read_pem(
-        &pck_cert_chain, pem_pck_certificate, pem_pck_certificate_size));
+    OE_TRACE_INFO(
+        "qe_identity.issuer_chain_size = %zu\n", qe_id_args.issuer_chain_size);
+
+    // validate the cert chain. The host provides it as concatenated DER.
+    OE_CHECK(oe_cert_chain_read_der(
+        &pck_cert_chain,
+        qe_id_args.issuer_chain,
+        qe_id_args.issuer_chain_size));
 
     // parse identity info json blob
     OE_TRACE_INFO("*qe_identity.qe_id_info:[%s]\n", qe_id_args.qe_id_info);
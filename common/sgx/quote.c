@@ -206,7 +206,8 @@ oe_result_t VerifyQuoteImpl(
 
     // PckCertificate Chain validations.
     {
-        // Read and validate the chain.
+        // Read and validate the chain. The quote's certification data embeds
+        // the PCK chain as PEM, so unlike the collateral chains it stays PEM.
         OE_CHECK(oe_cert_chain_read_pem(
             &pck_cert_chain, pem_pck_certificate, pem_pck_certificate_size));
 
@@ -203,8 +203,9 @@ oe_result_t oe_enforce_revocation(
 
     OE_CHECK(oe_get_revocation_info(&revocation_args));
 
-    // Apply revocation info.
-    OE_CHECK(oe_cert_chain_read_pem(
+    // Apply revocation info. The host provides the issuer chains as
+    // concatenated DER certificates.
+    OE_CHECK(oe_cert_chain_read_der(
         &tcb_issuer_chain,
         revocation_args.tcb_issuer_chain,
         revocation_args.tcb_issuer_chain_size));
@@ -215,14 +216,14 @@ oe_result_t oe_enforce_revocation(
     {
         OE_CHECK(oe_crl_read_der(
             &crls[i], revocation_args.crl[i], revocation_args.crl_size[i]));
-        OE_CHECK(oe_cert_chain_read_pem(
+        OE_CHECK(oe_cert_chain_read_der(
             &crl_issuer_chain[i],
             revocation_args.crl_issuer_chain[i],
             revocation_args.crl_issuer_chain_size[i]));
         OE_TRACE_VERBOSE(
-            "CRL certificate[%d]: \n[%s]\n",
+            "CRL issuer chain[%d] size = %zu\n",
             i,
-            revocation_args.crl_issuer_chain[i]);
+            revocation_args.crl_issuer_chain_size[i]);
     }
 
     // Verify the leaf cert.
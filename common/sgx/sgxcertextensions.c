@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 #include <openenclave/bits/safecrt.h>
+#include <openenclave/internal/asn1.h>
 #include <openenclave/internal/cert.h>
 #include <openenclave/internal/ec.h>
 #include <openenclave/internal/hexdump.h>
@@ -64,14 +65,9 @@ OE_STATIC_ASSERT(
     OE_COUNTOF(_tcb_comp_svn_oids));
 
 /**
- * Read length from the current location in ASN1 stream.
- * Length has 3 encodings described below:
- * Assume p is the current location in ASN1 stream.
- *
- * 1) If *p < 0x80, then *p is the length.
- * 2) If *p > 0x80, then *p-0x80 is the number of bytes that make up the length.
- * 3) If *p == 0x80, then the data is variable length and is terminated by two
- * zeros. We don't support this since Intel extensions are not variable length.
+ * Read a DER length from the current location in the ASN1 stream. Lengths
+ * that are not minimally encoded, indefinite or zero, or that run past the
+ * end of the stream, are rejected.
  */
 static oe_result_t _read_asn1_length(
     uint8_t** itr,
@@ -79,43 +75,23 @@ static oe_result_t _read_asn1_length(
     size_t* length)
 {
     oe_result_t result = OE_INVALID_SGX_CERTIFICATE_EXTENSIONS;
-    uint8_t* p = NULL;
-    uint8_t bytes = 0;
+    oe_asn1_t asn1;
 
     if (itr == NULL || *itr == NULL || end == NULL || length == NULL)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    p = *itr;
     *length = 0;
 
-    if (p < end)
-    {
-        if (*p < 0x80)
-        {
-            // Length is *p.
-            *length = *p++;
-            *itr = p;
-        }
-        else if (*p > 0x80)
-        {
-            bytes = (uint8_t)(*p++ - 0x80);
-            while (bytes > 0 && p < end)
-            {
-                *length = (*length << 8) | *p;
-                ++p;
-                --bytes;
-            }
-            // Assert that all the length bytes were read.
-            if (bytes == 0)
-            {
-                *itr = p;
-            }
-        }
-    }
+    if (*itr >= end)
+        OE_RAISE(OE_INVALID_SGX_CERTIFICATE_EXTENSIONS);
 
-    // Ensure that the read length is valid.
-    if (*length && (*itr + *length <= end))
-        result = OE_OK;
+    oe_asn1_init(&asn1, *itr, (size_t)(end - *itr));
+
+    if (oe_asn1_get_length(&asn1, length) != OE_OK || *length == 0)
+        OE_RAISE(OE_INVALID_SGX_CERTIFICATE_EXTENSIONS);
+
+    *itr = (uint8_t*)asn1.ptr;
+    result = OE_OK;
 
 done:
 
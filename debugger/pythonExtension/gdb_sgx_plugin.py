@@ -256,6 +256,36 @@ class OCallStartBreakpoint(gdb.Breakpoint):
         update_untrusted_ocall_frame(frame_pointer, ocallcontext_tuple)
         return False
 
+class LockProfileCommand(gdb.Command):
+    """Print the contention statistics of the enclave locks.
+
+Requires an enclave runtime built with USE_LOCK_PROFILING. With several
+enclaves loaded, the statistics of the enclave gdb resolves
+oe_lock_profiles in are printed, e.g. that of the selected frame."""
+
+    def __init__(self):
+        gdb.Command.__init__(self, "oe-lock-profile", gdb.COMMAND_DATA)
+
+    def invoke(self, arg, from_tty):
+        try:
+            table = gdb.parse_and_eval("oe_lock_profiles")
+        except gdb.error:
+            print("oegdb: oe_lock_profiles not found, is the enclave built with USE_LOCK_PROFILING?")
+            return
+        types = {1: "mutex", 2: "cond", 3: "rwlock"}
+        profiles = []
+        (low, high) = table.type.range()
+        for i in range(low, high + 1):
+            profile = table[i]
+            if int(profile['lock']) != 0:
+                profiles.append(profile)
+        profiles.sort(key=lambda p: (int(p['wait_ns']), int(p['contended'])), reverse=True)
+        print("%-18s %-6s %12s %12s %12s %14s" % ("lock", "type", "acquires", "contended", "parks", "wait_us"))
+        for p in profiles:
+            print("0x%-16x %-6s %12d %12d %12d %14d" % (
+                int(p['lock']), types.get(int(p['type']), "?"), int(p['acquires']),
+                int(p['contended']), int(p['parks']), int(p['wait_ns']) // 1000))
+
 def new_objfile_handler(event):
     global g_enclave_list_parsed
     if not g_enclave_list_parsed:
@@ -318,6 +348,7 @@ def oe_debugger_init():
     EnclaveCreationBreakpoint()
     EnclaveTerminationBreakpoint()
     OCallStartBreakpoint()
+    LockProfileCommand()
     return
 
 def oe_debugger_cleanup():
@@ -4,7 +4,6 @@
 /* Nest mbedtls header includes with required corelibc defines */
 // clang-format off
 #include "mbedtls_corelibc_defs.h"
-#include <mbedtls/oid.h>
 #include <mbedtls/platform.h>
 #include <mbedtls/x509_crt.h>
 #include "mbedtls_corelibc_undef.h"
@@ -13,6 +12,7 @@
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/asn1.h>
 #include <openenclave/internal/atomic.h>
 #include <openenclave/internal/cert.h>
 #include <openenclave/internal/hexdump.h>
@@ -128,6 +128,9 @@ typedef struct _cert
 
     /* Pointer to referent if this certificate is part of a chain */
     Referent* referent;
+
+    /* Index of the extensions, built by the first extension lookup */
+    oe_asn1_extensions_t* extensions;
 } Cert;
 
 OE_STATIC_ASSERT(sizeof(Cert) <= sizeof(oe_cert_t));
@@ -140,6 +143,7 @@ OE_INLINE void _cert_init(
     impl->magic = OE_CERT_MAGIC;
     impl->cert = cert;
     impl->referent = referent;
+    impl->extensions = NULL;
     _referent_add_ref(impl->referent);
 }
 
@@ -150,6 +154,12 @@ OE_INLINE bool _cert_is_valid(const Cert* impl)
 
 OE_INLINE void _cert_free(Cert* impl)
 {
+    if (impl->extensions)
+    {
+        oe_asn1_free_extensions(impl->extensions);
+        mbedtls_free(impl->extensions);
+    }
+
     /* Release the referent if its reference count is one */
     if (impl->referent)
     {
@@ -379,199 +389,54 @@ done:
 /*
 **==============================================================================
 **
-** _parse_extensions()
+** _get_extensions()
 **
 **==============================================================================
 */
 
-/* Returns true when done */
-typedef bool (*parse_extensions_callback_t)(
-    size_t index,
-    const char* oid,
-    bool critical,
-    const uint8_t* data,
-    size_t size,
-    void* args);
-
-typedef struct _find_extension_args
-{
-    oe_result_t result;
-    const char* oid;
-    uint8_t* data;
-    size_t* size;
-} FindExtensionArgs;
-
-static bool _find_extension(
-    size_t index,
-    const char* oid,
-    bool critical,
-    const uint8_t* data,
-    size_t size,
-    void* args_)
-{
-    FindExtensionArgs* args = (FindExtensionArgs*)args_;
-    OE_UNUSED(index);
-    OE_UNUSED(critical);
-
-    if (oe_strcmp(oid, args->oid) == 0)
-    {
-        /* If buffer is too small */
-        if (size > *args->size)
-        {
-            *args->size = size;
-            args->result = OE_BUFFER_TOO_SMALL;
-            return true;
-        }
-
-        /* Copy to caller's buffer */
-        if (args->data)
-            args->result = oe_memcpy_s(args->data, *args->size, data, size);
-        else
-            args->result = OE_OK;
-
-        *args->size = size;
-        return true;
-    }
-
-    /* Keep parsing */
-    return false;
-}
-
-typedef struct _get_extension_count_args
-{
-    size_t* count;
-} GetExtensionCountArgs;
-
-typedef struct _get_extension_args
-{
-    oe_result_t result;
-    size_t index;
-    oe_oid_string_t* oid;
-    uint8_t* data;
-    size_t* size;
-} GetExtensionArgs;
-
-/* Parse the extensions on an MBEDTLS X509 certificate */
-static int _parse_extensions(
-    const mbedtls_x509_crt* crt,
-    parse_extensions_callback_t callback,
-    void* args)
+/* Returns the extension index of a certificate, building it on first use */
+static oe_result_t _get_extensions(
+    const Cert* impl,
+    const oe_asn1_extensions_t** extensions)
 {
-    int ret = -1;
-    uint8_t* p = crt->v3_ext.p;
-    uint8_t* end = p + crt->v3_ext.len;
-    size_t len;
-    int rc;
-    size_t index = 0;
-
-    if (!p)
-    {
-        ret = 0;
-        goto done;
-    }
-    /* Parse tag that introduces the extensions */
-    {
-        int tag = MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE;
-
-        /* Get the tag and length of the entire packet */
-        rc = mbedtls_asn1_get_tag(&p, end, &len, tag);
-        if (rc != 0)
-        {
-            OE_TRACE_ERROR("mbedtls_asn1_get_tag rc= 0x%x\n", rc);
-            goto done;
-        }
-    }
+    oe_result_t result = OE_UNEXPECTED;
+    oe_asn1_extensions_t* index =
+        __atomic_load_n(&impl->extensions, __ATOMIC_ACQUIRE);
+    const mbedtls_x509_buf* v3_ext = &impl->cert->v3_ext;
 
-    /* Parse each extension of the form: [OID | CRITICAL | OCTETS] */
-    while (end - p > 1)
+    if (!index)
     {
-        oe_oid_string_t oidstr;
-        int is_critical = 0;
-        const uint8_t* octets;
-        size_t octets_size;
+        if (!(index = (oe_asn1_extensions_t*)mbedtls_calloc(
+                  1, sizeof(oe_asn1_extensions_t))))
+            OE_RAISE(OE_OUT_OF_MEMORY);
 
-        /* Parse the OID */
+        /* Certificates without extensions have an empty index */
+        if (v3_ext->p)
         {
-            mbedtls_x509_buf oid;
-
-            /* Parse the OID tag */
-            {
-                int tag = MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE;
-
-                rc = mbedtls_asn1_get_tag(&p, end, &len, tag);
-                if (rc != 0)
-                {
-                    OE_TRACE_ERROR("mbedtls_asn1_get_tag rc= 0x%x\n", rc);
-                    goto done;
-                }
-
-                oid.tag = p[0];
-            }
-
-            /* Parse the OID length */
-            {
-                rc = mbedtls_asn1_get_tag(&p, end, &len, MBEDTLS_ASN1_OID);
-                if (rc != 0)
-                {
-                    OE_TRACE_ERROR("mbedtls_asn1_get_tag rc= 0x%x\n", rc);
-                    goto done;
-                }
-
-                oid.len = len;
-                oid.p = p;
-                p += oid.len;
-            }
+            result = oe_asn1_index_extensions(v3_ext->p, v3_ext->len, index);
 
-            /* Convert OID to a string */
-            rc = mbedtls_oid_get_numeric_string(
-                oidstr.buf, sizeof(oidstr.buf), &oid);
-            if (rc < 0)
+            if (result != OE_OK)
             {
-                OE_TRACE_ERROR("mbedtls_oid_get_numeric_string rc= 0x%x\n", rc);
-                goto done;
+                mbedtls_free(index);
+                OE_RAISE(result);
             }
         }
 
-        /* Parse the critical flag */
+        /* Another thread may have built the index in the meantime */
+        if (!__sync_bool_compare_and_swap(
+                &((Cert*)impl)->extensions, NULL, index))
         {
-            rc = (mbedtls_asn1_get_bool(&p, end, &is_critical));
-            if (rc != 0 && rc != MBEDTLS_ERR_ASN1_UNEXPECTED_TAG)
-            {
-                OE_TRACE_ERROR("mbedtls_asn1_get_bool rc= 0x%x\n", rc);
-                goto done;
-            }
-        }
-
-        /* Parse the octet string */
-        {
-            const int tag = MBEDTLS_ASN1_OCTET_STRING;
-            rc = mbedtls_asn1_get_tag(&p, end, &len, tag);
-            if (rc != 0)
-            {
-                OE_TRACE_ERROR("mbedtls_asn1_get_tag rc= 0x%x\n", rc);
-                goto done;
-            }
-
-            octets = p;
-            octets_size = len;
-            p += len;
-        }
-
-        /* Invoke the caller's callback (returns true when done) */
-        if (callback(index, oidstr.buf, is_critical, octets, octets_size, args))
-        {
-            ret = 0;
-            goto done;
+            oe_asn1_free_extensions(index);
+            mbedtls_free(index);
+            index = __atomic_load_n(&impl->extensions, __ATOMIC_ACQUIRE);
         }
-
-        /* Increment the index */
-        index++;
     }
 
-    ret = 0;
+    *extensions = index;
+    result = OE_OK;
 
 done:
-    return ret;
+    return result;
 }
 
 /*
@@ -582,6 +447,30 @@ done:
 **==============================================================================
 */
 
+/* Orders and verifies a freshly parsed chain and initializes the handle */
+static oe_result_t _cert_chain_finish(CertChain* impl, Referent* referent)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    /* Reorder certs in the chain to preferred order */
+    referent->crt = _sort_certs_by_issue_date(referent->crt);
+
+    /* Verify the whole certificate chain */
+    OE_CHECK(_verify_whole_chain(referent->crt));
+
+    /* Calculate the length of the certificate chain */
+    for (mbedtls_x509_crt* p = referent->crt; p; p = p->next)
+        referent->length++;
+
+    /* Initialize the implementation and increment reference count */
+    OE_CHECK(_cert_chain_init(impl, referent));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t oe_cert_read_pem(
     oe_cert_t* cert,
     const void* pem_data,
@@ -634,6 +523,63 @@ done:
     return result;
 }
 
+oe_result_t oe_cert_read_der(
+    oe_cert_t* cert,
+    const void* der_data,
+    size_t der_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    Cert* impl = (Cert*)cert;
+    mbedtls_x509_crt* crt = NULL;
+    oe_asn1_t asn1;
+    oe_asn1_t sequence;
+    int rc = 0;
+
+    /* Clear the implementation */
+    if (impl)
+        memset(impl, 0, sizeof(Cert));
+
+    /* Check parameters */
+    if (!der_data || !der_size || !cert)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Must be exactly one DER certificate */
+    oe_asn1_init(&asn1, (const uint8_t*)der_data, der_size);
+    OE_CHECK(oe_asn1_get_sequence(&asn1, &sequence));
+
+    if (oe_asn1_more(&asn1))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Allocate memory for the certificate */
+    if (!(crt = mbedtls_calloc(1, sizeof(mbedtls_x509_crt))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Initialize the certificate structure */
+    mbedtls_x509_crt_init(crt);
+
+    /* Parse the DER buffer directly, without any PEM decoding */
+    rc = mbedtls_x509_crt_parse_der(crt, (const uint8_t*)der_data, der_size);
+    if (rc != 0)
+        OE_RAISE(OE_FAILURE, "mbedtls_x509_crt_parse_der rc= 0x%x\n", rc);
+
+    /* Initialize the implementation */
+    _cert_init(impl, crt, NULL);
+    crt = NULL;
+
+    result = OE_OK;
+
+done:
+
+    if (crt)
+    {
+        mbedtls_x509_crt_free(crt);
+        memset(crt, 0, sizeof(mbedtls_x509_crt));
+        mbedtls_free(crt);
+    }
+
+    return result;
+}
+
 oe_result_t oe_cert_free(oe_cert_t* cert)
 {
     oe_result_t result = OE_UNEXPECTED;
@@ -684,18 +630,57 @@ oe_result_t oe_cert_chain_read_pem(
     if (rc != 0)
         OE_RAISE(OE_FAILURE, "mbedtls_x509_crt_parse rc= 0x%x\n", rc);
 
-    /* Reorder certs in the chain to preferred order */
-    referent->crt = _sort_certs_by_issue_date(referent->crt);
+    OE_CHECK(_cert_chain_finish(impl, referent));
 
-    /* Verify the whole certificate chain */
-    OE_CHECK(_verify_whole_chain(referent->crt));
+    result = OE_OK;
 
-    /* Calculate the length of the certificate chain */
-    for (mbedtls_x509_crt* p = referent->crt; p; p = p->next)
-        referent->length++;
+done:
 
-    /* Initialize the implementation and increment reference count */
-    OE_CHECK(_cert_chain_init(impl, referent));
+    _referent_free(referent);
+
+    return result;
+}
+
+oe_result_t oe_cert_chain_read_der(
+    oe_cert_chain_t* chain,
+    const void* der_data,
+    size_t der_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    CertChain* impl = (CertChain*)chain;
+    Referent* referent = NULL;
+    oe_asn1_t asn1;
+    int rc = 0;
+
+    /* Clear the implementation (making it invalid) */
+    if (impl)
+        memset(impl, 0, sizeof(CertChain));
+
+    /* Check parameters */
+    if (!der_data || !der_size || !chain)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Create the referent */
+    if (!(referent = _referent_new()))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Parse each of the concatenated DER certificates in place */
+    oe_asn1_init(&asn1, (const uint8_t*)der_data, der_size);
+
+    while (oe_asn1_more(&asn1))
+    {
+        const uint8_t* start = asn1.ptr;
+        oe_asn1_t sequence;
+
+        OE_CHECK(oe_asn1_get_sequence(&asn1, &sequence));
+
+        rc = mbedtls_x509_crt_parse_der(
+            referent->crt, start, (size_t)(asn1.ptr - start));
+        if (rc != 0)
+            OE_RAISE(OE_FAILURE, "mbedtls_x509_crt_parse_der rc= 0x%x\n", rc);
+    }
+
+    OE_CHECK(_cert_chain_finish(impl, referent));
 
     result = OE_OK;
 
@@ -1014,21 +999,32 @@ oe_result_t oe_cert_find_extension(
     if (!_cert_is_valid(impl) || !oid || !size)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    /* Find the extension with the given OID using a callback */
+    /* Find the extension with the given OID in the index */
     {
-        FindExtensionArgs args;
-        args.result = OE_NOT_FOUND;
-        args.oid = oid;
-        args.data = data;
-        args.size = size;
+        const oe_asn1_extensions_t* extensions;
+        const oe_asn1_extension_t* extension;
+
+        OE_CHECK(_get_extensions(impl, &extensions));
+        OE_CHECK_NO_TRACE(
+            oe_asn1_find_extension(extensions, oid, &extension));
+
+        /* If buffer is too small */
+        if (extension->size > *size)
+        {
+            *size = extension->size;
+            OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+        }
 
-        if (_parse_extensions(impl->cert, _find_extension, &args) != 0)
-            OE_RAISE(OE_FAILURE);
+        /* Copy to caller's buffer */
+        if (data)
+            OE_CHECK(oe_memcpy_s(
+                data, *size, extension->data, extension->size));
 
-        result = args.result;
-        goto done;
+        *size = extension->size;
     }
 
+    result = OE_OK;
+
 done:
     return result;
 }
@@ -4,50 +4,309 @@
 /* Nest mbedtls header includes with required corelibc defines */
 // clang-format off
 #include "mbedtls_corelibc_defs.h"
-#include <mbedtls/pk.h>
-#include <mbedtls/cmac.h>
+#include <mbedtls/aes.h>
+#include <mbedtls/aesni.h>
 #include "mbedtls_corelibc_undef.h"
 // clang-format on
 
+#include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/cmac.h>
+#include <openenclave/internal/defs.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/utils.h>
 
-oe_result_t oe_aes_cmac_sign(
+#define AES_BLOCK_SIZE 16
+#define AES_128_ROUNDS 10
+#define AES_128_ROUND_KEYS_SIZE (AES_BLOCK_SIZE * (AES_128_ROUNDS + 1))
+
+/* Constant for the subkey derivation of a 128-bit block cipher (RFC 4493) */
+#define CMAC_RB 0x87
+
+typedef long long aes_block_t __attribute__((vector_size(AES_BLOCK_SIZE)));
+
+typedef struct _oe_aes_cmac_context_impl
+{
+    /* Expanded AES-128 encryption key */
+    uint32_t round_keys[AES_128_ROUND_KEYS_SIZE / sizeof(uint32_t)];
+    uint8_t k1[AES_BLOCK_SIZE];
+    uint8_t k2[AES_BLOCK_SIZE];
+
+    /* CBC-MAC of the blocks processed so far */
+    uint8_t state[AES_BLOCK_SIZE];
+
+    /* The last block is held back until final, as it is masked with a
+     * subkey */
+    uint8_t buffer[AES_BLOCK_SIZE];
+    size_t buffer_size;
+
+    bool aesni;
+} oe_aes_cmac_context_impl_t;
+
+OE_STATIC_ASSERT(
+    sizeof(oe_aes_cmac_context_impl_t) <= sizeof(oe_aes_cmac_context_t));
+
+__attribute__((target("aes"))) static void _cbc_mac_aesni(
+    const uint32_t* round_keys,
+    uint8_t state[AES_BLOCK_SIZE],
+    const uint8_t* blocks,
+    size_t count)
+{
+    aes_block_t rk[AES_128_ROUNDS + 1];
+    aes_block_t x;
+
+    memcpy(rk, round_keys, sizeof(rk));
+    memcpy(&x, state, sizeof(x));
+
+    for (size_t i = 0; i < count; i++)
+    {
+        aes_block_t m;
+
+        memcpy(&m, blocks + i * AES_BLOCK_SIZE, sizeof(m));
+        x ^= m ^ rk[0];
+
+        for (size_t r = 1; r < AES_128_ROUNDS; r++)
+            x = __builtin_ia32_aesenc128(x, rk[r]);
+
+        x = __builtin_ia32_aesenclast128(x, rk[AES_128_ROUNDS]);
+    }
+
+    memcpy(state, &x, sizeof(x));
+    oe_secure_zero_fill(rk, sizeof(rk));
+}
+
+/* Folds whole blocks into the CBC-MAC state */
+static void _cbc_mac(
+    oe_aes_cmac_context_impl_t* impl,
+    const uint8_t* blocks,
+    size_t count)
+{
+    if (impl->aesni)
+    {
+        _cbc_mac_aesni(impl->round_keys, impl->state, blocks, count);
+    }
+    else
+    {
+        mbedtls_aes_context aes = {0};
+
+        aes.nr = AES_128_ROUNDS;
+        aes.rk = impl->round_keys;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t j = 0; j < AES_BLOCK_SIZE; j++)
+                impl->state[j] ^= blocks[i * AES_BLOCK_SIZE + j];
+
+            mbedtls_internal_aes_encrypt(&aes, impl->state, impl->state);
+        }
+    }
+}
+
+/* Multiplies a block by x in GF(2^128), in constant time */
+static void _double_block(
+    const uint8_t in[AES_BLOCK_SIZE],
+    uint8_t out[AES_BLOCK_SIZE])
+{
+    uint8_t carry = (uint8_t)(0 - (in[0] >> 7));
+
+    for (size_t i = 0; i < AES_BLOCK_SIZE - 1; i++)
+        out[i] = (uint8_t)((in[i] << 1) | (in[i + 1] >> 7));
+
+    out[AES_BLOCK_SIZE - 1] =
+        (uint8_t)((in[AES_BLOCK_SIZE - 1] << 1) ^ (carry & CMAC_RB));
+}
+
+oe_result_t oe_aes_cmac_init(
+    oe_aes_cmac_context_t* context,
     const uint8_t* key,
-    size_t key_size,
+    size_t key_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_aes_cmac_context_impl_t* impl = (oe_aes_cmac_context_impl_t*)context;
+    mbedtls_aes_context aes;
+    const uint8_t zero[AES_BLOCK_SIZE] = {0};
+    int res;
+
+    mbedtls_aes_init(&aes);
+
+    if (!context || !key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (key_size * 8 != 128)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    oe_secure_zero_fill(impl, sizeof(*impl));
+
+    /* The key schedule is only computed once per context */
+    res = mbedtls_aes_setkey_enc(&aes, key, 128);
+    if (res != 0)
+        OE_RAISE_MSG(OE_FAILURE, "mbedtls error: 0x%x", res);
+
+    memcpy(impl->round_keys, aes.rk, sizeof(impl->round_keys));
+    impl->aesni = mbedtls_aesni_has_support(MBEDTLS_AESNI_AES) != 0;
+
+    /* L = AES(K, 0), K1 = L * x, K2 = K1 * x */
+    _cbc_mac(impl, zero, 1);
+    _double_block(impl->state, impl->k1);
+    _double_block(impl->k1, impl->k2);
+    oe_secure_zero_fill(impl->state, sizeof(impl->state));
+
+    result = OE_OK;
+
+done:
+    mbedtls_aes_free(&aes);
+    return result;
+}
+
+oe_result_t oe_aes_cmac_update(
+    oe_aes_cmac_context_t* context,
     const uint8_t* message,
-    size_t message_length,
+    size_t message_length)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_aes_cmac_context_impl_t* impl = (oe_aes_cmac_context_impl_t*)context;
+    size_t count;
+
+    if (!context || (!message && message_length))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (message_length == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    /* Complete the held back block, and process it only once it is known
+     * not to be the last one */
+    if (impl->buffer_size)
+    {
+        size_t n = AES_BLOCK_SIZE - impl->buffer_size;
+
+        if (n > message_length)
+            n = message_length;
+
+        memcpy(impl->buffer + impl->buffer_size, message, n);
+        impl->buffer_size += n;
+        message += n;
+        message_length -= n;
+
+        if (message_length == 0)
+        {
+            result = OE_OK;
+            goto done;
+        }
+
+        _cbc_mac(impl, impl->buffer, 1);
+        impl->buffer_size = 0;
+    }
+
+    /* Process every block but the last straight from the message */
+    count = (message_length - 1) / AES_BLOCK_SIZE;
+    _cbc_mac(impl, message, count);
+    message += count * AES_BLOCK_SIZE;
+    message_length -= count * AES_BLOCK_SIZE;
+
+    memcpy(impl->buffer, message, message_length);
+    impl->buffer_size = message_length;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_aes_cmac_final(
+    oe_aes_cmac_context_t* context,
     oe_aes_cmac_t* aes_cmac)
 {
     oe_result_t result = OE_UNEXPECTED;
-    const mbedtls_cipher_info_t* info = NULL;
-    size_t key_size_bits = key_size * 8;
+    oe_aes_cmac_context_impl_t* impl = (oe_aes_cmac_context_impl_t*)context;
+    uint8_t last[AES_BLOCK_SIZE];
 
-    if (aes_cmac == NULL)
+    if (!context || !aes_cmac)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-    if (key_size_bits != 128)
-        OE_RAISE(OE_UNSUPPORTED);
+    if (impl->buffer_size == AES_BLOCK_SIZE)
+    {
+        for (size_t i = 0; i < AES_BLOCK_SIZE; i++)
+            last[i] = impl->buffer[i] ^ impl->k1[i];
+    }
+    else
+    {
+        memset(last, 0, sizeof(last));
+        memcpy(last, impl->buffer, impl->buffer_size);
+        last[impl->buffer_size] = 0x80;
+
+        for (size_t i = 0; i < AES_BLOCK_SIZE; i++)
+            last[i] ^= impl->k2[i];
+    }
 
-    info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB);
-    if (info == NULL)
-        OE_RAISE(OE_FAILURE);
+    _cbc_mac(impl, last, 1);
 
     oe_secure_zero_fill(aes_cmac->impl, sizeof(*aes_cmac));
+    memcpy(aes_cmac->impl, impl->state, sizeof(impl->state));
+
+    /* Keep the key so that the context can sign the next message */
+    oe_secure_zero_fill(impl->state, sizeof(impl->state));
+    oe_secure_zero_fill(impl->buffer, sizeof(impl->buffer));
+    impl->buffer_size = 0;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_aes_cmac_free(oe_aes_cmac_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!context)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_secure_zero_fill(context, sizeof(*context));
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_aes_cmac_compute(
+    oe_aes_cmac_context_t* context,
+    const uint8_t* message,
+    size_t message_length,
+    oe_aes_cmac_t* aes_cmac)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_CHECK(oe_aes_cmac_update(context, message, message_length));
+    OE_CHECK(oe_aes_cmac_final(context, aes_cmac));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_aes_cmac_sign(
+    const uint8_t* key,
+    size_t key_size,
+    const uint8_t* message,
+    size_t message_length,
+    oe_aes_cmac_t* aes_cmac)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_aes_cmac_context_t context;
+
+    if (aes_cmac == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
 
-    if (mbedtls_cipher_cmac(
-            info,
-            key,
-            key_size_bits,
-            message,
-            message_length,
-            (uint8_t*)aes_cmac->impl) != 0)
-        OE_RAISE(OE_FAILURE);
+    OE_CHECK(oe_aes_cmac_init(&context, key, key_size));
+    OE_CHECK(oe_aes_cmac_compute(&context, message, message_length, aes_cmac));
 
     result = OE_OK;
 
 done:
+    oe_secure_zero_fill(&context, sizeof(context));
     return result;
 }
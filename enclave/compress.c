@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/compress.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+
+/* Decompresses the image into a new heap buffer */
+static oe_result_t _decompress(
+    const oe_compressed_data_t* compressed,
+    void** data,
+    size_t* size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_compressed_header_t header;
+    void* buffer = NULL;
+
+    /* The image is part of the measured enclave image, so it must lie
+     * inside the enclave */
+    if (!oe_is_within_enclave(compressed->image, compressed->image_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_get_compressed_header(
+        compressed->image, compressed->image_size, &header));
+
+    /* Empty data still gets a buffer so that success has a non-null data */
+    if (!(buffer = oe_malloc(
+              header.uncompressed_size ? header.uncompressed_size : 1)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_decompress_image(
+        compressed->image,
+        compressed->image_size,
+        buffer,
+        header.uncompressed_size));
+
+    *data = buffer;
+    *size = header.uncompressed_size;
+    buffer = NULL;
+    result = OE_OK;
+
+done:
+    oe_free(buffer);
+    return result;
+}
+
+oe_result_t oe_get_compressed_data(
+    oe_compressed_data_t* compressed,
+    const void** data,
+    size_t* size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t decompressed;
+    void* buffer = NULL;
+    size_t buffer_size = 0;
+
+    if (data)
+        *data = NULL;
+
+    if (size)
+        *size = 0;
+
+    if (!compressed || !data || !size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_spin_lock(&compressed->lock);
+
+    if (compressed->initialized)
+    {
+        result = compressed->result;
+
+        if (result == OE_OK)
+        {
+            *data = compressed->data;
+            *size = compressed->size;
+        }
+
+        oe_spin_unlock(&compressed->lock);
+        goto done;
+    }
+
+    oe_spin_unlock(&compressed->lock);
+
+    /* Decompress into a private buffer without holding the lock, so that
+     * other threads only spin while the result is published */
+    decompressed = _decompress(compressed, &buffer, &buffer_size);
+
+    oe_spin_lock(&compressed->lock);
+
+    /* Publish unless another thread got there first. Out of memory is not
+     * sticky: a later call may succeed. */
+    if (!compressed->initialized && decompressed != OE_OUT_OF_MEMORY)
+    {
+        compressed->result = decompressed;
+
+        if (decompressed == OE_OK)
+        {
+            compressed->data = buffer;
+            compressed->size = buffer_size;
+            buffer = NULL;
+        }
+
+        compressed->initialized = true;
+    }
+
+    if (compressed->initialized)
+    {
+        result = compressed->result;
+
+        if (result == OE_OK)
+        {
+            *data = compressed->data;
+            *size = compressed->size;
+        }
+    }
+    else
+    {
+        result = decompressed;
+    }
+
+    oe_spin_unlock(&compressed->lock);
+
+    /* Free the copy that lost the race to publish */
+    oe_free(buffer);
+
+done:
+    return result;
+}
+
+void oe_release_compressed_data(oe_compressed_data_t* compressed)
+{
+    if (!compressed)
+        return;
+
+    oe_spin_lock(&compressed->lock);
+    oe_free(compressed->data);
+    compressed->data = NULL;
+    compressed->size = 0;
+    compressed->result = OE_OK;
+    compressed->initialized = false;
+    oe_spin_unlock(&compressed->lock);
+}
@@ -0,0 +1,227 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/* Nest mbedtls header includes with required corelibc defines */
+// clang-format off
+#include "mbedtls_corelibc_defs.h"
+#include <mbedtls/gcm.h>
+#include "mbedtls_corelibc_undef.h"
+// clang-format on
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/edger8r/enclave.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/arena.h>
+#include <openenclave/internal/copyin.h>
+#include <openenclave/internal/hmac.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+
+#define AES_GCM_MAX_TAG_SIZE 16
+
+static oe_result_t _check_buffers(
+    const void* dest,
+    const void* src,
+    size_t size)
+{
+    if (!dest || !src)
+        return OE_INVALID_PARAMETER;
+
+    if (!oe_is_within_enclave(dest, size) || !oe_is_outside_enclave(src, size))
+        return OE_INVALID_PARAMETER;
+
+    return OE_OK;
+}
+
+oe_result_t oe_copy_in_sha256(
+    void* dest,
+    const void* src,
+    size_t size,
+    OE_SHA256* sha256)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* p = (uint8_t*)dest;
+    const uint8_t* q = (const uint8_t*)src;
+    oe_sha256_context_t context = {{0}};
+
+    if (!sha256)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_check_buffers(dest, src, size));
+    OE_CHECK(oe_sha256_init(&context));
+
+    /* Hash each chunk from its enclave copy while it is still cached */
+    while (size)
+    {
+        size_t n = size < OE_COPY_IN_CHUNK_SIZE ? size : OE_COPY_IN_CHUNK_SIZE;
+
+        memcpy(p, q, n);
+        OE_CHECK(oe_sha256_update(&context, p, n));
+
+        p += n;
+        q += n;
+        size -= n;
+    }
+
+    OE_CHECK(oe_sha256_final(&context, sha256));
+
+    result = OE_OK;
+
+done:
+    oe_sha256_free(&context);
+    return result;
+}
+
+oe_result_t oe_copy_in_hmac_sha256(
+    void* dest,
+    const void* src,
+    size_t size,
+    const uint8_t* key,
+    size_t key_size,
+    OE_SHA256* hmac)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* p = (uint8_t*)dest;
+    const uint8_t* q = (const uint8_t*)src;
+    oe_hmac_sha256_context_t context;
+    bool initialized = false;
+
+    if (!hmac)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_check_buffers(dest, src, size));
+    OE_CHECK(oe_hmac_sha256_init(&context, key, key_size));
+    initialized = true;
+
+    while (size)
+    {
+        size_t n = size < OE_COPY_IN_CHUNK_SIZE ? size : OE_COPY_IN_CHUNK_SIZE;
+
+        memcpy(p, q, n);
+        OE_CHECK(oe_hmac_sha256_update(&context, p, n));
+
+        p += n;
+        q += n;
+        size -= n;
+    }
+
+    OE_CHECK(oe_hmac_sha256_final(&context, hmac));
+
+    result = OE_OK;
+
+done:
+
+    if (initialized)
+        oe_hmac_sha256_free(&context);
+
+    return result;
+}
+
+oe_result_t oe_copy_in_aes_gcm_decrypt(
+    void* dest,
+    const void* src,
+    size_t size,
+    const uint8_t* key,
+    size_t key_size,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* tag,
+    size_t tag_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t* p = (uint8_t*)dest;
+    const uint8_t* q = (const uint8_t*)src;
+    size_t remaining = size;
+    mbedtls_gcm_context context;
+    uint8_t chunk[OE_COPY_IN_CHUNK_SIZE];
+    uint8_t computed_tag[AES_GCM_MAX_TAG_SIZE];
+    int res;
+
+    mbedtls_gcm_init(&context);
+
+    if (!key || !iv || !iv_size || (!aad && aad_size) || !tag)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (key_size != 16 && key_size != 24 && key_size != 32)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (tag_size < 4 || tag_size > AES_GCM_MAX_TAG_SIZE)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_check_buffers(dest, src, size));
+
+    res = mbedtls_gcm_setkey(
+        &context, MBEDTLS_CIPHER_ID_AES, key, (unsigned int)key_size * 8);
+    if (res != 0)
+        OE_RAISE_MSG(OE_FAILURE, "mbedtls error: 0x%x", res);
+
+    res = mbedtls_gcm_starts(
+        &context, MBEDTLS_GCM_DECRYPT, iv, iv_size, aad, aad_size);
+    if (res != 0)
+        OE_RAISE_MSG(OE_FAILURE, "mbedtls error: 0x%x", res);
+
+    /* mbedtls cannot decrypt in place, so each chunk of ciphertext is read
+     * into a cached bounce buffer and decrypted into the destination. The
+     * chunk size is a multiple of the AES block size as mbedtls requires. */
+    while (remaining)
+    {
+        size_t n = remaining < sizeof(chunk) ? remaining : sizeof(chunk);
+
+        memcpy(chunk, q, n);
+
+        res = mbedtls_gcm_update(&context, n, chunk, p);
+        if (res != 0)
+            OE_RAISE_MSG(OE_FAILURE, "mbedtls error: 0x%x", res);
+
+        p += n;
+        q += n;
+        remaining -= n;
+    }
+
+    res = mbedtls_gcm_finish(&context, computed_tag, tag_size);
+    if (res != 0)
+        OE_RAISE_MSG(OE_FAILURE, "mbedtls error: 0x%x", res);
+
+    if (!oe_constant_time_mem_equal(computed_tag, tag, tag_size))
+        OE_RAISE(OE_VERIFY_FAILED);
+
+    result = OE_OK;
+
+done:
+
+    /* Never release plaintext that failed authentication */
+    if (result != OE_OK && dest && oe_is_within_enclave(dest, size))
+        oe_secure_zero_fill(dest, size);
+
+    oe_secure_zero_fill(chunk, sizeof(chunk));
+    mbedtls_gcm_free(&context);
+    return result;
+}
+
+oe_result_t oe_copy_in_sha256_param(
+    const void* host_ptr,
+    size_t size,
+    void** enclave_ptr,
+    void* digest,
+    size_t digest_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    void* p = NULL;
+
+    if (!enclave_ptr || !digest || digest_size < sizeof(OE_SHA256))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* The copy lives as long as the other marshalled parameters */
+    if (!(p = oe_arena_alloc(size ? size : 1)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(oe_copy_in_sha256(p, host_ptr, size, (OE_SHA256*)digest));
+
+    *enclave_ptr = p;
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -2,28 +2,48 @@
 // Licensed under the MIT License.
 
 #include "intstr.h"
-#include <openenclave/corelibc/string.h>
 
-const char* oe_uint64_to_hexstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
+/* Decimal digit pairs "00" through "99", so that each division by 100
+ * produces two digits */
+static const char _dec_pairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char _hex_digits[] = "0123456789abcdef";
+
+/* Formats x backwards from end, returning the first digit */
+static char* _format_dec(char* end, uint64_t x)
 {
-    for (size_t i = 0; i < 16; i++)
-        buf->data[15 - i] = oe_get_hex_char(x, i);
+    char* p = end;
 
-    buf->data[16] = '\0';
+    while (x >= 100)
+    {
+        const char* pair = &_dec_pairs[(x % 100) * 2];
 
-    const char* p = buf->data;
+        x /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
 
-    /* Skip over leading zeros (but not the final zero) */
-    while (p[0] && p[1] && p[0] == '0')
-        p++;
+    if (x >= 10)
+    {
+        const char* pair = &_dec_pairs[x * 2];
 
-    if (size)
-        *size = oe_strlen(p);
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    else
+    {
+        *--p = (char)('0' + x);
+    }
 
     return p;
 }
 
-const char* oe_uint64_to_octstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
+const char* oe_uint64_to_hexstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
 {
     char* p;
     char* end = buf->data + sizeof(buf->data) - 1;
@@ -33,8 +53,8 @@ const char* oe_uint64_to_octstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
 
     do
     {
-        *--p = (char)('0' + x % 8);
-    } while (x /= 8);
+        *--p = _hex_digits[x & 0xf];
+    } while (x >>= 4);
 
     if (size)
         *size = (size_t)(end - p);
@@ -42,7 +62,7 @@ const char* oe_uint64_to_octstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
     return p;
 }
 
-const char* oe_uint64_to_decstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
+const char* oe_uint64_to_octstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
 {
     char* p;
     char* end = buf->data + sizeof(buf->data) - 1;
@@ -52,8 +72,8 @@ const char* oe_uint64_to_decstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
 
     do
     {
-        *--p = (char)('0' + x % 10);
-    } while (x /= 10);
+        *--p = (char)('0' + (x & 7));
+    } while (x >>= 3);
 
     if (size)
         *size = (size_t)(end - p);
@@ -61,34 +81,30 @@ const char* oe_uint64_to_decstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
     return p;
 }
 
-const char* oe_int64_to_decstr(oe_intstr_buf_t* buf, int64_t x, size_t* size)
+const char* oe_uint64_to_decstr(oe_intstr_buf_t* buf, uint64_t x, size_t* size)
 {
     char* p;
-    int neg = 0;
-    static const char _str[] = "-9223372036854775808";
     char* end = buf->data + sizeof(buf->data) - 1;
 
-    if (x == OE_INT64_MIN)
-    {
-        *size = sizeof(_str) - 1;
-        return _str;
-    }
+    *end = '\0';
+    p = _format_dec(end, x);
 
-    if (x < 0)
-    {
-        neg = 1;
-        x = -x;
-    }
+    if (size)
+        *size = (size_t)(end - p);
 
-    p = end;
-    *p = '\0';
+    return p;
+}
 
-    do
-    {
-        *--p = (char)('0' + x % 10);
-    } while (x /= 10);
+const char* oe_int64_to_decstr(oe_intstr_buf_t* buf, int64_t x, size_t* size)
+{
+    char* p;
+    char* end = buf->data + sizeof(buf->data) - 1;
 
-    if (neg)
+    /* Negate as unsigned, which is also defined for OE_INT64_MIN */
+    *end = '\0';
+    p = _format_dec(end, x < 0 ? 0 - (uint64_t)x : (uint64_t)x);
+
+    if (x < 0)
         *--p = '-';
 
     if (size)
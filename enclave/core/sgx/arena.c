@@ -0,0 +1,208 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/arena.h>
+#include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+#include "arena.h"
+#include "td.h"
+
+/*
+**==============================================================================
+**
+** Per-thread ecall arena:
+**
+**     Each td_t owns an arena of td->arena_capacity bytes starting at
+**     td->arena_base. Allocations bump td->arena_used. Requests that do not
+**     fit are served from the heap and chained on td->arena_overflow_list.
+**     When the outermost ecall returns, td_pop_callsite() calls
+**     oe_arena_reset(), which frees the overflow blocks and rewinds the
+**     arena. A nested ecall made from an ocall only releases what it
+**     allocated itself: _handle_ecall() marks the arena with oe_arena_mark()
+**     on entry and calls oe_arena_rewind() on return. The arena memory
+**     itself is kept for subsequent ecalls and is only released by
+**     oe_arena_free_all() when the enclave terminates.
+**
+**==============================================================================
+*/
+
+/* Header prepended to each block that overflows to the heap */
+typedef struct _overflow_block
+{
+    struct _overflow_block* next;
+    uint64_t padding;
+} overflow_block_t;
+
+OE_STATIC_ASSERT(sizeof(overflow_block_t) % OE_ARENA_ALIGNMENT == 0);
+
+/* Header prepended to each thread's arena, linking all arenas together */
+typedef struct _arena_header
+{
+    struct _arena_header* next;
+    uint64_t padding;
+} arena_header_t;
+
+OE_STATIC_ASSERT(sizeof(arena_header_t) % OE_ARENA_ALIGNMENT == 0);
+
+static size_t _capacity;
+static arena_header_t* _arenas;
+static oe_spinlock_t _arenas_lock = OE_SPINLOCK_INITIALIZER;
+
+oe_result_t oe_arena_set_capacity(size_t capacity)
+{
+    if (capacity > OE_ARENA_MAX_CAPACITY)
+        return OE_INVALID_PARAMETER;
+
+    _capacity = oe_round_up_to_multiple(capacity, OE_ARENA_ALIGNMENT);
+
+    return OE_OK;
+}
+
+static void* _overflow_alloc(td_t* td, size_t size)
+{
+    overflow_block_t* block;
+    size_t total;
+
+    if (oe_safe_add_u64(sizeof(overflow_block_t), size, &total) != OE_OK)
+        return NULL;
+
+    if (!(block = oe_malloc(total)))
+        return NULL;
+
+    block->next = (overflow_block_t*)td->arena_overflow_list;
+    td->arena_overflow_list = block;
+    td->arena_overflow_count++;
+
+    return block + 1;
+}
+
+void* oe_arena_alloc(size_t size)
+{
+    td_t* td = oe_get_td();
+    uint64_t used;
+
+    if (size == 0)
+        size = 1;
+
+    if (size > OE_ARENA_MAX_CAPACITY)
+        return _overflow_alloc(td, size);
+
+    /* Lazily allocate this thread's arena on first use */
+    if (!td->arena_base && _capacity)
+    {
+        arena_header_t* header = oe_memalign(
+            OE_ARENA_ALIGNMENT, sizeof(arena_header_t) + _capacity);
+
+        if (header)
+        {
+            oe_spin_lock(&_arenas_lock);
+            header->next = _arenas;
+            _arenas = header;
+            oe_spin_unlock(&_arenas_lock);
+
+            td->arena_base = (uint64_t)(header + 1);
+            td->arena_capacity = _capacity;
+            td->arena_used = 0;
+        }
+    }
+
+    used = td->arena_used + oe_round_up_to_multiple(size, OE_ARENA_ALIGNMENT);
+
+    if (used > td->arena_capacity)
+        return _overflow_alloc(td, size);
+
+    void* ptr = (uint8_t*)td->arena_base + td->arena_used;
+    td->arena_used = used;
+
+    if (used > td->arena_peak)
+        td->arena_peak = used;
+
+    return ptr;
+}
+
+void* oe_arena_calloc(size_t nmemb, size_t size)
+{
+    size_t total;
+    void* ptr;
+
+    if (oe_safe_mul_u64(nmemb, size, &total) != OE_OK)
+        return NULL;
+
+    if ((ptr = oe_arena_alloc(total)))
+        memset(ptr, 0, total);
+
+    return ptr;
+}
+
+oe_result_t oe_arena_get_stats(oe_arena_stats_t* stats)
+{
+    td_t* td = oe_get_td();
+
+    if (!stats)
+        return OE_INVALID_PARAMETER;
+
+    stats->capacity = td->arena_capacity;
+    stats->used_bytes = td->arena_used;
+    stats->peak_bytes = td->arena_peak;
+    stats->overflow_count = td->arena_overflow_count;
+
+    return OE_OK;
+}
+
+void oe_arena_mark(td_t* td, oe_arena_mark_t* mark)
+{
+    mark->used = td->arena_used;
+    mark->overflow_list = td->arena_overflow_list;
+}
+
+void oe_arena_rewind(td_t* td, const oe_arena_mark_t* mark)
+{
+    overflow_block_t* p = (overflow_block_t*)td->arena_overflow_list;
+
+    /* Blocks are pushed on the front, so those allocated since the mark
+     * precede the list head that was current when the mark was taken */
+    while (p && p != mark->overflow_list)
+    {
+        overflow_block_t* next = p->next;
+        oe_free(p);
+        p = next;
+    }
+
+    td->arena_overflow_list = p;
+    td->arena_used = mark->used;
+}
+
+void oe_arena_reset(td_t* td)
+{
+    const oe_arena_mark_t mark = {0, NULL};
+
+    oe_arena_rewind(td, &mark);
+}
+
+void oe_arena_free_all(void)
+{
+    td_t* td = oe_get_td();
+    arena_header_t* p;
+
+    oe_arena_reset(td);
+
+    oe_spin_lock(&_arenas_lock);
+    p = _arenas;
+    _arenas = NULL;
+    oe_spin_unlock(&_arenas_lock);
+
+    while (p)
+    {
+        arena_header_t* next = p->next;
+        oe_free(p);
+        p = next;
+    }
+
+    td->arena_base = 0;
+    td->arena_capacity = 0;
+}
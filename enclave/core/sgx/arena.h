@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_ENCLAVE_CORE_SGX_ARENA_H
+#define _OE_ENCLAVE_CORE_SGX_ARENA_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/internal/sgxtypes.h>
+
+OE_EXTERNC_BEGIN
+
+/* Position of the arena of a thread, used to release nested allocations */
+typedef struct _oe_arena_mark
+{
+    uint64_t used;
+    void* overflow_list;
+} oe_arena_mark_t;
+
+/* Record the current position of this thread's arena */
+void oe_arena_mark(td_t* td, oe_arena_mark_t* mark);
+
+/* Release the allocations made on this thread since the mark was taken */
+void oe_arena_rewind(td_t* td, const oe_arena_mark_t* mark);
+
+/* Release all ecall-scoped allocations made on this thread */
+void oe_arena_reset(td_t* td);
+
+/* Release the arenas of all threads (called on enclave termination) */
+void oe_arena_free_all(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_ENCLAVE_CORE_SGX_ARENA_H */
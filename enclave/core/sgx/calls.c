@@ -7,6 +7,7 @@
 #include <openenclave/corelibc/string.h>
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/arena.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/fault.h>
 #include <openenclave/internal/globals.h>
@@ -20,9 +21,11 @@
 #include <openenclave/internal/utils.h>
 #include "../../asym_keys.h"
 #include "../../sgx/report.h"
+#include "arena.h"
 #include "asmdefs.h"
 #include "atexit.h"
 #include "cpuid.h"
+#include "hostheap.h"
 #include "init.h"
 #include "report.h"
 #include "td.h"
@@ -196,6 +199,20 @@ done:
 extern const oe_ecall_func_t __oe_ecalls_table[];
 extern const size_t __oe_ecalls_table_size;
 
+bool oe_is_call_cancelled(void)
+{
+    td_t* td = oe_get_td();
+
+    if ((td->call_cancelled && *td->call_cancelled) ||
+        (td->call_expired && *td->call_expired))
+    {
+        td->call_was_cancelled = 1;
+        return true;
+    }
+
+    return false;
+}
+
 /**
  * This is the preferred way to call enclave functions.
  */
@@ -203,6 +220,11 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
 {
     oe_call_enclave_function_args_t args, *args_ptr;
     oe_result_t result = OE_OK;
+    td_t* td = oe_get_td();
+    const volatile uint32_t* saved_cancelled;
+    const volatile uint32_t* saved_expired;
+    uint64_t saved_was_cancelled;
+    bool cancelled;
     oe_ecall_func_t func = NULL;
     uint8_t* buffer = NULL;
     uint8_t* input_buffer = NULL;
@@ -241,6 +263,14 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
     if ((args.output_buffer_size % OE_EDGER8R_BUFFER_ALIGNMENT) != 0)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    // The cancellation flags stay in host memory, where the host sets them
+    // while the function runs.
+    if ((args.cancelled &&
+         !oe_is_outside_enclave((void*)args.cancelled, sizeof(uint32_t))) ||
+        (args.expired &&
+         !oe_is_outside_enclave((void*)args.expired, sizeof(uint32_t))))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
     OE_CHECK(oe_safe_add_u64(
         args.input_buffer_size, args.output_buffer_size, &buffer_size));
 
@@ -253,8 +283,10 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
     if (func == NULL)
         OE_RAISE(OE_NOT_FOUND);
 
-    // Allocate buffers in enclave memory
-    buffer = input_buffer = oe_malloc(buffer_size);
+    // Allocate buffers in enclave memory. The buffers are ecall-scoped and
+    // are released by td_pop_callsite() when the outermost ecall returns, or
+    // by _handle_ecall() when this is a nested ecall.
+    buffer = input_buffer = oe_arena_alloc(buffer_size);
     if (buffer == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
@@ -267,6 +299,15 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
     output_buffer = buffer + args.input_buffer_size;
     memset(output_buffer, 0, args.output_buffer_size);
 
+    // Install the cancellation flags of this call. Those of the ecall this
+    // one is nested in, if any, are restored when it returns.
+    saved_cancelled = td->call_cancelled;
+    saved_expired = td->call_expired;
+    saved_was_cancelled = td->call_was_cancelled;
+    td->call_cancelled = args.cancelled;
+    td->call_expired = args.expired;
+    td->call_was_cancelled = 0;
+
     // Call the function.
     func(
         input_buffer,
@@ -275,11 +316,21 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
         args.output_buffer_size,
         &output_bytes_written);
 
+    cancelled = td->call_was_cancelled != 0;
+    td->call_cancelled = saved_cancelled;
+    td->call_expired = saved_expired;
+    td->call_was_cancelled = saved_was_cancelled;
+
     // The output_buffer is expected to point to a marshaling struct,
     // whose first field is an oe_result_t. The function is expected
     // to fill this field with the status of the ecall.
     result = *(oe_result_t*)output_buffer;
 
+    // A function that saw its cancellation may have stopped half way, so
+    // its outputs are discarded.
+    if (result == OE_OK && cancelled)
+        result = OE_CANCELED;
+
     if (result == OE_OK)
     {
         // Copy outputs to host memory.
@@ -291,9 +342,6 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
     }
 
 done:
-    if (buffer)
-        oe_free(buffer);
-
     return result;
 }
 
@@ -317,6 +365,40 @@ void oe_virtual_exception_dispatcher(
     uint64_t arg_in,
     uint64_t* arg_out);
 
+/*
+**==============================================================================
+**
+** oe_set_max_nested_ecall_depth()
+**
+**     Nested ecalls of enclave functions are rejected unless the enclave
+**     opts in. Exception handling and termination are always allowed.
+**
+**==============================================================================
+*/
+
+static uint32_t _max_nested_ecall_depth;
+
+oe_result_t oe_set_max_nested_ecall_depth(uint32_t max_depth)
+{
+    if (max_depth > OE_MAX_NESTED_ECALL_DEPTH)
+        return OE_INVALID_PARAMETER;
+
+    __atomic_store_n(&_max_nested_ecall_depth, max_depth, __ATOMIC_RELEASE);
+    return OE_OK;
+}
+
+static bool _is_nested_ecall_allowed(const td_t* td, uint16_t func)
+{
+    if (func == OE_ECALL_VIRTUAL_EXCEPTION_HANDLER ||
+        func == OE_ECALL_DESTRUCTOR)
+        return true;
+
+    // The depth counts the outermost ecall, which is not nested.
+    return func == OE_ECALL_CALL_ENCLAVE_FUNCTION &&
+           td->depth - 1 <=
+               __atomic_load_n(&_max_nested_ecall_depth, __ATOMIC_ACQUIRE);
+}
+
 /*
 **==============================================================================
 **
@@ -339,6 +421,8 @@ static void _handle_ecall(
     /* Insert ECALL context onto front of td_t.ecalls list */
     Callsite callsite = {{0}};
     uint64_t arg_out = 0;
+    oe_arena_mark_t arena_mark;
+    bool nested = false;
 
     td_push_callsite(td, &callsite);
 
@@ -366,14 +450,25 @@ static void _handle_ecall(
     }
 
     // td_push_callsite increments the depth. depth > 1 indicates a reentrant
-    // call. Reentrancy is allowed to handle exceptions and to terminate the
-    // enclave.
-    if (td->depth > 1 && (func != OE_ECALL_VIRTUAL_EXCEPTION_HANDLER &&
-                          func != OE_ECALL_DESTRUCTOR))
+    // call. Reentrancy is allowed to handle exceptions, to terminate the
+    // enclave and, up to the depth set by oe_set_max_nested_ecall_depth(),
+    // to call enclave functions from an ocall.
+    if (td->depth > 1)
     {
-        /* reentrancy not permitted. */
-        result = OE_REENTRANT_ECALL;
-        goto done;
+        if (!_is_nested_ecall_allowed(td, func))
+        {
+            /* reentrancy not permitted. */
+            result = OE_REENTRANT_ECALL;
+            goto done;
+        }
+
+        // A nested ecall reuses the TCS and the arena of the pending ecall.
+        // Only release what the nested ecall allocates when it returns.
+        if (func == OE_ECALL_CALL_ENCLAVE_FUNCTION)
+        {
+            oe_arena_mark(td, &arena_mark);
+            nested = true;
+        }
     }
 
     /* Dispatch the ECALL */
@@ -392,6 +487,12 @@ static void _handle_ecall(
             /* Call all finalization functions */
             oe_call_fini_functions();
 
+            /* Release the per-thread ecall arenas */
+            oe_arena_free_all();
+
+            /* Return the host heap chunks to the host */
+            oe_host_heap_free_all();
+
 #if defined(OE_USE_DEBUG_MALLOC)
 
             /* If memory still allocated, print a trace and return an error */
@@ -447,6 +548,9 @@ static void _handle_ecall(
 
 done:
 
+    if (nested)
+        oe_arena_rewind(td, &arena_mark);
+
     /* Remove ECALL context from front of td_t.ecalls list */
     td_pop_callsite(td);
 
@@ -10,6 +10,7 @@
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/stack_alloc.h>
+#include "hostheap.h"
 #include "td.h"
 
 void* oe_host_malloc(size_t size)
@@ -17,6 +18,10 @@ void* oe_host_malloc(size_t size)
     uint64_t arg_in = size;
     uint64_t arg_out = 0;
 
+    if (oe_host_heap_enabled() &&
+        (arg_out = (uint64_t)oe_host_heap_alloc(size)))
+        return (void*)arg_out;
+
     if (oe_ocall(OE_OCALL_MALLOC, arg_in, &arg_out) != OE_OK)
     {
         return NULL;
@@ -46,6 +51,33 @@ void* oe_host_realloc(void* ptr, size_t size)
 {
     oe_realloc_args_t* arg_in = NULL;
     uint64_t arg_out = 0;
+    size_t block_size;
+
+    if (!ptr)
+        return oe_host_malloc(size);
+
+    /* Blocks from the host heap are resized without an OCALL */
+    if ((block_size = oe_host_heap_block_size(ptr)))
+    {
+        void* new_ptr;
+
+        if (size == 0)
+        {
+            oe_host_heap_free(ptr);
+            return NULL;
+        }
+
+        if (size <= block_size)
+            return ptr;
+
+        if (!(new_ptr = oe_host_malloc(size)))
+            return NULL;
+
+        oe_memcpy_s(new_ptr, size, ptr, block_size);
+        oe_host_heap_free(ptr);
+
+        return new_ptr;
+    }
 
     if (!(arg_in =
               (oe_realloc_args_t*)oe_host_calloc(1, sizeof(oe_realloc_args_t))))
@@ -70,6 +102,9 @@ done:
 
 void oe_host_free(void* ptr)
 {
+    if (oe_host_heap_free(ptr))
+        return;
+
     oe_ocall(OE_OCALL_FREE, (uint64_t)ptr, NULL);
 }
 
@@ -199,6 +234,8 @@ int oe_host_fprintf(int device, const char* fmt, ...)
 }
 
 // Function used by oeedger8r for allocating ocall buffers.
+// These come from the host heap only once the enclave enables it, so that
+// enclaves which do not use it never donate a chunk.
 void* oe_allocate_ocall_buffer(size_t size)
 {
     return oe_host_malloc(size);
@@ -0,0 +1,540 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/hostheap.h>
+#include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
+#include "hostheap.h"
+#include "td.h"
+
+/*
+**==============================================================================
+**
+** Host heap:
+**
+**     The host donates chunks of OE_HOST_HEAP_CHUNK_SIZE bytes (one
+**     OE_OCALL_MALLOC each), which are divided into spans of SPAN_SIZE
+**     bytes. Each span in use holds blocks of a single power-of-two size
+**     class between 16 bytes and OE_HOST_HEAP_MAX_BLOCK_SIZE.
+**
+**     All allocator state lives in enclave memory: the chunk table, the
+**     per-span bitmaps and the per-thread caches. Nothing is ever read back
+**     from the donated memory, so the host can only change the contents of
+**     the blocks, which it could always do. Every pointer passed to
+**     oe_host_heap_free() is checked against the span bitmaps, and invalid
+**     or double frees abort the enclave.
+**
+**     Each td_t has a cache of recently freed blocks per size class, so most
+**     allocations and frees take no lock. The global state is protected by
+**     a spinlock that is never held across an OCALL. The chunk table is
+**     append-only, so pointers are looked up without the lock.
+**
+**     oe_host_heap_free_all() returns every chunk to the host when the
+**     enclave terminates. The heap is closed from then on, so allocations
+**     made later in termination (such as OCALL buffers) use an OCALL each
+**     and are released by the host rather than growing a chunk that would
+**     never be returned.
+**
+**==============================================================================
+*/
+
+#define SPAN_SIZE (64 * 1024)
+#define SPANS_PER_CHUNK (OE_HOST_HEAP_CHUNK_SIZE / SPAN_SIZE)
+#define MIN_BLOCK_SHIFT 4
+#define NUM_CLASSES 11
+#define BITMAP_WORDS ((SPAN_SIZE >> MIN_BLOCK_SHIFT) / 64)
+#define CACHE_SIZE 16
+#define CACHE_BATCH (CACHE_SIZE / 2)
+#define UNASSIGNED OE_UINT32_MAX
+
+OE_STATIC_ASSERT(
+    (1 << (MIN_BLOCK_SHIFT + NUM_CLASSES - 1)) == OE_HOST_HEAP_MAX_BLOCK_SIZE);
+OE_STATIC_ASSERT(OE_HOST_HEAP_CHUNK_SIZE % SPAN_SIZE == 0);
+
+typedef struct _span
+{
+    struct _span* prev;
+    struct _span* next;
+    uint8_t* base;
+
+    /* Size class of the blocks (UNASSIGNED while on the free span list) */
+    uint32_t class_index;
+    uint32_t num_blocks;
+    uint32_t num_used;
+
+    /* Bitmap word where the last block was found */
+    uint32_t hint;
+
+    /* Blocks that are allocated (including those held by a cache) */
+    uint64_t used[BITMAP_WORDS];
+
+    /* Blocks that were freed into a cache */
+    uint64_t cached[BITMAP_WORDS];
+} span_t;
+
+typedef struct _chunk
+{
+    uint8_t* base;
+    span_t* spans;
+} chunk_t;
+
+typedef struct _block
+{
+    span_t* span;
+    size_t index;
+} block_t;
+
+typedef struct _cache
+{
+    struct _cache* next;
+    uint64_t hits;
+    uint32_t count[NUM_CLASSES];
+    block_t blocks[NUM_CLASSES][CACHE_SIZE];
+} cache_t;
+
+static chunk_t _chunks[OE_HOST_HEAP_MAX_CHUNKS];
+static size_t _num_chunks;
+static span_t* _free_spans;
+static span_t* _partial_spans[NUM_CLASSES];
+static cache_t* _caches;
+static bool _enabled;
+static bool _closed;
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+
+static uint32_t _get_class_index(size_t size)
+{
+    uint32_t class_index = 0;
+
+    while (((size_t)1 << (class_index + MIN_BLOCK_SHIFT)) < size)
+        class_index++;
+
+    return class_index;
+}
+
+static size_t _get_class_size(uint32_t class_index)
+{
+    return (size_t)1 << (class_index + MIN_BLOCK_SHIFT);
+}
+
+static void* _get_block_address(const block_t* block)
+{
+    return block->span->base +
+           (block->index << (block->span->class_index + MIN_BLOCK_SHIFT));
+}
+
+static void _list_push(span_t** list, span_t* span)
+{
+    span->prev = NULL;
+    span->next = *list;
+
+    if (*list)
+        (*list)->prev = span;
+
+    *list = span;
+}
+
+static void _list_remove(span_t** list, span_t* span)
+{
+    if (span->prev)
+        span->prev->next = span->next;
+    else
+        *list = span->next;
+
+    if (span->next)
+        span->next->prev = span->prev;
+
+    span->prev = NULL;
+    span->next = NULL;
+}
+
+/* Find the block that ptr points to. Returns false if ptr is not within the
+ * host heap and aborts if it is within the heap but not an allocated block.
+ */
+static bool _find_block(const void* ptr, block_t* block)
+{
+    size_t num_chunks = __atomic_load_n(&_num_chunks, __ATOMIC_ACQUIRE);
+    uint64_t addr = (uint64_t)ptr;
+
+    for (size_t i = 0; i < num_chunks; i++)
+    {
+        uint64_t offset = addr - (uint64_t)_chunks[i].base;
+        uint32_t class_index;
+        uint64_t bit;
+
+        if (addr < (uint64_t)_chunks[i].base ||
+            offset >= OE_HOST_HEAP_CHUNK_SIZE)
+            continue;
+
+        block->span = &_chunks[i].spans[offset / SPAN_SIZE];
+        offset %= SPAN_SIZE;
+
+        class_index =
+            __atomic_load_n(&block->span->class_index, __ATOMIC_ACQUIRE);
+
+        if (class_index == UNASSIGNED ||
+            (offset & (_get_class_size(class_index) - 1)))
+            oe_abort();
+
+        block->index = offset >> (class_index + MIN_BLOCK_SHIFT);
+        bit = 1ULL << (block->index % 64);
+
+        if (!(__atomic_load_n(
+                  &block->span->used[block->index / 64], __ATOMIC_RELAXED) &
+              bit))
+            oe_abort();
+
+        return true;
+    }
+
+    return false;
+}
+
+/* Allocate a block from the spans of a size class (caller holds _lock) */
+static bool _alloc_locked(uint32_t class_index, block_t* block)
+{
+    span_t* span = _partial_spans[class_index];
+    uint32_t num_words;
+
+    if (!span)
+    {
+        if (!(span = _free_spans))
+            return false;
+
+        _list_remove(&_free_spans, span);
+        span->num_blocks = SPAN_SIZE >> (class_index + MIN_BLOCK_SHIFT);
+        span->num_used = 0;
+        span->hint = 0;
+        __atomic_store_n(&span->class_index, class_index, __ATOMIC_RELEASE);
+        _list_push(&_partial_spans[class_index], span);
+    }
+
+    num_words = (span->num_blocks + 63) / 64;
+
+    for (uint32_t i = 0; i < num_words; i++)
+    {
+        uint32_t word = (span->hint + i) % num_words;
+        uint64_t free_bits = ~span->used[word];
+
+        if (word == num_words - 1 && (span->num_blocks % 64))
+            free_bits &= (1ULL << (span->num_blocks % 64)) - 1;
+
+        if (free_bits)
+        {
+            uint64_t bit = free_bits & (~free_bits + 1);
+
+            __atomic_store_n(
+                &span->used[word], span->used[word] | bit, __ATOMIC_RELAXED);
+            span->hint = word;
+            block->span = span;
+            block->index = word * 64 + (size_t)__builtin_ctzll(bit);
+            break;
+        }
+    }
+
+    if (++span->num_used == span->num_blocks)
+        _list_remove(&_partial_spans[class_index], span);
+
+    return true;
+}
+
+/* Return a block to its span (caller holds _lock) */
+static void _free_locked(const block_t* block)
+{
+    span_t* span = block->span;
+    uint32_t class_index = span->class_index;
+    size_t word = block->index / 64;
+    uint64_t bit = 1ULL << (block->index % 64);
+
+    __atomic_fetch_and(&span->cached[word], ~bit, __ATOMIC_RELAXED);
+    __atomic_store_n(
+        &span->used[word], span->used[word] & ~bit, __ATOMIC_RELAXED);
+
+    if (span->num_used-- == span->num_blocks)
+        _list_push(&_partial_spans[class_index], span);
+
+    if (span->num_used == 0)
+    {
+        _list_remove(&_partial_spans[class_index], span);
+        __atomic_store_n(&span->class_index, UNASSIGNED, __ATOMIC_RELEASE);
+        _list_push(&_free_spans, span);
+    }
+}
+
+/* Obtain another chunk from the host */
+static bool _grow(void)
+{
+    uint64_t arg_out = 0;
+    span_t* spans = NULL;
+    bool added = false;
+
+    if (__atomic_load_n(&_closed, __ATOMIC_ACQUIRE) ||
+        __atomic_load_n(&_num_chunks, __ATOMIC_ACQUIRE) >=
+            OE_HOST_HEAP_MAX_CHUNKS)
+        return false;
+
+    if (oe_ocall(OE_OCALL_MALLOC, OE_HOST_HEAP_CHUNK_SIZE, &arg_out) !=
+            OE_OK ||
+        !arg_out)
+        return false;
+
+    if (!oe_is_outside_enclave((void*)arg_out, OE_HOST_HEAP_CHUNK_SIZE))
+        oe_abort();
+
+    if ((spans = (span_t*)oe_calloc(SPANS_PER_CHUNK, sizeof(span_t))))
+    {
+        oe_spin_lock(&_lock);
+
+        if (!_closed && _num_chunks < OE_HOST_HEAP_MAX_CHUNKS)
+        {
+            for (size_t i = SPANS_PER_CHUNK; i > 0; i--)
+            {
+                span_t* span = &spans[i - 1];
+
+                span->base = (uint8_t*)arg_out + (i - 1) * SPAN_SIZE;
+                span->class_index = UNASSIGNED;
+                _list_push(&_free_spans, span);
+            }
+
+            _chunks[_num_chunks].base = (uint8_t*)arg_out;
+            _chunks[_num_chunks].spans = spans;
+            __atomic_store_n(&_num_chunks, _num_chunks + 1, __ATOMIC_RELEASE);
+            added = true;
+        }
+
+        oe_spin_unlock(&_lock);
+    }
+
+    if (!added)
+    {
+        oe_free(spans);
+        oe_ocall(OE_OCALL_FREE, arg_out, NULL);
+    }
+
+    return added;
+}
+
+static cache_t* _get_cache(td_t* td)
+{
+    cache_t* cache = (cache_t*)td->host_heap_cache;
+
+    /* Lazily allocate this thread's cache on first use */
+    if (!cache && (cache = (cache_t*)oe_calloc(1, sizeof(cache_t))))
+    {
+        oe_spin_lock(&_lock);
+        cache->next = _caches;
+        _caches = cache;
+        oe_spin_unlock(&_lock);
+
+        td->host_heap_cache = cache;
+    }
+
+    return cache;
+}
+
+/* Allocate a block and move a batch of further blocks into the cache */
+static bool _refill(cache_t* cache, uint32_t class_index, block_t* block)
+{
+    bool found;
+
+    oe_spin_lock(&_lock);
+
+    if ((found = _alloc_locked(class_index, block)))
+    {
+        block_t* blocks = cache->blocks[class_index];
+        uint32_t* count = &cache->count[class_index];
+
+        while (*count < CACHE_BATCH &&
+               _alloc_locked(class_index, &blocks[*count]))
+        {
+            block_t* b = &blocks[(*count)++];
+
+            __atomic_fetch_or(
+                &b->span->cached[b->index / 64],
+                1ULL << (b->index % 64),
+                __ATOMIC_RELAXED);
+        }
+    }
+
+    oe_spin_unlock(&_lock);
+
+    return found;
+}
+
+/* Return half of the cached blocks of a size class to their spans */
+static void _flush(cache_t* cache, uint32_t class_index)
+{
+    uint32_t* count = &cache->count[class_index];
+
+    oe_spin_lock(&_lock);
+
+    while (*count > CACHE_SIZE - CACHE_BATCH)
+        _free_locked(&cache->blocks[class_index][--(*count)]);
+
+    oe_spin_unlock(&_lock);
+}
+
+bool oe_host_heap_enabled(void)
+{
+    return __atomic_load_n(&_enabled, __ATOMIC_RELAXED);
+}
+
+oe_result_t oe_host_heap_enable(size_t reserve)
+{
+    size_t num_chunks;
+
+    if (reserve > (size_t)OE_HOST_HEAP_MAX_CHUNKS * OE_HOST_HEAP_CHUNK_SIZE)
+        return OE_INVALID_PARAMETER;
+
+    num_chunks = (reserve + OE_HOST_HEAP_CHUNK_SIZE - 1) /
+                 OE_HOST_HEAP_CHUNK_SIZE;
+
+    while (__atomic_load_n(&_num_chunks, __ATOMIC_ACQUIRE) < num_chunks)
+    {
+        if (!_grow())
+            return OE_OUT_OF_MEMORY;
+    }
+
+    __atomic_store_n(&_enabled, true, __ATOMIC_RELAXED);
+
+    return OE_OK;
+}
+
+void* oe_host_heap_alloc(size_t size)
+{
+    td_t* td = oe_get_td();
+    cache_t* cache;
+    uint32_t class_index;
+    block_t block;
+
+    if (size > OE_HOST_HEAP_MAX_BLOCK_SIZE ||
+        __atomic_load_n(&_closed, __ATOMIC_ACQUIRE) ||
+        !(cache = _get_cache(td)))
+        return NULL;
+
+    class_index = _get_class_index(size);
+
+    if (cache->count[class_index])
+    {
+        block = cache->blocks[class_index][--cache->count[class_index]];
+        __atomic_fetch_and(
+            &block.span->cached[block.index / 64],
+            ~(1ULL << (block.index % 64)),
+            __ATOMIC_RELAXED);
+        cache->hits++;
+    }
+    else if (
+        !_refill(cache, class_index, &block) &&
+        !(_grow() && _refill(cache, class_index, &block)))
+    {
+        return NULL;
+    }
+
+    td->host_heap_allocs++;
+
+    return _get_block_address(&block);
+}
+
+size_t oe_host_heap_block_size(const void* ptr)
+{
+    block_t block;
+
+    if (!ptr || !_find_block(ptr, &block))
+        return 0;
+
+    return _get_class_size(block.span->class_index);
+}
+
+bool oe_host_heap_free(void* ptr)
+{
+    block_t block;
+    uint64_t bit;
+    uint32_t class_index;
+    cache_t* cache;
+
+    if (!ptr || !_find_block(ptr, &block))
+        return false;
+
+    /* Mark the block as cached, which also detects double frees */
+    bit = 1ULL << (block.index % 64);
+
+    if (__atomic_fetch_or(
+            &block.span->cached[block.index / 64], bit, __ATOMIC_RELAXED) &
+        bit)
+        oe_abort();
+
+    if (!(cache = _get_cache(oe_get_td())))
+    {
+        oe_spin_lock(&_lock);
+        _free_locked(&block);
+        oe_spin_unlock(&_lock);
+        return true;
+    }
+
+    class_index = block.span->class_index;
+
+    if (cache->count[class_index] == CACHE_SIZE)
+        _flush(cache, class_index);
+
+    cache->blocks[class_index][cache->count[class_index]++] = block;
+
+    return true;
+}
+
+oe_result_t oe_host_heap_get_stats(oe_host_heap_stats_t* stats)
+{
+    td_t* td = oe_get_td();
+    const cache_t* cache = (const cache_t*)td->host_heap_cache;
+
+    if (!stats)
+        return OE_INVALID_PARAMETER;
+
+    stats->num_chunks = __atomic_load_n(&_num_chunks, __ATOMIC_ACQUIRE);
+    stats->num_allocs = td->host_heap_allocs;
+    stats->num_cache_hits = cache ? cache->hits : 0;
+
+    return OE_OK;
+}
+
+void oe_host_heap_free_all(void)
+{
+    td_t* td = oe_get_td();
+    cache_t* cache;
+    size_t num_chunks;
+
+    oe_spin_lock(&_lock);
+    __atomic_store_n(&_closed, true, __ATOMIC_RELEASE);
+    __atomic_store_n(&_enabled, false, __ATOMIC_RELAXED);
+    cache = _caches;
+    num_chunks = _num_chunks;
+    _caches = NULL;
+    _free_spans = NULL;
+    __atomic_store_n(&_num_chunks, 0, __ATOMIC_RELEASE);
+
+    for (size_t i = 0; i < NUM_CLASSES; i++)
+        _partial_spans[i] = NULL;
+
+    oe_spin_unlock(&_lock);
+
+    while (cache)
+    {
+        cache_t* next = cache->next;
+        oe_free(cache);
+        cache = next;
+    }
+
+    for (size_t i = 0; i < num_chunks; i++)
+    {
+        oe_free(_chunks[i].spans);
+        oe_ocall(OE_OCALL_FREE, (uint64_t)_chunks[i].base, NULL);
+        _chunks[i].base = NULL;
+        _chunks[i].spans = NULL;
+    }
+
+    /* Only this thread is still in the enclave, so no other td_t refers to
+     * the caches freed above */
+    td->host_heap_cache = NULL;
+    td->host_heap_allocs = 0;
+}
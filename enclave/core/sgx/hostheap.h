@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_ENCLAVE_CORE_SGX_HOSTHEAP_H
+#define _OE_ENCLAVE_CORE_SGX_HOSTHEAP_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/hostheap.h>
+
+OE_EXTERNC_BEGIN
+
+/* Whether oe_host_malloc() should use the host heap */
+bool oe_host_heap_enabled(void);
+
+/* Allocate a block from the host heap (NULL if too large or exhausted) */
+void* oe_host_heap_alloc(size_t size);
+
+/* Get the usable size of a host heap block (zero if not a host heap block) */
+size_t oe_host_heap_block_size(const void* ptr);
+
+/* Release a host heap block (false if not a host heap block) */
+bool oe_host_heap_free(void* ptr);
+
+OE_EXTERNC_END
+
+#endif /* _OE_ENCLAVE_CORE_SGX_HOSTHEAP_H */
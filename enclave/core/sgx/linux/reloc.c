@@ -4,6 +4,7 @@
 #include <openenclave/enclave.h>
 #include <openenclave/internal/elf.h>
 #include <openenclave/internal/globals.h>
+#include <openenclave/internal/reloc.h>
 #include "../init.h"
 
 /*
@@ -13,16 +14,61 @@
 **
 **     Apply symbol relocations from the relocation pages, whose content
 **     was copied from the ELF file during loading. These relocations are
-**     included in the enclave signature (MRENCLAVE).
+**     included in the enclave signature (MRENCLAVE). The pages use either
+**     the default or the compact format (see internal/reloc.h).
 **
 **==============================================================================
 */
 
+static void _apply_relr(uint8_t* baseaddr, const uint64_t* relr, size_t n)
+{
+    const uint64_t base = (uint64_t)baseaddr;
+    uint64_t* where = NULL;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        uint64_t entry = relr[i];
+
+        if ((entry & 1) == 0)
+        {
+            /* Address entry: relocate it and continue after it */
+            where = (uint64_t*)(baseaddr + entry);
+            *where++ += base;
+        }
+        else
+        {
+            /* Bitmap entry: relocate the marked words after the cursor */
+            uint64_t* p = where;
+
+            for (entry >>= 1; entry; entry >>= 1, p++)
+            {
+                if (entry & 1)
+                    *p += base;
+            }
+
+            where += OE_RELR_BITMAP_WORDS;
+        }
+    }
+}
+
 bool oe_apply_relocations(void)
 {
-    const elf64_rela_t* relocs = (const elf64_rela_t*)__oe_get_reloc_base();
-    size_t nrelocs = __oe_get_reloc_size() / sizeof(elf64_rela_t);
-    const uint8_t* baseaddr = (const uint8_t*)__oe_get_enclave_base();
+    const uint64_t* relr;
+    size_t nrelr;
+    const elf64_rela_t* relocs;
+    size_t nrelocs;
+    uint8_t* baseaddr = (uint8_t*)__oe_get_enclave_base();
+
+    if (!oe_get_relocations(
+            __oe_get_reloc_base(),
+            __oe_get_reloc_size(),
+            &relr,
+            &nrelr,
+            &relocs,
+            &nrelocs))
+        return false;
+
+    _apply_relr(baseaddr, relr, nrelr);
 
     for (size_t i = 0; i < nrelocs; i++)
     {
@@ -8,6 +8,7 @@
 #include <openenclave/internal/elf.h>
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/reloc.h>
 #include <openenclave/internal/utils.h>
 #include "../td.h"
 
@@ -306,11 +307,22 @@ oe_result_t oe_thread_local_init(td_t* td)
             // value of the tpoff variables to a computed constant value. Hence
             // this is inherently thread-safe and also can be called multiple
             // times.
-            const elf64_rela_t* relocs =
-                (const elf64_rela_t*)__oe_get_reloc_base();
-            size_t nrelocs = __oe_get_reloc_size() / sizeof(elf64_rela_t);
+            const uint64_t* relr;
+            size_t nrelr;
+            const elf64_rela_t* relocs;
+            size_t nrelocs;
             const uint8_t* baseaddr = (const uint8_t*)__oe_get_enclave_base();
 
+            // Thread-local relocations are never RELR-encoded
+            if (!oe_get_relocations(
+                    __oe_get_reloc_base(),
+                    __oe_get_reloc_size(),
+                    &relr,
+                    &nrelr,
+                    &relocs,
+                    &nrelocs))
+                OE_RAISE(OE_UNEXPECTED);
+
             for (size_t i = 0; i < nrelocs; i++)
             {
                 const elf64_rela_t* p = &relocs[i];
@@ -0,0 +1,268 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "lockprofile.h"
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/print.h>
+#include <openenclave/internal/types.h>
+
+#if defined(OE_USE_LOCK_PROFILING)
+
+/*
+**==============================================================================
+**
+** Lock profiling:
+**
+**     Records are kept in an open-addressed table keyed by lock address.
+**     A record is claimed by a compare-and-swap of its lock field and its
+**     counters are updated atomically, so that recording an acquire never
+**     takes a lock itself. Records are never removed. Lookups probe a few
+**     records only, so that a nearly full table does not slow every
+**     acquire down.
+**
+**==============================================================================
+*/
+
+/* Visible to the debugger, e.g. "p oe_lock_profiles" */
+oe_lock_profile_t oe_lock_profiles[OE_LOCK_PROFILE_MAX_LOCKS];
+
+/* Number of records probed before giving up on a lock */
+#define MAX_PROBES 8
+
+/* Number of acquires not recorded because the table was full */
+static uint64_t _dropped;
+
+static oe_lock_profile_t* _get_profile(const void* lock, oe_lock_type_t type)
+{
+    /* Fibonacci hashing of the address, which is at least 8-byte aligned */
+    size_t index = (size_t)(((uint64_t)lock >> 3) * 0x9e3779b97f4a7c15ULL) %
+                   OE_LOCK_PROFILE_MAX_LOCKS;
+
+    for (size_t i = 0; i < MAX_PROBES; i++)
+    {
+        oe_lock_profile_t* profile = &oe_lock_profiles[index];
+        const void* owner = __atomic_load_n(&profile->lock, __ATOMIC_ACQUIRE);
+
+        if (owner == lock)
+            return profile;
+
+        if (!owner)
+        {
+            if (__atomic_compare_exchange_n(
+                    &profile->lock,
+                    &owner,
+                    lock,
+                    false,
+                    __ATOMIC_ACQ_REL,
+                    __ATOMIC_ACQUIRE))
+            {
+                /* Readers skip the record until its type is published */
+                __atomic_store_n(&profile->type, type, __ATOMIC_RELEASE);
+                return profile;
+            }
+
+            /* Another thread claimed the record, maybe for the same lock */
+            if (owner == lock)
+                return profile;
+        }
+
+        index = (index + 1) % OE_LOCK_PROFILE_MAX_LOCKS;
+    }
+
+    return NULL;
+}
+
+void oe_lock_profile_record(
+    const void* lock,
+    oe_lock_type_t type,
+    bool contended,
+    uint64_t parks,
+    uint64_t wait_ns)
+{
+    oe_lock_profile_t* profile = _get_profile(lock, type);
+
+    if (!profile)
+    {
+        __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    __atomic_fetch_add(&profile->acquires, 1, __ATOMIC_RELAXED);
+
+    if (contended)
+        __atomic_fetch_add(&profile->contended, 1, __ATOMIC_RELAXED);
+
+    if (parks)
+    {
+        __atomic_fetch_add(&profile->parks, parks, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&profile->wait_ns, wait_ns, __ATOMIC_RELAXED);
+    }
+}
+
+/* Whether profile p should be listed before profile q */
+static bool _before(const oe_lock_profile_t* p, const oe_lock_profile_t* q)
+{
+    if (p->wait_ns != q->wait_ns)
+        return p->wait_ns > q->wait_ns;
+
+    return p->contended > q->contended;
+}
+
+oe_result_t oe_get_lock_profiles(
+    oe_lock_profile_t* profiles,
+    size_t count,
+    size_t* num_profiles)
+{
+    size_t n = 0;
+
+    if (num_profiles)
+        *num_profiles = 0;
+
+    if (!profiles || !num_profiles)
+        return OE_INVALID_PARAMETER;
+
+    /* Keep the first count records in order with an insertion sort */
+    for (size_t i = 0; i < OE_LOCK_PROFILE_MAX_LOCKS && count; i++)
+    {
+        const oe_lock_profile_t* src = &oe_lock_profiles[i];
+        oe_lock_profile_t profile;
+        size_t j;
+
+        memset(&profile, 0, sizeof(profile));
+
+        if (!(profile.lock = __atomic_load_n(&src->lock, __ATOMIC_ACQUIRE)))
+            continue;
+
+        if (!(profile.type = __atomic_load_n(&src->type, __ATOMIC_ACQUIRE)))
+            continue;
+
+        profile.acquires = __atomic_load_n(&src->acquires, __ATOMIC_RELAXED);
+        profile.contended = __atomic_load_n(&src->contended, __ATOMIC_RELAXED);
+        profile.parks = __atomic_load_n(&src->parks, __ATOMIC_RELAXED);
+        profile.wait_ns = __atomic_load_n(&src->wait_ns, __ATOMIC_RELAXED);
+
+        if (n == count)
+        {
+            if (!_before(&profile, &profiles[n - 1]))
+                continue;
+
+            n--;
+        }
+
+        for (j = n; j > 0 && _before(&profile, &profiles[j - 1]); j--)
+            profiles[j] = profiles[j - 1];
+
+        profiles[j] = profile;
+        n++;
+    }
+
+    *num_profiles = n;
+    return OE_OK;
+}
+
+static const char* _type_name(uint32_t type)
+{
+    switch (type)
+    {
+        case OE_LOCK_TYPE_MUTEX:
+            return "mutex";
+        case OE_LOCK_TYPE_COND:
+            return "cond";
+        case OE_LOCK_TYPE_RWLOCK:
+            return "rwlock";
+        default:
+            return "?";
+    }
+}
+
+void oe_dump_lock_profiles(void)
+{
+    oe_lock_profile_t* profiles;
+    size_t count;
+
+    if (!(profiles = (oe_lock_profile_t*)oe_malloc(
+              OE_LOCK_PROFILE_MAX_LOCKS * sizeof(oe_lock_profile_t))))
+        return;
+
+    if (oe_get_lock_profiles(profiles, OE_LOCK_PROFILE_MAX_LOCKS, &count) ==
+        OE_OK)
+    {
+        oe_host_printf("=== %s(): %zu locks\n", __FUNCTION__, count);
+        oe_host_printf(
+            "%-18s %-6s %12s %12s %12s %14s\n",
+            "lock",
+            "type",
+            "acquires",
+            "contended",
+            "parks",
+            "wait_us");
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const oe_lock_profile_t* p = &profiles[i];
+
+            oe_host_printf(
+                "%-18p %-6s %12llu %12llu %12llu %14llu\n",
+                p->lock,
+                _type_name(p->type),
+                OE_LLU(p->acquires),
+                OE_LLU(p->contended),
+                OE_LLU(p->parks),
+                OE_LLU(p->wait_ns / 1000));
+        }
+
+        if (_dropped)
+        {
+            oe_host_printf(
+                "%llu acquires of further locks were not recorded\n",
+                OE_LLU(_dropped));
+        }
+
+        oe_host_printf("\n");
+    }
+
+    oe_free(profiles);
+}
+
+void oe_reset_lock_profiles(void)
+{
+    for (size_t i = 0; i < OE_LOCK_PROFILE_MAX_LOCKS; i++)
+    {
+        oe_lock_profile_t* profile = &oe_lock_profiles[i];
+
+        __atomic_store_n(&profile->acquires, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&profile->contended, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&profile->parks, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&profile->wait_ns, 0, __ATOMIC_RELAXED);
+    }
+
+    __atomic_store_n(&_dropped, 0, __ATOMIC_RELAXED);
+}
+
+#else /* !defined(OE_USE_LOCK_PROFILING) */
+
+oe_result_t oe_get_lock_profiles(
+    oe_lock_profile_t* profiles,
+    size_t count,
+    size_t* num_profiles)
+{
+    OE_UNUSED(profiles);
+    OE_UNUSED(count);
+
+    if (num_profiles)
+        *num_profiles = 0;
+
+    return OE_UNSUPPORTED;
+}
+
+void oe_dump_lock_profiles(void)
+{
+}
+
+void oe_reset_lock_profiles(void)
+{
+}
+
+#endif /* defined(OE_USE_LOCK_PROFILING) */
@@ -0,0 +1,43 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_ENCLAVE_CORE_SGX_LOCKPROFILE_H
+#define _OE_ENCLAVE_CORE_SGX_LOCKPROFILE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/lockprofile.h>
+
+OE_EXTERNC_BEGIN
+
+#if defined(OE_USE_LOCK_PROFILING)
+
+/* Record an acquire of the lock, which parked the given number of times */
+void oe_lock_profile_record(
+    const void* lock,
+    oe_lock_type_t type,
+    bool contended,
+    uint64_t parks,
+    uint64_t wait_ns);
+
+#else /* !defined(OE_USE_LOCK_PROFILING) */
+
+OE_INLINE void oe_lock_profile_record(
+    const void* lock,
+    oe_lock_type_t type,
+    bool contended,
+    uint64_t parks,
+    uint64_t wait_ns)
+{
+    OE_UNUSED(lock);
+    OE_UNUSED(type);
+    OE_UNUSED(contended);
+    OE_UNUSED(parks);
+    OE_UNUSED(wait_ns);
+}
+
+#endif /* defined(OE_USE_LOCK_PROFILING) */
+
+OE_EXTERNC_END
+
+#endif /* _OE_ENCLAVE_CORE_SGX_LOCKPROFILE_H */
@@ -10,6 +10,7 @@
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/utils.h>
+#include "arena.h"
 #include "asmdefs.h"
 #include "thread.h"
 
@@ -98,6 +99,11 @@ void td_pop_callsite(td_t* td)
         // The outermost ecall is about to return.
         // Clear the thread-local storage.
         td_clear(td);
+
+        // Release the ecall-scoped allocations. This is done after clearing
+        // the thread-local storage since thread-local destructors may still
+        // refer to memory obtained from oe_arena_alloc().
+        oe_arena_reset(td);
     }
     else
     {
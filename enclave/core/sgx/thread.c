@@ -9,6 +9,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/thread.h>
+#include "lockprofile.h"
 #include "td.h"
 
 /*
@@ -19,13 +20,25 @@
 **==============================================================================
 */
 
-static int _thread_wait(oe_thread_data_t* self)
+/* How long an acquire waited, for lock profiling */
+typedef struct _lock_wait
+{
+    uint64_t parks;
+
+    /* Reported by the host, so only as trustworthy as the host */
+    uint64_t wait_ns;
+} lock_wait_t;
+
+static int _thread_wait(oe_thread_data_t* self, lock_wait_t* wait)
 {
     const void* tcs = td_to_tcs((td_t*)self);
+    uint64_t wait_ns = 0;
 
-    if (oe_ocall(OE_OCALL_THREAD_WAIT, (uint64_t)tcs, NULL) != OE_OK)
+    if (oe_ocall(OE_OCALL_THREAD_WAIT, (uint64_t)tcs, &wait_ns) != OE_OK)
         return -1;
 
+    wait->parks++;
+    wait->wait_ns += wait_ns;
     return 0;
 }
 
@@ -39,10 +52,14 @@ static int _thread_wake(oe_thread_data_t* self)
     return 0;
 }
 
-static int _thread_wake_wait(oe_thread_data_t* waiter, oe_thread_data_t* self)
+static int _thread_wake_wait(
+    oe_thread_data_t* waiter,
+    oe_thread_data_t* self,
+    lock_wait_t* wait)
 {
     int ret = -1;
     oe_thread_wake_wait_args_t* args = NULL;
+    uint64_t wait_ns = 0;
 
     if (!(args = oe_host_calloc(1, sizeof(oe_thread_wake_wait_args_t))))
         goto done;
@@ -50,9 +67,11 @@ static int _thread_wake_wait(oe_thread_data_t* waiter, oe_thread_data_t* self)
     args->waiter_tcs = td_to_tcs((td_t*)waiter);
     args->self_tcs = td_to_tcs((td_t*)self);
 
-    if (oe_ocall(OE_OCALL_THREAD_WAKE_WAIT, (uint64_t)args, NULL) != OE_OK)
+    if (oe_ocall(OE_OCALL_THREAD_WAKE_WAIT, (uint64_t)args, &wait_ns) != OE_OK)
         goto done;
 
+    wait->parks++;
+    wait->wait_ns += wait_ns;
     ret = 0;
 
 done:
@@ -222,6 +241,8 @@ oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
 {
     oe_mutex_impl_t* m = (oe_mutex_impl_t*)mutex;
     oe_thread_data_t* self = oe_get_thread_data();
+    lock_wait_t wait = {0, 0};
+    bool contended = false;
 
     if (!m)
         return OE_INVALID_PARAMETER;
@@ -235,9 +256,13 @@ oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
             if (_mutex_lock(m, self) == 0)
             {
                 oe_spin_unlock(&m->lock);
+                oe_lock_profile_record(
+                    m, OE_LOCK_TYPE_MUTEX, contended, wait.parks, wait.wait_ns);
                 return OE_OK;
             }
 
+            contended = true;
+
             /* If the waiters queue does not contain this thread */
             if (!_queue_contains(&m->queue, self))
             {
@@ -248,7 +273,7 @@ oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
         oe_spin_unlock(&m->lock);
 
         /* Ask host to wait for an event on this thread */
-        _thread_wait(self);
+        _thread_wait(self, &wait);
     }
 
     /* Unreachable! */
@@ -411,6 +436,7 @@ oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
 {
     oe_cond_impl_t* cond = (oe_cond_impl_t*)condition;
     oe_thread_data_t* self = oe_get_thread_data();
+    lock_wait_t wait = {0, 0};
 
     if (!cond || !mutex)
         return OE_INVALID_PARAMETER;
@@ -435,12 +461,12 @@ oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
             {
                 if (waiter)
                 {
-                    _thread_wake_wait(waiter, self);
+                    _thread_wake_wait(waiter, self, &wait);
                     waiter = NULL;
                 }
                 else
                 {
-                    _thread_wait(self);
+                    _thread_wait(self, &wait);
                 }
             }
             oe_spin_lock(&cond->lock);
@@ -451,6 +477,8 @@ oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
         }
     }
     oe_spin_unlock(&cond->lock);
+    oe_lock_profile_record(
+        cond, OE_LOCK_TYPE_COND, wait.parks != 0, wait.parks, wait.wait_ns);
     oe_mutex_lock(mutex);
 
     return OE_OK;
@@ -552,6 +580,8 @@ oe_result_t oe_rwlock_rdlock(oe_rwlock_t* read_write_lock)
 {
     oe_rwlock_impl_t* rw_lock = (oe_rwlock_impl_t*)read_write_lock;
     oe_thread_data_t* self = oe_get_thread_data();
+    lock_wait_t wait = {0, 0};
+    bool contended = false;
 
     if (!rw_lock)
         return OE_INVALID_PARAMETER;
@@ -562,12 +592,14 @@ oe_result_t oe_rwlock_rdlock(oe_rwlock_t* read_write_lock)
     // Multiple readers can concurrently operate.
     while (rw_lock->writer != NULL)
     {
+        contended = true;
+
         // Add self to list of waiters, and go to wait state.
         if (!_queue_contains(&rw_lock->queue, self))
             _queue_push_back(&rw_lock->queue, self);
 
         oe_spin_unlock(&rw_lock->lock);
-        _thread_wait(self);
+        _thread_wait(self, &wait);
 
         // Upon waking, re-acquire the lock.
         // Just like a condition variable.
@@ -578,6 +610,8 @@ oe_result_t oe_rwlock_rdlock(oe_rwlock_t* read_write_lock)
     rw_lock->readers++;
 
     oe_spin_unlock(&rw_lock->lock);
+    oe_lock_profile_record(
+        rw_lock, OE_LOCK_TYPE_RWLOCK, contended, wait.parks, wait.wait_ns);
 
     return OE_OK;
 }
@@ -660,6 +694,8 @@ oe_result_t oe_rwlock_wrlock(oe_rwlock_t* read_write_lock)
 {
     oe_rwlock_impl_t* rw_lock = (oe_rwlock_impl_t*)read_write_lock;
     oe_thread_data_t* self = oe_get_thread_data();
+    lock_wait_t wait = {0, 0};
+    bool contended = false;
 
     if (!rw_lock)
         return OE_INVALID_PARAMETER;
@@ -676,13 +712,15 @@ oe_result_t oe_rwlock_wrlock(oe_rwlock_t* read_write_lock)
     // Wait for all readers and any other writer to finish.
     while (rw_lock->readers > 0 || rw_lock->writer != NULL)
     {
+        contended = true;
+
         // Add self to list of waiters, and go to wait state.
         if (!_queue_contains(&rw_lock->queue, self))
             _queue_push_back(&rw_lock->queue, self);
 
         oe_spin_unlock(&rw_lock->lock);
 
-        _thread_wait(self);
+        _thread_wait(self, &wait);
 
         // Upon waking, re-acquire the lock.
         // Just like a condition variable.
@@ -691,6 +729,8 @@ oe_result_t oe_rwlock_wrlock(oe_rwlock_t* read_write_lock)
 
     rw_lock->writer = self;
     oe_spin_unlock(&rw_lock->lock);
+    oe_lock_profile_record(
+        rw_lock, OE_LOCK_TYPE_RWLOCK, contended, wait.parks, wait.wait_ns);
 
     return OE_OK;
 }
@@ -201,3 +201,10 @@ log_level_t get_current_logging_level(void)
 {
     return _active_log_level;
 }
+
+log_level_t set_current_logging_level(log_level_t level)
+{
+    log_level_t previous = _active_log_level;
+    _active_log_level = level;
+    return previous;
+}
@@ -6,28 +6,46 @@
 #include <openenclave/corelibc/string.h>
 #include <openenclave/internal/defs.h>
 
+/*
+**==============================================================================
+**
+** Word-at-a-time helpers:
+**
+**     The routines below scan strings a machine word at a time. Every word
+**     load is aligned to the word size, so a load that includes any byte of
+**     a string never extends beyond the page holding that byte. The scans
+**     may therefore read past the terminating null byte, but never past the
+**     end of the enclave or into an unmapped page.
+**
+**==============================================================================
+*/
+
+typedef size_t __attribute__((__may_alias__)) word_t;
+
+#define WORD_SIZE sizeof(word_t)
+#define WORD_ONES ((word_t)-1 / 0xFF)
+#define WORD_HIGHS (WORD_ONES * 0x80)
+#define WORD_HAS_ZERO(X) (((X) - WORD_ONES) & ~(X) & WORD_HIGHS)
+#define IS_WORD_ALIGNED(P) (((uintptr_t)(P) % WORD_SIZE) == 0)
+
 size_t oe_strlen(const char* s)
 {
     const char* p = s;
+    const word_t* w;
+
+    for (; !IS_WORD_ALIGNED(p); p++)
+    {
+        if (!*p)
+            return (size_t)(p - s);
+    }
+
+    for (w = (const word_t*)p; !WORD_HAS_ZERO(*w); w++)
+        ;
 
-    while (p[0] && p[1] && p[2] && p[3] && p[4] && p[5])
-        p += 6;
-
-    if (!p[0])
-        return (size_t)(p - s);
-    if (!p[1])
-        return (size_t)(p - s + 1);
-    if (!p[2])
-        return (size_t)(p - s + 2);
-    if (!p[3])
-        return (size_t)(p - s + 3);
-    if (!p[4])
-        return (size_t)(p - s + 4);
-    if (!p[5])
-        return (size_t)(p - s + 5);
-
-    /* Unreachable */
-    return 0;
+    for (p = (const char*)w; *p; p++)
+        ;
+
+    return (size_t)(p - s);
 }
 
 size_t oe_strnlen(const char* s, size_t n)
@@ -42,13 +60,38 @@ size_t oe_strnlen(const char* s, size_t n)
 
 int oe_strcmp(const char* s1, const char* s2)
 {
-    while ((*s1 && *s2) && (*s1 == *s2))
+    const unsigned char* p1 = (const unsigned char*)s1;
+    const unsigned char* p2 = (const unsigned char*)s2;
+
+    /* Words may only be compared if both strings are equally misaligned */
+    if ((uintptr_t)p1 % WORD_SIZE == (uintptr_t)p2 % WORD_SIZE)
     {
-        s1++;
-        s2++;
+        const word_t* w1;
+        const word_t* w2;
+
+        for (; !IS_WORD_ALIGNED(p1); p1++, p2++)
+        {
+            if (!*p1 || *p1 != *p2)
+                return *p1 - *p2;
+        }
+
+        w1 = (const word_t*)p1;
+        w2 = (const word_t*)p2;
+
+        for (; *w1 == *w2 && !WORD_HAS_ZERO(*w1); w1++, w2++)
+            ;
+
+        p1 = (const unsigned char*)w1;
+        p2 = (const unsigned char*)w2;
+    }
+
+    while (*p1 && *p1 == *p2)
+    {
+        p1++;
+        p2++;
     }
 
-    return *s1 - *s2;
+    return *p1 - *p2;
 }
 
 int oe_strncmp(const char* s1, const char* s2, size_t n)
@@ -66,7 +109,7 @@ int oe_strncmp(const char* s1, const char* s2, size_t n)
         return 0;
 
     /* Return difference of mismatching characters */
-    return *s1 - *s2;
+    return *(const unsigned char*)s1 - *(const unsigned char*)s2;
 }
 
 size_t oe_strlcpy(char* dest, const char* src, size_t size)
@@ -121,18 +164,58 @@ size_t oe_strlcat(char* dest, const char* src, size_t size)
     return n;
 }
 
+char* oe_strchrnul(const char* s, int c)
+{
+    const word_t* w;
+    word_t pattern;
+
+    c = (unsigned char)c;
+
+    if (!c)
+        return (char*)s + oe_strlen(s);
+
+    for (; !IS_WORD_ALIGNED(s); s++)
+    {
+        if (!*s || *(const unsigned char*)s == c)
+            return (char*)s;
+    }
+
+    /* Stop at the first word holding either a null byte or c */
+    pattern = WORD_ONES * (unsigned char)c;
+
+    for (w = (const word_t*)s;
+         !WORD_HAS_ZERO(*w) && !WORD_HAS_ZERO(*w ^ pattern);
+         w++)
+        ;
+
+    for (s = (const char*)w; *s && *(const unsigned char*)s != c; s++)
+        ;
+
+    return (char*)s;
+}
+
+char* oe_strchr(const char* s, int c)
+{
+    char* p = oe_strchrnul(s, c);
+
+    return *(unsigned char*)p == (unsigned char)c ? p : NULL;
+}
+
 char* oe_strstr(const char* haystack, const char* needle)
 {
-    size_t hlen = oe_strlen(haystack);
-    size_t nlen = oe_strlen(needle);
+    size_t nlen;
+
+    if (!needle[0])
+        return (char*)haystack;
 
-    if (nlen > hlen)
-        return NULL;
+    nlen = oe_strlen(needle);
 
-    for (size_t i = 0; i < hlen - nlen + 1; i++)
+    /* Skip to each occurrence of the first character of the needle. Unlike
+     * memcmp(), oe_strncmp() stops at the end of the haystack. */
+    for (; (haystack = oe_strchr(haystack, needle[0])); haystack++)
     {
-        if (memcmp(haystack + i, needle, nlen) == 0)
-            return (char*)haystack + i;
+        if (oe_strncmp(haystack + 1, needle + 1, nlen - 1) == 0)
+            return (char*)haystack;
     }
 
     return NULL;
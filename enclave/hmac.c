@@ -5,12 +5,17 @@
 // clang-format off
 #include "mbedtls_corelibc_defs.h"
 #include <mbedtls/md.h>
+#include <mbedtls/sha256.h>
 #include "mbedtls_corelibc_undef.h"
 // clang-format on
 
+#include <openenclave/corelibc/string.h>
 #include <openenclave/internal/defs.h>
 #include <openenclave/internal/hmac.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+
+#define HMAC_SHA256_BLOCK_SIZE 64
 
 typedef struct _oe_hmac_sha256_context_impl
 {
@@ -113,3 +118,74 @@ oe_result_t oe_hmac_sha256_free(oe_hmac_sha256_context_t* context)
 done:
     return result;
 }
+
+/* Hashes the key XOR-ed with the given pad byte as a single block and
+ * returns the resulting state. */
+static void _hash_key_block(
+    const uint8_t* key,
+    size_t keysize,
+    uint8_t pad,
+    uint32_t state[8])
+{
+    uint8_t block[HMAC_SHA256_BLOCK_SIZE];
+    mbedtls_sha256_context ctx;
+
+    memset(block, pad, sizeof(block));
+
+    for (size_t i = 0; i < keysize; i++)
+        block[i] ^= key[i];
+
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts_ret(&ctx, 0);
+    mbedtls_sha256_update_ret(&ctx, block, sizeof(block));
+    memcpy(state, ctx.state, sizeof(ctx.state));
+    mbedtls_sha256_free(&ctx);
+
+    oe_secure_zero_fill(block, sizeof(block));
+}
+
+oe_result_t oe_hmac_sha256_key_init(
+    oe_hmac_sha256_key_t* key,
+    const uint8_t* keydata,
+    size_t keysize)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint8_t hashed_key[OE_SHA256_SIZE];
+
+    if (!key || !keydata)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Keys longer than a block are replaced by their hash (RFC 2104) */
+    if (keysize > HMAC_SHA256_BLOCK_SIZE)
+    {
+        int res = mbedtls_sha256_ret(keydata, keysize, hashed_key, 0);
+        if (res != 0)
+            OE_RAISE_MSG(OE_FAILURE, "mbedtls error: 0x%x", res);
+
+        keydata = hashed_key;
+        keysize = sizeof(hashed_key);
+    }
+
+    _hash_key_block(keydata, keysize, 0x36, key->inner);
+    _hash_key_block(keydata, keysize, 0x5c, key->outer);
+
+    result = OE_OK;
+
+done:
+    oe_secure_zero_fill(hashed_key, sizeof(hashed_key));
+    return result;
+}
+
+oe_result_t oe_hmac_sha256_key_free(oe_hmac_sha256_key_t* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_secure_zero_fill(key, sizeof(*key));
+    result = OE_OK;
+
+done:
+    return result;
+}
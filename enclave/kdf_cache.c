@@ -0,0 +1,240 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/kdf.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+
+typedef struct _kdf_cache_entry
+{
+    bool valid;
+    uint64_t key_id;
+
+    /* Value of the cache tick when the entry was last used */
+    uint64_t last_use;
+
+    size_t fixed_data_size;
+    uint8_t fixed_data[OE_KDF_CACHE_MAX_FIXED_DATA_SIZE];
+    size_t derived_key_size;
+    uint8_t derived_key[OE_KDF_CACHE_MAX_KEY_SIZE];
+} kdf_cache_entry_t;
+
+struct _oe_kdf_cache
+{
+    oe_spinlock_t lock;
+    uint64_t tick;
+
+    /* Incremented by every eviction, so that a key derived while an
+     * eviction ran (possibly from a key that has since been rotated) is not
+     * cached */
+    uint64_t generation;
+    size_t capacity;
+    kdf_cache_entry_t entries[];
+};
+
+static void _clear_entry(kdf_cache_entry_t* entry)
+{
+    oe_secure_zero_fill(entry, sizeof(*entry));
+}
+
+static kdf_cache_entry_t* _find_entry(
+    oe_kdf_cache_t* cache,
+    uint64_t key_id,
+    const uint8_t* fixed_data,
+    size_t fixed_data_size,
+    size_t derived_key_size)
+{
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        kdf_cache_entry_t* entry = &cache->entries[i];
+
+        if (entry->valid && entry->key_id == key_id &&
+            entry->derived_key_size == derived_key_size &&
+            entry->fixed_data_size == fixed_data_size &&
+            (fixed_data_size == 0 ||
+             memcmp(entry->fixed_data, fixed_data, fixed_data_size) == 0))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/* Returns a free entry, or else the least recently used one */
+static kdf_cache_entry_t* _find_victim(oe_kdf_cache_t* cache)
+{
+    kdf_cache_entry_t* victim = &cache->entries[0];
+
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        kdf_cache_entry_t* entry = &cache->entries[i];
+
+        if (!entry->valid)
+            return entry;
+
+        if (entry->last_use < victim->last_use)
+            victim = entry;
+    }
+
+    return victim;
+}
+
+oe_result_t oe_kdf_cache_create(size_t capacity, oe_kdf_cache_t** cache)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_kdf_cache_t* p = NULL;
+    size_t size;
+
+    if (cache)
+        *cache = NULL;
+
+    if (!capacity || !cache)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_sizet(capacity, sizeof(kdf_cache_entry_t), &size));
+    OE_CHECK(oe_safe_add_sizet(size, sizeof(oe_kdf_cache_t), &size));
+
+    if (!(p = (oe_kdf_cache_t*)oe_calloc(1, size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    p->lock = OE_SPINLOCK_INITIALIZER;
+    p->capacity = capacity;
+
+    *cache = p;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_kdf_cache_derive_key(
+    oe_kdf_cache_t* cache,
+    uint64_t key_id,
+    const oe_kdf_key_t* kdf_key,
+    const uint8_t* fixed_data,
+    size_t fixed_data_size,
+    uint8_t* derived_key,
+    size_t derived_key_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    kdf_cache_entry_t* entry;
+    uint64_t generation;
+
+    if (!cache || !kdf_key || !derived_key)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!fixed_data)
+        fixed_data_size = 0;
+
+    if (derived_key_size > OE_KDF_CACHE_MAX_KEY_SIZE ||
+        fixed_data_size > OE_KDF_CACHE_MAX_FIXED_DATA_SIZE)
+    {
+        OE_CHECK(oe_kdf_key_derive(
+            kdf_key,
+            fixed_data,
+            fixed_data_size,
+            derived_key,
+            derived_key_size));
+
+        result = OE_OK;
+        goto done;
+    }
+
+    oe_spin_lock(&cache->lock);
+    entry = _find_entry(
+        cache, key_id, fixed_data, fixed_data_size, derived_key_size);
+    if (entry)
+    {
+        entry->last_use = ++cache->tick;
+        memcpy(derived_key, entry->derived_key, derived_key_size);
+    }
+    generation = cache->generation;
+    oe_spin_unlock(&cache->lock);
+
+    if (entry)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    /* Derive outside of the lock so that other lookups are not held up */
+    OE_CHECK(oe_kdf_key_derive(
+        kdf_key, fixed_data, fixed_data_size, derived_key, derived_key_size));
+
+    oe_spin_lock(&cache->lock);
+
+    if (cache->generation != generation)
+    {
+        oe_spin_unlock(&cache->lock);
+        result = OE_OK;
+        goto done;
+    }
+
+    entry = _find_entry(
+        cache, key_id, fixed_data, fixed_data_size, derived_key_size);
+    if (!entry)
+    {
+        entry = _find_victim(cache);
+        _clear_entry(entry);
+
+        entry->valid = true;
+        entry->key_id = key_id;
+        entry->fixed_data_size = fixed_data_size;
+        if (fixed_data_size)
+            memcpy(entry->fixed_data, fixed_data, fixed_data_size);
+        entry->derived_key_size = derived_key_size;
+        memcpy(entry->derived_key, derived_key, derived_key_size);
+    }
+    entry->last_use = ++cache->tick;
+    oe_spin_unlock(&cache->lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_kdf_cache_evict_key(oe_kdf_cache_t* cache, uint64_t key_id)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!cache)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_spin_lock(&cache->lock);
+    cache->generation++;
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        if (cache->entries[i].valid && cache->entries[i].key_id == key_id)
+            _clear_entry(&cache->entries[i]);
+    }
+    oe_spin_unlock(&cache->lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_kdf_cache_destroy(oe_kdf_cache_t* cache)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!cache)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_secure_zero_fill(
+        cache->entries, cache->capacity * sizeof(kdf_cache_entry_t));
+    oe_free(cache);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
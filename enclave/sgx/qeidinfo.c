@@ -88,9 +88,9 @@ oe_result_t oe_get_qe_identity_info(oe_get_qe_identity_info_args_t* args)
         tmp_args.issuer_chain,
         tmp_args.issuer_chain_size));
 
-    // Check for null terminators.
-    if (args->qe_id_info[args->qe_id_info_size - 1] != 0 ||
-        args->issuer_chain[args->issuer_chain_size - 1] != 0)
+    // Check for null terminator. The issuer chain is DER and is not
+    // zero-terminated.
+    if (args->qe_id_info[args->qe_id_info_size - 1] != 0)
         OE_RAISE(OE_INVALID_REVOCATION_INFO);
 
     result = OE_OK;
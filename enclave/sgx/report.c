@@ -5,6 +5,7 @@
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/bits/types.h>
 #include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/cmac.h>
@@ -12,6 +13,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 #include "../common/sgx/quote.h"
 
@@ -41,6 +43,63 @@ done:
     return result;
 }
 
+/* The report key only depends on the key id of the report, which is the same
+ * for every report until the platform is reset. Its AES-CMAC context is kept
+ * so that verifying a local report needs neither EGETKEY nor a new key
+ * expansion. */
+static struct
+{
+    bool valid;
+    uint8_t keyid[SGX_KEYID_SIZE];
+    oe_aes_cmac_context_t context;
+} _report_key_cache;
+static oe_spinlock_t _report_key_cache_lock = OE_SPINLOCK_INITIALIZER;
+
+static oe_result_t _get_report_key_context(
+    const sgx_report_t* sgx_report,
+    oe_aes_cmac_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sgx_key_t sgx_key = {{0}};
+    bool found = false;
+
+    oe_spin_lock(&_report_key_cache_lock);
+    if (_report_key_cache.valid &&
+        memcmp(
+            _report_key_cache.keyid,
+            sgx_report->keyid,
+            sizeof(_report_key_cache.keyid)) == 0)
+    {
+        *context = _report_key_cache.context;
+        found = true;
+    }
+    oe_spin_unlock(&_report_key_cache_lock);
+
+    if (!found)
+    {
+        OE_CHECK(_get_report_key(sgx_report, &sgx_key));
+        OE_CHECK(oe_aes_cmac_init(
+            context, (uint8_t*)&sgx_key, sizeof(sgx_key)));
+
+        oe_spin_lock(&_report_key_cache_lock);
+        memcpy(
+            _report_key_cache.keyid,
+            sgx_report->keyid,
+            sizeof(_report_key_cache.keyid));
+        _report_key_cache.context = *context;
+        _report_key_cache.valid = true;
+        oe_spin_unlock(&_report_key_cache_lock);
+    }
+
+    result = OE_OK;
+
+done:
+    // Cleanup secret.
+    oe_secure_zero_fill(&sgx_key, sizeof(sgx_key));
+
+    return result;
+}
+
 // oe_verify_report needs crypto library's cmac computation. oecore does not
 // have crypto functionality. Hence oe_verify report is implemented here instead
 // of in oecore. Also see ECall_HandleVerifyReport below.
@@ -51,12 +110,12 @@ oe_result_t oe_verify_report(
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_report_t oe_report = {0};
-    sgx_key_t sgx_key = {{0}};
+    oe_aes_cmac_context_t report_key = {{0}};
     oe_report_header_t* header = (oe_report_header_t*)report;
 
     sgx_report_t* sgx_report = NULL;
 
-    const size_t aes_cmac_length = sizeof(sgx_key);
+    const size_t aes_cmac_length = sizeof(sgx_key_t);
     oe_aes_cmac_t report_aes_cmac = {{0}};
     oe_aes_cmac_t computed_aes_cmac = {{0}};
 
@@ -72,11 +131,10 @@ oe_result_t oe_verify_report(
     {
         sgx_report = (sgx_report_t*)header->report;
 
-        OE_CHECK(_get_report_key(sgx_report, &sgx_key));
+        OE_CHECK(_get_report_key_context(sgx_report, &report_key));
 
-        OE_CHECK(oe_aes_cmac_sign(
-            (uint8_t*)&sgx_key,
-            sizeof(sgx_key),
+        OE_CHECK(oe_aes_cmac_compute(
+            &report_key,
             (uint8_t*)&sgx_report->body,
             sizeof(sgx_report->body),
             &computed_aes_cmac));
@@ -101,7 +159,7 @@ oe_result_t oe_verify_report(
 
 done:
     // Cleanup secret.
-    oe_secure_zero_fill(&sgx_key, sizeof(sgx_key));
+    oe_secure_zero_fill(&report_key, sizeof(report_key));
 
     return result;
 }
@@ -125,15 +125,10 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
             tmp_args.crl_issuer_chain_size[i]));
     }
 
-    // Check for null terminators.
-    if (args->tcb_info[args->tcb_info_size - 1] != 0 ||
-        args->tcb_issuer_chain[args->tcb_issuer_chain_size - 1] != 0)
+    // Check for null terminator. The issuer chains are DER and the CRLs are
+    // DER, so only the TCB info JSON is expected to be zero-terminated.
+    if (args->tcb_info[args->tcb_info_size - 1] != 0)
         OE_RAISE(OE_INVALID_REVOCATION_INFO);
-    for (uint32_t i = 0; i < args->num_crl_urls; ++i)
-    {
-        if (args->crl_issuer_chain[i][args->crl_issuer_chain_size[i] - 1] != 0)
-            OE_RAISE(OE_INVALID_REVOCATION_INFO);
-    }
 
     result = OE_OK;
 done:
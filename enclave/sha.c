@@ -73,3 +73,40 @@ oe_result_t oe_sha256_final(oe_sha256_context_t* context, OE_SHA256* sha256)
 done:
     return result;
 }
+
+oe_result_t oe_sha256_clone(
+    oe_sha256_context_t* dest,
+    const oe_sha256_context_t* src)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_impl_t* dest_impl = (oe_sha256_context_impl_t*)dest;
+    const oe_sha256_context_impl_t* src_impl =
+        (const oe_sha256_context_impl_t*)src;
+
+    if (!dest || !src)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    mbedtls_sha256_init(&dest_impl->ctx);
+    mbedtls_sha256_clone(&dest_impl->ctx, &src_impl->ctx);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sha256_free(oe_sha256_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_impl_t* impl = (oe_sha256_context_impl_t*)context;
+
+    if (!context)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    mbedtls_sha256_free(&impl->ctx);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
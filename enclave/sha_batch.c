@@ -0,0 +1,445 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/* Nest mbedtls header includes with required corelibc defines */
+// clang-format off
+#include "mbedtls_corelibc_defs.h"
+#include <mbedtls/sha256.h>
+#include "mbedtls_corelibc_undef.h"
+// clang-format on
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/defs.h>
+#include <openenclave/internal/hmac.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/sha.h>
+#include <openenclave/internal/utils.h>
+
+/*
+**==============================================================================
+**
+** Multi-buffer SHA-256:
+**
+**     Up to SHA256_LANES messages are hashed side by side, one message per
+**     32-bit lane of an AVX2 register, so that a single pass over the
+**     compression function advances all of them by one block. Messages of
+**     different lengths share the pass; a lane whose message has no more
+**     blocks keeps its state unchanged.
+**
+**     The vector code uses compiler vector extensions rather than intrinsics
+**     and is only run when CPUID and XCR0 report AVX2. Otherwise every
+**     message is hashed with mbedtls.
+**
+**==============================================================================
+*/
+
+#define SHA256_LANES 8
+#define SHA256_BLOCK_SIZE 64
+
+#define CPUID_1_ECX_OSXSAVE (1u << 27)
+#define CPUID_1_ECX_AVX (1u << 28)
+#define CPUID_7_EBX_AVX2 (1u << 5)
+#define XCR0_SSE_AVX 0x6
+
+typedef uint32_t u32x8_t __attribute__((vector_size(32)));
+
+typedef struct _sha256_lane
+{
+    /* State to start from, or NULL for the SHA-256 initial value */
+    const uint32_t* state;
+
+    /* Number of bytes already absorbed into state */
+    uint64_t prefix;
+
+    const uint8_t* data;
+    size_t size;
+    OE_SHA256* sha256;
+} sha256_lane_t;
+
+static const uint32_t _iv[8] = {0x6a09e667,
+                                0xbb67ae85,
+                                0x3c6ef372,
+                                0xa54ff53a,
+                                0x510e527f,
+                                0x9b05688c,
+                                0x1f83d9ab,
+                                0x5be0cd19};
+
+static const uint32_t _k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+static void _cpuid(
+    uint32_t leaf,
+    uint32_t subleaf,
+    uint32_t* eax,
+    uint32_t* ebx,
+    uint32_t* ecx,
+    uint32_t* edx)
+{
+    /* Emulated by the enclave's exception handler in hardware mode */
+    asm volatile("cpuid"
+                 : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                 : "a"(leaf), "c"(subleaf));
+}
+
+static bool _have_avx2(void)
+{
+    static int _avx2 = -1;
+
+    if (_avx2 < 0)
+    {
+        uint32_t eax, ebx, ecx, edx;
+        bool avx2 = false;
+
+        _cpuid(1, 0, &eax, &ebx, &ecx, &edx);
+
+        /* The enclave's XFRM must also enable the AVX register state */
+        if ((ecx & CPUID_1_ECX_OSXSAVE) && (ecx & CPUID_1_ECX_AVX))
+        {
+            uint32_t xcr0_lo, xcr0_hi;
+
+            asm volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+
+            if ((xcr0_lo & XCR0_SSE_AVX) == XCR0_SSE_AVX)
+            {
+                _cpuid(7, 0, &eax, &ebx, &ecx, &edx);
+                avx2 = (ebx & CPUID_7_EBX_AVX2) != 0;
+            }
+        }
+
+        _avx2 = avx2 ? 1 : 0;
+    }
+
+    return _avx2 == 1;
+}
+
+static uint32_t _load_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void _store_be32(uint8_t* p, uint32_t x)
+{
+    p[0] = (uint8_t)(x >> 24);
+    p[1] = (uint8_t)(x >> 16);
+    p[2] = (uint8_t)(x >> 8);
+    p[3] = (uint8_t)x;
+}
+
+/* Number of blocks in the padded message, including the 0x80 byte and the
+ * 64-bit length */
+static size_t _num_blocks(const sha256_lane_t* lane)
+{
+    return (lane->size + 9 + SHA256_BLOCK_SIZE - 1) / SHA256_BLOCK_SIZE;
+}
+
+/* Returns the given block of the padded message of a lane. Whole blocks of
+ * the message are returned in place; others are built in the scratch
+ * buffer. */
+static const uint8_t* _get_block(
+    const sha256_lane_t* lane,
+    size_t index,
+    size_t num_blocks,
+    uint8_t scratch[SHA256_BLOCK_SIZE])
+{
+    size_t offset = index * SHA256_BLOCK_SIZE;
+    size_t n = 0;
+
+    if (offset + SHA256_BLOCK_SIZE <= lane->size)
+        return lane->data + offset;
+
+    if (offset < lane->size)
+    {
+        n = lane->size - offset;
+        memcpy(scratch, lane->data + offset, n);
+    }
+
+    memset(scratch + n, 0, SHA256_BLOCK_SIZE - n);
+
+    if (offset <= lane->size)
+        scratch[n] = 0x80;
+
+    if (index == num_blocks - 1)
+    {
+        uint64_t bits = (lane->prefix + lane->size) * 8;
+
+        _store_be32(scratch + 56, (uint32_t)(bits >> 32));
+        _store_be32(scratch + 60, (uint32_t)bits);
+    }
+
+    return scratch;
+}
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define BSIG0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define BSIG1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define SSIG0(x) (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define SSIG1(x) (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+/* Advances the lanes whose mask is set by one block. Vectors are passed in
+ * memory so that no AVX2 value crosses into code built without AVX2. */
+__attribute__((target("avx2"))) static void _compress_x8(
+    uint32_t state[8][SHA256_LANES],
+    const uint32_t words[16][SHA256_LANES],
+    const uint32_t mask[SHA256_LANES])
+{
+    u32x8_t s[8];
+    u32x8_t w[16];
+    u32x8_t m;
+    u32x8_t a, b, c, d, e, f, g, h;
+
+    for (size_t i = 0; i < 8; i++)
+        memcpy(&s[i], state[i], sizeof(s[i]));
+
+    for (size_t i = 0; i < 16; i++)
+        memcpy(&w[i], words[i], sizeof(w[i]));
+
+    memcpy(&m, mask, sizeof(m));
+
+    a = s[0];
+    b = s[1];
+    c = s[2];
+    d = s[3];
+    e = s[4];
+    f = s[5];
+    g = s[6];
+    h = s[7];
+
+    for (size_t t = 0; t < 64; t++)
+    {
+        u32x8_t k = {_k[t], _k[t], _k[t], _k[t], _k[t], _k[t], _k[t], _k[t]};
+        u32x8_t t1, t2;
+
+        if (t >= 16)
+        {
+            w[t & 15] += SSIG1(w[(t - 2) & 15]) + w[(t - 7) & 15] +
+                         SSIG0(w[(t - 15) & 15]);
+        }
+
+        t1 = h + BSIG1(e) + CH(e, f, g) + k + w[t & 15];
+        t2 = BSIG0(a) + MAJ(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    s[0] = (s[0] & ~m) | ((s[0] + a) & m);
+    s[1] = (s[1] & ~m) | ((s[1] + b) & m);
+    s[2] = (s[2] & ~m) | ((s[2] + c) & m);
+    s[3] = (s[3] & ~m) | ((s[3] + d) & m);
+    s[4] = (s[4] & ~m) | ((s[4] + e) & m);
+    s[5] = (s[5] & ~m) | ((s[5] + f) & m);
+    s[6] = (s[6] & ~m) | ((s[6] + g) & m);
+    s[7] = (s[7] & ~m) | ((s[7] + h) & m);
+
+    for (size_t i = 0; i < 8; i++)
+        memcpy(state[i], &s[i], sizeof(s[i]));
+}
+
+static void _sha256_x8(const sha256_lane_t* lanes, size_t count)
+{
+    uint32_t state[8][SHA256_LANES];
+    uint32_t words[16][SHA256_LANES] = {{0}};
+    uint32_t mask[SHA256_LANES];
+    size_t num_blocks[SHA256_LANES] = {0};
+    size_t max_blocks = 0;
+    uint8_t scratch[SHA256_BLOCK_SIZE];
+
+    for (size_t lane = 0; lane < SHA256_LANES; lane++)
+    {
+        const uint32_t* s = _iv;
+
+        if (lane < count)
+        {
+            if (lanes[lane].state)
+                s = lanes[lane].state;
+
+            num_blocks[lane] = _num_blocks(&lanes[lane]);
+
+            if (num_blocks[lane] > max_blocks)
+                max_blocks = num_blocks[lane];
+        }
+
+        for (size_t i = 0; i < 8; i++)
+            state[i][lane] = s[i];
+    }
+
+    for (size_t index = 0; index < max_blocks; index++)
+    {
+        for (size_t lane = 0; lane < SHA256_LANES; lane++)
+        {
+            const uint8_t* block;
+
+            if (index >= num_blocks[lane])
+            {
+                mask[lane] = 0;
+                continue;
+            }
+
+            block = _get_block(&lanes[lane], index, num_blocks[lane], scratch);
+
+            for (size_t i = 0; i < 16; i++)
+                words[i][lane] = _load_be32(block + 4 * i);
+
+            mask[lane] = 0xffffffff;
+        }
+
+        _compress_x8(state, words, mask);
+    }
+
+    for (size_t lane = 0; lane < count; lane++)
+    {
+        for (size_t i = 0; i < 8; i++)
+            _store_be32(lanes[lane].sha256->buf + 4 * i, state[i][lane]);
+    }
+
+    oe_secure_zero_fill(words, sizeof(words));
+    oe_secure_zero_fill(scratch, sizeof(scratch));
+}
+
+static void _sha256_x1(const sha256_lane_t* lane)
+{
+    mbedtls_sha256_context ctx;
+
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts_ret(&ctx, 0);
+
+    if (lane->state)
+    {
+        memcpy(ctx.state, lane->state, sizeof(ctx.state));
+        ctx.total[0] = (uint32_t)lane->prefix;
+        ctx.total[1] = (uint32_t)(lane->prefix >> 32);
+    }
+
+    mbedtls_sha256_update_ret(&ctx, lane->data, lane->size);
+    mbedtls_sha256_finish_ret(&ctx, lane->sha256->buf);
+    mbedtls_sha256_free(&ctx);
+}
+
+/* Hashes up to SHA256_LANES lanes. A single message gains nothing from the
+ * vector code, so it goes straight to mbedtls. */
+static void _sha256_lanes(const sha256_lane_t* lanes, size_t count)
+{
+    if (count > 1 && _have_avx2())
+    {
+        _sha256_x8(lanes, count);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; i++)
+            _sha256_x1(&lanes[i]);
+    }
+}
+
+oe_result_t oe_sha256_batch(
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* sha256s)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sha256_lane_t lanes[SHA256_LANES];
+
+    if (count && (!data || !sizes || !sha256s))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!data[i] && sizes[i])
+            OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+    for (size_t i = 0; i < count; i += SHA256_LANES)
+    {
+        size_t n = count - i < SHA256_LANES ? count - i : SHA256_LANES;
+
+        for (size_t j = 0; j < n; j++)
+        {
+            lanes[j].state = NULL;
+            lanes[j].prefix = 0;
+            lanes[j].data = (const uint8_t*)data[i + j];
+            lanes[j].size = sizes[i + j];
+            lanes[j].sha256 = &sha256s[i + j];
+        }
+
+        _sha256_lanes(lanes, n);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_hmac_sha256_batch(
+    const oe_hmac_sha256_key_t* const* keys,
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* hmacs)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    sha256_lane_t lanes[SHA256_LANES];
+    OE_SHA256 inner[SHA256_LANES];
+
+    if (count && (!keys || !data || !sizes || !hmacs))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!keys[i] || (!data[i] && sizes[i]))
+            OE_RAISE(OE_INVALID_PARAMETER);
+    }
+
+    /* HMAC(K, m) = H(K ^ opad || H(K ^ ipad || m)). The padded key blocks
+     * have already been absorbed into the key states. */
+    for (size_t i = 0; i < count; i += SHA256_LANES)
+    {
+        size_t n = count - i < SHA256_LANES ? count - i : SHA256_LANES;
+
+        for (size_t j = 0; j < n; j++)
+        {
+            lanes[j].state = keys[i + j]->inner;
+            lanes[j].prefix = SHA256_BLOCK_SIZE;
+            lanes[j].data = (const uint8_t*)data[i + j];
+            lanes[j].size = sizes[i + j];
+            lanes[j].sha256 = &inner[j];
+        }
+
+        _sha256_lanes(lanes, n);
+
+        for (size_t j = 0; j < n; j++)
+        {
+            lanes[j].state = keys[i + j]->outer;
+            lanes[j].data = inner[j].buf;
+            lanes[j].size = sizeof(inner[j].buf);
+            lanes[j].sha256 = &hmacs[i + j];
+        }
+
+        _sha256_lanes(lanes, n);
+    }
+
+    oe_secure_zero_fill(inner, sizeof(inner));
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -487,6 +487,48 @@ done:
     return result;
 }
 
+oe_result_t oe_cert_read_der(
+    oe_cert_t* cert,
+    const void* der_data,
+    size_t der_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    Cert* impl = (Cert*)cert;
+    X509* x509 = NULL;
+    const unsigned char* p = (const unsigned char*)der_data;
+
+    /* Zero-initialize the implementation */
+    if (impl)
+        impl->magic = 0;
+
+    /* Check parameters */
+    if (!der_data || !der_size || der_size > OE_INT_MAX || !cert)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Initialize OpenSSL (if not already initialized) */
+    oe_initialize_openssl();
+
+    /* Decode the DER certificate directly, without any PEM decoding */
+    if (!(x509 = d2i_X509(NULL, &p, (long)der_size)))
+        OE_RAISE(OE_FAILURE);
+
+    /* Must be exactly one DER certificate */
+    if (p != (const unsigned char*)der_data + der_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    _cert_init(impl, x509);
+    x509 = NULL;
+
+    result = OE_OK;
+
+done:
+
+    if (x509)
+        X509_free(x509);
+
+    return result;
+}
+
 oe_result_t oe_cert_free(oe_cert_t* cert)
 {
     oe_result_t result = OE_UNEXPECTED;
@@ -542,6 +584,25 @@ static void _sort_certs_by_issue_date(STACK_OF(X509) * chain)
     sk_X509_sort(chain);
 }
 
+/* Orders and verifies a freshly read chain and takes ownership of it */
+static oe_result_t _cert_chain_finish(CertChain* impl, STACK_OF(X509) * sk)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    /* Reorder certs in the chain to preferred order */
+    _sort_certs_by_issue_date(sk);
+
+    /* Verify the whole certificate chain */
+    OE_CHECK(_verify_whole_chain(sk));
+
+    _cert_chain_init(impl, sk);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t oe_cert_chain_read_pem(
     oe_cert_chain_t* chain,
     const void* pem_data,
@@ -570,18 +631,141 @@ oe_result_t oe_cert_chain_read_pem(
     if (!(sk = _read_cert_chain((const char*)pem_data)))
         OE_RAISE(OE_FAILURE);
 
-    /* Reorder certs in the chain to preferred order */
-    _sort_certs_by_issue_date(sk);
+    OE_CHECK(_cert_chain_finish(impl, sk));
+    sk = NULL;
 
-    /* Verify the whole certificate chain */
-    OE_CHECK(_verify_whole_chain(sk));
+    result = OE_OK;
 
-    _cert_chain_init(impl, sk);
+done:
+
+    if (sk)
+        sk_X509_pop_free(sk, X509_free);
+
+    return result;
+}
 
+oe_result_t oe_cert_chain_read_der(
+    oe_cert_chain_t* chain,
+    const void* der_data,
+    size_t der_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    CertChain* impl = (CertChain*)chain;
+    STACK_OF(X509)* sk = NULL;
+    X509* x509 = NULL;
+    const unsigned char* p = (const unsigned char*)der_data;
+    const unsigned char* end = p + der_size;
+
+    /* Zero-initialize the implementation */
+    if (impl)
+        memset(impl, 0, sizeof(CertChain));
+
+    /* Check parameters */
+    if (!der_data || !der_size || der_size > OE_INT_MAX || !chain)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Initialize OpenSSL (if not already initialized) */
+    oe_initialize_openssl();
+
+    if (!(sk = sk_X509_new_null()))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Decode each of the concatenated DER certificates in turn */
+    while (p < end)
+    {
+        if (!(x509 = d2i_X509(NULL, &p, (long)(end - p))))
+            OE_RAISE(OE_FAILURE);
+
+        if (!sk_X509_push(sk, x509))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        x509 = NULL;
+    }
+
+    OE_CHECK(_cert_chain_finish(impl, sk));
+    sk = NULL;
+
+    result = OE_OK;
+
+done:
+
+    if (x509)
+        X509_free(x509);
+
+    if (sk)
+        sk_X509_pop_free(sk, X509_free);
+
+    return result;
+}
+
+oe_result_t oe_cert_chain_pem_to_der(
+    const void* pem_data,
+    size_t pem_size,
+    uint8_t* der_data,
+    size_t* der_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    BIO* bio = NULL;
+    X509* x509 = NULL;
+    size_t size = 0;
+    size_t count = 0;
+
+    /* Check parameters */
+    if (!pem_data || !pem_size || pem_size > OE_INT_MAX || !der_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Initialize OpenSSL (if not already initialized) */
+    oe_initialize_openssl();
+
+    if (!(bio = BIO_new_mem_buf(pem_data, (int)pem_size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Re-encode each certificate, writing only what fits in the buffer */
+    while ((x509 = PEM_read_bio_X509(bio, NULL, 0, NULL)))
+    {
+        int n = i2d_X509(x509, NULL);
+
+        if (n <= 0)
+            OE_RAISE(OE_FAILURE);
+
+        if (der_data && size + (size_t)n <= *der_size)
+        {
+            unsigned char* p = der_data + size;
+
+            if (i2d_X509(x509, &p) != n)
+                OE_RAISE(OE_FAILURE);
+        }
+
+        size += (size_t)n;
+        count++;
+        X509_free(x509);
+        x509 = NULL;
+    }
+
+    /* Running out of PEM blocks is the expected way for the loop to end */
+    if (count == 0 ||
+        ERR_GET_REASON(ERR_peek_last_error()) != PEM_R_NO_START_LINE)
+        OE_RAISE(OE_FAILURE);
+
+    ERR_clear_error();
+
+    if (!der_data || size > *der_size)
+    {
+        *der_size = size;
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+
+    *der_size = size;
     result = OE_OK;
 
 done:
 
+    if (x509)
+        X509_free(x509);
+
+    if (bio)
+        BIO_free(bio);
+
     return result;
 }
 
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #if defined(__linux__)
+#include <openssl/crypto.h>
 #include <openssl/sha.h>
 #elif defined(_WIN32)
 #include "bcrypt/bcrypt.h"
@@ -104,3 +105,59 @@ oe_result_t oe_sha256_final(oe_sha256_context_t* context, OE_SHA256* sha256)
 done:
     return result;
 }
+
+oe_result_t oe_sha256_clone(
+    oe_sha256_context_t* dest,
+    const oe_sha256_context_t* src)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_impl_t* dest_impl = (oe_sha256_context_impl_t*)dest;
+    const oe_sha256_context_impl_t* src_impl =
+        (const oe_sha256_context_impl_t*)src;
+
+    if (!dest || !src)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+#if defined(__linux__)
+    memcpy(&dest_impl->ctx, &src_impl->ctx, sizeof(dest_impl->ctx));
+#elif defined(_WIN32)
+    if (BCryptDuplicateHash(
+            src_impl->handle, &dest_impl->handle, NULL, 0, 0) !=
+        STATUS_SUCCESS)
+    {
+        OE_RAISE(OE_FAILURE);
+    }
+#endif
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sha256_free(oe_sha256_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_impl_t* impl = (oe_sha256_context_impl_t*)context;
+
+    if (!context)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+#if defined(__linux__)
+    OPENSSL_cleanse(&impl->ctx, sizeof(impl->ctx));
+#elif defined(_WIN32)
+    /* Finished hashes keep their handle until it is destroyed */
+    if (impl->handle)
+    {
+        if (BCryptDestroyHash(impl->handle) != STATUS_SUCCESS)
+            OE_RAISE(OE_FAILURE);
+
+        impl->handle = NULL;
+    }
+#endif
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -52,3 +52,44 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     OE_UNUSED(enclave);
     return OE_UNSUPPORTED;
 }
+
+oe_result_t oe_snapshot_enclave(
+    oe_enclave_t* enclave,
+    oe_enclave_snapshot_t** snapshot)
+{
+    OE_UNUSED(enclave);
+
+    if (snapshot)
+        *snapshot = NULL;
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_clone_enclave(
+    oe_enclave_snapshot_t* snapshot,
+    oe_enclave_t** enclave)
+{
+    OE_UNUSED(snapshot);
+
+    if (enclave)
+        *enclave = NULL;
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_free_enclave_snapshot(oe_enclave_snapshot_t* snapshot)
+{
+    OE_UNUSED(snapshot);
+    return OE_UNSUPPORTED;
+}
+
+void oe_cancel(oe_cancellation_token_t* token)
+{
+    OE_UNUSED(token);
+}
+
+oe_result_t oe_set_call_options(const oe_call_options_t* options)
+{
+    OE_UNUSED(options);
+    return OE_UNSUPPORTED;
+}
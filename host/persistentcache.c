@@ -0,0 +1,345 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "persistentcache.h"
+#include <openenclave/internal/sha.h>
+#include <openenclave/internal/trace.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#include <io.h>
+#include <process.h>
+#endif
+#include "dupenv.h"
+#include "fopen.h"
+
+/* Version 2 follows every record with its SHA-256 */
+#define PERSISTENT_CACHE_FILE_VERSION 2
+
+typedef struct _file_header
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint64_t key_size;
+    uint64_t value_size;
+} file_header_t;
+
+static size_t _record_size(const oe_persistent_cache_t* cache)
+{
+    return cache->key_size + cache->value_size;
+}
+
+static uint8_t* _record(const oe_persistent_cache_t* cache, size_t index)
+{
+    return cache->records + index * _record_size(cache);
+}
+
+static bool _checksum(
+    const oe_persistent_cache_t* cache,
+    const uint8_t* record,
+    OE_SHA256* hash)
+{
+    oe_sha256_context_t context = {{0}};
+    bool ok = oe_sha256_init(&context) == OE_OK &&
+              oe_sha256_update(&context, record, _record_size(cache)) ==
+                  OE_OK &&
+              oe_sha256_final(&context, hash) == OE_OK;
+
+    oe_sha256_free(&context);
+    return ok;
+}
+
+static size_t _find(const oe_persistent_cache_t* cache, const void* key)
+{
+    if (!cache->records)
+        return cache->capacity;
+
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        if (cache->last_use[i] &&
+            memcmp(_record(cache, i), key, cache->key_size) == 0)
+            return i;
+    }
+
+    return cache->capacity;
+}
+
+/* Returns a free entry, or else the least recently used one */
+static size_t _find_victim(const oe_persistent_cache_t* cache)
+{
+    size_t victim = 0;
+
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        if (!cache->last_use[i])
+            return i;
+
+        if (cache->last_use[i] < cache->last_use[victim])
+            victim = i;
+    }
+
+    return victim;
+}
+
+static void _insert(
+    oe_persistent_cache_t* cache,
+    const void* key,
+    const void* value)
+{
+    size_t index = _find(cache, key);
+
+    if (index == cache->capacity)
+        index = _find_victim(cache);
+
+    memcpy(_record(cache, index), key, cache->key_size);
+    memcpy(_record(cache, index) + cache->key_size, value, cache->value_size);
+    cache->last_use[index] = ++cache->tick;
+}
+
+/* Loads the persisted entries, ignoring a missing or malformed file and
+ * any record whose checksum does not match */
+static void _load(oe_persistent_cache_t* cache)
+{
+    char* path = NULL;
+    FILE* stream = NULL;
+    uint8_t* record = NULL;
+    file_header_t header;
+    OE_SHA256 stored;
+    OE_SHA256 computed;
+
+    if (!(path = oe_dupenv(cache->file_env)) || !*path)
+        goto done;
+
+    if (oe_fopen(&stream, path, "rb") != 0)
+        goto done;
+
+    if (fread(&header, sizeof(header), 1, stream) != 1 ||
+        header.magic != cache->file_magic ||
+        header.version != PERSISTENT_CACHE_FILE_VERSION ||
+        header.key_size != cache->key_size ||
+        header.value_size != cache->value_size ||
+        header.count > cache->capacity)
+        goto done;
+
+    if (!(record = (uint8_t*)malloc(_record_size(cache))))
+        goto done;
+
+    for (uint32_t i = 0; i < header.count; i++)
+    {
+        if (fread(record, _record_size(cache), 1, stream) != 1 ||
+            fread(&stored, sizeof(stored), 1, stream) != 1)
+            break;
+
+        if (!_checksum(cache, record, &computed) ||
+            memcmp(&stored, &computed, sizeof(stored)) != 0)
+        {
+            OE_TRACE_WARNING("skipping corrupt record in cache file: %s", path);
+            continue;
+        }
+
+        _insert(cache, record, record + cache->key_size);
+    }
+
+done:
+
+    if (stream)
+        fclose(stream);
+
+    free(record);
+    free(path);
+}
+
+/* Flushes a stream to the disk */
+static int _sync(FILE* stream)
+{
+    if (fflush(stream) != 0)
+        return -1;
+
+#if defined(__linux__)
+    return fsync(fileno(stream));
+#elif defined(_WIN32)
+    return _commit(_fileno(stream));
+#endif
+}
+
+/* Replaces the file at path with the file at temp_path */
+static int _replace(const char* temp_path, const char* path)
+{
+#if defined(__linux__)
+    return rename(temp_path, path);
+#elif defined(_WIN32)
+    return MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#endif
+}
+
+/* Writes the entries back to the persisted file, if there is one. The
+ * entries are written to a temporary file in the same directory, which is
+ * then renamed over the file, so that other processes loading the file at
+ * the same time see either the old or the new contents and never a mix. */
+static void _save(oe_persistent_cache_t* cache)
+{
+    char* path = NULL;
+    char* temp_path = NULL;
+    size_t temp_path_size;
+    FILE* stream = NULL;
+    bool written = false;
+    file_header_t header = {cache->file_magic,
+                            PERSISTENT_CACHE_FILE_VERSION,
+                            0,
+                            cache->key_size,
+                            cache->value_size};
+    OE_SHA256 hash;
+
+    if (!(path = oe_dupenv(cache->file_env)) || !*path)
+        goto done;
+
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        if (cache->last_use[i])
+            header.count++;
+    }
+
+    /* Each process writes its own temporary file */
+    temp_path_size = strlen(path) + 32;
+
+    if (!(temp_path = (char*)malloc(temp_path_size)))
+        goto done;
+
+#if defined(__linux__)
+    snprintf(temp_path, temp_path_size, "%s.%d.tmp", path, (int)getpid());
+#elif defined(_WIN32)
+    snprintf(temp_path, temp_path_size, "%s.%d.tmp", path, _getpid());
+#endif
+
+    if (oe_fopen(&stream, temp_path, "wb") != 0)
+    {
+        OE_TRACE_WARNING("cannot write cache file: %s", temp_path);
+        goto done;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, stream) != 1)
+        goto done;
+
+    for (size_t i = 0; i < cache->capacity; i++)
+    {
+        if (!cache->last_use[i])
+            continue;
+
+        if (!_checksum(cache, _record(cache, i), &hash) ||
+            fwrite(_record(cache, i), _record_size(cache), 1, stream) != 1 ||
+            fwrite(&hash, sizeof(hash), 1, stream) != 1)
+            goto done;
+    }
+
+    if (_sync(stream) != 0)
+        goto done;
+
+    written = true;
+
+done:
+
+    if (stream)
+    {
+        if (fclose(stream) != 0)
+            written = false;
+
+        if (!written || _replace(temp_path, path) != 0)
+        {
+            OE_TRACE_WARNING("cannot write cache file: %s", path);
+            remove(temp_path);
+        }
+    }
+
+    free(temp_path);
+    free(path);
+}
+
+void oe_persistent_cache_lock(oe_persistent_cache_t* cache)
+{
+    oe_mutex_lock(&cache->lock);
+
+    /* Without memory the cache simply stays empty */
+    if (!cache->records)
+    {
+        cache->records = (uint8_t*)calloc(cache->capacity, _record_size(cache));
+        cache->last_use = (uint64_t*)calloc(cache->capacity, sizeof(uint64_t));
+
+        if (!cache->records || !cache->last_use)
+        {
+            free(cache->records);
+            free(cache->last_use);
+            cache->records = NULL;
+            cache->last_use = NULL;
+            return;
+        }
+    }
+
+    if (!cache->loaded)
+    {
+        cache->loaded = true;
+        _load(cache);
+    }
+}
+
+void oe_persistent_cache_unlock(oe_persistent_cache_t* cache)
+{
+    oe_mutex_unlock(&cache->lock);
+}
+
+bool oe_persistent_cache_get(
+    oe_persistent_cache_t* cache,
+    const void* key,
+    void* value)
+{
+    size_t index = _find(cache, key);
+
+    if (index == cache->capacity)
+        return false;
+
+    memcpy(value, _record(cache, index) + cache->key_size, cache->value_size);
+    cache->last_use[index] = ++cache->tick;
+    return true;
+}
+
+void oe_persistent_cache_put(
+    oe_persistent_cache_t* cache,
+    const void* key,
+    const void* value)
+{
+    if (!cache->records)
+        return;
+
+    _insert(cache, key, value);
+    _save(cache);
+}
+
+void oe_persistent_cache_remove(oe_persistent_cache_t* cache, const void* key)
+{
+    size_t index = _find(cache, key);
+
+    if (index != cache->capacity)
+    {
+        memset(_record(cache, index), 0, _record_size(cache));
+        cache->last_use[index] = 0;
+    }
+}
+
+void oe_persistent_cache_clear(oe_persistent_cache_t* cache)
+{
+    oe_mutex_lock(&cache->lock);
+
+    if (cache->records)
+    {
+        memset(cache->records, 0, cache->capacity * _record_size(cache));
+        memset(cache->last_use, 0, cache->capacity * sizeof(uint64_t));
+    }
+
+    cache->tick = 0;
+    cache->loaded = false;
+    oe_mutex_unlock(&cache->lock);
+}
@@ -0,0 +1,78 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_PERSISTENTCACHE_H
+#define _OE_HOST_PERSISTENTCACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include "hostthread.h"
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** oe_persistent_cache_t
+**
+**     A fixed capacity map from fixed size keys to fixed size values, in which
+**     the least recently used entry is replaced when the map is full. If the
+**     environment variable named by file_env is set, the map is loaded from
+**     that file on first use and written back to it on every insertion. The
+**     file is replaced by renaming a temporary file over it, and each record
+**     carries a SHA-256 that is checked when the file is loaded.
+**     Define instances statically with OE_PERSISTENT_CACHE_INITIALIZER().
+**
+**==============================================================================
+*/
+
+typedef struct _oe_persistent_cache
+{
+    const char* file_env;
+    uint64_t file_magic;
+    size_t key_size;
+    size_t value_size;
+    size_t capacity;
+
+    /* Private fields */
+    oe_mutex lock;
+    uint8_t* records;
+    uint64_t* last_use;
+    uint64_t tick;
+    bool loaded;
+} oe_persistent_cache_t;
+
+#define OE_PERSISTENT_CACHE_INITIALIZER(                      \
+    FILE_ENV, FILE_MAGIC, KEY_SIZE, VALUE_SIZE, CAPACITY)     \
+    {                                                         \
+        FILE_ENV, FILE_MAGIC, KEY_SIZE, VALUE_SIZE, CAPACITY, \
+            OE_H_MUTEX_INITIALIZER, NULL, NULL, 0, false      \
+    }
+
+/* Locks the cache, loading it first if necessary. All functions below but
+ * oe_persistent_cache_clear() must be called with the cache locked. */
+void oe_persistent_cache_lock(oe_persistent_cache_t* cache);
+
+void oe_persistent_cache_unlock(oe_persistent_cache_t* cache);
+
+/* Copies the value for the key and returns true if the key is present */
+bool oe_persistent_cache_get(
+    oe_persistent_cache_t* cache,
+    const void* key,
+    void* value);
+
+/* Adds or replaces the value for the key and saves the cache */
+void oe_persistent_cache_put(
+    oe_persistent_cache_t* cache,
+    const void* key,
+    const void* value);
+
+/* Removes the key from memory; the file keeps it until the next put */
+void oe_persistent_cache_remove(oe_persistent_cache_t* cache, const void* key);
+
+/* Drops every entry from memory, so that the file is loaded again */
+void oe_persistent_cache_clear(oe_persistent_cache_t* cache);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_PERSISTENTCACHE_H */
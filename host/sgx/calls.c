@@ -28,8 +28,10 @@
 #include <openenclave/internal/utils.h>
 #include "../ocalls.h"
 #include "asmdefs.h"
+#include "deadline.h"
 #include "enclave.h"
 #include "ocalls.h"
+#include "snapshot.h"
 
 /*
 **==============================================================================
@@ -337,23 +339,36 @@ static oe_result_t _handle_ocall(
             break;
 
         case OE_OCALL_MALLOC:
-            HandleMalloc(arg_in, arg_out);
-            break;
-
         case OE_OCALL_REALLOC:
-            HandleRealloc(arg_in, arg_out);
-            break;
-
         case OE_OCALL_FREE:
-            HandleFree(arg_in);
+        {
+            /* Snapshots need to know the host memory the enclave holds */
+            if (enclave->simulate)
+            {
+                oe_sgx_handle_sim_host_allocation(
+                    enclave, func, arg_in, arg_out);
+            }
+            else if (func == OE_OCALL_MALLOC)
+            {
+                HandleMalloc(arg_in, arg_out);
+            }
+            else if (func == OE_OCALL_REALLOC)
+            {
+                HandleRealloc(arg_in, arg_out);
+            }
+            else
+            {
+                HandleFree(arg_in);
+            }
             break;
+        }
 
         case OE_OCALL_WRITE:
             HandlePrint(arg_in);
             break;
 
         case OE_OCALL_THREAD_WAIT:
-            HandleThreadWait(enclave, arg_in);
+            HandleThreadWait(enclave, arg_in, arg_out);
             break;
 
         case OE_OCALL_THREAD_WAKE:
@@ -361,7 +376,7 @@ static oe_result_t _handle_ocall(
             break;
 
         case OE_OCALL_THREAD_WAKE_WAIT:
-            HandleThreadWakeWait(enclave, arg_in);
+            HandleThreadWakeWait(enclave, arg_in, arg_out);
             break;
 
         case OE_OCALL_GET_QUOTE:
@@ -518,7 +533,8 @@ int __oe_dispatch_ocall(
 **
 **     If such a binding already exists, the binding's count in incremented.
 **     Else, the calling host thread is bound to the first available enclave
-**     thread context.
+**     thread context reserved for the given TCS pool, if any, or else to the
+**     first available one that no pool reserved.
 **
 **     Returns the address of the thread control structure (TCS) corresponding
 **     to the enclave thread context.
@@ -526,11 +542,12 @@ int __oe_dispatch_ocall(
 **==============================================================================
 */
 
-static void* _assign_tcs(oe_enclave_t* enclave)
+static void* _assign_tcs(oe_enclave_t* enclave, uint8_t pool)
 {
     void* tcs = NULL;
     size_t i;
     oe_thread thread = oe_thread_self();
+    int pass;
 
     oe_mutex_lock(&enclave->lock);
     {
@@ -547,14 +564,18 @@ static void* _assign_tcs(oe_enclave_t* enclave)
             }
         }
 
-        /* If binding not found above, look for an available ThreadBinding */
-        if (!tcs)
+        /* If binding not found above, look for an available ThreadBinding,
+         * first among those of the pool and then among unreserved ones */
+        for (pass = pool ? 0 : 1; !tcs && pass < 2; pass++)
         {
+            const uint8_t wanted = pass == 0 ? pool : 0;
+
             for (i = 0; i < enclave->num_bindings; i++)
             {
                 ThreadBinding* binding = &enclave->bindings[i];
 
-                if (!(binding->flags & _OE_THREAD_BUSY))
+                if (enclave->tcs_pools[i] == wanted &&
+                    !(binding->flags & _OE_THREAD_BUSY))
                 {
                     binding->flags |= _OE_THREAD_BUSY;
                     binding->thread = thread;
@@ -574,6 +595,35 @@ static void* _assign_tcs(oe_enclave_t* enclave)
     return tcs;
 }
 
+/*
+**==============================================================================
+**
+** _get_tcs_pool()
+**
+**     Returns the TCS pool of the enclave function called by the given ECALL,
+**     or zero if the ECALL may only use unreserved TCSs.
+**
+**==============================================================================
+*/
+
+static uint8_t _get_tcs_pool(oe_enclave_t* enclave, uint16_t func, uint64_t arg)
+{
+    const oe_call_enclave_function_args_t* args;
+
+    if (func != OE_ECALL_CALL_ENCLAVE_FUNCTION || !enclave->num_ecall_pools)
+        return 0;
+
+    args = (const oe_call_enclave_function_args_t*)arg;
+
+    for (size_t i = 0; i < enclave->num_ecall_pools; i++)
+    {
+        if (enclave->ecall_pools[i].function_id == args->function_id)
+            return enclave->ecall_pools[i].pool;
+    }
+
+    return 0;
+}
+
 /*
 **==============================================================================
 **
@@ -643,7 +693,7 @@ oe_result_t oe_ecall(
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /* Assign a td_t for this operation */
-    if (!(tcs = _assign_tcs(enclave)))
+    if (!(tcs = _assign_tcs(enclave, _get_tcs_pool(enclave, func, arg))))
         OE_RAISE(OE_OUT_OF_THREADS);
 
     /* Perform ECALL or ORET */
@@ -693,6 +743,40 @@ done:
 **==============================================================================
 */
 
+/*
+**==============================================================================
+**
+** oe_set_call_options()
+**
+**     The options of the calling thread are kept in thread-specific data.
+**
+**==============================================================================
+*/
+
+static oe_once_type _call_options_once;
+static oe_thread_key _call_options_key;
+
+static void _create_call_options_key(void)
+{
+    oe_thread_key_create(&_call_options_key);
+}
+
+oe_result_t oe_set_call_options(const oe_call_options_t* options)
+{
+    oe_once(&_call_options_once, _create_call_options_key);
+
+    if (oe_thread_setspecific(_call_options_key, (void*)options) != 0)
+        return OE_FAILURE;
+
+    return OE_OK;
+}
+
+void oe_cancel(oe_cancellation_token_t* token)
+{
+    if (token)
+        token->cancelled = 1;
+}
+
 oe_result_t oe_call_enclave_function(
     oe_enclave_t* enclave,
     uint32_t function_id,
@@ -704,11 +788,18 @@ oe_result_t oe_call_enclave_function(
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_call_enclave_function_args_t args;
+    const oe_call_options_t* options;
+    oe_deadline_t deadline;
+    bool deadline_started = false;
 
     /* Reject invalid parameters */
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    oe_once(&_call_options_once, _create_call_options_key);
+    options = (const oe_call_options_t*)oe_thread_getspecific(
+        _call_options_key);
+
     /* Initialize the call_enclave_args structure */
     {
         args.function_id = function_id;
@@ -718,6 +809,22 @@ oe_result_t oe_call_enclave_function(
         args.output_buffer_size = output_buffer_size;
         args.output_bytes_written = 0;
         args.result = OE_UNEXPECTED;
+        args.cancelled = NULL;
+        args.expired = NULL;
+    }
+
+    /* Let the enclave poll the cancellation token and the deadline */
+    if (options)
+    {
+        if (options->token)
+            args.cancelled = &options->token->cancelled;
+
+        if (options->timeout_ms)
+        {
+            OE_CHECK(oe_deadline_start(&deadline, options->timeout_ms));
+            deadline_started = true;
+            args.expired = &deadline.expired;
+        }
     }
 
     /* Perform the ECALL */
@@ -739,6 +846,10 @@ oe_result_t oe_call_enclave_function(
     result = OE_OK;
 
 done:
+
+    if (deadline_started)
+        oe_deadline_stop(&deadline);
+
     return result;
 }
 
@@ -52,6 +52,8 @@ static char* get_fullpath(const char* path)
 #include "enclave.h"
 #include "exception.h"
 #include "sgxload.h"
+#include "snapshot.h"
+#include "stackusage.h"
 
 static oe_once_type _enclave_init_once;
 
@@ -126,8 +128,9 @@ static oe_result_t _add_stack_pages(
     size_t npages)
 {
     const bool extend = true;
+    const uint32_t filler = OE_SGX_STACK_FILL_PATTERN;
     return _add_filled_pages(
-        context, enclave_addr, vaddr, npages, 0xcccccccc, extend);
+        context, enclave_addr, vaddr, npages, filler, extend);
 }
 
 static oe_result_t _add_heap_pages(
@@ -302,6 +305,8 @@ static oe_result_t _add_data_pages(
         &props->header.size_settings;
     size_t i;
 
+    enclave->num_stack_pages = size_settings->num_stack_pages;
+
     /* Add the heap pages */
     OE_CHECK(_add_heap_pages(
         context, enclave->addr, vaddr, size_settings->num_heap_pages));
@@ -459,6 +464,16 @@ oe_result_t oe_sgx_validate_enclave_properties(
         goto done;
     }
 
+    if (properties->config.flags & ~OE_SGX_CONFIG_FLAGS_MASK)
+    {
+        if (field_name)
+            *field_name = "config.flags";
+        OE_TRACE_ERROR(
+            "unknown config.flags: flags = %x\n", properties->config.flags);
+        result = OE_FAILURE;
+        goto done;
+    }
+
     result = OE_OK;
 
 done:
@@ -547,6 +562,19 @@ oe_result_t oe_sgx_build_enclave(
     // Set the XFRM field
     props.config.xfrm = context->attributes.xfrm;
 
+    /* Switch to the compact relocation format if the image was signed with
+     * it. This changes the relocation size, so it precedes the layout. */
+    if (props.config.flags & OE_SGX_CONFIG_FLAGS_COMPACT_RELOCATIONS)
+    {
+        if (!oeimage.compact_relocations)
+            OE_RAISE_MSG(
+                OE_UNSUPPORTED_ENCLAVE_IMAGE,
+                "image type does not support compact relocations",
+                NULL);
+
+        OE_CHECK(oeimage.compact_relocations(&oeimage));
+    }
+
     /* Calculate the size of image */
     OE_CHECK(oeimage.calculate_size(&oeimage, &image_size));
 
@@ -598,6 +626,123 @@ done:
     return result;
 }
 
+/*
+** Reserves the bindings of the TCS pools of the configuration, taking them
+** from the last binding backwards, and records the pool of each function.
+*/
+static oe_result_t _configure_tcs_pools(
+    oe_enclave_t* enclave,
+    const oe_sgx_create_config_t* config)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t num_reserved = 0;
+    size_t num_functions = 0;
+
+    if (config->num_tcs_pools > OE_SGX_MAX_TCS_POOLS ||
+        (config->num_tcs_pools && !config->tcs_pools))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (uint32_t i = 0; i < config->num_tcs_pools; i++)
+    {
+        const oe_sgx_tcs_pool_t* pool = &config->tcs_pools[i];
+
+        if (pool->num_function_ids && !pool->function_ids)
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        num_reserved += pool->num_tcs;
+        num_functions += pool->num_function_ids;
+    }
+
+    /* Ecalls of functions outside the pools need at least one TCS */
+    if (num_reserved >= enclave->num_bindings)
+        OE_RAISE_MSG(
+            OE_INVALID_PARAMETER,
+            "TCS pools reserve %zu of %zu TCSs",
+            num_reserved,
+            enclave->num_bindings);
+
+    if (num_functions &&
+        !(enclave->ecall_pools = (oe_sgx_ecall_pool_t*)calloc(
+              num_functions, sizeof(oe_sgx_ecall_pool_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* The unpooled path scans the bindings from the first, so the pools
+     * take the last ones, the first pool starting from the very last */
+    num_reserved = 0;
+
+    for (uint32_t i = 0; i < config->num_tcs_pools; i++)
+    {
+        const oe_sgx_tcs_pool_t* pool = &config->tcs_pools[i];
+        const uint8_t pool_number = (uint8_t)(i + 1);
+
+        for (uint32_t j = 0; j < pool->num_tcs; j++)
+            enclave->tcs_pools[enclave->num_bindings - 1 - num_reserved++] =
+                pool_number;
+
+        for (uint32_t j = 0; j < pool->num_function_ids; j++)
+        {
+            const uint32_t function_id = pool->function_ids[j];
+
+            for (size_t k = 0; k < enclave->num_ecall_pools; k++)
+            {
+                if (enclave->ecall_pools[k].function_id == function_id)
+                    OE_RAISE_MSG(
+                        OE_INVALID_PARAMETER,
+                        "function %u is in more than one TCS pool",
+                        function_id);
+            }
+
+            enclave->ecall_pools[enclave->num_ecall_pools].function_id =
+                function_id;
+            enclave->ecall_pools[enclave->num_ecall_pools].pool = pool_number;
+            enclave->num_ecall_pools++;
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+** Releases the enclave memory, the shared pages, the Windows events and the
+** allocations of an enclave structure, but not the structure itself. Used
+** by oe_terminate_enclave() and when oe_create_enclave() fails.
+*/
+static oe_result_t _release_enclave(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_OK;
+
+    /* Unmap the enclave memory region and drop the shared pages */
+    if (enclave->addr)
+        result = oe_sgx_delete_enclave(enclave);
+
+#if defined(_WIN32)
+
+    /* Release Windows events created during enclave creation */
+    for (size_t i = 0; i < enclave->num_bindings; i++)
+    {
+        ThreadBinding* binding = &enclave->bindings[i];
+
+        if (binding->event.handle)
+            CloseHandle(binding->event.handle);
+    }
+
+#endif
+
+    /* Free the path name of the enclave image file */
+    free(enclave->path);
+
+    /* Free the assignment of enclave functions to TCS pools */
+    free(enclave->ecall_pools);
+
+    /* Free the list of host memory held by a simulated enclave */
+    free(enclave->host_allocations);
+
+    return result;
+}
+
 /*
 ** This method encapsulates all steps of the enclave creation process:
 **     - Loads an enclave image file
@@ -626,6 +771,7 @@ oe_result_t oe_create_enclave(
     oe_result_t result = OE_UNEXPECTED;
     oe_enclave_t* enclave = NULL;
     oe_sgx_load_context_t context;
+    bool registered = false;
 
     _initialize_enclave_host();
 
@@ -636,7 +782,9 @@ oe_result_t oe_create_enclave(
     if (!enclave_path || !enclave_out ||
         ((enclave_type != OE_ENCLAVE_TYPE_SGX) &&
          (enclave_type != OE_ENCLAVE_TYPE_AUTO)) ||
-        (flags & OE_ENCLAVE_FLAG_RESERVED) || config || config_size > 0)
+        (flags & OE_ENCLAVE_FLAG_RESERVED) ||
+        (config && config_size != sizeof(oe_sgx_create_config_t)) ||
+        (!config && config_size > 0))
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /* Allocate and zero-fill the enclave structure */
@@ -674,11 +822,19 @@ oe_result_t oe_create_enclave(
     /* Build the enclave */
     OE_CHECK(oe_sgx_build_enclave(&context, enclave_path, NULL, enclave));
 
+    /* Reserve TCSs for classes of ecalls before any ecall is made */
+    if (config)
+        OE_CHECK(_configure_tcs_pools(
+            enclave, (const oe_sgx_create_config_t*)config));
+
     /* Push the new created enclave to the global list. */
     if (oe_push_enclave_instance(enclave) != 0)
     {
         OE_RAISE(OE_FAILURE);
     }
+
+    registered = true;
+
 #if defined(__linux__)
 
     /* Notify GDB that a new enclave is created */
@@ -705,6 +861,19 @@ done:
 
     if (result != OE_OK && enclave)
     {
+        /* Undo the creation as oe_terminate_enclave() would, except for the
+         * destructor ECALL, so that the memory, the shared pages and the TCS
+         * pool state are not leaked */
+        if (registered)
+        {
+#if defined(__linux__)
+            oe_notify_gdb_enclave_termination(
+                enclave, enclave->path, (uint32_t)strlen(enclave->path));
+#endif
+            oe_remove_enclave_instance(enclave);
+        }
+
+        _release_enclave(enclave);
         free(enclave);
     }
 
@@ -721,9 +890,20 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     if (!enclave || enclave->magic != ENCLAVE_MAGIC)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    /* Clones are discarded without running the destructors, so that the
+     * state they share with their snapshot is left untouched */
+    if (enclave->snapshot)
+    {
+        result = oe_sgx_terminate_clone(enclave);
+        goto done;
+    }
+
     /* Call the enclave destructor */
     OE_CHECK(oe_ecall(enclave, OE_ECALL_DESTRUCTOR, 0, NULL));
 
+    /* Report how deep the stacks grew, if asked to */
+    oe_sgx_report_stack_usage(enclave);
+
 #if defined(__linux__)
 
     /* Notify GDB that this enclave is terminated */
@@ -743,23 +923,9 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
 
     oe_mutex_lock(&enclave->lock);
     {
-        /* Unmap the enclave memory region.
+        /* Unmap the enclave memory region and free the rest.
          * Track failures reported by the platform, but do not exit early */
-        result = oe_sgx_delete_enclave(enclave);
-
-#if defined(_WIN32)
-
-        /* Release Windows events created during enclave creation */
-        for (size_t i = 0; i < enclave->num_bindings; i++)
-        {
-            ThreadBinding* binding = &enclave->bindings[i];
-            CloseHandle(binding->event.handle);
-        }
-
-#endif
-
-        /* Free the path name of the enclave image file */
-        free(enclave->path);
+        result = _release_enclave(enclave);
     }
     /* Release and destroy the mutex object */
     oe_mutex_unlock(&enclave->lock);
@@ -0,0 +1,357 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "deadline.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <time.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+#include <openenclave/internal/raise.h>
+#include "../hostthread.h"
+
+/*
+**==============================================================================
+**
+** Platform primitives:
+**
+**     The watchdog sleeps on a condition variable until the earliest armed
+**     deadline, measured on a monotonic clock in milliseconds.
+**
+**==============================================================================
+*/
+
+#if defined(__linux__)
+
+typedef pthread_mutex_t _lock_t;
+typedef pthread_cond_t _cond_t;
+#define _LOCK_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+
+static bool _init_cond(_cond_t* cond)
+{
+    pthread_condattr_t attr;
+    bool initialized;
+
+    if (pthread_condattr_init(&attr) != 0)
+        return false;
+
+    initialized = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0 &&
+                  pthread_cond_init(cond, &attr) == 0;
+    pthread_condattr_destroy(&attr);
+
+    return initialized;
+}
+
+static uint64_t _now(void)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void _lock(_lock_t* lock)
+{
+    pthread_mutex_lock(lock);
+}
+
+static void _unlock(_lock_t* lock)
+{
+    pthread_mutex_unlock(lock);
+}
+
+/* Waits until signalled or until the given time, if not zero */
+static void _wait(_cond_t* cond, _lock_t* lock, uint64_t until)
+{
+    struct timespec ts;
+
+    if (!until)
+    {
+        pthread_cond_wait(cond, lock);
+        return;
+    }
+
+    ts.tv_sec = (time_t)(until / 1000);
+    ts.tv_nsec = (long)((until % 1000) * 1000000);
+    pthread_cond_timedwait(cond, lock, &ts);
+}
+
+static void _signal(_cond_t* cond)
+{
+    pthread_cond_signal(cond);
+}
+
+#elif defined(_WIN32)
+
+typedef SRWLOCK _lock_t;
+typedef CONDITION_VARIABLE _cond_t;
+#define _LOCK_INITIALIZER SRWLOCK_INIT
+
+static bool _init_cond(_cond_t* cond)
+{
+    InitializeConditionVariable(cond);
+    return true;
+}
+
+static uint64_t _now(void)
+{
+    return GetTickCount64();
+}
+
+static void _lock(_lock_t* lock)
+{
+    AcquireSRWLockExclusive(lock);
+}
+
+static void _unlock(_lock_t* lock)
+{
+    ReleaseSRWLockExclusive(lock);
+}
+
+/* Waits until signalled or until the given time, if not zero */
+static void _wait(_cond_t* cond, _lock_t* lock, uint64_t until)
+{
+    DWORD timeout = INFINITE;
+
+    if (until)
+    {
+        uint64_t now = _now();
+        timeout = until > now ? (DWORD)(until - now) : 0;
+    }
+
+    SleepConditionVariableSRW(cond, lock, timeout, 0);
+}
+
+static void _signal(_cond_t* cond)
+{
+    WakeConditionVariable(cond);
+}
+
+#endif
+
+/*
+**==============================================================================
+**
+** Watchdog:
+**
+**==============================================================================
+*/
+
+static _lock_t _watchdog_lock = _LOCK_INITIALIZER;
+static _cond_t _armed;
+static oe_once_type _watchdog_once;
+static bool _armed_initialized;
+
+/* Whether the watchdog was started in this process, and whether it is being
+ * stopped by oe_deadline_shutdown() */
+static bool _watchdog_started;
+static bool _watchdog_stopping;
+
+#if defined(__linux__)
+static pthread_t _watchdog_thread;
+#elif defined(_WIN32)
+static HANDLE _watchdog_thread;
+#endif
+
+/* Armed deadlines that have not expired yet */
+static oe_deadline_t* _deadlines;
+
+static void _watch(void)
+{
+    _lock(&_watchdog_lock);
+
+    /* Deadlines still armed are watched again once the watchdog restarts */
+    while (!_watchdog_stopping)
+    {
+        oe_deadline_t** p = &_deadlines;
+        uint64_t now = _now();
+        uint64_t earliest = 0;
+
+        /* Expire the deadlines that passed and find the next one */
+        while (*p)
+        {
+            oe_deadline_t* deadline = *p;
+
+            if (deadline->time <= now)
+            {
+                deadline->expired = 1;
+                *p = deadline->next;
+                deadline->next = NULL;
+                continue;
+            }
+
+            if (!earliest || deadline->time < earliest)
+                earliest = deadline->time;
+
+            p = &deadline->next;
+        }
+
+        _wait(&_armed, &_watchdog_lock, earliest);
+    }
+
+    _unlock(&_watchdog_lock);
+}
+
+#if defined(__linux__)
+
+static void* _watchdog(void* arg)
+{
+    OE_UNUSED(arg);
+    _watch();
+    return NULL;
+}
+
+static bool _start_thread(void)
+{
+    return pthread_create(&_watchdog_thread, NULL, _watchdog, NULL) == 0;
+}
+
+static void _join_thread(void)
+{
+    pthread_join(_watchdog_thread, NULL);
+}
+
+/* The forking thread holds the lock across fork(), so that the child gets
+ * a consistent list of deadlines */
+static void _before_fork(void)
+{
+    _lock(&_watchdog_lock);
+}
+
+static void _after_fork_in_parent(void)
+{
+    _unlock(&_watchdog_lock);
+}
+
+/* The child has no watchdog, so it starts its own when it next arms a
+ * deadline */
+static void _after_fork_in_child(void)
+{
+    _watchdog_started = false;
+    _watchdog_stopping = false;
+    _armed_initialized = _init_cond(&_armed);
+    _unlock(&_watchdog_lock);
+}
+
+/* Stop the watchdog before liboehost is unloaded or the process exits */
+__attribute__((destructor)) static void _shutdown_at_unload(void)
+{
+    oe_deadline_shutdown();
+}
+
+#elif defined(_WIN32)
+
+static DWORD WINAPI _watchdog(LPVOID arg)
+{
+    OE_UNUSED(arg);
+    _watch();
+    return 0;
+}
+
+static bool _start_thread(void)
+{
+    _watchdog_thread = CreateThread(NULL, 0, _watchdog, NULL, 0, NULL);
+    return _watchdog_thread != NULL;
+}
+
+static void _join_thread(void)
+{
+    WaitForSingleObject(_watchdog_thread, INFINITE);
+    CloseHandle(_watchdog_thread);
+}
+
+#endif
+
+static void _initialize(void)
+{
+    _armed_initialized = _init_cond(&_armed);
+
+#if defined(__linux__)
+    pthread_atfork(_before_fork, _after_fork_in_parent, _after_fork_in_child);
+#endif
+}
+
+/*
+**==============================================================================
+**
+** Public interface:
+**
+**==============================================================================
+*/
+
+oe_result_t oe_deadline_start(oe_deadline_t* deadline, uint64_t timeout_ms)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!deadline || !timeout_ms)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_once(&_watchdog_once, _initialize);
+
+    deadline->expired = 0;
+    deadline->time = _now() + timeout_ms;
+
+    _lock(&_watchdog_lock);
+
+    if (!_watchdog_started && !_watchdog_stopping)
+        _watchdog_started = _armed_initialized && _start_thread();
+
+    if (!_watchdog_started || _watchdog_stopping)
+    {
+        _unlock(&_watchdog_lock);
+        OE_RAISE_MSG(OE_FAILURE, "cannot start the deadline watchdog", NULL);
+    }
+
+    deadline->next = _deadlines;
+    _deadlines = deadline;
+    _signal(&_armed);
+    _unlock(&_watchdog_lock);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_deadline_stop(oe_deadline_t* deadline)
+{
+    _lock(&_watchdog_lock);
+
+    for (oe_deadline_t** p = &_deadlines; *p; p = &(*p)->next)
+    {
+        if (*p == deadline)
+        {
+            *p = deadline->next;
+            break;
+        }
+    }
+
+    _unlock(&_watchdog_lock);
+}
+
+void oe_deadline_shutdown(void)
+{
+    _lock(&_watchdog_lock);
+
+    if (!_watchdog_started || _watchdog_stopping)
+    {
+        _unlock(&_watchdog_lock);
+        return;
+    }
+
+    _watchdog_stopping = true;
+    _signal(&_armed);
+    _unlock(&_watchdog_lock);
+
+    _join_thread();
+
+    _lock(&_watchdog_lock);
+    _watchdog_started = false;
+    _watchdog_stopping = false;
+    _unlock(&_watchdog_lock);
+}
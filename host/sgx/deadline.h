@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_DEADLINE_H
+#define _OE_HOST_DEADLINE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** oe_deadline_t
+**
+**     A deadline whose expired field is set by a watchdog thread once the
+**     deadline passes. The enclave polls the field through the address
+**     passed in oe_call_enclave_function_args_t.expired.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_deadline
+{
+    volatile uint32_t expired;
+
+    /* Private fields */
+    uint64_t time;
+    struct _oe_deadline* next;
+} oe_deadline_t;
+
+/* Arms the deadline to expire timeout_ms milliseconds from now */
+oe_result_t oe_deadline_start(oe_deadline_t* deadline, uint64_t timeout_ms);
+
+/* Disarms the deadline, after which it is no longer referenced */
+void oe_deadline_stop(oe_deadline_t* deadline);
+
+/* Stops and joins the watchdog, which the next oe_deadline_start() starts
+ * again. On Linux this runs when liboehost is unloaded or the process exits,
+ * and a child process created by fork() starts its own watchdog */
+void oe_deadline_shutdown(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_DEADLINE_H */
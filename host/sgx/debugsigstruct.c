@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "debugsigstruct.h"
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/sgxsign.h>
+#include <string.h>
+#include "../persistentcache.h"
+#include "../signkey.h"
+
+#define DEBUG_SIGSTRUCT_FILE_MAGIC 0x484341435344454fULL /* "OEDSCACH" */
+
+typedef struct _debug_sigstruct_key
+{
+    uint8_t mrenclave[OE_SHA256_SIZE];
+    uint64_t attributes;
+    uint16_t product_id;
+    uint16_t security_version;
+    uint32_t reserved;
+} debug_sigstruct_key_t;
+
+static oe_persistent_cache_t _cache = OE_PERSISTENT_CACHE_INITIALIZER(
+    OE_DEBUG_SIGSTRUCT_CACHE_ENV,
+    DEBUG_SIGSTRUCT_FILE_MAGIC,
+    sizeof(debug_sigstruct_key_t),
+    sizeof(sgx_sigstruct_t),
+    OE_DEBUG_SIGSTRUCT_CACHE_SIZE);
+
+/* Guards against a persisted file that does not match its keys */
+static bool _sigstruct_matches(
+    const sgx_sigstruct_t* sigstruct,
+    const debug_sigstruct_key_t* key)
+{
+    return memcmp(
+               sigstruct->header,
+               SGX_SIGSTRUCT_HEADER,
+               sizeof(SGX_SIGSTRUCT_HEADER)) == 0 &&
+           memcmp(
+               sigstruct->enclavehash,
+               key->mrenclave,
+               sizeof(key->mrenclave)) == 0 &&
+           sigstruct->attributes.flags == key->attributes &&
+           sigstruct->isvprodid == key->product_id &&
+           sigstruct->isvsvn == key->security_version;
+}
+
+oe_result_t oe_sgx_get_debug_sigstruct(
+    const OE_SHA256* mrenclave,
+    uint64_t attributes,
+    uint16_t product_id,
+    uint16_t security_version,
+    sgx_sigstruct_t* sigstruct,
+    bool* cached)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    debug_sigstruct_key_t key;
+    bool locked = false;
+
+    if (cached)
+        *cached = false;
+
+    if (!mrenclave || !sigstruct)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memset(&key, 0, sizeof(key));
+    memcpy(key.mrenclave, mrenclave->buf, sizeof(key.mrenclave));
+    key.attributes = attributes;
+    key.product_id = product_id;
+    key.security_version = security_version;
+
+    oe_persistent_cache_lock(&_cache);
+    locked = true;
+
+    if (oe_persistent_cache_get(&_cache, &key, sigstruct) &&
+        _sigstruct_matches(sigstruct, &key))
+    {
+        if (cached)
+            *cached = true;
+
+        result = OE_OK;
+        goto done;
+    }
+
+    /* The lock is held across the signature so that concurrent creations of
+     * the same enclave sign it only once */
+    OE_CHECK(oe_sgx_sign_enclave(
+        mrenclave,
+        attributes,
+        product_id,
+        security_version,
+        OE_DEBUG_SIGN_KEY,
+        OE_DEBUG_SIGN_KEY_SIZE,
+        sigstruct));
+
+    oe_persistent_cache_put(&_cache, &key, sigstruct);
+
+    result = OE_OK;
+
+done:
+
+    if (locked)
+        oe_persistent_cache_unlock(&_cache);
+
+    return result;
+}
+
+void oe_sgx_clear_debug_sigstruct_cache(void)
+{
+    oe_persistent_cache_clear(&_cache);
+}
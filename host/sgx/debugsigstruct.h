@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_DEBUGSIGSTRUCT_H
+#define _OE_HOST_DEBUGSIGSTRUCT_H
+
+#include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/sha.h>
+
+OE_EXTERNC_BEGIN
+
+/* Number of debug SIGSTRUCTs kept per process */
+#define OE_DEBUG_SIGSTRUCT_CACHE_SIZE 64
+
+/* Names a file where the debug SIGSTRUCT cache persists across processes */
+#define OE_DEBUG_SIGSTRUCT_CACHE_ENV "OE_DEBUG_SIGSTRUCT_CACHE"
+
+/*
+**==============================================================================
+**
+** oe_sgx_get_debug_sigstruct()
+**
+**     Gets the SIGSTRUCT of an unsigned enclave, signed with the well-known
+**     debug key. Generated SIGSTRUCTs are cached per process, keyed by
+**     MRENCLAVE and the other signed properties, so that repeated creations
+**     of the same enclave skip the RSA-3072 signature. When
+**     OE_DEBUG_SIGSTRUCT_CACHE_ENV names a file, the cache is loaded from it
+**     on first use and written back whenever a SIGSTRUCT is generated.
+**
+**     The optional cached parameter is set to whether the SIGSTRUCT came from
+**     the cache.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_get_debug_sigstruct(
+    const OE_SHA256* mrenclave,
+    uint64_t attributes,
+    uint16_t product_id,
+    uint16_t security_version,
+    sgx_sigstruct_t* sigstruct,
+    bool* cached);
+
+/*
+**==============================================================================
+**
+** oe_sgx_clear_debug_sigstruct_cache()
+**
+**     Drops the in-memory SIGSTRUCTs. The persisted file, if any, is not
+**     modified and is loaded again on the next use.
+**
+**==============================================================================
+*/
+
+void oe_sgx_clear_debug_sigstruct_cache(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_DEBUGSIGSTRUCT_H */
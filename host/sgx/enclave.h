@@ -12,6 +12,7 @@
 #include <stdbool.h>
 #include "../hostthread.h"
 #include "asmdefs.h"
+#include "sharedpages.h"
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -82,6 +83,13 @@ OE_STATIC_ASSERT(OE_OFFSETOF(ThreadBinding, tcs) == ThreadBinding_tcs);
 /* Get thread data from thread-specific data (TSD) */
 ThreadBinding* GetThreadBinding(void);
 
+/* Assigns an enclave function to a TCS pool (see oe_sgx_tcs_pool_t) */
+typedef struct _oe_sgx_ecall_pool
+{
+    uint32_t function_id;
+    uint8_t pool;
+} oe_sgx_ecall_pool_t;
+
 /**
  *  This structure must be kept in sync with the defines in
  *  debugger/pythonExtension/gdb_sgx_plugin.py.
@@ -120,6 +128,31 @@ struct _oe_enclave
 
     /* Simulation mode */
     bool simulate;
+
+    /* Number of pages of each TCS stack */
+    size_t num_stack_pages;
+
+    /* Read-only segments mapped from pages shared with other simulated
+     * instances of the same image */
+    oe_sgx_shared_pages_t* shared_pages[OE_SGX_MAX_SHARED_SEGMENTS];
+    size_t num_shared_pages;
+
+    /* TCS pool of each binding: zero if no pool reserved the binding, else
+     * one plus the index of the oe_sgx_tcs_pool_t that reserved it */
+    uint8_t tcs_pools[OE_SGX_MAX_TCS];
+
+    /* TCS pool of each enclave function listed in a oe_sgx_tcs_pool_t */
+    oe_sgx_ecall_pool_t* ecall_pools;
+    size_t num_ecall_pools;
+
+    /* Host memory that a simulated enclave obtained through OCALLs, which
+     * its snapshots must keep alive, as a hash set (see snapshot.c) */
+    void** host_allocations;
+    size_t num_host_allocations;
+    size_t host_allocations_capacity;
+
+    /* The snapshot this enclave is a clone of, if any */
+    oe_enclave_snapshot_t* snapshot;
 };
 
 // Static asserts for consistency with
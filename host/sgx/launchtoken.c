@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "launchtoken.h"
+#include <openenclave/host.h>
+#include <openenclave/internal/aesm.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/sha.h>
+#include <string.h>
+#include "../persistentcache.h"
+
+#define LAUNCH_TOKEN_FILE_MAGIC 0x48434143544c454fULL /* "OELTCACH" */
+
+typedef struct _launch_token_key
+{
+    uint8_t mrenclave[OE_SHA256_SIZE];
+    uint8_t mrsigner[OE_SHA256_SIZE];
+    sgx_attributes_t attributes;
+} launch_token_key_t;
+
+static oe_persistent_cache_t _cache = OE_PERSISTENT_CACHE_INITIALIZER(
+    OE_LAUNCH_TOKEN_CACHE_ENV,
+    LAUNCH_TOKEN_FILE_MAGIC,
+    sizeof(launch_token_key_t),
+    sizeof(sgx_launch_token_t),
+    OE_LAUNCH_TOKEN_CACHE_SIZE);
+
+static oe_result_t _make_key(
+    const sgx_sigstruct_t* sigstruct,
+    const sgx_attributes_t* attributes,
+    launch_token_key_t* key)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+    OE_SHA256 mrsigner;
+
+    memset(key, 0, sizeof(*key));
+    memcpy(key->mrenclave, sigstruct->enclavehash, sizeof(key->mrenclave));
+    key->attributes = *attributes;
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(
+        &context, sigstruct->modulus, sizeof(sigstruct->modulus)));
+    OE_CHECK(oe_sha256_final(&context, &mrsigner));
+    memcpy(key->mrsigner, mrsigner.buf, sizeof(key->mrsigner));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static oe_result_t _get_launch_token_from_aesm(
+    const sgx_sigstruct_t* sigstruct,
+    const sgx_attributes_t* attributes,
+    sgx_launch_token_t* launch_token)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    aesm_t* aesm = NULL;
+
+    if (!(aesm = aesm_connect()))
+        OE_RAISE(OE_FAILURE);
+
+    OE_CHECK(aesm_get_launch_token(
+        aesm,
+        (uint8_t*)sigstruct->enclavehash,
+        (uint8_t*)sigstruct->modulus,
+        attributes,
+        launch_token));
+
+    result = OE_OK;
+
+done:
+
+    if (aesm)
+        aesm_disconnect(aesm);
+
+    return result;
+}
+
+oe_result_t oe_sgx_get_launch_token(
+    const sgx_sigstruct_t* sigstruct,
+    const sgx_attributes_t* attributes,
+    bool refresh,
+    sgx_launch_token_t* launch_token,
+    bool* cached)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    launch_token_key_t key;
+    bool locked = false;
+
+    if (cached)
+        *cached = false;
+
+    if (!sigstruct || !attributes || !launch_token)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memset(launch_token, 0, sizeof(sgx_launch_token_t));
+    OE_CHECK(_make_key(sigstruct, attributes, &key));
+
+    oe_persistent_cache_lock(&_cache);
+    locked = true;
+
+    if (refresh)
+    {
+        /* Never hand out a token that was rejected, even if AESM fails */
+        oe_persistent_cache_remove(&_cache, &key);
+    }
+    else if (oe_persistent_cache_get(&_cache, &key, launch_token))
+    {
+        if (cached)
+            *cached = true;
+
+        result = OE_OK;
+        goto done;
+    }
+
+    /* The lock is held across the request so that concurrent creations of
+     * the same enclave do not each ask the AESM service for a token */
+    OE_CHECK(_get_launch_token_from_aesm(sigstruct, attributes, launch_token));
+    oe_persistent_cache_put(&_cache, &key, launch_token);
+
+    result = OE_OK;
+
+done:
+
+    if (locked)
+        oe_persistent_cache_unlock(&_cache);
+
+    return result;
+}
+
+void oe_sgx_clear_launch_token_cache(void)
+{
+    oe_persistent_cache_clear(&_cache);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_LAUNCHTOKEN_H
+#define _OE_HOST_LAUNCHTOKEN_H
+
+#include <openenclave/internal/sgxtypes.h>
+
+OE_EXTERNC_BEGIN
+
+/* Number of launch tokens kept per process */
+#define OE_LAUNCH_TOKEN_CACHE_SIZE 64
+
+/* Names a file where the launch token cache persists across processes */
+#define OE_LAUNCH_TOKEN_CACHE_ENV "OE_LAUNCH_TOKEN_CACHE"
+
+/*
+**==============================================================================
+**
+** oe_sgx_get_launch_token()
+**
+**     Gets a launch token for the enclave signed by the given SIGSTRUCT.
+**     Tokens are cached per process, keyed by MRENCLAVE, MRSIGNER and the
+**     attributes, so that the AESM service is asked only once per enclave.
+**     When OE_LAUNCH_TOKEN_CACHE_ENV names a file, the cache is loaded from
+**     it on first use and written back whenever a new token is obtained.
+**
+**     If refresh is true, the cached token is ignored and replaced by a new
+**     one, e.g. after EINIT rejected it. The optional cached parameter is set
+**     to whether the token came from the cache.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_get_launch_token(
+    const sgx_sigstruct_t* sigstruct,
+    const sgx_attributes_t* attributes,
+    bool refresh,
+    sgx_launch_token_t* launch_token,
+    bool* cached);
+
+/*
+**==============================================================================
+**
+** oe_sgx_clear_launch_token_cache()
+**
+**     Drops the in-memory launch tokens. The persisted file, if any, is not
+**     modified and is loaded again on the next use.
+**
+**==============================================================================
+*/
+
+void oe_sgx_clear_launch_token_cache(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_LAUNCHTOKEN_H */
@@ -9,6 +9,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
+#include <stdlib.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
@@ -34,6 +35,9 @@
 
 #define AESM_SOCKET "/var/run/aesmd/aesm.socket"
 
+/* Overrides AESM_SOCKET, e.g. to talk to a stand-in service in tests */
+#define AESM_SOCKET_ENV "OE_AESM_SOCKET"
+
 typedef enum _wire_type
 {
     WIRE_TYPE_VARINT = 0,
@@ -431,6 +435,10 @@ aesm_t* aesm_connect()
     int sock = -1;
     struct sockaddr_un addr;
     aesm_t* aesm = NULL;
+    const char* path = getenv(AESM_SOCKET_ENV);
+
+    if (!path || !*path)
+        path = AESM_SOCKET;
 
     /* Create a socket for connecting to the AESM service */
     if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
@@ -439,8 +447,12 @@ aesm_t* aesm_connect()
     /* Initialize the address */
     memset(&addr, 0, sizeof(struct sockaddr_un));
     addr.sun_family = AF_UNIX;
-    oe_strncpy_s(
-        addr.sun_path, sizeof(addr.sun_path), AESM_SOCKET, strlen(AESM_SOCKET));
+    if (oe_strncpy_s(
+            addr.sun_path, sizeof(addr.sun_path), path, strlen(path)) != OE_OK)
+    {
+        close(sock);
+        goto done;
+    }
 
     /* Connect to the AESM service */
     if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) != 0)
@@ -3,6 +3,7 @@
 
 #include <dlfcn.h>
 #include <openenclave/bits/safecrt.h>
+#include <openenclave/internal/cert.h>
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/report.h>
@@ -184,7 +185,8 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
     {
         OE_RAISE_MSG(OE_INVALID_REVOCATION_INFO, "tcb_issuer_chain is NULL");
     }
-    host_buffer_size += revocation_info->tcb_issuer_chain_size + 1;
+    // Issuer chains are passed on as DER, which is never larger than the PEM.
+    host_buffer_size += revocation_info->tcb_issuer_chain_size;
 
     if (revocation_info->crl_count != args->num_crl_urls)
     {
@@ -216,7 +218,7 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
                 "crl[%d].crl_issuer_chain is NULL.",
                 i);
         }
-        host_buffer_size += revocation_info->crls[i].crl_issuer_chain_size + 1;
+        host_buffer_size += revocation_info->crls[i].crl_issuer_chain_size;
     }
 
     p = (uint8_t*)calloc(1, host_buffer_size);
@@ -245,14 +247,13 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
     if (revocation_info->tcb_issuer_chain != NULL)
     {
         args->tcb_issuer_chain = p;
-        args->tcb_issuer_chain_size = revocation_info->tcb_issuer_chain_size;
-        OE_CHECK(oe_memcpy_s(
-            args->tcb_issuer_chain,
-            args->tcb_issuer_chain_size,
+        args->tcb_issuer_chain_size = (size_t)(p_end - p);
+        // Decode the PEM once here so that verifiers can read DER directly.
+        OE_CHECK(oe_cert_chain_pem_to_der(
             revocation_info->tcb_issuer_chain,
-            revocation_info->tcb_issuer_chain_size));
-        // Add null terminator
-        args->tcb_issuer_chain[args->tcb_issuer_chain_size++] = 0;
+            revocation_info->tcb_issuer_chain_size,
+            args->tcb_issuer_chain,
+            &args->tcb_issuer_chain_size));
         p += args->tcb_issuer_chain_size;
         OE_TRACE_INFO(
             "tcb_issuer_chain_size = %d\n",
@@ -280,15 +281,12 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
         if (revocation_info->crls[i].crl_issuer_chain != NULL)
         {
             args->crl_issuer_chain[i] = p;
-            args->crl_issuer_chain_size[i] =
-                revocation_info->crls[i].crl_issuer_chain_size;
-            OE_CHECK(oe_memcpy_s(
-                args->crl_issuer_chain[i],
-                args->crl_issuer_chain_size[i],
+            args->crl_issuer_chain_size[i] = (size_t)(p_end - p);
+            OE_CHECK(oe_cert_chain_pem_to_der(
                 revocation_info->crls[i].crl_issuer_chain,
-                revocation_info->crls[i].crl_issuer_chain_size));
-            // Add null terminator
-            args->crl_issuer_chain[i][args->crl_issuer_chain_size[i]++] = 0;
+                revocation_info->crls[i].crl_issuer_chain_size,
+                args->crl_issuer_chain[i],
+                &args->crl_issuer_chain_size[i]));
             p += args->crl_issuer_chain_size[i];
             OE_TRACE_INFO(
                 "crls[%d].crl_issuer_chain_size = %d\n",
@@ -303,7 +301,7 @@ oe_result_t oe_get_revocation_info(oe_get_revocation_info_args_t* args)
         }
     }
 
-    if (p != p_end)
+    if (p > p_end)
         OE_RAISE(OE_UNEXPECTED);
 
     result = OE_OK;
@@ -362,7 +360,8 @@ oe_result_t oe_get_qe_identity_info(oe_get_qe_identity_info_args_t* args)
     if (identity->issuer_chain == NULL || identity->issuer_chain_size == 0)
         OE_RAISE_MSG(OE_INVALID_QE_IDENTITY_INFO, "issuer_chain is NULL");
 
-    host_buffer_size += identity->issuer_chain_size + 1;
+    // The issuer chain is passed on as DER, which is never larger than the PEM.
+    host_buffer_size += identity->issuer_chain_size;
     p = (uint8_t*)calloc(1, host_buffer_size);
     p_end = p + host_buffer_size;
     if (p == NULL)
@@ -389,19 +388,17 @@ oe_result_t oe_get_qe_identity_info(oe_get_qe_identity_info_args_t* args)
     if (identity->issuer_chain != NULL)
     {
         args->issuer_chain = p;
-        args->issuer_chain_size = identity->issuer_chain_size;
-        OE_CHECK(oe_memcpy_s(
-            args->issuer_chain,
-            args->issuer_chain_size,
+        args->issuer_chain_size = (size_t)(p_end - p);
+        OE_CHECK(oe_cert_chain_pem_to_der(
             identity->issuer_chain,
-            identity->issuer_chain_size));
-        // Add null terminator
-        args->issuer_chain[args->issuer_chain_size++] = 0;
+            identity->issuer_chain_size,
+            args->issuer_chain,
+            &args->issuer_chain_size));
         p += args->issuer_chain_size;
         OE_TRACE_INFO("issuer_chain_size = %ld\n", args->issuer_chain_size);
     }
 
-    if (p != p_end)
+    if (p > p_end)
         OE_RAISE(OE_UNEXPECTED);
 
     result = OE_OK;
@@ -13,6 +13,7 @@
 #include <openenclave/internal/mem.h>
 #include <openenclave/internal/properties.h>
 #include <openenclave/internal/raise.h>
+#include <openenclave/internal/reloc.h>
 #include <openenclave/internal/sgxcreate.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/trace.h>
@@ -422,6 +423,166 @@ static oe_result_t _unload(oe_enclave_image_t* image)
     return _free_elf_image(image);
 }
 
+static int _compare_offsets(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Encode sorted, unique, 8-byte aligned offsets as RELR words */
+static size_t _encode_relr(const uint64_t* offsets, size_t n, uint64_t* relr)
+{
+    const uint64_t span = OE_RELR_BITMAP_WORDS * sizeof(uint64_t);
+    size_t nrelr = 0;
+    size_t i = 0;
+
+    while (i < n)
+    {
+        uint64_t where = offsets[i] + sizeof(uint64_t);
+
+        relr[nrelr++] = offsets[i++];
+
+        for (;;)
+        {
+            uint64_t bitmap = 0;
+
+            for (; i < n && offsets[i] - where < span; i++)
+                bitmap |= 1ULL << ((offsets[i] - where) / sizeof(uint64_t));
+
+            if (!bitmap)
+                break;
+
+            relr[nrelr++] = (bitmap << 1) | 1;
+            where += span;
+        }
+    }
+
+    return nrelr;
+}
+
+/*
+** Rewrite the relocation pages in the compact format (see reloc.h). The
+** addend of each aligned R_X86_64_RELATIVE relocation is stored in the image
+** so that the enclave only has to add its base address, which lets it apply
+** thousands of relocations with a few RELR words.
+*/
+static oe_result_t _compact_relocations(oe_enclave_image_t* image)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const elf64_rela_t* relocs = (const elf64_rela_t*)image->u.elf.reloc_data;
+    size_t max_relocs = image->reloc_size / sizeof(elf64_rela_t);
+    size_t nrelocs = 0;
+    uint64_t* offsets = NULL;
+    size_t noffsets = 0;
+    elf64_rela_t* rela = NULL;
+    size_t nrela = 0;
+    uint64_t* relr = NULL;
+    size_t nrelr;
+    oe_compact_reloc_header_t header;
+    uint8_t* data = NULL;
+    size_t size;
+
+    while (nrelocs < max_relocs && relocs[nrelocs].r_offset != 0)
+        nrelocs++;
+
+    if (nrelocs == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    if (!(offsets = (uint64_t*)malloc(nrelocs * sizeof(uint64_t))) ||
+        !(rela = (elf64_rela_t*)malloc(nrelocs * sizeof(elf64_rela_t))) ||
+        !(relr = (uint64_t*)malloc(nrelocs * sizeof(uint64_t))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    /* Store the addends in the image (in table order, so the last one wins
+     * for duplicate offsets) and split off the relocations RELR cannot
+     * express */
+    for (size_t i = 0; i < nrelocs; i++)
+    {
+        const elf64_rela_t* p = &relocs[i];
+        uint64_t addend = (uint64_t)p->r_addend;
+
+        if (ELF64_R_TYPE(p->r_info) == R_X86_64_RELATIVE &&
+            p->r_offset % sizeof(uint64_t) == 0 &&
+            p->r_offset <= image->image_size - sizeof(uint64_t))
+        {
+            OE_CHECK(oe_memcpy_s(
+                image->image_base + p->r_offset,
+                sizeof(uint64_t),
+                &addend,
+                sizeof(addend)));
+            offsets[noffsets++] = p->r_offset;
+        }
+        else
+        {
+            rela[nrela++] = *p;
+        }
+    }
+
+    /* Sort and remove duplicate offsets */
+    qsort(offsets, noffsets, sizeof(uint64_t), _compare_offsets);
+    {
+        size_t n = 0;
+
+        for (size_t i = 0; i < noffsets; i++)
+        {
+            if (n == 0 || offsets[n - 1] != offsets[i])
+                offsets[n++] = offsets[i];
+        }
+
+        noffsets = n;
+    }
+
+    nrelr = _encode_relr(offsets, noffsets, relr);
+
+    /* Build the new relocation pages (zero-padded to page size) */
+    size = sizeof(header) + nrelr * sizeof(uint64_t) +
+           nrela * sizeof(elf64_rela_t);
+    size = oe_round_up_to_page_size(size);
+
+    if (!(data = (uint8_t*)calloc(1, size)))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = OE_COMPACT_RELOC_MAGIC;
+    header.num_relr = nrelr;
+    header.num_rela = nrela;
+
+    memcpy(data, &header, sizeof(header));
+    memcpy(data + sizeof(header), relr, nrelr * sizeof(uint64_t));
+    memcpy(
+        data + sizeof(header) + nrelr * sizeof(uint64_t),
+        rela,
+        nrela * sizeof(elf64_rela_t));
+
+    OE_TRACE_INFO(
+        "Compacted %zu relocations (%zu bytes) into %zu RELR words and %zu "
+        "other relocations (%zu bytes)\n",
+        nrelocs,
+        image->reloc_size,
+        nrelr,
+        nrela,
+        size);
+
+    free(image->u.elf.reloc_data);
+    image->u.elf.reloc_data = data;
+    image->reloc_size = size;
+    data = NULL;
+
+    result = OE_OK;
+
+done:
+    free(offsets);
+    free(rela);
+    free(relr);
+    free(data);
+    return result;
+}
+
 // ------------------------------------------------------------------
 
 /*
@@ -515,7 +676,7 @@ done:
 
 static oe_result_t _add_segment_pages(
     oe_sgx_load_context_t* context,
-    uint64_t enclave_addr,
+    oe_enclave_t* enclave,
     const oe_elf_segment_t* segment,
     void* image)
 {
@@ -525,6 +686,7 @@ static oe_result_t _add_segment_pages(
     uint64_t segment_end;
 
     assert(context);
+    assert(enclave);
     assert(segment);
     assert(image);
 
@@ -542,16 +704,16 @@ static oe_result_t _add_segment_pages(
 
     flags |= SGX_SECINFO_REG;
 
-    for (; page_rva < segment_end; page_rva += OE_PAGE_SIZE)
-    {
-        OE_CHECK(oe_sgx_load_enclave_data(
-            context,
-            enclave_addr,
-            enclave_addr + page_rva,
-            (uint64_t)image + page_rva,
-            flags,
-            true));
-    }
+    /* Load the segment pages as one run so that read-only segments can be
+     * shared between simulated instances of this image */
+    OE_CHECK(oe_sgx_load_enclave_shared_data(
+        context,
+        enclave,
+        enclave->addr,
+        enclave->addr + page_rva,
+        (uint64_t)image + page_rva,
+        oe_round_up_to_page_size(segment_end) - page_rva,
+        flags));
 
     result = OE_OK;
 
@@ -580,10 +742,7 @@ static oe_result_t _add_pages(
     for (i = 0; i < image->u.elf.num_segments; i++)
     {
         OE_CHECK(_add_segment_pages(
-            context,
-            enclave->addr,
-            &image->u.elf.segments[i],
-            image->image_base));
+            context, enclave, &image->u.elf.segments[i], image->image_base));
     }
 
     *vaddr = image->image_size;
@@ -796,6 +955,7 @@ oe_result_t oe_load_elf_enclave_image(
     image->calculate_size = _calculate_size;
     image->add_pages = _add_pages;
     image->patch = _patch;
+    image->compact_relocations = _compact_relocations;
     image->sgx_load_enclave_properties = _sgx_load_enclave_properties;
     image->sgx_update_enclave_properties = _sgx_update_enclave_properties;
     image->unload = _unload;
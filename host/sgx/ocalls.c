@@ -28,6 +28,7 @@
 #include "enclave.h"
 #include "ocalls.h"
 #include "quote.h"
+#include "quoteservice.h"
 #include "sgxquoteprovider.h"
 
 void HandleMalloc(uint64_t arg_in, uint64_t* arg_out)
@@ -52,16 +53,51 @@ void HandleFree(uint64_t arg)
     free((void*)arg);
 }
 
-void HandleThreadWait(oe_enclave_t* enclave, uint64_t arg_in)
+/* Returns a monotonic time in nanoseconds */
+static uint64_t _now_ns(void)
+{
+#if defined(__linux__)
+
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+
+#elif defined(_WIN32)
+
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+
+    /* Split the conversion so that it cannot overflow */
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 /
+               (uint64_t)frequency.QuadPart;
+
+#endif
+}
+
+/* Sets arg_out to how many nanoseconds the thread was parked, which the
+ * enclave may use to profile lock contention */
+void HandleThreadWait(oe_enclave_t* enclave, uint64_t arg_in, uint64_t* arg_out)
 {
     const uint64_t tcs = arg_in;
     EnclaveEvent* event = GetEnclaveEvent(enclave, tcs);
+    uint64_t start;
     assert(event);
 
 #if defined(__linux__)
 
     if (__sync_fetch_and_add(&event->value, (uint32_t)-1) == 0)
     {
+        start = _now_ns();
+
         do
         {
             syscall(
@@ -77,12 +113,19 @@ void HandleThreadWait(oe_enclave_t* enclave, uint64_t arg_in)
             // Since FUTEX_WAIT uses atomic instructions to load event->value,
             // it is safe to use a non-atomic operation here.
         } while (event->value == (uint32_t)-1);
+
+        if (arg_out)
+            *arg_out = _now_ns() - start;
     }
 
 #elif defined(_WIN32)
 
+    start = _now_ns();
     WaitForSingleObject(event->handle, INFINITE);
 
+    if (arg_out)
+        *arg_out = _now_ns() - start;
+
 #endif
 }
 
@@ -105,7 +148,10 @@ void HandleThreadWake(oe_enclave_t* enclave, uint64_t arg_in)
 #endif
 }
 
-void HandleThreadWakeWait(oe_enclave_t* enclave, uint64_t arg_in)
+void HandleThreadWakeWait(
+    oe_enclave_t* enclave,
+    uint64_t arg_in,
+    uint64_t* arg_out)
 {
     oe_thread_wake_wait_args_t* args = (oe_thread_wake_wait_args_t*)arg_in;
 
@@ -115,12 +161,12 @@ void HandleThreadWakeWait(oe_enclave_t* enclave, uint64_t arg_in)
 #if defined(__linux__)
 
     HandleThreadWake(enclave, (uint64_t)args->waiter_tcs);
-    HandleThreadWait(enclave, (uint64_t)args->self_tcs);
+    HandleThreadWait(enclave, (uint64_t)args->self_tcs, arg_out);
 
 #elif defined(_WIN32)
 
     HandleThreadWake(enclave, (uint64_t)args->waiter_tcs);
-    HandleThreadWait(enclave, (uint64_t)args->self_tcs);
+    HandleThreadWait(enclave, (uint64_t)args->self_tcs, arg_out);
 
 #endif
 }
@@ -131,8 +177,8 @@ void HandleGetQuote(uint64_t arg_in)
     if (!args)
         return;
 
-    args->result =
-        sgx_get_quote(&args->sgx_report, args->quote, &args->quote_size);
+    args->result = oe_quote_service_get_quote(
+        &args->sgx_report, args->quote, &args->quote_size);
 }
 
 #ifdef OE_USE_LIBSGX
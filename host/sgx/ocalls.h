@@ -10,9 +10,12 @@ void HandleMalloc(uint64_t arg_in, uint64_t* arg_out);
 void HandleRealloc(uint64_t arg_in, uint64_t* arg_out);
 void HandleFree(uint64_t arg);
 
-void HandleThreadWait(oe_enclave_t* enclave, uint64_t arg);
+void HandleThreadWait(oe_enclave_t* enclave, uint64_t arg, uint64_t* arg_out);
 void HandleThreadWake(oe_enclave_t* enclave, uint64_t arg);
-void HandleThreadWakeWait(oe_enclave_t* enclave, uint64_t arg_in);
+void HandleThreadWakeWait(
+    oe_enclave_t* enclave,
+    uint64_t arg_in,
+    uint64_t* arg_out);
 
 void HandleGetQuote(uint64_t arg_in);
 void HandleGetQETargetInfo(uint64_t arg_in);
@@ -0,0 +1,465 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "quoteservice.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include <string.h>
+#include "../hostthread.h"
+#include "quote.h"
+
+/*
+**==============================================================================
+**
+** Platform primitives:
+**
+**==============================================================================
+*/
+
+#if defined(__linux__)
+
+typedef pthread_mutex_t _lock_t;
+typedef pthread_cond_t _cond_t;
+#define _LOCK_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define _COND_INITIALIZER PTHREAD_COND_INITIALIZER
+
+static void _lock(_lock_t* lock)
+{
+    pthread_mutex_lock(lock);
+}
+
+static void _unlock(_lock_t* lock)
+{
+    pthread_mutex_unlock(lock);
+}
+
+static void _wait(_cond_t* cond, _lock_t* lock)
+{
+    pthread_cond_wait(cond, lock);
+}
+
+static void _signal(_cond_t* cond)
+{
+    pthread_cond_signal(cond);
+}
+
+static void _broadcast(_cond_t* cond)
+{
+    pthread_cond_broadcast(cond);
+}
+
+#elif defined(_WIN32)
+
+typedef SRWLOCK _lock_t;
+typedef CONDITION_VARIABLE _cond_t;
+#define _LOCK_INITIALIZER SRWLOCK_INIT
+#define _COND_INITIALIZER CONDITION_VARIABLE_INIT
+
+static void _lock(_lock_t* lock)
+{
+    AcquireSRWLockExclusive(lock);
+}
+
+static void _unlock(_lock_t* lock)
+{
+    ReleaseSRWLockExclusive(lock);
+}
+
+static void _wait(_cond_t* cond, _lock_t* lock)
+{
+    SleepConditionVariableSRW(cond, lock, INFINITE, 0);
+}
+
+static void _signal(_cond_t* cond)
+{
+    WakeConditionVariable(cond);
+}
+
+static void _broadcast(_cond_t* cond)
+{
+    WakeAllConditionVariable(cond);
+}
+
+#endif
+
+/*
+**==============================================================================
+**
+** Service state:
+**
+**==============================================================================
+*/
+
+typedef struct _quote_request
+{
+    const sgx_report_t* report;
+    uint8_t* quote;
+    size_t quote_size;
+    oe_result_t result;
+    bool done;
+
+    /* Next request in the queue */
+    struct _quote_request* next;
+
+    /* Identical requests that are answered with this request's result */
+    struct _quote_request* followers;
+} quote_request_t;
+
+static _lock_t _service_lock = _LOCK_INITIALIZER;
+
+/* Signalled when a request is queued */
+static _cond_t _queued = _COND_INITIALIZER;
+
+/* Signalled when a queue slot is freed */
+static _cond_t _dequeued = _COND_INITIALIZER;
+
+/* Broadcast when requests complete */
+static _cond_t _completed = _COND_INITIALIZER;
+
+static quote_request_t* _queue_head;
+static quote_request_t* _queue_tail;
+
+/* The request each worker is processing, if any */
+static quote_request_t* _running[OE_QUOTE_SERVICE_WORKERS];
+
+static oe_quote_provider_t _provider = sgx_get_quote;
+static oe_quote_service_stats_t _stats;
+
+/* Whether the workers were started in this process, and whether they are
+ * being stopped by oe_quote_service_shutdown() */
+static bool _started;
+static bool _stopping;
+
+#if defined(__linux__)
+static pthread_t _workers[OE_QUOTE_SERVICE_WORKERS];
+static oe_once_type _atfork_once = OE_H_ONCE_INITIALIZER;
+#elif defined(_WIN32)
+static HANDLE _workers[OE_QUOTE_SERVICE_WORKERS];
+#endif
+
+static size_t _num_workers;
+
+/* Whether a request can share the result of another one */
+static bool _is_identical(
+    const quote_request_t* request,
+    const quote_request_t* other)
+{
+    return request->quote_size == other->quote_size &&
+           (request->quote == NULL) == (other->quote == NULL) &&
+           memcmp(request->report, other->report, sizeof(sgx_report_t)) == 0;
+}
+
+/* Finds a queued or running request that the given one can follow */
+static quote_request_t* _find_identical(const quote_request_t* request)
+{
+    for (quote_request_t* p = _queue_head; p; p = p->next)
+    {
+        if (_is_identical(request, p))
+            return p;
+    }
+
+    for (size_t i = 0; i < OE_QUOTE_SERVICE_WORKERS; i++)
+    {
+        if (_running[i] && _is_identical(request, _running[i]))
+            return _running[i];
+    }
+
+    return NULL;
+}
+
+static void _complete(quote_request_t* request)
+{
+    for (quote_request_t* p = request->followers; p; p = p->followers)
+    {
+        /* Followers have the same buffer size so the result carries over */
+        if (request->result == OE_OK && request->quote)
+            memcpy(p->quote, request->quote, request->quote_size);
+
+        p->quote_size = request->quote_size;
+        p->result = request->result;
+        p->done = true;
+    }
+
+    request->done = true;
+}
+
+static void _process_requests(size_t index)
+{
+    _lock(&_service_lock);
+
+    for (;;)
+    {
+        quote_request_t* request;
+        oe_quote_provider_t provider;
+        size_t quote_size;
+        oe_result_t result;
+
+        while (!_queue_head && !_stopping)
+            _wait(&_queued, &_service_lock);
+
+        /* Requests queued before the shutdown are still served */
+        if (!_queue_head)
+            break;
+
+        request = _queue_head;
+        _queue_head = request->next;
+        if (!_queue_head)
+            _queue_tail = NULL;
+
+        _stats.queue_depth--;
+        _stats.busy_workers++;
+        _running[index] = request;
+        provider = _provider;
+        quote_size = request->quote_size;
+        _signal(&_dequeued);
+
+        /* Identical requests may attach to this one while it is running */
+        _unlock(&_service_lock);
+        result = provider(request->report, request->quote, &quote_size);
+        _lock(&_service_lock);
+
+        _running[index] = NULL;
+        _stats.busy_workers--;
+        _stats.completed++;
+
+        request->quote_size = quote_size;
+        request->result = result;
+        _complete(request);
+        _broadcast(&_completed);
+    }
+
+    _unlock(&_service_lock);
+}
+
+#if defined(__linux__)
+
+static void* _worker(void* arg)
+{
+    _process_requests((size_t)arg);
+    return NULL;
+}
+
+static bool _start_worker(size_t index)
+{
+    return pthread_create(&_workers[index], NULL, _worker, (void*)index) == 0;
+}
+
+static void _join_worker(size_t index)
+{
+    pthread_join(_workers[index], NULL);
+}
+
+/* The forking thread holds the lock across fork(), so that the child gets
+ * consistent state */
+static void _before_fork(void)
+{
+    _lock(&_service_lock);
+}
+
+static void _after_fork_in_parent(void)
+{
+    _unlock(&_service_lock);
+}
+
+/* The child has none of the workers, nor the threads whose requests were
+ * queued, so it starts over and creates its own workers on first use */
+static void _after_fork_in_child(void)
+{
+    _queue_head = NULL;
+    _queue_tail = NULL;
+    memset(_running, 0, sizeof(_running));
+    _stats.queue_depth = 0;
+    _stats.busy_workers = 0;
+    _num_workers = 0;
+    _started = false;
+    _stopping = false;
+
+    pthread_cond_init(&_queued, NULL);
+    pthread_cond_init(&_dequeued, NULL);
+    pthread_cond_init(&_completed, NULL);
+    _unlock(&_service_lock);
+}
+
+static void _register_atfork(void)
+{
+    pthread_atfork(_before_fork, _after_fork_in_parent, _after_fork_in_child);
+}
+
+/* Stop the workers before liboehost is unloaded or the process exits */
+__attribute__((destructor)) static void _shutdown_at_unload(void)
+{
+    oe_quote_service_shutdown();
+}
+
+#elif defined(_WIN32)
+
+static DWORD WINAPI _worker(LPVOID arg)
+{
+    _process_requests((size_t)arg);
+    return 0;
+}
+
+static bool _start_worker(size_t index)
+{
+    _workers[index] = CreateThread(NULL, 0, _worker, (LPVOID)index, 0, NULL);
+    return _workers[index] != NULL;
+}
+
+static void _join_worker(size_t index)
+{
+    WaitForSingleObject(_workers[index], INFINITE);
+    CloseHandle(_workers[index]);
+}
+
+#endif
+
+/* Called with _service_lock held */
+static void _start_workers(void)
+{
+    if (_started)
+        return;
+
+    _started = true;
+
+    while (_num_workers < OE_QUOTE_SERVICE_WORKERS &&
+           _start_worker(_num_workers))
+        _num_workers++;
+}
+
+/*
+**==============================================================================
+**
+** Public interface:
+**
+**==============================================================================
+*/
+
+oe_result_t oe_quote_service_get_quote(
+    const sgx_report_t* sgx_report,
+    uint8_t* quote,
+    size_t* quote_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    quote_request_t request;
+    quote_request_t* leader;
+
+    if (!sgx_report || !quote_size)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    memset(&request, 0, sizeof(request));
+    request.report = sgx_report;
+    request.quote = quote;
+    request.quote_size = *quote_size;
+
+#if defined(__linux__)
+    oe_once(&_atfork_once, _register_atfork);
+#endif
+
+    _lock(&_service_lock);
+    _start_workers();
+    _stats.requests++;
+
+    if ((leader = _find_identical(&request)))
+    {
+        request.followers = leader->followers;
+        leader->followers = &request;
+        _stats.deduplicated++;
+    }
+    else
+    {
+        while (!_stopping && _num_workers &&
+               _stats.queue_depth == OE_QUOTE_SERVICE_QUEUE_SIZE)
+        {
+            _stats.queue_full_waits++;
+            _wait(&_dequeued, &_service_lock);
+        }
+
+        /* Without any worker, or while the workers are being stopped,
+         * generate the quote on the calling thread */
+        if (_stopping || !_num_workers)
+        {
+            oe_quote_provider_t provider = _provider;
+
+            _stats.completed++;
+            _unlock(&_service_lock);
+
+            result = provider(sgx_report, quote, quote_size);
+            goto done;
+        }
+
+        if (_queue_tail)
+            _queue_tail->next = &request;
+        else
+            _queue_head = &request;
+
+        _queue_tail = &request;
+
+        if (++_stats.queue_depth > _stats.max_queue_depth)
+            _stats.max_queue_depth = _stats.queue_depth;
+
+        _signal(&_queued);
+    }
+
+    while (!request.done)
+        _wait(&_completed, &_service_lock);
+
+    _unlock(&_service_lock);
+
+    *quote_size = request.quote_size;
+    result = request.result;
+
+done:
+    return result;
+}
+
+void oe_quote_service_set_provider(oe_quote_provider_t provider)
+{
+    _lock(&_service_lock);
+    _provider = provider ? provider : sgx_get_quote;
+    _unlock(&_service_lock);
+}
+
+void oe_quote_service_shutdown(void)
+{
+    size_t num_workers;
+
+    _lock(&_service_lock);
+
+    if (!_started || _stopping)
+    {
+        _unlock(&_service_lock);
+        return;
+    }
+
+    _stopping = true;
+    num_workers = _num_workers;
+    _broadcast(&_queued);
+    _broadcast(&_dequeued);
+    _unlock(&_service_lock);
+
+    for (size_t i = 0; i < num_workers; i++)
+        _join_worker(i);
+
+    _lock(&_service_lock);
+    _num_workers = 0;
+    _started = false;
+    _stopping = false;
+    _unlock(&_service_lock);
+}
+
+void oe_quote_service_get_stats(oe_quote_service_stats_t* stats)
+{
+    if (!stats)
+        return;
+
+    _lock(&_service_lock);
+    *stats = _stats;
+    _unlock(&_service_lock);
+}
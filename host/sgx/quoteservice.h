@@ -0,0 +1,119 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_QUOTESERVICE_H
+#define _OE_HOST_QUOTESERVICE_H
+
+#include <openenclave/internal/sgxtypes.h>
+
+OE_EXTERNC_BEGIN
+
+/* Number of threads that talk to the quoting enclave concurrently */
+#define OE_QUOTE_SERVICE_WORKERS 4
+
+/* Number of distinct requests that may wait for a worker */
+#define OE_QUOTE_SERVICE_QUEUE_SIZE 32
+
+/*
+**==============================================================================
+**
+** oe_quote_provider_t
+**
+**     Produces a quote for a report, with the semantics of sgx_get_quote().
+**
+**==============================================================================
+*/
+
+typedef oe_result_t (*oe_quote_provider_t)(
+    const sgx_report_t* sgx_report,
+    uint8_t* quote,
+    size_t* quote_size);
+
+typedef struct _oe_quote_service_stats
+{
+    /* Requests submitted to the service */
+    uint64_t requests;
+
+    /* Requests answered from an identical request already in flight */
+    uint64_t deduplicated;
+
+    /* Requests answered by a call to the quote provider */
+    uint64_t completed;
+
+    /* Times a request had to wait for room in the queue */
+    uint64_t queue_full_waits;
+
+    /* Current and highest number of queued requests */
+    size_t queue_depth;
+    size_t max_queue_depth;
+
+    /* Workers currently inside the quote provider */
+    size_t busy_workers;
+} oe_quote_service_stats_t;
+
+/*
+**==============================================================================
+**
+** oe_quote_service_get_quote()
+**
+**     Gets a quote through a bounded pool of worker threads. At most
+**     OE_QUOTE_SERVICE_WORKERS quotes are generated at once, and further
+**     requests queue in arrival order. When the queue is full, callers block
+**     until a worker frees a slot. A request for the same report and buffer
+**     size as one already queued or in progress does not generate a second
+**     quote: it receives a copy of the first request's result. Otherwise the
+**     behavior is that of sgx_get_quote().
+**
+**==============================================================================
+*/
+
+oe_result_t oe_quote_service_get_quote(
+    const sgx_report_t* sgx_report,
+    uint8_t* quote,
+    size_t* quote_size);
+
+/*
+**==============================================================================
+**
+** oe_quote_service_set_provider()
+**
+**     Replaces the quote provider, mainly for testing. Passing NULL restores
+**     sgx_get_quote().
+**
+**==============================================================================
+*/
+
+void oe_quote_service_set_provider(oe_quote_provider_t provider);
+
+/*
+**==============================================================================
+**
+** oe_quote_service_shutdown()
+**
+**     Stops the workers once the requests already queued are answered, and
+**     waits for them to exit. Requests made during the shutdown are served
+**     on the calling thread, and a later request starts the workers again.
+**     On Linux this runs when liboehost is unloaded or the process exits,
+**     and a child process created by fork() starts its own workers.
+**
+**==============================================================================
+*/
+
+void oe_quote_service_shutdown(void);
+
+/*
+**==============================================================================
+**
+** oe_quote_service_get_stats()
+**
+**     Gets a snapshot of the service's counters. Counters are cumulative over
+**     the lifetime of the process.
+**
+**==============================================================================
+*/
+
+void oe_quote_service_get_stats(oe_quote_service_stats_t* stats);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_QUOTESERVICE_H */
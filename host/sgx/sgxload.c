@@ -18,17 +18,17 @@
 #include <assert.h>
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/bits/safemath.h>
-#include <openenclave/internal/aesm.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxcreate.h>
-#include <openenclave/internal/sgxsign.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include "../memalign.h"
-#include "../signkey.h"
+#include "debugsigstruct.h"
 #include "enclave.h"
+#include "launchtoken.h"
 #include "sgxmeasure.h"
+#include "sharedpages.h"
 #include "xstate.h"
 
 static int _make_memory_protect_param(uint64_t inflags, bool simulate)
@@ -347,15 +347,15 @@ static oe_result_t _get_sig_struct(
                 "Failed enclave was not signed with debug flag",
                 NULL);
 
-        /* Perform debug-signing with well-known debug-signing key */
-        OE_CHECK(oe_sgx_sign_enclave(
+        /* Perform debug-signing with well-known debug-signing key, reusing
+         * the signature of an earlier creation of the same enclave */
+        OE_CHECK(oe_sgx_get_debug_sigstruct(
             mrenclave,
             properties->config.attributes,
             properties->config.product_id,
             properties->config.security_version,
-            OE_DEBUG_SIGN_KEY,
-            OE_DEBUG_SIGN_KEY_SIZE,
-            sigstruct));
+            sigstruct,
+            NULL));
     }
     else
     {
@@ -379,36 +379,78 @@ done:
 static oe_result_t _get_launch_token(
     const oe_sgx_enclave_properties_t* properties,
     sgx_sigstruct_t* sigstruct,
-    sgx_launch_token_t* launch_token)
+    bool refresh,
+    sgx_launch_token_t* launch_token,
+    bool* cached)
 {
-    oe_result_t result = OE_UNEXPECTED;
-    aesm_t* aesm = NULL;
-
     /* Initialize the SGX attributes */
     sgx_attributes_t attributes = {0};
     attributes.flags = properties->config.attributes;
     attributes.xfrm = properties->config.xfrm;
 
-    memset(launch_token, 0, sizeof(sgx_launch_token_t));
+    /* Obtain a launch token from the cache or the AESM service */
+    return oe_sgx_get_launch_token(
+        sigstruct, &attributes, refresh, launch_token, cached);
+}
 
-    /* Obtain a launch token from the AESM service */
-    if (!(aesm = aesm_connect()))
-        OE_RAISE(OE_FAILURE);
+static oe_result_t _initialize_enclave(
+    oe_sgx_load_context_t* context,
+    uint64_t addr,
+    sgx_sigstruct_t* sigstruct,
+    sgx_launch_token_t* launch_token)
+{
+    oe_result_t result = OE_UNEXPECTED;
 
-    OE_CHECK(aesm_get_launch_token(
-        aesm,
-        sigstruct->enclavehash,
-        sigstruct->modulus,
-        &attributes,
-        launch_token));
+#if defined(__linux__)
 
-    result = OE_OK;
+    /* Ask the Linux SGX driver to initialize the enclave
+       sgxioctl internally traces any driver returned error */
+    if (sgx_ioctl_enclave_init(
+            context->dev, addr, (uint64_t)sigstruct, (uint64_t)launch_token) !=
+        0)
+        OE_RAISE(OE_IOCTL_FAILED);
 
-done:
+#elif defined(_WIN32)
 
-    if (aesm)
-        aesm_disconnect(aesm);
+    OE_STATIC_ASSERT(
+        OE_FIELD_SIZE(ENCLAVE_INIT_INFO_SGX, SigStruct) ==
+        sizeof(sgx_sigstruct_t));
+    OE_STATIC_ASSERT(
+        OE_FIELD_SIZE(ENCLAVE_INIT_INFO_SGX, EInitToken) <=
+        sizeof(sgx_launch_token_t));
+
+    OE_UNUSED(context);
+
+    /* Ask the OS to initialize the enclave */
+    DWORD enclave_error;
+    ENCLAVE_INIT_INFO_SGX info = {{0}};
+
+    OE_CHECK(oe_memcpy_s(
+        &info.SigStruct,
+        sizeof(info.SigStruct),
+        (void*)sigstruct,
+        sizeof(sgx_sigstruct_t)));
+    OE_CHECK(oe_memcpy_s(
+        &info.EInitToken,
+        sizeof(info.EInitToken),
+        (void*)launch_token,
+        sizeof(info.EInitToken)));
+
+    if (!InitializeEnclave(
+            GetCurrentProcess(),
+            (LPVOID)addr,
+            &info,
+            sizeof(info),
+            &enclave_error))
+        OE_RAISE_MSG(
+            OE_PLATFORM_ERROR,
+            "InitializeEnclave failed (err=%#x)",
+            enclave_error);
+#endif
+
+    result = OE_OK;
 
+done:
     return result;
 }
 #endif
@@ -450,6 +492,10 @@ done:
 
 void oe_sgx_cleanup_load_context(oe_sgx_load_context_t* context)
 {
+    /* Stop the measurement thread if the load did not complete */
+    if (context && context->measure_pipeline)
+        oe_sgx_measure_pipeline_finish(context->measure_pipeline);
+
 #if !defined(OE_USE_LIBSGX) && defined(__linux__)
     if (context && context->dev != OE_SGX_NO_DEVICE_HANDLE)
         close(context->dev);
@@ -501,6 +547,18 @@ oe_result_t oe_sgx_create_enclave(
     /* Measure this operation */
     OE_CHECK(oe_sgx_measure_create_enclave(&context->hash_context, secs));
 
+    /* When the host is the only one copying pages (simulation and measurement
+     * modes), overlap the page measurement with the page copies. Failing to
+     * start the pipeline is not fatal: pages are then measured inline. */
+    if (!context->measure_inline &&
+        (context->type == OE_SGX_LOAD_TYPE_MEASURE ||
+         oe_sgx_is_simulation_load_context(context)))
+    {
+        if (oe_sgx_measure_pipeline_start(
+                &context->hash_context, &context->measure_pipeline) != OE_OK)
+            context->measure_pipeline = NULL;
+    }
+
     if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
     {
         /* Use this phony base address when signing enclaves */
@@ -690,6 +748,81 @@ static void _dump_load_enclave_data(
 
 #endif /* defined(OE_TRACE_MEASURE) */
 
+static oe_result_t _measure_enclave_data(
+    oe_sgx_load_context_t* context,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t flags,
+    bool extend)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+#if defined(OE_TRACE_MEASURE)
+
+    _dump_load_enclave_data(addr - base, flags, src, extend);
+
+#endif /* defined(OE_TRACE_MEASURE) */
+
+    if (context->measure_pipeline)
+    {
+        OE_CHECK(oe_sgx_measure_pipeline_load_enclave_data(
+            context->measure_pipeline, base, addr, src, flags, extend));
+    }
+    else
+    {
+        OE_CHECK(oe_sgx_measure_load_enclave_data(
+            &context->hash_context, base, addr, src, flags, extend));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static bool _is_within_sim_enclave(
+    const oe_sgx_load_context_t* context,
+    uint64_t addr,
+    size_t size)
+{
+    uint64_t start = (uint64_t)context->sim.addr;
+    uint64_t end = start + context->sim.size;
+
+    return addr >= start && addr < end && size <= end - addr;
+}
+
+static oe_result_t _set_sim_page_protection(
+    uint64_t addr,
+    size_t size,
+    uint64_t flags)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    int prot = _make_memory_protect_param(flags, true /*simulate*/);
+
+    if ((uint32_t)prot > OE_INT_MAX)
+        OE_RAISE_MSG(OE_FAILURE, "Unexpected page protections: %#x", prot);
+
+#if defined(__linux__)
+    if (mprotect((void*)addr, size, prot) != 0)
+        OE_RAISE_MSG(
+            OE_FAILURE, "mprotect failed (addr=%#x, prot=%#x)", addr, prot);
+#elif defined(_WIN32)
+    DWORD old;
+    if (!VirtualProtect((LPVOID)addr, size, prot, &old))
+        OE_RAISE_MSG(
+            OE_FAILURE,
+            "VirtualProtect failed (addr=%#x, prot=%#x)",
+            addr,
+            prot);
+#endif
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t oe_sgx_load_enclave_data(
     oe_sgx_load_context_t* context,
     uint64_t base,
@@ -710,15 +843,8 @@ oe_result_t oe_sgx_load_enclave_data(
     if (addr % OE_PAGE_SIZE)
         OE_RAISE(OE_INVALID_PARAMETER);
 
-#if defined(OE_TRACE_MEASURE)
-
-    _dump_load_enclave_data(addr - base, flags, src, extend);
-
-#endif /* defined(OE_TRACE_MEASURE) */
-
     /* Measure this operation */
-    OE_CHECK(oe_sgx_measure_load_enclave_data(
-        &context->hash_context, base, addr, src, flags, extend));
+    OE_CHECK(_measure_enclave_data(context, base, addr, src, flags, extend));
 
     if (context->type == OE_SGX_LOAD_TYPE_MEASURE)
     {
@@ -730,9 +856,7 @@ oe_result_t oe_sgx_load_enclave_data(
     {
         /* Simulate enclave add page */
         /* Verify that page is within enclave boundaries */
-        if ((void*)addr < context->sim.addr ||
-            (uint8_t*)addr >
-                (uint8_t*)context->sim.addr + context->sim.size - OE_PAGE_SIZE)
+        if (!_is_within_sim_enclave(context, addr, OE_PAGE_SIZE))
             OE_RAISE_MSG(
                 OE_FAILURE, "Page is NOT within enclave boundaries", NULL);
 
@@ -741,30 +865,7 @@ oe_result_t oe_sgx_load_enclave_data(
             (uint8_t*)addr, OE_PAGE_SIZE, (uint8_t*)src, OE_PAGE_SIZE));
 
         /* Set page access permissions */
-        {
-            int prot = _make_memory_protect_param(flags, true /*simulate*/);
-
-            if ((uint32_t)prot > OE_INT_MAX)
-                OE_RAISE_MSG(
-                    OE_FAILURE, "Unexpected page protections: %#x", prot);
-
-#if defined(__linux__)
-            if (mprotect((void*)addr, OE_PAGE_SIZE, prot) != 0)
-                OE_RAISE_MSG(
-                    OE_FAILURE,
-                    "mprotect failed (addr=%#x, prot=%#x)",
-                    addr,
-                    prot);
-#elif defined(_WIN32)
-            DWORD old;
-            if (!VirtualProtect((LPVOID)addr, OE_PAGE_SIZE, prot, &old))
-                OE_RAISE_MSG(
-                    OE_FAILURE,
-                    "VirtualProtect failed (addr=%#x, prot=%#x)",
-                    addr,
-                    prot);
-#endif
-        }
+        OE_CHECK(_set_sim_page_protection(addr, OE_PAGE_SIZE, flags));
     }
     else
     {
@@ -835,6 +936,77 @@ done:
     return result;
 }
 
+oe_result_t oe_sgx_load_enclave_shared_data(
+    oe_sgx_load_context_t* context,
+    oe_enclave_t* enclave,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    size_t size,
+    uint64_t flags)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_shared_pages_t* pages = NULL;
+    int prot;
+
+    if (!context || !enclave || !base || !addr || !src || !flags)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (context->state != OE_SGX_LOAD_STATE_ENCLAVE_CREATED)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* ADDR and SIZE must be page aligned */
+    if ((addr % OE_PAGE_SIZE) || (size % OE_PAGE_SIZE))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Only read-only pages of simulated enclaves can be shared. Everything
+     * else is loaded one page at a time. */
+    if (context->type != OE_SGX_LOAD_TYPE_CREATE ||
+        !oe_sgx_is_simulation_load_context(context) ||
+        (flags & SGX_SECINFO_W) ||
+        enclave->num_shared_pages == OE_SGX_MAX_SHARED_SEGMENTS)
+    {
+        for (size_t offset = 0; offset < size; offset += OE_PAGE_SIZE)
+        {
+            OE_CHECK(oe_sgx_load_enclave_data(
+                context, base, addr + offset, src + offset, flags, true));
+        }
+
+        result = OE_OK;
+        goto done;
+    }
+
+    if (!_is_within_sim_enclave(context, addr, size))
+        OE_RAISE_MSG(
+            OE_FAILURE, "Pages are NOT within enclave boundaries", NULL);
+
+    /* Measure the pages exactly as if they were added one by one */
+    for (size_t offset = 0; offset < size; offset += OE_PAGE_SIZE)
+    {
+        OE_CHECK(_measure_enclave_data(
+            context, base, addr + offset, src + offset, flags, true));
+    }
+
+    prot = _make_memory_protect_param(flags, true /*simulate*/);
+
+    if (oe_sgx_map_shared_pages(
+            (void*)addr, (const void*)src, size, prot, &pages) == OE_OK)
+    {
+        enclave->shared_pages[enclave->num_shared_pages++] = pages;
+    }
+    else
+    {
+        /* Fall back to a private copy of the pages */
+        OE_CHECK(oe_memcpy_s((void*)addr, size, (const void*)src, size));
+        OE_CHECK(_set_sim_page_protection(addr, size, flags));
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 oe_result_t oe_sgx_initialize_enclave(
     oe_sgx_load_context_t* context,
     uint64_t addr,
@@ -852,6 +1024,14 @@ oe_result_t oe_sgx_initialize_enclave(
     if (context->state != OE_SGX_LOAD_STATE_ENCLAVE_CREATED)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    /* Wait for the pages still queued for measurement */
+    if (context->measure_pipeline)
+    {
+        oe_sgx_measure_pipeline_t* pipeline = context->measure_pipeline;
+        context->measure_pipeline = NULL;
+        OE_CHECK(oe_sgx_measure_pipeline_finish(pipeline));
+    }
+
     /* Measure this operation */
     OE_CHECK(
         oe_sgx_measure_initialize_enclave(&context->hash_context, mrenclave));
@@ -880,54 +1060,24 @@ oe_result_t oe_sgx_initialize_enclave(
 #else
         /* If not using libsgx, get a launch token from the AESM service */
         sgx_launch_token_t launch_token;
-        OE_CHECK(_get_launch_token(properties, &sigstruct, &launch_token));
+        bool cached;
+        OE_CHECK(_get_launch_token(
+            properties, &sigstruct, false, &launch_token, &cached));
 
-#if defined(__linux__)
+        result = _initialize_enclave(context, addr, &sigstruct, &launch_token);
 
-        /* Ask the Linux SGX driver to initialize the enclave
-           sgxioctl internally traces any driver returned error */
-        if (sgx_ioctl_enclave_init(
-                context->dev,
-                addr,
-                (uint64_t)&sigstruct,
-                (uint64_t)&launch_token) != 0)
-            OE_RAISE(OE_IOCTL_FAILED);
-
-#elif defined(_WIN32)
-
-        OE_STATIC_ASSERT(
-            OE_FIELD_SIZE(ENCLAVE_INIT_INFO_SGX, SigStruct) ==
-            sizeof(sigstruct));
-        OE_STATIC_ASSERT(
-            OE_FIELD_SIZE(ENCLAVE_INIT_INFO_SGX, EInitToken) <=
-            sizeof(launch_token));
-
-        /* Ask the OS to initialize the enclave */
-        DWORD enclave_error;
-        ENCLAVE_INIT_INFO_SGX info = {{0}};
+        /* A cached token is stale once the platform's launch key changes, so
+         * retry once with a token just issued by the AESM service */
+        if (result != OE_OK && cached)
+        {
+            OE_CHECK(_get_launch_token(
+                properties, &sigstruct, true, &launch_token, NULL));
 
-        OE_CHECK(oe_memcpy_s(
-            &info.SigStruct,
-            sizeof(info.SigStruct),
-            (void*)&sigstruct,
-            sizeof(sigstruct)));
-        OE_CHECK(oe_memcpy_s(
-            &info.EInitToken,
-            sizeof(info.EInitToken),
-            (void*)&launch_token,
-            sizeof(info.EInitToken)));
+            result =
+                _initialize_enclave(context, addr, &sigstruct, &launch_token);
+        }
 
-        if (!InitializeEnclave(
-                GetCurrentProcess(),
-                (LPVOID)addr,
-                &info,
-                sizeof(info),
-                &enclave_error))
-            OE_RAISE_MSG(
-                OE_PLATFORM_ERROR,
-                "InitializeEnclave failed (err=%#x)",
-                enclave_error);
-#endif
+        OE_CHECK(result);
 #endif
     }
 
@@ -948,6 +1098,13 @@ oe_result_t oe_sgx_delete_enclave(oe_enclave_t* enclave)
     /* free allocate memory. */
     OE_CHECK(_sgx_free_enclave_memory(
         (void*)enclave->addr, enclave->size, enclave->simulate));
+
+    /* Drop the references to the pages shared with other instances now that
+     * they are no longer mapped */
+    for (size_t i = 0; i < enclave->num_shared_pages; i++)
+        oe_sgx_release_shared_pages(enclave->shared_pages[i]);
+
+    enclave->num_shared_pages = 0;
     result = OE_OK;
 done:
     return result;
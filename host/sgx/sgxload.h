@@ -37,6 +37,23 @@ oe_result_t oe_sgx_load_enclave_data(
     uint64_t flags,
     bool extend);
 
+/**
+ * Loads a run of pages with the same flags into the enclave.
+ *
+ * The pages are measured exactly as if each had been passed to
+ * oe_sgx_load_enclave_data() with **extend** set. When creating a simulated
+ * enclave, read-only pages are mapped from memory shared with other
+ * instances of the same image (see sharedpages.h) instead of being copied.
+ */
+oe_result_t oe_sgx_load_enclave_shared_data(
+    oe_sgx_load_context_t* context,
+    oe_enclave_t* enclave,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    size_t size,
+    uint64_t flags);
+
 oe_result_t oe_sgx_initialize_enclave(
     oe_sgx_load_context_t* context,
     uint64_t addr,
@@ -2,6 +2,11 @@
 // Licensed under the MIT License.
 
 #include "sgxmeasure.h"
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+#include <stdlib.h>
+#include <openenclave/bits/safecrt.h>
 #include <openenclave/host.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
@@ -119,3 +124,242 @@ oe_result_t oe_sgx_measure_initialize_enclave(
 done:
     return result;
 }
+
+/*
+**==============================================================================
+**
+** Measurement pipeline (see sgxmeasure.h)
+**
+**     The loader thread (producer) appends records to a ring of
+**     OE_SGX_MEASURE_PIPELINE_DEPTH slots and the measurement thread
+**     (consumer) removes them from the head. The page contents are copied
+**     into the slot since callers may reuse their source buffer as soon as
+**     oe_sgx_load_enclave_data() returns. Only the slot indices and count are
+**     protected by the mutex: a slot is owned by the producer until count is
+**     incremented and by the consumer until count is decremented.
+**
+**==============================================================================
+*/
+
+#if defined(__linux__)
+
+typedef struct _measure_record
+{
+    uint64_t base;
+    uint64_t addr;
+    uint64_t flags;
+    bool extend;
+    uint8_t page[OE_PAGE_SIZE];
+} measure_record_t;
+
+struct _oe_sgx_measure_pipeline
+{
+    oe_sha256_context_t* context;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    size_t head;
+    size_t count;
+    bool done;
+    oe_result_t result;
+    measure_record_t records[OE_SGX_MEASURE_PIPELINE_DEPTH];
+};
+
+static void* _measure_thread(void* arg)
+{
+    oe_sgx_measure_pipeline_t* pipeline = (oe_sgx_measure_pipeline_t*)arg;
+
+    for (;;)
+    {
+        measure_record_t* record;
+        oe_result_t result;
+
+        pthread_mutex_lock(&pipeline->mutex);
+
+        while (pipeline->count == 0 && !pipeline->done)
+            pthread_cond_wait(&pipeline->not_empty, &pipeline->mutex);
+
+        if (pipeline->count == 0)
+        {
+            pthread_mutex_unlock(&pipeline->mutex);
+            break;
+        }
+
+        record = &pipeline->records[pipeline->head];
+        pthread_mutex_unlock(&pipeline->mutex);
+
+        result = oe_sgx_measure_load_enclave_data(
+            pipeline->context,
+            record->base,
+            record->addr,
+            (uint64_t)record->page,
+            record->flags,
+            record->extend);
+
+        pthread_mutex_lock(&pipeline->mutex);
+
+        if (result != OE_OK && pipeline->result == OE_OK)
+            pipeline->result = result;
+
+        pipeline->head = (pipeline->head + 1) % OE_SGX_MEASURE_PIPELINE_DEPTH;
+        pipeline->count--;
+        pthread_cond_signal(&pipeline->not_full);
+        pthread_mutex_unlock(&pipeline->mutex);
+    }
+
+    return NULL;
+}
+
+oe_result_t oe_sgx_measure_pipeline_start(
+    oe_sha256_context_t* context,
+    oe_sgx_measure_pipeline_t** pipeline)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_measure_pipeline_t* p = NULL;
+
+    if (pipeline)
+        *pipeline = NULL;
+
+    if (!context || !pipeline)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(p = (oe_sgx_measure_pipeline_t*)calloc(1, sizeof(*p))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    p->context = context;
+    p->result = OE_OK;
+    pthread_mutex_init(&p->mutex, NULL);
+    pthread_cond_init(&p->not_empty, NULL);
+    pthread_cond_init(&p->not_full, NULL);
+
+    if (pthread_create(&p->thread, NULL, _measure_thread, p) != 0)
+    {
+        pthread_cond_destroy(&p->not_full);
+        pthread_cond_destroy(&p->not_empty);
+        pthread_mutex_destroy(&p->mutex);
+        OE_RAISE_MSG(OE_FAILURE, "pthread_create failed", NULL);
+    }
+
+    *pipeline = p;
+    p = NULL;
+    result = OE_OK;
+
+done:
+    free(p);
+    return result;
+}
+
+oe_result_t oe_sgx_measure_pipeline_load_enclave_data(
+    oe_sgx_measure_pipeline_t* pipeline,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t flags,
+    bool extend)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    measure_record_t* record;
+
+    /* Reject the parameters the measurement thread would reject */
+    if (!pipeline || !base || !addr || !src || !flags || addr < base)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    pthread_mutex_lock(&pipeline->mutex);
+
+    while (pipeline->count == OE_SGX_MEASURE_PIPELINE_DEPTH)
+        pthread_cond_wait(&pipeline->not_full, &pipeline->mutex);
+
+    result = pipeline->result;
+    record = &pipeline->records
+                  [(pipeline->head + pipeline->count) %
+                   OE_SGX_MEASURE_PIPELINE_DEPTH];
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    /* Stop queueing once the measurement thread has failed */
+    OE_CHECK(result);
+
+    record->base = base;
+    record->addr = addr;
+    record->flags = flags;
+    record->extend = extend;
+
+    /* Only extended pages contribute their contents to the measurement */
+    if (extend)
+        OE_CHECK(oe_memcpy_s(
+            record->page, sizeof(record->page), (void*)src, OE_PAGE_SIZE));
+
+    pthread_mutex_lock(&pipeline->mutex);
+    pipeline->count++;
+    pthread_cond_signal(&pipeline->not_empty);
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_measure_pipeline_finish(oe_sgx_measure_pipeline_t* pipeline)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!pipeline)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    pthread_mutex_lock(&pipeline->mutex);
+    pipeline->done = true;
+    pthread_cond_signal(&pipeline->not_empty);
+    pthread_mutex_unlock(&pipeline->mutex);
+
+    pthread_join(pipeline->thread, NULL);
+
+    result = pipeline->result;
+
+    pthread_cond_destroy(&pipeline->not_full);
+    pthread_cond_destroy(&pipeline->not_empty);
+    pthread_mutex_destroy(&pipeline->mutex);
+    free(pipeline);
+
+done:
+    return result;
+}
+
+#else /* !defined(__linux__) */
+
+oe_result_t oe_sgx_measure_pipeline_start(
+    oe_sha256_context_t* context,
+    oe_sgx_measure_pipeline_t** pipeline)
+{
+    OE_UNUSED(context);
+
+    if (pipeline)
+        *pipeline = NULL;
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_sgx_measure_pipeline_load_enclave_data(
+    oe_sgx_measure_pipeline_t* pipeline,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t flags,
+    bool extend)
+{
+    OE_UNUSED(pipeline);
+    OE_UNUSED(base);
+    OE_UNUSED(addr);
+    OE_UNUSED(src);
+    OE_UNUSED(flags);
+    OE_UNUSED(extend);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_sgx_measure_pipeline_finish(oe_sgx_measure_pipeline_t* pipeline)
+{
+    OE_UNUSED(pipeline);
+    return OE_UNSUPPORTED;
+}
+
+#endif /* !defined(__linux__) */
@@ -25,6 +25,41 @@ oe_result_t oe_sgx_measure_initialize_enclave(
     oe_sha256_context_t* context,
     OE_SHA256* mrenclave);
 
+/*
+**==============================================================================
+**
+** Measurement pipeline:
+**
+**     Moves the EADD/EEXTEND measurement of loaded pages onto a worker thread
+**     so that hashing overlaps with copying pages into the enclave. Pages are
+**     queued in load order and measured in the same order, so the resulting
+**     MRENCLAVE is identical to the one computed inline.
+**
+**==============================================================================
+*/
+
+/* Number of pages that may be queued before the loader blocks */
+#define OE_SGX_MEASURE_PIPELINE_DEPTH 64
+
+typedef struct _oe_sgx_measure_pipeline oe_sgx_measure_pipeline_t;
+
+/* Start a worker thread that measures queued pages into **context** */
+oe_result_t oe_sgx_measure_pipeline_start(
+    oe_sha256_context_t* context,
+    oe_sgx_measure_pipeline_t** pipeline);
+
+/* Queue a page for measurement (same parameters as the inline version) */
+oe_result_t oe_sgx_measure_pipeline_load_enclave_data(
+    oe_sgx_measure_pipeline_t* pipeline,
+    uint64_t base,
+    uint64_t addr,
+    uint64_t src,
+    uint64_t flags,
+    bool extend);
+
+/* Wait for all queued pages to be measured and release the pipeline */
+oe_result_t oe_sgx_measure_pipeline_finish(oe_sgx_measure_pipeline_t* pipeline);
+
 OE_EXTERNC_END
 
 #endif /* _OE_SGXMEASURE_H */
@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "sharedpages.h"
+#if defined(__linux__)
+#include <errno.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/sha.h>
+#include <openenclave/internal/trace.h>
+#include <openenclave/internal/utils.h>
+
+#if defined(__linux__)
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+/* Name shown for the shared mappings in /proc/<pid>/maps */
+#define SHARED_PAGES_NAME "oe-shared-pages"
+
+struct _oe_sgx_shared_pages
+{
+    struct _oe_sgx_shared_pages* next;
+    OE_SHA256 hash;
+    size_t size;
+    int fd;
+    size_t refs;
+};
+
+static oe_sgx_shared_pages_t* _cache;
+static pthread_mutex_t _cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static oe_result_t _hash_pages(const void* src, size_t size, OE_SHA256* hash)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sha256_context_t context;
+
+    OE_CHECK(oe_sha256_init(&context));
+    OE_CHECK(oe_sha256_update(&context, src, size));
+    OE_CHECK(oe_sha256_final(&context, hash));
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Creates a memory file descriptor holding a copy of the given pages */
+static int _create_fd(const void* src, size_t size)
+{
+    int fd;
+    const uint8_t* p = (const uint8_t*)src;
+    size_t n = size;
+
+    fd = (int)syscall(SYS_memfd_create, SHARED_PAGES_NAME, MFD_CLOEXEC);
+
+    if (fd < 0)
+        return -1;
+
+    if (ftruncate(fd, (off_t)size) != 0)
+        goto failed;
+
+    while (n)
+    {
+        ssize_t written = pwrite(fd, p, n, (off_t)(p - (const uint8_t*)src));
+
+        if (written < 0 && errno == EINTR)
+            continue;
+
+        if (written <= 0)
+            goto failed;
+
+        p += written;
+        n -= (size_t)written;
+    }
+
+    return fd;
+
+failed:
+    close(fd);
+    return -1;
+}
+
+oe_result_t oe_sgx_map_shared_pages(
+    void* addr,
+    const void* src,
+    size_t size,
+    int prot,
+    oe_sgx_shared_pages_t** pages)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_sgx_shared_pages_t* entry = NULL;
+    bool created = false;
+    bool locked = false;
+    OE_SHA256 hash;
+
+    if (pages)
+        *pages = NULL;
+
+    if (!addr || !src || !size || !pages || (size % OE_PAGE_SIZE) ||
+        ((uint64_t)addr % OE_PAGE_SIZE))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(_hash_pages(src, size, &hash));
+
+    pthread_mutex_lock(&_cache_lock);
+    locked = true;
+
+    for (entry = _cache; entry; entry = entry->next)
+    {
+        if (entry->size == size &&
+            memcmp(entry->hash.buf, hash.buf, sizeof(hash.buf)) == 0)
+            break;
+    }
+
+    if (!entry)
+    {
+        if (!(entry = (oe_sgx_shared_pages_t*)calloc(1, sizeof(*entry))))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        created = true;
+        entry->fd = -1;
+        entry->hash = hash;
+        entry->size = size;
+
+        if ((entry->fd = _create_fd(src, size)) < 0)
+            OE_RAISE_MSG(OE_FAILURE, "memfd_create failed: errno=%d", errno);
+    }
+
+    /* Replace the anonymous pages with a private mapping of the shared file.
+     * Pages that are written later are copied on write. */
+    if (mmap(addr, size, prot, MAP_PRIVATE | MAP_FIXED, entry->fd, 0) !=
+        addr)
+    {
+        int err = errno;
+
+        /* A failed fixed mapping may have removed the original pages, so
+         * restore an anonymous mapping for the caller to copy into */
+        mmap(addr, size, prot, MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+        OE_RAISE_MSG(OE_FAILURE, "mmap failed: errno=%d", err);
+    }
+
+    if (created)
+    {
+        entry->next = _cache;
+        _cache = entry;
+        created = false;
+    }
+
+    entry->refs++;
+    *pages = entry;
+    result = OE_OK;
+
+done:
+
+    if (created)
+    {
+        if (entry->fd >= 0)
+            close(entry->fd);
+
+        free(entry);
+    }
+
+    if (locked)
+        pthread_mutex_unlock(&_cache_lock);
+
+    return result;
+}
+
+void oe_sgx_release_shared_pages(oe_sgx_shared_pages_t* pages)
+{
+    if (!pages)
+        return;
+
+    pthread_mutex_lock(&_cache_lock);
+
+    if (--pages->refs == 0)
+    {
+        oe_sgx_shared_pages_t** p = &_cache;
+
+        while (*p != pages)
+            p = &(*p)->next;
+
+        *p = pages->next;
+        close(pages->fd);
+        free(pages);
+    }
+
+    pthread_mutex_unlock(&_cache_lock);
+}
+
+#else /* !defined(__linux__) */
+
+oe_result_t oe_sgx_map_shared_pages(
+    void* addr,
+    const void* src,
+    size_t size,
+    int prot,
+    oe_sgx_shared_pages_t** pages)
+{
+    OE_UNUSED(addr);
+    OE_UNUSED(src);
+    OE_UNUSED(size);
+    OE_UNUSED(prot);
+
+    if (pages)
+        *pages = NULL;
+
+    return OE_UNSUPPORTED;
+}
+
+void oe_sgx_release_shared_pages(oe_sgx_shared_pages_t* pages)
+{
+    OE_UNUSED(pages);
+}
+
+#endif /* !defined(__linux__) */
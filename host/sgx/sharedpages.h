@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_SHAREDPAGES_H
+#define _OE_HOST_SGX_SHAREDPAGES_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Shared pages:
+**
+**     In simulation mode, the read-only segments of an enclave image (such
+**     as .text and .rodata) are identical in every instance of that image.
+**     Rather than copying them into each instance, the loader places their
+**     contents in a memory file descriptor that is cached by content hash
+**     and maps it privately into each instance. All instances therefore
+**     share the same physical pages, and any page that is later written
+**     (by relocation or by a debugger inserting breakpoints) is copied on
+**     write for that instance only.
+**
+**     This is only supported on Linux. Elsewhere oe_sgx_map_shared_pages()
+**     returns OE_UNSUPPORTED and the caller copies the pages as before.
+**
+**==============================================================================
+*/
+
+/* Maximum number of shared segments tracked per enclave */
+#define OE_SGX_MAX_SHARED_SEGMENTS 8
+
+typedef struct _oe_sgx_shared_pages oe_sgx_shared_pages_t;
+
+/**
+ * Maps **size** bytes copied from **src** at **addr** using shared pages.
+ *
+ * The pages are looked up in (or added to) a process-wide cache keyed by
+ * the SHA-256 of their contents and mapped copy-on-write over the existing
+ * mapping at **addr**.
+ *
+ * @param addr Page-aligned address within the simulated enclave.
+ * @param src The page contents.
+ * @param size The number of bytes to map; a multiple of the page size.
+ * @param prot The memory protection to apply to the mapping.
+ * @param pages[out] The cache entry, to be released with
+ *        oe_sgx_release_shared_pages() once the mapping is removed.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_UNSUPPORTED if shared pages are not supported.
+ */
+oe_result_t oe_sgx_map_shared_pages(
+    void* addr,
+    const void* src,
+    size_t size,
+    int prot,
+    oe_sgx_shared_pages_t** pages);
+
+/**
+ * Releases a reference obtained from oe_sgx_map_shared_pages().
+ *
+ * The cache entry is destroyed when its last reference is released.
+ */
+void oe_sgx_release_shared_pages(oe_sgx_shared_pages_t* pages);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_SGX_SHAREDPAGES_H */
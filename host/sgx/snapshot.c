@@ -0,0 +1,624 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "snapshot.h"
+#if defined(__linux__)
+#include <errno.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/debug.h>
+#include <openenclave/internal/raise.h>
+#include <stdlib.h>
+#include <string.h>
+#include "asmdefs.h"
+#include "enclave.h"
+#include "ocalls.h"
+#if defined(__linux__)
+#include "sharedpages.h"
+#endif
+
+/*
+**==============================================================================
+**
+** Host allocations:
+**
+**     Simulated enclaves record the host memory they obtain through OCALLs,
+**     since a snapshot keeps the pointers to that memory in its image. The
+**     clones then ignore frees of the memory they inherited, so that the
+**     next clone finds it intact, and free what they allocated themselves
+**     when they are terminated.
+**
+**==============================================================================
+*/
+
+/* The allocations are kept in an open-addressed hash set with linear
+ * probing, whose capacity is a power of two at least twice the count, so
+ * that every OCALL that allocates or frees host memory finds its pointer
+ * in constant time */
+static size_t _hash(const void* ptr, size_t capacity)
+{
+    return (size_t)((((uint64_t)ptr >> 4) * 0x9e3779b97f4a7c15ULL) >> 32) &
+           (capacity - 1);
+}
+
+static bool _find(void** ptrs, size_t capacity, void* ptr, size_t* index)
+{
+    if (!capacity)
+        return false;
+
+    for (size_t i = _hash(ptr, capacity); ptrs[i]; i = (i + 1) & (capacity - 1))
+    {
+        if (ptrs[i] == ptr)
+        {
+            if (index)
+                *index = i;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void _insert(void** ptrs, size_t capacity, void* ptr)
+{
+    size_t i = _hash(ptr, capacity);
+
+    while (ptrs[i])
+        i = (i + 1) & (capacity - 1);
+
+    ptrs[i] = ptr;
+}
+
+/* Called with the enclave lock held */
+static void _add(oe_enclave_t* enclave, void* ptr)
+{
+    if ((enclave->num_host_allocations + 1) * 2 >
+        enclave->host_allocations_capacity)
+    {
+        size_t capacity = enclave->host_allocations_capacity
+                              ? enclave->host_allocations_capacity * 2
+                              : 16;
+        void** ptrs = (void**)calloc(capacity, sizeof(void*));
+
+        /* Untracked memory is merely not freed when a clone terminates */
+        if (!ptrs)
+            return;
+
+        for (size_t i = 0; i < enclave->host_allocations_capacity; i++)
+        {
+            if (enclave->host_allocations[i])
+                _insert(ptrs, capacity, enclave->host_allocations[i]);
+        }
+
+        free(enclave->host_allocations);
+        enclave->host_allocations = ptrs;
+        enclave->host_allocations_capacity = capacity;
+    }
+
+    _insert(
+        enclave->host_allocations, enclave->host_allocations_capacity, ptr);
+    enclave->num_host_allocations++;
+}
+
+/* Called with the enclave lock held */
+static bool _remove(oe_enclave_t* enclave, void* ptr)
+{
+    void** ptrs = enclave->host_allocations;
+    const size_t mask = enclave->host_allocations_capacity - 1;
+    size_t i;
+
+    if (!_find(ptrs, enclave->host_allocations_capacity, ptr, &i))
+        return false;
+
+    /* Move back the following entries that would no longer be found */
+    for (size_t j = (i + 1) & mask; ptrs[j]; j = (j + 1) & mask)
+    {
+        size_t home = _hash(ptrs[j], mask + 1);
+
+        /* Whether home lies cyclically in (i, j] */
+        if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+            continue;
+
+        ptrs[i] = ptrs[j];
+        i = j;
+    }
+
+    ptrs[i] = NULL;
+    enclave->num_host_allocations--;
+    return true;
+}
+
+#if defined(__linux__)
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+/* Name shown for the snapshot mappings in /proc/<pid>/maps */
+#define SNAPSHOT_NAME "oe-enclave-snapshot"
+
+/* Protection of a range of the enclave image */
+typedef struct _region
+{
+    uint64_t addr;
+    uint64_t size;
+    int prot;
+} region_t;
+
+struct _oe_enclave_snapshot
+{
+    /* The snapshotted enclave, whose structure every clone reuses since
+     * the image refers to it */
+    oe_enclave_t* enclave;
+
+    /* The structure as it was snapshotted */
+    oe_enclave_t state;
+
+    /* Memory file holding the image */
+    int fd;
+
+    region_t* regions;
+    size_t num_regions;
+
+    /* Host memory referred to by the image, as a hash set */
+    void** host_allocations;
+    size_t host_allocations_capacity;
+
+    /* Whether a clone currently occupies the address range */
+    bool cloned;
+};
+
+/* Replaces the enclave image with an inaccessible reservation */
+static oe_result_t _reserve(uint64_t addr, uint64_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (mmap((void*)addr,
+             size,
+             PROT_NONE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_NORESERVE,
+             -1,
+             0) != (void*)addr)
+        OE_RAISE_MSG(OE_FAILURE, "mmap failed: errno=%d", errno);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Records the protection of each mapping of the enclave image */
+static oe_result_t _read_regions(
+    const oe_enclave_t* enclave,
+    oe_enclave_snapshot_t* snapshot)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    FILE* stream = NULL;
+    char line[512];
+    size_t capacity = 0;
+    const uint64_t enclave_end = enclave->addr + enclave->size;
+
+    if (!(stream = fopen("/proc/self/maps", "r")))
+        OE_RAISE_MSG(OE_FAILURE, "cannot open /proc/self/maps", NULL);
+
+    while (fgets(line, sizeof(line), stream))
+    {
+        unsigned long start;
+        unsigned long end;
+        char perms[5];
+        region_t* region;
+
+        if (sscanf(line, "%lx-%lx %4s", &start, &end, perms) != 3)
+            continue;
+
+        if (end <= enclave->addr || start >= enclave_end)
+            continue;
+
+        if (snapshot->num_regions == capacity)
+        {
+            region_t* regions;
+
+            capacity = capacity ? capacity * 2 : 16;
+            regions = (region_t*)realloc(
+                snapshot->regions, capacity * sizeof(region_t));
+
+            if (!regions)
+                OE_RAISE(OE_OUT_OF_MEMORY);
+
+            snapshot->regions = regions;
+        }
+
+        region = &snapshot->regions[snapshot->num_regions++];
+        region->addr = start < enclave->addr ? enclave->addr : start;
+        region->size = (end > enclave_end ? enclave_end : end) - region->addr;
+        region->prot = (perms[0] == 'r' ? PROT_READ : 0) |
+                       (perms[1] == 'w' ? PROT_WRITE : 0) |
+                       (perms[2] == 'x' ? PROT_EXEC : 0);
+    }
+
+    result = OE_OK;
+
+done:
+
+    if (stream)
+        fclose(stream);
+
+    return result;
+}
+
+/* Copies the readable parts of the enclave image into the memory file */
+static oe_result_t _write_image(
+    const oe_enclave_t* enclave,
+    oe_enclave_snapshot_t* snapshot)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    snapshot->fd = (int)syscall(SYS_memfd_create, SNAPSHOT_NAME, MFD_CLOEXEC);
+
+    if (snapshot->fd < 0)
+        OE_RAISE_MSG(OE_UNSUPPORTED, "memfd_create failed: errno=%d", errno);
+
+    if (ftruncate(snapshot->fd, (off_t)enclave->size) != 0)
+        OE_RAISE_MSG(OE_FAILURE, "ftruncate failed: errno=%d", errno);
+
+    /* Guard pages are not readable and stay zero */
+    for (size_t i = 0; i < snapshot->num_regions; i++)
+    {
+        const region_t* region = &snapshot->regions[i];
+        const uint8_t* p = (const uint8_t*)region->addr;
+        size_t n = region->size;
+
+        if (!(region->prot & PROT_READ))
+            continue;
+
+        while (n)
+        {
+            off_t offset = (off_t)((uint64_t)p - enclave->addr);
+            ssize_t written = pwrite(snapshot->fd, p, n, offset);
+
+            if (written < 0 && errno == EINTR)
+                continue;
+
+            if (written <= 0)
+                OE_RAISE_MSG(OE_FAILURE, "pwrite failed: errno=%d", errno);
+
+            p += written;
+            n -= (size_t)written;
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+static void _free_snapshot(oe_enclave_snapshot_t* snapshot)
+{
+    if (snapshot->fd >= 0)
+        close(snapshot->fd);
+
+    free(snapshot->regions);
+    free(snapshot);
+}
+
+oe_result_t oe_snapshot_enclave(
+    oe_enclave_t* enclave,
+    oe_enclave_snapshot_t** snapshot_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_snapshot_t* snapshot = NULL;
+    bool locked = false;
+
+    if (snapshot_out)
+        *snapshot_out = NULL;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !snapshot_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!enclave->simulate || enclave->snapshot)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    if (!(snapshot = (oe_enclave_snapshot_t*)calloc(1, sizeof(*snapshot))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    snapshot->fd = -1;
+
+    oe_mutex_lock(&enclave->lock);
+    locked = true;
+
+    for (size_t i = 0; i < enclave->num_bindings; i++)
+    {
+        if (enclave->bindings[i].flags & _OE_THREAD_BUSY)
+            OE_RAISE(OE_BUSY);
+    }
+
+    OE_CHECK(_read_regions(enclave, snapshot));
+    OE_CHECK(_write_image(enclave, snapshot));
+
+    /* From here on the enclave only lives on in the snapshot */
+    enclave->magic = 0;
+    oe_remove_enclave_instance(enclave);
+
+    oe_notify_gdb_enclave_termination(
+        enclave, enclave->path, (uint32_t)strlen(enclave->path));
+
+    OE_CHECK(_reserve(enclave->addr, enclave->size));
+
+    /* The reservation replaced the pages shared with other instances */
+    for (size_t i = 0; i < enclave->num_shared_pages; i++)
+        oe_sgx_release_shared_pages(enclave->shared_pages[i]);
+
+    enclave->num_shared_pages = 0;
+
+    /* The image refers to the host memory the enclave holds */
+    snapshot->host_allocations = enclave->host_allocations;
+    snapshot->host_allocations_capacity = enclave->host_allocations_capacity;
+    enclave->host_allocations = NULL;
+    enclave->num_host_allocations = 0;
+    enclave->host_allocations_capacity = 0;
+
+    snapshot->enclave = enclave;
+    snapshot->state = *enclave;
+    *snapshot_out = snapshot;
+    snapshot = NULL;
+    result = OE_OK;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&enclave->lock);
+
+    if (snapshot)
+        _free_snapshot(snapshot);
+
+    return result;
+}
+
+oe_result_t oe_clone_enclave(
+    oe_enclave_snapshot_t* snapshot,
+    oe_enclave_t** enclave_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_t* enclave;
+    bool mapped = false;
+
+    if (enclave_out)
+        *enclave_out = NULL;
+
+    if (!snapshot || !enclave_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (snapshot->cloned)
+        OE_RAISE(OE_BUSY);
+
+    enclave = snapshot->enclave;
+
+    /* Map the image copy-on-write over the reservation */
+    if (mmap((void*)enclave->addr,
+             enclave->size,
+             PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED,
+             snapshot->fd,
+             0) != (void*)enclave->addr)
+        OE_RAISE_MSG(OE_FAILURE, "mmap failed: errno=%d", errno);
+
+    mapped = true;
+
+    for (size_t i = 0; i < snapshot->num_regions; i++)
+    {
+        const region_t* region = &snapshot->regions[i];
+
+        if (mprotect((void*)region->addr, region->size, region->prot) != 0)
+            OE_RAISE_MSG(OE_FAILURE, "mprotect failed: errno=%d", errno);
+    }
+
+    /* Thread bindings and the lock were idle when the snapshot was taken */
+    *enclave = snapshot->state;
+    enclave->snapshot = snapshot;
+
+    if (oe_mutex_init(&enclave->lock) != 0)
+        OE_RAISE(OE_FAILURE);
+
+    if (oe_push_enclave_instance(enclave) != 0)
+    {
+        oe_mutex_destroy(&enclave->lock);
+        OE_RAISE(OE_FAILURE);
+    }
+
+    oe_notify_gdb_enclave_creation(
+        enclave, enclave->path, (uint32_t)strlen(enclave->path));
+
+    enclave->magic = ENCLAVE_MAGIC;
+    snapshot->cloned = true;
+    *enclave_out = enclave;
+    result = OE_OK;
+
+done:
+
+    if (result != OE_OK && mapped)
+        _reserve(snapshot->enclave->addr, snapshot->enclave->size);
+
+    return result;
+}
+
+oe_result_t oe_sgx_terminate_clone(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_snapshot_t* snapshot = enclave->snapshot;
+
+    oe_notify_gdb_enclave_termination(
+        enclave, enclave->path, (uint32_t)strlen(enclave->path));
+
+    oe_remove_enclave_instance(enclave);
+    enclave->magic = 0;
+
+    /* Free what the clone allocated; what it inherited stays for the next */
+    for (size_t i = 0; i < enclave->host_allocations_capacity; i++)
+        free(enclave->host_allocations[i]);
+
+    free(enclave->host_allocations);
+    enclave->host_allocations = NULL;
+    enclave->num_host_allocations = 0;
+    enclave->host_allocations_capacity = 0;
+
+    oe_mutex_destroy(&enclave->lock);
+
+    /* Discard the pages written by the clone */
+    OE_CHECK(_reserve(enclave->addr, enclave->size));
+
+    snapshot->cloned = false;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_free_enclave_snapshot(oe_enclave_snapshot_t* snapshot)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_enclave_t* enclave;
+
+    if (!snapshot)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (snapshot->cloned)
+        OE_RAISE(OE_BUSY);
+
+    enclave = snapshot->enclave;
+    munmap((void*)enclave->addr, enclave->size);
+
+    for (size_t i = 0; i < snapshot->host_allocations_capacity; i++)
+        free(snapshot->host_allocations[i]);
+
+    free(snapshot->host_allocations);
+    free(enclave->path);
+    free(enclave->ecall_pools);
+    memset(enclave, 0, sizeof(oe_enclave_t));
+    free(enclave);
+    _free_snapshot(snapshot);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Whether the memory was inherited from the snapshot of a clone */
+static bool _is_inherited(const oe_enclave_t* enclave, void* ptr)
+{
+    const oe_enclave_snapshot_t* snapshot = enclave->snapshot;
+
+    return snapshot && _find(
+                           snapshot->host_allocations,
+                           snapshot->host_allocations_capacity,
+                           ptr,
+                           NULL);
+}
+
+#else /* !defined(__linux__) */
+
+oe_result_t oe_snapshot_enclave(
+    oe_enclave_t* enclave,
+    oe_enclave_snapshot_t** snapshot)
+{
+    OE_UNUSED(enclave);
+
+    if (snapshot)
+        *snapshot = NULL;
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_clone_enclave(
+    oe_enclave_snapshot_t* snapshot,
+    oe_enclave_t** enclave)
+{
+    OE_UNUSED(snapshot);
+
+    if (enclave)
+        *enclave = NULL;
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_free_enclave_snapshot(oe_enclave_snapshot_t* snapshot)
+{
+    OE_UNUSED(snapshot);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_sgx_terminate_clone(oe_enclave_t* enclave)
+{
+    OE_UNUSED(enclave);
+    return OE_UNSUPPORTED;
+}
+
+static bool _is_inherited(const oe_enclave_t* enclave, void* ptr)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(ptr);
+    return false;
+}
+
+#endif /* defined(__linux__) */
+
+void oe_sgx_handle_sim_host_allocation(
+    oe_enclave_t* enclave,
+    uint16_t func,
+    uint64_t arg_in,
+    uint64_t* arg_out)
+{
+    oe_mutex_lock(&enclave->lock);
+
+    switch ((oe_func_t)func)
+    {
+        case OE_OCALL_MALLOC:
+        {
+            HandleMalloc(arg_in, arg_out);
+
+            if (arg_out && *arg_out)
+                _add(enclave, (void*)*arg_out);
+
+            break;
+        }
+        case OE_OCALL_REALLOC:
+        {
+            oe_realloc_args_t* args = (oe_realloc_args_t*)arg_in;
+
+            /* The size of inherited memory is unknown, so it cannot be
+             * copied to a new block and clones fail to resize it */
+            if (!args || _is_inherited(enclave, args->ptr))
+                break;
+
+            HandleRealloc(arg_in, arg_out);
+
+            if (arg_out && *arg_out)
+            {
+                _remove(enclave, args->ptr);
+                _add(enclave, (void*)*arg_out);
+            }
+
+            break;
+        }
+        case OE_OCALL_FREE:
+        {
+            void* ptr = (void*)arg_in;
+
+            if (!_remove(enclave, ptr) && _is_inherited(enclave, ptr))
+                break;
+
+            HandleFree(arg_in);
+            break;
+        }
+        default:
+            break;
+    }
+
+    oe_mutex_unlock(&enclave->lock);
+}
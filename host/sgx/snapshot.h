@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_SNAPSHOT_H
+#define _OE_HOST_SGX_SNAPSHOT_H
+
+#include <openenclave/host.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** oe_sgx_handle_sim_host_allocation()
+**
+**     Handles OE_OCALL_MALLOC, OE_OCALL_REALLOC and OE_OCALL_FREE for a
+**     simulated enclave, recording the host memory it holds. A snapshot
+**     inherits that memory, which its clones must neither free nor resize.
+**
+**==============================================================================
+*/
+
+void oe_sgx_handle_sim_host_allocation(
+    oe_enclave_t* enclave,
+    uint16_t func,
+    uint64_t arg_in,
+    uint64_t* arg_out);
+
+/*
+**==============================================================================
+**
+** oe_sgx_terminate_clone()
+**
+**     Discards a clone created by oe_clone_enclave(), called by
+**     oe_terminate_enclave().
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_terminate_clone(oe_enclave_t* enclave);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_SGX_SNAPSHOT_H */
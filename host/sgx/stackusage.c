@@ -0,0 +1,166 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "stackusage.h"
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/utils.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../dupenv.h"
+#include "enclave.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Reads enclave memory. The SGX driver lets the host read the memory of a
+ * debug enclave through /proc/self/mem (or ReadProcessMemory() on Windows),
+ * whereas a direct access would only see the abort page. */
+static oe_result_t _read_enclave_memory(
+    const oe_enclave_t* enclave,
+    uint64_t addr,
+    void* buffer,
+    size_t size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (enclave->simulate)
+    {
+        memcpy(buffer, (const void*)addr, size);
+    }
+    else
+    {
+#if defined(__linux__)
+        int fd = open("/proc/self/mem", O_RDONLY);
+        ssize_t n;
+
+        if (fd == -1)
+            OE_RAISE(OE_FAILURE);
+
+        n = pread(fd, buffer, size, (off_t)addr);
+        close(fd);
+
+        if (n < 0 || (size_t)n != size)
+            OE_RAISE(OE_FAILURE);
+#elif defined(_WIN32)
+        SIZE_T n = 0;
+
+        if (!ReadProcessMemory(
+                GetCurrentProcess(), (LPCVOID)addr, buffer, size, &n) ||
+            n != size)
+            OE_RAISE(OE_FAILURE);
+#endif
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/* Gets the deepest use of the stack that lies below the given TCS */
+static oe_result_t _get_used(
+    const oe_enclave_t* enclave,
+    uint64_t tcs,
+    uint64_t* used)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const uint64_t stack_size = enclave->num_stack_pages * OE_PAGE_SIZE;
+    /* A guard page separates the top of the stack from the TCS pages */
+    const uint64_t top = tcs - OE_PAGE_SIZE;
+    uint32_t page[OE_PAGE_SIZE / sizeof(uint32_t)];
+
+    *used = 0;
+
+    /* Scan up from the bottom, since stacks grow down */
+    for (uint64_t addr = top - stack_size; addr < top; addr += OE_PAGE_SIZE)
+    {
+        OE_CHECK(_read_enclave_memory(enclave, addr, page, sizeof(page)));
+
+        for (size_t i = 0; i < OE_COUNTOF(page); i++)
+        {
+            if (page[i] != OE_SGX_STACK_FILL_PATTERN)
+            {
+                *used = top - (addr + i * sizeof(uint32_t));
+                result = OE_OK;
+                goto done;
+            }
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_sgx_get_stack_usage(
+    oe_enclave_t* enclave,
+    oe_sgx_stack_usage_t* usage)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (usage)
+        memset(usage, 0, sizeof(*usage));
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !usage)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!enclave->debug && !enclave->simulate)
+        OE_RAISE(OE_UNSUPPORTED);
+
+    usage->stack_size = enclave->num_stack_pages * OE_PAGE_SIZE;
+    usage->num_stacks = enclave->num_bindings;
+
+    for (size_t i = 0; i < enclave->num_bindings; i++)
+    {
+        OE_CHECK(_get_used(enclave, enclave->bindings[i].tcs, &usage->used[i]));
+
+        if (usage->used[i] > usage->max_used)
+            usage->max_used = usage->used[i];
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_sgx_report_stack_usage(oe_enclave_t* enclave)
+{
+    char* env = NULL;
+    oe_sgx_stack_usage_t usage;
+
+    if (!(env = oe_dupenv(OE_STACK_USAGE_ENV)))
+        return;
+
+    if (oe_sgx_get_stack_usage(enclave, &usage) != OE_OK)
+    {
+        fprintf(stderr, "%s: cannot read the stack usage\n", enclave->path);
+        goto done;
+    }
+
+    fprintf(
+        stderr,
+        "%s: stack usage: %llu of %llu bytes (%llu of %llu pages)\n",
+        enclave->path,
+        (unsigned long long)usage.max_used,
+        (unsigned long long)usage.stack_size,
+        (unsigned long long)oe_round_up_to_page_size(usage.max_used) /
+            OE_PAGE_SIZE,
+        (unsigned long long)enclave->num_stack_pages);
+
+    for (size_t i = 0; i < usage.num_stacks; i++)
+    {
+        fprintf(
+            stderr,
+            "    TCS %zu: %llu bytes\n",
+            i,
+            (unsigned long long)usage.used[i]);
+    }
+
+done:
+    free(env);
+}
@@ -0,0 +1,68 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_STACKUSAGE_H
+#define _OE_HOST_STACKUSAGE_H
+
+#include <openenclave/bits/properties.h>
+#include <openenclave/host.h>
+
+OE_EXTERNC_BEGIN
+
+/* The pattern that fills every stack page when the enclave is created */
+#define OE_SGX_STACK_FILL_PATTERN 0xcccccccc
+
+/* If set, the stack usage is written to stderr when an enclave terminates */
+#define OE_STACK_USAGE_ENV "OE_REPORT_STACK_USAGE"
+
+typedef struct _oe_sgx_stack_usage
+{
+    /* Size in bytes of each stack (NumStackPages * OE_PAGE_SIZE) */
+    uint64_t stack_size;
+
+    /* Number of stacks, one per TCS */
+    size_t num_stacks;
+
+    /* Deepest use in bytes of each stack since the enclave was created */
+    uint64_t used[OE_SGX_MAX_TCS];
+
+    /* Deepest use in bytes of any stack */
+    uint64_t max_used;
+} oe_sgx_stack_usage_t;
+
+/*
+**==============================================================================
+**
+** oe_sgx_get_stack_usage()
+**
+**     Gets the high-water mark of each TCS stack of a debug or simulated
+**     enclave, by scanning the stack from its lowest address for the first
+**     word that no longer holds OE_SGX_STACK_FILL_PATTERN. This tells how
+**     many of the NumStackPages pages have ever been used.
+**
+**     Fails with OE_UNSUPPORTED for production enclaves, whose memory cannot
+**     be read by the host.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_get_stack_usage(
+    oe_enclave_t* enclave,
+    oe_sgx_stack_usage_t* usage);
+
+/*
+**==============================================================================
+**
+** oe_sgx_report_stack_usage()
+**
+**     Writes the stack usage of the enclave to stderr if OE_STACK_USAGE_ENV
+**     is set. Called when the enclave terminates.
+**
+**==============================================================================
+*/
+
+void oe_sgx_report_stack_usage(oe_enclave_t* enclave);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOST_STACKUSAGE_H */
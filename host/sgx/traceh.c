@@ -245,3 +245,15 @@ log_level_t get_current_logging_level(void)
 {
     return _log_level;
 }
+
+log_level_t set_current_logging_level(log_level_t level)
+{
+    log_level_t previous;
+
+    /* Read the environment first, so that it does not override the level */
+    _initialize_log_config();
+    previous = _log_level;
+    _log_level = level;
+
+    return previous;
+}
@@ -7,8 +7,12 @@
 #include <openenclave/bits/defs.h>
 #include <openenclave/bits/types.h>
 
+OE_EXTERNC_BEGIN
+
 extern const uint8_t OE_DEBUG_SIGN_KEY[];
 
 extern size_t OE_DEBUG_SIGN_KEY_SIZE;
 
+OE_EXTERNC_END
+
 #endif /* _OE_HOST_SIGNKEY_H */
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/**
+ * @file compressed.h
+ *
+ * This file defines the interface to read-only data that "oesign compress"
+ * stores compressed in the enclave image.
+ *
+ */
+#ifndef _OE_BITS_COMPRESSED_H
+#define _OE_BITS_COMPRESSED_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Name of the enclave image section that holds compressed data.
+ */
+#define OE_COMPRESSED_SECTION_NAME ".oecompressed"
+
+/**
+ * Descriptor of compressed data embedded in the enclave image.
+ *
+ * "oesign compress -i INPUT -o OUTPUT.c -n NAME" generates OUTPUT.c, which
+ * defines the descriptor NAME, and OUTPUT.bin, the compressed image that
+ * OUTPUT.c includes in the enclave image. Compile OUTPUT.c into the enclave
+ * and declare the descriptor where it is used:
+ *
+ *     extern oe_compressed_data_t NAME;
+ *
+ * The fields are private.
+ */
+typedef struct _oe_compressed_data
+{
+    const void* image;
+    size_t image_size;
+
+    /* Filled in on first use by oe_get_compressed_data() */
+    uint32_t lock;
+    bool initialized;
+    oe_result_t result;
+    void* data;
+    size_t size;
+} oe_compressed_data_t;
+
+/**
+ * Initializer of a descriptor for the compressed image of the given size.
+ */
+#define OE_COMPRESSED_DATA_INITIALIZER(IMAGE, IMAGE_SIZE) \
+    {                                                     \
+        (IMAGE), (IMAGE_SIZE), 0, false, OE_OK, NULL, 0   \
+    }
+
+/**
+ * Returns the decompressed contents of compressed enclave data.
+ *
+ * The first call decompresses the image into the enclave heap and verifies
+ * its SHA-256 digest. Later calls (from any thread) return the cached copy.
+ * Decompression runs without the descriptor's lock held, so threads racing
+ * on the first call may each decompress; only the first copy is published
+ * and the others are freed. The decompressed data lives until
+ * oe_release_compressed_data() is called.
+ *
+ * @param compressed The compressed data descriptor.
+ * @param data[out] The decompressed data.
+ * @param size[out] The size of the decompressed data in bytes.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if the image does not lie inside the enclave
+ *          or is malformed.
+ * @returns OE_VERIFY_FAILED if the decompressed data does not match its
+ *          digest.
+ */
+oe_result_t oe_get_compressed_data(
+    oe_compressed_data_t* compressed,
+    const void** data,
+    size_t* size);
+
+/**
+ * Releases the decompressed copy of compressed enclave data.
+ *
+ * The next call to oe_get_compressed_data() decompresses the image again.
+ * The caller must ensure that no other thread is using the data.
+ *
+ * @param compressed The compressed data descriptor.
+ */
+void oe_release_compressed_data(oe_compressed_data_t* compressed);
+
+OE_EXTERNC_END
+
+#endif /* _OE_BITS_COMPRESSED_H */
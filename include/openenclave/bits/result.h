@@ -269,6 +269,11 @@ typedef enum _oe_result
      */
     OE_VERIFY_CRL_EXPIRED,
 
+    /**
+     * The enclave function call was cancelled or exceeded its deadline.
+     */
+    OE_CANCELED,
+
     __OE_RESULT_MAX = OE_ENUM_MAX,
 } oe_result_t;
 /**< typedef enum _oe_result oe_result_t*/
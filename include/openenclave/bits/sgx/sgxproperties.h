@@ -33,13 +33,23 @@ typedef struct _oe_sgx_enclave_image_info_t
 #define OE_SGX_FLAGS_MODE64BIT 0x0000000000000004ULL
 #define OE_SGX_SIGSTRUCT_SIZE 1808
 
+// oe_sgx_enclave_config_t.flags: options that change how the enclave is laid
+// out and measured. Set at sign time by the oesign tool.
+#define OE_SGX_CONFIG_FLAGS_COMPACT_RELOCATIONS 0x00000001U
+#define OE_SGX_CONFIG_FLAGS_MASK OE_SGX_CONFIG_FLAGS_COMPACT_RELOCATIONS
+
 typedef struct oe_sgx_enclave_config_t
 {
     uint16_t product_id;
     uint16_t security_version;
 
-    /* Padding to make packed and unpacked size the same */
-    uint32_t padding;
+    /* (OE_SGX_CONFIG_FLAGS_*). Also keeps packed and unpacked size the same.
+     * padding is the former name of the field, kept for source
+     * compatibility; new code should use flags. */
+    union {
+        uint32_t flags;
+        uint32_t padding;
+    };
 
     /* (OE_SGX_FLAGS_DEBUG | OE_SGX_FLAGS_MODE64BIT) */
     uint64_t attributes;
@@ -123,7 +133,7 @@ typedef struct _oe_sgx_enclave_properties
         {                                                                 \
             .product_id = PRODUCT_ID,                                     \
             .security_version = SECURITY_VERSION,                         \
-            .padding = 0,                                                 \
+            .flags = 0,                                                   \
             .attributes = OE_MAKE_ATTRIBUTES(ALLOW_DEBUG)                 \
         },                                                                \
         .image_info =                                                     \
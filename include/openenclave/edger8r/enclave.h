@@ -92,6 +92,56 @@ void* oe_allocate_ocall_buffer(size_t size);
  */
 void oe_free_ocall_buffer(void* buffer);
 
+/**
+ * Copy an [in] parameter that has the sha256 attribute into the enclave.
+ *
+ * The parameter is not marshalled by the host. Instead, it is copied from
+ * host memory into ecall-scoped enclave memory and its SHA-256 digest is
+ * computed in the same pass.
+ *
+ * @param host_ptr The parameter as passed by the host.
+ * @param size The size of the parameter in bytes.
+ * @param enclave_ptr Receives the address of the copy in enclave memory.
+ * @param digest Buffer that receives the 32-byte SHA-256 digest.
+ * @param digest_size The size of the digest buffer.
+ *
+ * @return OE_OK the parameter was copied.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ * @return OE_OUT_OF_MEMORY the copy could not be allocated.
+ */
+oe_result_t oe_copy_in_sha256_param(
+    const void* host_ptr,
+    size_t size,
+    void** enclave_ptr,
+    void* digest,
+    size_t digest_size);
+
+/**
+ * Copy an [in] parameter that has the sha256 attribute into the enclave and
+ * write its digest to the given out parameter, whose pointer must already
+ * have been set with OE_SET_OUT_POINTER.
+ */
+#define OE_COPY_IN_SHA256_POINTER(                                      \
+    argname, argsize, argtype, digestname, digestsize)                  \
+    if (pargs_in->argname)                                              \
+    {                                                                   \
+        void* _p_in = NULL;                                             \
+        if (!pargs_in->digestname)                                      \
+        {                                                               \
+            _result = OE_INVALID_PARAMETER;                             \
+            goto done;                                                  \
+        }                                                               \
+        _result = oe_copy_in_sha256_param(                              \
+            (const void*)pargs_in->argname,                             \
+            (size_t)(argsize),                                          \
+            &_p_in,                                                     \
+            (void*)pargs_in->digestname,                                \
+            (size_t)(digestsize));                                      \
+        if (_result != OE_OK)                                           \
+            goto done;                                                  \
+        pargs_in->argname = (argtype)_p_in;                             \
+    }
+
 /**
  * For hand-written enclaves, that use the older calling mechanism, define empty
  * ecall tables.
@@ -14,6 +14,7 @@
 #error "enclave.h and host.h must not be included in the same compilation unit."
 #endif
 
+#include "bits/compressed.h"
 #include "bits/defs.h"
 #include "bits/exception.h"
 #include "bits/properties.h"
@@ -109,8 +110,10 @@ bool oe_is_outside_enclave(const void* ptr, size_t size);
  *
  * This function allocates **size** bytes from the host's heap and returns the
  * address of the allocated memory. The implementation performs an OCALL to
- * the host, which calls malloc(). To free the memory, it must be passed to
- * oe_host_free().
+ * the host, which calls malloc(), unless the enclave has enabled the host
+ * heap (see oe_host_heap_enable()), in which case small requests are served
+ * inside the enclave from memory donated by the host. To free the memory, it
+ * must be passed to oe_host_free().
  *
  * @param size The number of bytes to be allocated.
  *
@@ -125,8 +128,9 @@ void* oe_host_malloc(size_t size);
  * This function changes the size of the memory block pointed to by **ptr**
  * on the host's heap to **size** bytes. The memory block may be moved to a
  * new location, which is returned by this function. The implementation
- * performs an OCALL to the host, which calls realloc(). To free the memory,
- * it must be passed to oe_host_free().
+ * performs an OCALL to the host, which calls realloc(), unless **ptr** was
+ * allocated from the host heap. To free the memory, it must be passed to
+ * oe_host_free().
  *
  * @param ptr The memory block to change the size of. If NULL, this method
  * allocates **size** bytes as if oe_host_malloc was invoked. If not NULL,
@@ -149,8 +153,8 @@ void* oe_host_realloc(void* ptr, size_t size);
  *
  * This function allocates **size** bytes from the host's heap and fills it
  * with zero character. It returns the address of the allocated memory. The
- * implementation performs an OCALL to the host, which calls calloc().
- * To free the memory, it must be passed to oe_host_free().
+ * memory is obtained as by oe_host_malloc(). To free the memory, it must be
+ * passed to oe_host_free().
  *
  * @param nmemb The number of elements to be allocated and zero-filled.
  * @param size The size of each element.
@@ -164,7 +168,9 @@ void* oe_host_calloc(size_t nmemb, size_t size);
  * Release allocated memory.
  *
  * This function releases memory allocated with oe_host_malloc() or
- * oe_host_calloc() by performing an OCALL where the host calls free().
+ * oe_host_calloc(). Blocks from the host heap are released inside the
+ * enclave; other memory is released by performing an OCALL where the host
+ * calls free().
  *
  * @param ptr Pointer to memory to be released or null.
  *
@@ -63,6 +63,46 @@ typedef void (*oe_ocall_func_t)(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * Maximum number of TCS pools in an oe_sgx_create_config_t.
+ */
+#define OE_SGX_MAX_TCS_POOLS 8
+
+/**
+ * A number of enclave threads (TCSs) reserved for a class of ecalls.
+ *
+ * Ecalls of the enclave functions listed in a pool first try the TCSs
+ * reserved for that pool, and then the TCSs that no pool reserved. All other
+ * ecalls only use the TCSs that no pool reserved, so a burst of them cannot
+ * keep the ecalls of a pool from getting a TCS.
+ */
+typedef struct _oe_sgx_tcs_pool
+{
+    /** The number of TCSs reserved for the pool */
+    uint32_t num_tcs;
+
+    /** The ids of the enclave functions of the pool, which oeedger8r
+     *  generates as **fcn_id_<name>** */
+    const uint32_t* function_ids;
+
+    /** The number of elements in **function_ids** */
+    uint32_t num_function_ids;
+} oe_sgx_tcs_pool_t;
+
+/**
+ * Configuration of an SGX enclave passed to oe_create_enclave().
+ */
+typedef struct _oe_sgx_create_config
+{
+    /** The TCS pools of the enclave. Together they must leave at least one
+     *  TCS unreserved. A function may only belong to one pool. */
+    const oe_sgx_tcs_pool_t* tcs_pools;
+
+    /** The number of elements in **tcs_pools**, at most
+     *  OE_SGX_MAX_TCS_POOLS */
+    uint32_t num_tcs_pools;
+} oe_sgx_create_config_t;
+
 /**
  * Create an enclave from an enclave image file.
  *
@@ -83,7 +123,8 @@ typedef void (*oe_ocall_func_t)(
  *                               DO NOT SHIP CODE with this flag
  *
  * @param config Additional enclave creation configuration data for the specific
- * enclave type. This parameter is reserved and must be NULL.
+ * enclave type. For SGX enclaves, this is either NULL or a pointer to an
+ * oe_sgx_create_config_t.
  *
  * @param config_size The size of the **config** data buffer in bytes.
  *
@@ -121,6 +162,122 @@ oe_result_t oe_create_enclave(
  */
 oe_result_t oe_terminate_enclave(oe_enclave_t* enclave);
 
+/**
+ * A snapshot of an initialized simulation-mode enclave.
+ */
+typedef struct _oe_enclave_snapshot oe_enclave_snapshot_t;
+
+/**
+ * Snapshot an initialized simulation-mode enclave.
+ *
+ * This function captures the memory image of the enclave, including the
+ * state left by its global constructors, so that oe_clone_enclave() can
+ * recreate the enclave without loading and initializing it again.
+ *
+ * The enclave is consumed: on success, **enclave** may no longer be used and
+ * its address range is reserved for the clones. Since the memory image holds
+ * absolute addresses, all clones occupy that same range, so only one clone
+ * of a snapshot may exist at a time.
+ *
+ * The enclave must have been created with OE_ENCLAVE_FLAG_SIMULATE and no
+ * ecall may be in progress. This is only supported on Linux.
+ *
+ * @param enclave The enclave to snapshot.
+ * @param snapshot[out] The snapshot, to be released with
+ *        oe_free_enclave_snapshot().
+ *
+ * @returns OE_OK on success.
+ * @returns OE_UNSUPPORTED if the enclave is not simulated or the platform
+ *          does not support snapshots.
+ * @returns OE_BUSY if an ecall is in progress.
+ */
+oe_result_t oe_snapshot_enclave(
+    oe_enclave_t* enclave,
+    oe_enclave_snapshot_t** snapshot);
+
+/**
+ * Create an enclave from a snapshot.
+ *
+ * The memory image of the snapshot is mapped copy-on-write, so the clone
+ * starts in the state the snapshotted enclave was in, at the cost of a few
+ * system calls. Terminating a clone with oe_terminate_enclave() discards it
+ * without running the enclave's destructors.
+ *
+ * @param snapshot The snapshot.
+ * @param enclave[out] The new enclave.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_BUSY if another clone of the snapshot has not been terminated.
+ */
+oe_result_t oe_clone_enclave(
+    oe_enclave_snapshot_t* snapshot,
+    oe_enclave_t** enclave);
+
+/**
+ * Release a snapshot and the address range reserved for its clones.
+ *
+ * @param snapshot The snapshot.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_BUSY if a clone of the snapshot has not been terminated.
+ */
+oe_result_t oe_free_enclave_snapshot(oe_enclave_snapshot_t* snapshot);
+
+/**
+ * A token that cancels the enclave function calls it is attached to.
+ *
+ * Define tokens with OE_CANCELLATION_TOKEN_INITIALIZER and attach them to
+ * calls with oe_set_call_options().
+ */
+typedef struct _oe_cancellation_token
+{
+    /** Nonzero once oe_cancel() was called */
+    volatile uint32_t cancelled;
+} oe_cancellation_token_t;
+
+#define OE_CANCELLATION_TOKEN_INITIALIZER \
+    {                                     \
+        0                                 \
+    }
+
+/**
+ * Cancel the enclave function calls that use the given token.
+ *
+ * This function may be called from any thread. Cancellation is cooperative:
+ * a running call only stops once the enclave function polls
+ * oe_is_call_cancelled(), and the call then fails with OE_CANCELED. Calls
+ * made with the token after it was cancelled are cancelled from the start.
+ *
+ * @param token The token to cancel.
+ */
+void oe_cancel(oe_cancellation_token_t* token);
+
+/**
+ * Options of the enclave function calls made by a thread.
+ */
+typedef struct _oe_call_options
+{
+    /** A token that cancels the calls, or NULL */
+    oe_cancellation_token_t* token;
+
+    /** The time after which each call is cancelled in milliseconds, or zero
+     *  for no deadline */
+    uint64_t timeout_ms;
+} oe_call_options_t;
+
+/**
+ * Set the options of the enclave function calls made by the calling thread.
+ *
+ * The options apply to all enclave function calls the calling thread makes
+ * until this function is called again. The structure is not copied and must
+ * remain valid until then. Pass NULL to remove the options.
+ *
+ * @param options The options of the calls, or NULL.
+ *
+ * @returns OE_OK on success.
+ */
+oe_result_t oe_set_call_options(const oe_call_options_t* options);
+
 #if (OE_API_VERSION < 2)
 #define oe_get_report oe_get_report_v1
 #else
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_ARENA_H
+#define _OE_ARENA_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/* Alignment of every block returned by oe_arena_alloc() */
+#define OE_ARENA_ALIGNMENT 16
+
+/* Upper bound on the per-thread arena capacity */
+#define OE_ARENA_MAX_CAPACITY (64 * 1024 * 1024)
+
+/**
+ * Enables the per-thread ecall arena.
+ *
+ * Each enclave thread (TCS) lazily allocates an arena of **capacity** bytes
+ * from the enclave heap the first time oe_arena_alloc() is called on that
+ * thread. The arena is kept for the lifetime of the enclave and is rewound
+ * each time the outermost ecall on the thread returns.
+ *
+ * The capacity only applies to threads that have not yet allocated their
+ * arena, so this function is typically called once from an enclave
+ * constructor or from the first ecall. A capacity of zero (the default)
+ * disables the arena, in which case oe_arena_alloc() serves every request
+ * from the heap.
+ *
+ * @param capacity The size of each per-thread arena in bytes.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **capacity** exceeds OE_ARENA_MAX_CAPACITY.
+ */
+oe_result_t oe_arena_set_capacity(size_t capacity);
+
+/**
+ * Allocates memory whose lifetime is bound to the current ecall.
+ *
+ * The memory is carved from the calling thread's arena by bumping a pointer.
+ * If the arena is disabled or exhausted, the block is allocated from the
+ * enclave heap instead. Either way, the caller never frees the block: all
+ * blocks are released together when the outermost ecall on the calling
+ * thread returns to the host. Blocks allocated by a nested ecall (see
+ * oe_set_max_nested_ecall_depth()) are released when that ecall returns.
+ *
+ * Blocks are aligned on OE_ARENA_ALIGNMENT bytes.
+ *
+ * @param size The number of bytes to allocate.
+ *
+ * @returns The allocated memory or NULL if out of memory.
+ */
+void* oe_arena_alloc(size_t size);
+
+/**
+ * Allocates zero-filled memory whose lifetime is bound to the current ecall.
+ *
+ * @param nmemb The number of elements to allocate.
+ * @param size The size of each element.
+ *
+ * @returns The allocated memory or NULL if out of memory.
+ */
+void* oe_arena_calloc(size_t nmemb, size_t size);
+
+typedef struct _oe_arena_stats
+{
+    /* Capacity of the calling thread's arena (zero if not yet allocated) */
+    uint64_t capacity;
+
+    /* Bytes currently carved from the calling thread's arena */
+    uint64_t used_bytes;
+
+    /* Largest value of used_bytes observed on the calling thread */
+    uint64_t peak_bytes;
+
+    /* Number of requests that overflowed to the heap on this thread */
+    uint64_t overflow_count;
+} oe_arena_stats_t;
+
+/**
+ * Obtains arena statistics for the calling thread.
+ *
+ * @param stats[out] the arena statistics.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **stats** is null.
+ */
+oe_result_t oe_arena_get_stats(oe_arena_stats_t* stats);
+
+OE_EXTERNC_END
+
+#endif /* _OE_ARENA_H */
@@ -300,6 +300,112 @@ oe_result_t oe_asn1_get_octet_string(
     const uint8_t** data,
     size_t* length);
 
+/**
+ * Gets a DER length from the ASN.1 input stream.
+ *
+ * This function reads the length octets at the current position and advances
+ * the current position just beyond them. Indefinite and non-minimal
+ * encodings are rejected, as are lengths that run past the end of the stream.
+ *
+ * @param asn1[in,out] the ASN.1 input stream.
+ * @param length[out] the length.
+ *
+ * @return OE_OK success
+ * @return OE_INVALID_PARAMETER a parameter is invalid
+ * @return OE_FAILURE general failure
+ */
+oe_result_t oe_asn1_get_length(oe_asn1_t* asn1, size_t* length);
+
+/* Number of extensions an extension index holds without allocating */
+#define OE_ASN1_INLINE_EXTENSIONS 32
+
+/* An X.509 extension within the DER data it was indexed from */
+typedef struct _oe_asn1_extension
+{
+    /* The contents of the extnID element */
+    const uint8_t* oid;
+    size_t oid_size;
+
+    /* The critical flag (false when absent) */
+    bool critical;
+
+    /* The contents of the extnValue octet string */
+    const uint8_t* data;
+    size_t size;
+} oe_asn1_extension_t;
+
+/* Index of the extensions of an X.509 certificate */
+typedef struct _oe_asn1_extensions
+{
+    size_t count;
+    oe_asn1_extension_t entries[OE_ASN1_INLINE_EXTENSIONS];
+
+    /* Entries past the inline ones, allocated only for certificates with
+     * more than OE_ASN1_INLINE_EXTENSIONS extensions */
+    oe_asn1_extension_t* overflow;
+} oe_asn1_extensions_t;
+
+/**
+ * Indexes the extensions of an X.509 certificate.
+ *
+ * This function walks the DER-encoded Extensions SEQUENCE once and records
+ * where the OID and value of each extension are. Nothing is copied, so the
+ * DER data must outlive the index. The first OE_ASN1_INLINE_EXTENSIONS
+ * entries are stored in the index itself; any further entries are stored in
+ * a heap array, so the index must be released with
+ * oe_asn1_free_extensions().
+ *
+ * @param der[in] the DER-encoded Extensions SEQUENCE.
+ * @param der_size[in] the size of the DER data.
+ * @param extensions[out] the index.
+ *
+ * @return OE_OK success
+ * @return OE_INVALID_PARAMETER a parameter is invalid
+ * @return OE_OUT_OF_MEMORY the overflow entries could not be allocated
+ * @return OE_FAILURE the DER data is malformed
+ */
+oe_result_t oe_asn1_index_extensions(
+    const uint8_t* der,
+    size_t der_size,
+    oe_asn1_extensions_t* extensions);
+
+/**
+ * Releases the overflow entries of an extension index.
+ *
+ * The index is left empty. Releasing an empty index does nothing.
+ *
+ * @param extensions[in,out] the index built by oe_asn1_index_extensions().
+ */
+void oe_asn1_free_extensions(oe_asn1_extensions_t* extensions);
+
+/**
+ * Gets an entry of an extension index.
+ *
+ * @param extensions[in] the index built by oe_asn1_index_extensions().
+ * @param index[in] the position of the entry, less than extensions->count.
+ *
+ * @return the entry, or NULL if **index** is out of range
+ */
+const oe_asn1_extension_t* oe_asn1_get_extension(
+    const oe_asn1_extensions_t* extensions,
+    size_t index);
+
+/**
+ * Finds the extension with the given OID in an extension index.
+ *
+ * @param extensions[in] the index built by oe_asn1_index_extensions().
+ * @param oid[in] the OID in dotted string form (e.g. "2.5.29.19").
+ * @param extension[out] the matching extension.
+ *
+ * @return OE_OK success
+ * @return OE_INVALID_PARAMETER a parameter is invalid
+ * @return OE_NOT_FOUND no extension has the given OID
+ */
+oe_result_t oe_asn1_find_extension(
+    const oe_asn1_extensions_t* extensions,
+    const char* oid,
+    const oe_asn1_extension_t** extension);
+
 OE_EXTERNC_END
 
 #endif /* _OE_ASN1_H */
@@ -203,6 +203,12 @@ typedef struct _oe_call_enclave_function_args
     size_t output_buffer_size;
     size_t output_bytes_written;
     oe_result_t result;
+
+    /* Host flags that ask the function to stop, or null. These fields
+     * change the layout shared by the host and the enclave, so both must
+     * be built from the same release */
+    const volatile uint32_t* cancelled;
+    const volatile uint32_t* expired;
 } oe_call_enclave_function_args_t;
 
 /*
@@ -379,6 +385,45 @@ oe_result_t oe_ecall(
  */
 oe_result_t oe_ocall(uint16_t func, uint64_t arg_in, uint64_t* arg_out);
 
+/* Upper bound on the depth accepted by oe_set_max_nested_ecall_depth() */
+#define OE_MAX_NESTED_ECALL_DEPTH 16
+
+/**
+ * Allows the host to call enclave functions from within an ocall.
+ *
+ * By default, an ecall made by the host while an ocall of the same thread
+ * is pending fails with OE_REENTRANT_ECALL. This function lets such nested
+ * ecalls call enclave functions on the TCS of the pending ecall, as long as
+ * no more than **max_depth** of them are pending at once on that thread.
+ * Each nested ecall runs on the enclave stack below the pending ocall, so
+ * the enclave must be configured with enough stack pages for the deepest
+ * nesting it allows.
+ *
+ * A depth of zero (the default) disallows nested ecalls again.
+ *
+ * @param max_depth The maximum number of nested ecalls per thread.
+ *
+ * @retval OE_OK The function was successful.
+ * @retval OE_INVALID_PARAMETER **max_depth** exceeds OE_MAX_NESTED_ECALL_DEPTH.
+ */
+oe_result_t oe_set_max_nested_ecall_depth(uint32_t max_depth);
+
+/**
+ * Checks whether the host gave up on the current enclave function call.
+ *
+ * The host cancels a call through the oe_cancellation_token_t of its
+ * oe_call_options_t, or when the timeout of those options expires. The enclave
+ * function is expected to poll this function, which only reads two words of
+ * host memory, and to return early once it returns true.
+ *
+ * Once this function has returned true, the call fails with OE_CANCELED and
+ * its outputs are not copied back to the host. The host controls the result,
+ * so it must not be used to make security decisions.
+ *
+ * @returns true if the call was cancelled or exceeded its deadline.
+ */
+bool oe_is_call_cancelled(void);
+
 OE_EXTERNC_END
 
 #endif /* _OE_CALLS_H */
@@ -56,6 +56,25 @@ oe_result_t oe_cert_read_pem(
     const void* pem_data,
     size_t pem_size);
 
+/**
+ * Read a certificate from DER format
+ *
+ * This function reads a certificate from a single DER encoded X.509
+ * certificate, skipping the PEM and base64 decoding of oe_cert_read_pem().
+ * The caller is responsible for releasing the certificate by passing it to
+ * oe_cert_free().
+ *
+ * @param cert initialized certificate handle upon return
+ * @param der_data DER data
+ * @param der_size size of the DER data
+ *
+ * @return OE_OK load was successful
+ */
+oe_result_t oe_cert_read_der(
+    oe_cert_t* cert,
+    const void* der_data,
+    size_t der_size);
+
 /**
  * Read a certificate chain from PEM format.
  *
@@ -88,6 +107,49 @@ oe_result_t oe_cert_chain_read_pem(
     const void* pem_data,
     size_t pem_size);
 
+/**
+ * Read a certificate chain from DER format.
+ *
+ * This function reads a certificate chain from one or more DER encoded X.509
+ * certificates laid out back to back. The resulting chain is ordered and
+ * verified exactly as by oe_cert_chain_read_pem(). The caller is responsible
+ * for releasing the certificate chain by passing it to oe_cert_chain_free().
+ *
+ * @param chain initialized certificate chain handle upon return
+ * @param der_data concatenated DER certificates
+ * @param der_size size of the DER data
+ *
+ * @return OE_OK load was successful
+ */
+oe_result_t oe_cert_chain_read_der(
+    oe_cert_chain_t* chain,
+    const void* der_data,
+    size_t der_size);
+
+#ifndef OE_BUILD_ENCLAVE
+/**
+ * Convert a PEM certificate chain to concatenated DER certificates (host only)
+ *
+ * This function decodes each certificate of a PEM chain and writes its DER
+ * encoding to **der_data**, in the order the certificates appear, producing
+ * the input expected by oe_cert_chain_read_der(). The PEM data need not be
+ * zero-terminated. The DER output is never larger than **pem_size**.
+ *
+ * @param pem_data PEM certificate chain
+ * @param pem_size size of the PEM data
+ * @param der_data buffer that receives the DER certificates (may be null)
+ * @param der_size size of **der_data**; set to the required size on return
+ *
+ * @return OE_OK conversion was successful
+ * @return OE_BUFFER_TOO_SMALL **der_data** is too small
+ */
+oe_result_t oe_cert_chain_pem_to_der(
+    const void* pem_data,
+    size_t pem_size,
+    uint8_t* der_data,
+    size_t* der_size);
+#endif
+
 /**
  * Releases a certificate
  *
@@ -17,6 +17,13 @@ typedef struct _oe_aes_cmac
     uint64_t impl[4];
 } oe_aes_cmac_t;
 
+/* Opaque representation of an AES-CMAC context */
+typedef struct _oe_aes_cmac_context
+{
+    /* Internal implementation */
+    uint64_t impl[32];
+} oe_aes_cmac_context_t;
+
 /**
  * oe_secure_aes_cmac_equal does a secure constant time comparison of two
  * oe_aes_cmac_t instances. Returns 1 if equal and 0 otherwise.
@@ -45,6 +52,71 @@ oe_result_t oe_aes_cmac_sign(
     size_t message_length,
     oe_aes_cmac_t* aes_cmac);
 
+/**
+ * oe_aes_cmac_init initializes a context for computing AES-CMACs with the
+ * given key.
+ *
+ * The expanded key and the CMAC subkeys are computed once and kept in the
+ * context, which may then be used for any number of messages.
+ *
+ * @param context The context to be initialized.
+ * @param key The key used to compute the AES-CMAC.
+ * @param key_size The size of the key in bytes. Only 128-bit keys are
+ * supported.
+ */
+oe_result_t oe_aes_cmac_init(
+    oe_aes_cmac_context_t* context,
+    const uint8_t* key,
+    size_t key_size);
+
+/**
+ * oe_aes_cmac_update extends the AES-CMAC of the current message with
+ * additional data.
+ *
+ * @param context The context of the AES-CMAC.
+ * @param message Pointer to the data.
+ * @param message_length Length of the data in bytes.
+ */
+oe_result_t oe_aes_cmac_update(
+    oe_aes_cmac_context_t* context,
+    const uint8_t* message,
+    size_t message_length);
+
+/**
+ * oe_aes_cmac_final computes the AES-CMAC of the current message and resets
+ * the context for the next message.
+ *
+ * @param context The context of the AES-CMAC.
+ * @param aes_cmac Output parameter where the computed AES-CMAC will be
+ * written to.
+ */
+oe_result_t oe_aes_cmac_final(
+    oe_aes_cmac_context_t* context,
+    oe_aes_cmac_t* aes_cmac);
+
+/**
+ * oe_aes_cmac_compute computes the AES-CMAC of a whole message with the key
+ * of the given context.
+ *
+ * @param context The context of the AES-CMAC.
+ * @param message Pointer to start of the message.
+ * @param message_length Length of the message in bytes.
+ * @param aes_cmac Output parameter where the computed AES-CMAC will be
+ * written to.
+ */
+oe_result_t oe_aes_cmac_compute(
+    oe_aes_cmac_context_t* context,
+    const uint8_t* message,
+    size_t message_length,
+    oe_aes_cmac_t* aes_cmac);
+
+/**
+ * oe_aes_cmac_free clears the key material held by the given context.
+ *
+ * @param context The context to be cleared.
+ */
+oe_result_t oe_aes_cmac_free(oe_aes_cmac_context_t* context);
+
 OE_EXTERNC_END
 
 #endif /* _OE_CMAC_H */
@@ -0,0 +1,147 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_COMPRESS_H
+#define _OE_COMPRESS_H
+
+#include <openenclave/bits/compressed.h>
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include "defs.h"
+#include "sha.h"
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Compressed enclave data:
+**
+**     Large read-only data (models, lookup tables) can be stored compressed
+**     in the enclave image and decompressed into the enclave heap on first
+**     use. The compressed image is produced at build time by
+**     "oesign compress", which writes it to a file along with a C source
+**     file that assembles it into the OE_COMPRESSED_SECTION_NAME section.
+**     Only the compressed bytes are part of the enclave image, so they are
+**     what is loaded and measured. Enclaves read the data through the
+**     interface in <openenclave/bits/compressed.h>.
+**     The header carries the SHA-256 of the decompressed data, which is
+**     verified after decompression.
+**
+**     Image layout:
+**
+**         +--------------------------------+
+**         | oe_compressed_header_t         |
+**         +--------------------------------+
+**         | LZ4 block (compressed_size)    |
+**         +--------------------------------+
+**
+**==============================================================================
+*/
+
+#define OE_COMPRESSED_MAGIC 0x5a4c454f /* "OELZ" */
+
+#define OE_COMPRESSED_VERSION 1
+
+/* Compression algorithms */
+#define OE_COMPRESSED_ALGORITHM_LZ4 1
+
+OE_PACK_BEGIN
+typedef struct _oe_compressed_header
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t algorithm;
+    uint64_t uncompressed_size;
+    uint64_t compressed_size;
+    uint8_t sha256[OE_SHA256_SIZE];
+} oe_compressed_header_t;
+OE_PACK_END
+
+OE_CHECK_SIZE(sizeof(oe_compressed_header_t), 56);
+
+/**
+ * Returns the maximum size of the LZ4 block produced for **size** bytes.
+ */
+size_t oe_lz4_compress_bound(size_t size);
+
+/**
+ * Compresses a buffer into an LZ4 block.
+ *
+ * @param src The data to compress.
+ * @param src_size The size of **src** in bytes.
+ * @param dest The output buffer.
+ * @param dest_size The size of **dest**; at least oe_lz4_compress_bound().
+ * @param compressed_size[out] The number of bytes written to **dest**.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_BUFFER_TOO_SMALL if **dest** is too small.
+ */
+oe_result_t oe_lz4_compress(
+    const void* src,
+    size_t src_size,
+    void* dest,
+    size_t dest_size,
+    size_t* compressed_size);
+
+/**
+ * Decompresses an LZ4 block.
+ *
+ * The block must decompress to exactly **dest_size** bytes.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if the block is malformed.
+ */
+oe_result_t oe_lz4_decompress(
+    const void* src,
+    size_t src_size,
+    void* dest,
+    size_t dest_size);
+
+/**
+ * Builds a compressed image (header and LZ4 block) for a buffer.
+ *
+ * @param data The data to compress (may be NULL if **size** is zero).
+ * @param size The size of **data** in bytes.
+ * @param image[out] The compressed image, to be released with oe_free().
+ * @param image_size[out] The size of **image** in bytes.
+ */
+oe_result_t oe_compress_image(
+    const void* data,
+    size_t size,
+    uint8_t** image,
+    size_t* image_size);
+
+/**
+ * Validates the header of a compressed image.
+ *
+ * @param image The compressed image.
+ * @param image_size The size of **image** in bytes.
+ * @param header[out] The validated header.
+ */
+oe_result_t oe_get_compressed_header(
+    const void* image,
+    size_t image_size,
+    oe_compressed_header_t* header);
+
+/**
+ * Decompresses a compressed image and verifies its SHA-256 digest.
+ *
+ * @param image The compressed image.
+ * @param image_size The size of **image** in bytes.
+ * @param dest The output buffer.
+ * @param dest_size The size of **dest**; must equal the uncompressed size.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_VERIFY_FAILED if the decompressed data does not match the hash.
+ */
+oe_result_t oe_decompress_image(
+    const void* image,
+    size_t image_size,
+    void* dest,
+    size_t dest_size);
+
+OE_EXTERNC_END
+
+#endif /* _OE_COMPRESS_H */
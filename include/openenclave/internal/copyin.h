@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_COPYIN_H
+#define _OE_COPYIN_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/sha.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Fused copy-in primitives:
+**
+**     Each function below copies a host buffer into enclave memory and
+**     processes it in the same pass. The host buffer is read exactly once,
+**     in chunks of OE_COPY_IN_CHUNK_SIZE bytes, and each chunk is hashed or
+**     decrypted while it is still in the cache. The result always describes
+**     the enclave copy, so the host cannot change the data between the copy
+**     and the check.
+**
+**     The source buffer must lie outside the enclave and the destination
+**     buffer must lie within the enclave.
+**
+**==============================================================================
+*/
+
+#define OE_COPY_IN_CHUNK_SIZE 4096
+
+/**
+ * Copies a host buffer into the enclave and computes its SHA-256 hash.
+ *
+ * @param dest The destination buffer in enclave memory.
+ * @param src The source buffer in host memory.
+ * @param size The number of bytes to copy.
+ * @param sha256 Receives the hash of the copied data.
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if a buffer is null or in the wrong memory.
+ */
+oe_result_t oe_copy_in_sha256(
+    void* dest,
+    const void* src,
+    size_t size,
+    OE_SHA256* sha256);
+
+/**
+ * Copies a host buffer into the enclave and computes its HMAC-SHA256.
+ *
+ * @param dest The destination buffer in enclave memory.
+ * @param src The source buffer in host memory.
+ * @param size The number of bytes to copy.
+ * @param key The HMAC key.
+ * @param key_size The size of the HMAC key.
+ * @param hmac Receives the HMAC of the copied data.
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if a buffer is null or in the wrong memory.
+ */
+oe_result_t oe_copy_in_hmac_sha256(
+    void* dest,
+    const void* src,
+    size_t size,
+    const uint8_t* key,
+    size_t key_size,
+    OE_SHA256* hmac);
+
+/**
+ * Decrypts an AES-GCM ciphertext from host memory into the enclave.
+ *
+ * The tag is checked after the whole ciphertext has been decrypted. If it
+ * does not match, the destination buffer is cleared.
+ *
+ * @param dest The destination buffer in enclave memory, which receives
+ *        **size** bytes of plaintext.
+ * @param src The ciphertext in host memory.
+ * @param size The size of the ciphertext.
+ * @param key The AES key (16, 24 or 32 bytes).
+ * @param key_size The size of the AES key.
+ * @param iv The initialization vector.
+ * @param iv_size The size of the initialization vector.
+ * @param aad The additional authenticated data (may be null if
+ *        **aad_size** is zero).
+ * @param aad_size The size of the additional authenticated data.
+ * @param tag The expected authentication tag.
+ * @param tag_size The size of the authentication tag (4 to 16 bytes).
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if a parameter is invalid.
+ * @return OE_VERIFY_FAILED if the authentication tag does not match.
+ */
+oe_result_t oe_copy_in_aes_gcm_decrypt(
+    void* dest,
+    const void* src,
+    size_t size,
+    const uint8_t* key,
+    size_t key_size,
+    const uint8_t* iv,
+    size_t iv_size,
+    const uint8_t* aad,
+    size_t aad_size,
+    const uint8_t* tag,
+    size_t tag_size);
+
+OE_EXTERNC_END
+
+#endif /* _OE_COPYIN_H */
@@ -73,6 +73,62 @@ oe_result_t oe_hmac_sha256_final(
  */
 oe_result_t oe_hmac_sha256_free(oe_hmac_sha256_context_t* context);
 
+/* A HMAC-SHA256 key with its padded inner and outer key blocks already
+ * hashed, so that each message only pays for its own blocks. */
+typedef struct _oe_hmac_sha256_key
+{
+    uint32_t inner[8];
+    uint32_t outer[8];
+} oe_hmac_sha256_key_t;
+
+/**
+ * Precomputes the inner and outer hash states of a HMAC-SHA256 key
+ *
+ * The result may be used for any number of oe_hmac_sha256_batch() calls and
+ * must be released with oe_hmac_sha256_key_free().
+ *
+ * @param key The key states to be initialized
+ * @param keydata The key used to calculate the HMAC
+ * @param keysize The size of the HMAC key
+ *
+ * @return OE_OK upon success
+ */
+oe_result_t oe_hmac_sha256_key_init(
+    oe_hmac_sha256_key_t* key,
+    const uint8_t* keydata,
+    size_t keysize);
+
+/**
+ * Clears the given HMAC-SHA256 key states
+ *
+ * @param key The key states to be cleared
+ *
+ * @return OE_OK upon success
+ */
+oe_result_t oe_hmac_sha256_key_free(oe_hmac_sha256_key_t* key);
+
+/**
+ * Computes the HMAC-SHA256 of several messages at once
+ *
+ * Messages are processed side by side in SIMD lanes where the CPU supports
+ * it. This is only available inside the enclave.
+ *
+ * @param keys The key of each message; entries may repeat
+ * @param data The messages (may be null when their size is zero)
+ * @param sizes The size of each message
+ * @param count The number of messages
+ * @param hmacs Array of **count** entries that receives the HMACs
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if a parameter is invalid
+ */
+oe_result_t oe_hmac_sha256_batch(
+    const oe_hmac_sha256_key_t* const* keys,
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* hmacs);
+
 OE_EXTERNC_END
 
 #endif /* _OE_HMAC_H */
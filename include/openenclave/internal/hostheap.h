@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOSTHEAP_H
+#define _OE_HOSTHEAP_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/* Size of each chunk of host memory donated to the enclave */
+#define OE_HOST_HEAP_CHUNK_SIZE (1024 * 1024)
+
+/* Maximum number of chunks the host heap manages */
+#define OE_HOST_HEAP_MAX_CHUNKS 64
+
+/* Largest request served from the host heap (larger ones use an OCALL) */
+#define OE_HOST_HEAP_MAX_BLOCK_SIZE (16 * 1024)
+
+/**
+ * Serves oe_host_malloc() and related functions from the host heap.
+ *
+ * The host heap is untrusted memory donated by the host in chunks of
+ * OE_HOST_HEAP_CHUNK_SIZE bytes and carved up by an allocator whose state
+ * lives inside the enclave. The host heap is off by default. Once this
+ * function is called, it backs the buffers that oeedger8r allocates for
+ * OCALL arguments, as well as oe_host_malloc(), oe_host_calloc(),
+ * oe_host_realloc() and oe_host_strndup(), so that those calls rarely leave
+ * the enclave.
+ *
+ * Memory obtained from the host heap must be released with oe_host_free()
+ * or oe_host_realloc(). Enclaves that hand host buffers to the host to be
+ * released with free() must not enable it.
+ *
+ * @param reserve The number of bytes to donate to the host heap up front.
+ *        Further chunks are donated on demand.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **reserve** exceeds the maximum size of
+ *          the host heap.
+ * @returns OE_OUT_OF_MEMORY if the host could not donate the memory.
+ */
+oe_result_t oe_host_heap_enable(size_t reserve);
+
+typedef struct _oe_host_heap_stats
+{
+    /* Number of chunks donated by the host */
+    uint64_t num_chunks;
+
+    /* Number of allocations served from the host heap on this thread */
+    uint64_t num_allocs;
+
+    /* Number of those allocations served from this thread's cache */
+    uint64_t num_cache_hits;
+} oe_host_heap_stats_t;
+
+/**
+ * Obtains host heap statistics.
+ *
+ * @param stats[out] the host heap statistics.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **stats** is null.
+ */
+oe_result_t oe_host_heap_get_stats(oe_host_heap_stats_t* stats);
+
+/**
+ * Returns every chunk of the host heap to the host.
+ *
+ * The enclave runtime calls this function when the enclave is terminated.
+ * Afterwards the host heap is closed: allocations use an OCALL and
+ * oe_host_heap_enable() fails.
+ */
+void oe_host_heap_free_all(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOSTHEAP_H */
@@ -16,6 +16,14 @@ typedef enum _oe_kdf_mode
     OE_KDF_HMAC_SHA256_CTR
 } oe_kdf_mode_t;
 
+/* Opaque representation of a KDF key whose HMAC inner and outer states have
+ * been precomputed */
+typedef struct _oe_kdf_key
+{
+    /* Internal private implementation */
+    uint64_t impl[36];
+} oe_kdf_key_t;
+
 /**
  * Creates the fixed data as specified by NIST SP800-108.
  * Specfically, it produces the byte array in the form of
@@ -72,6 +80,163 @@ oe_result_t oe_kdf_derive_key(
     uint8_t* derived_key,
     size_t derived_key_size);
 
+/**
+ * Prepares a key for repeated key derivations.
+ *
+ * The key is processed once, so that each later derivation only hashes its
+ * own counter and fixed data. The result may be shared by several threads
+ * and must be released with oe_kdf_key_free().
+ *
+ * @param mode The KDF algorithm to use.
+ * @param key The key used to derive the output keys
+ * @param key_size The size of the input key
+ * @param kdf_key The KDF key to be initialized
+ *
+ * @return OE_OK upon success
+ * @return OE_FAILURE if there is generic failure
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ */
+oe_result_t oe_kdf_key_init(
+    oe_kdf_mode_t mode,
+    const uint8_t* key,
+    size_t key_size,
+    oe_kdf_key_t* kdf_key);
+
+/**
+ * Derives a key from a prepared KDF key and some user defined data.
+ *
+ * The result is the same as oe_kdf_derive_key() with the original key.
+ *
+ * @param kdf_key The KDF key returned by oe_kdf_key_init()
+ * @param fixed_data The optional user-defined data used to derive the key
+ * @param fixed_data_size The size of the optional user-defined data
+ * @param derived_key The buffer where the output key will be written to
+ * @param derived_key_size The size of the output key
+ *
+ * @return OE_OK upon success
+ * @return OE_CONSTRAINT_FAILED if derived key size is too large
+ * @return OE_FAILURE if there is generic failure
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ */
+oe_result_t oe_kdf_key_derive(
+    const oe_kdf_key_t* kdf_key,
+    const uint8_t* fixed_data,
+    size_t fixed_data_size,
+    uint8_t* derived_key,
+    size_t derived_key_size);
+
+/**
+ * Derives one key per fixed data entry from a prepared KDF key.
+ *
+ * Key **i** is written to **derived_keys** + i * **derived_key_size**. If
+ * any derivation fails, the whole output buffer is cleared.
+ *
+ * @param kdf_key The KDF key returned by oe_kdf_key_init()
+ * @param fixed_data The fixed data of each key (entries may be null)
+ * @param fixed_data_sizes The size of each fixed data entry
+ * @param count The number of keys to derive
+ * @param derived_keys Buffer of **count** * **derived_key_size** bytes
+ * @param derived_key_size The size of each output key
+ *
+ * @return OE_OK upon success
+ * @return OE_CONSTRAINT_FAILED if derived key size is too large
+ * @return OE_INTEGER_OVERFLOW if the output buffer size overflows
+ * @return OE_FAILURE if there is generic failure
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ */
+oe_result_t oe_kdf_key_derive_many(
+    const oe_kdf_key_t* kdf_key,
+    const uint8_t* const* fixed_data,
+    const size_t* fixed_data_sizes,
+    size_t count,
+    uint8_t* derived_keys,
+    size_t derived_key_size);
+
+/**
+ * Clears a KDF key returned by oe_kdf_key_init().
+ *
+ * @param kdf_key The KDF key to be cleared
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ */
+oe_result_t oe_kdf_key_free(oe_kdf_key_t* kdf_key);
+
+/* Derived keys and fixed data larger than these are never cached */
+#define OE_KDF_CACHE_MAX_KEY_SIZE 64
+#define OE_KDF_CACHE_MAX_FIXED_DATA_SIZE 128
+
+/* Bounded cache of derived keys, indexed by (key id, fixed data) */
+typedef struct _oe_kdf_cache oe_kdf_cache_t;
+
+/**
+ * Creates a cache of derived keys.
+ *
+ * When the cache is full, the least recently used entry is cleared and
+ * reused. The cache may be shared by several threads. This is only
+ * available inside the enclave.
+ *
+ * @param capacity The maximum number of cached keys
+ * @param cache Receives the new cache
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ * @return OE_OUT_OF_MEMORY if there is no memory available
+ */
+oe_result_t oe_kdf_cache_create(size_t capacity, oe_kdf_cache_t** cache);
+
+/**
+ * Derives a key through a cache.
+ *
+ * The caller chooses **key_id** to identify **kdf_key**; it must not reuse
+ * the id for another key without calling oe_kdf_cache_evict_key() first.
+ * Requests larger than OE_KDF_CACHE_MAX_KEY_SIZE or with fixed data larger
+ * than OE_KDF_CACHE_MAX_FIXED_DATA_SIZE are derived but not cached, and so
+ * is a key whose derivation overlapped a call to oe_kdf_cache_evict_key().
+ *
+ * @param cache The cache returned by oe_kdf_cache_create()
+ * @param key_id The caller-defined id of the KDF key
+ * @param kdf_key The KDF key used on a cache miss
+ * @param fixed_data The optional user-defined data used to derive the key
+ * @param fixed_data_size The size of the optional user-defined data
+ * @param derived_key The buffer where the output key will be written to
+ * @param derived_key_size The size of the output key
+ *
+ * @return OE_OK upon success
+ * @return OE_CONSTRAINT_FAILED if derived key size is too large
+ * @return OE_FAILURE if there is generic failure
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ */
+oe_result_t oe_kdf_cache_derive_key(
+    oe_kdf_cache_t* cache,
+    uint64_t key_id,
+    const oe_kdf_key_t* kdf_key,
+    const uint8_t* fixed_data,
+    size_t fixed_data_size,
+    uint8_t* derived_key,
+    size_t derived_key_size);
+
+/**
+ * Clears every cached key derived from the given key id.
+ *
+ * @param cache The cache returned by oe_kdf_cache_create()
+ * @param key_id The caller-defined id of the KDF key
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ */
+oe_result_t oe_kdf_cache_evict_key(oe_kdf_cache_t* cache, uint64_t key_id);
+
+/**
+ * Clears and releases a cache of derived keys.
+ *
+ * @param cache The cache returned by oe_kdf_cache_create()
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if there is an invalid parameter
+ */
+oe_result_t oe_kdf_cache_destroy(oe_kdf_cache_t* cache);
+
 OE_EXTERNC_END
 
 #endif /* _OE_KDF_H */
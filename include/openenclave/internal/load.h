@@ -108,6 +108,9 @@ struct _oe_enclave_image
 
     oe_result_t (*patch)(oe_enclave_image_t* image, size_t enclave_end);
 
+    /* Converts the relocation pages to the compact format (may be null) */
+    oe_result_t (*compact_relocations)(oe_enclave_image_t* image);
+
     oe_result_t (*sgx_load_enclave_properties)(
         const oe_enclave_image_t* image,
         const char* section_name,
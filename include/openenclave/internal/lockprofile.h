@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_LOCKPROFILE_H
+#define _OE_LOCKPROFILE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/* Number of distinct locks that can be profiled */
+#define OE_LOCK_PROFILE_MAX_LOCKS 256
+
+typedef enum _oe_lock_type
+{
+    OE_LOCK_TYPE_MUTEX = 1,
+    OE_LOCK_TYPE_COND = 2,
+    OE_LOCK_TYPE_RWLOCK = 3,
+    __OE_LOCK_TYPE_MAX = OE_ENUM_MAX,
+} oe_lock_type_t;
+
+/**
+ * Contention statistics of one oe_mutex_t, oe_cond_t or oe_rwlock_t.
+ *
+ * For a condition variable, an acquire is a call to oe_cond_wait(); the
+ * time spent reacquiring the mutex is counted against the mutex.
+ */
+typedef struct _oe_lock_profile
+{
+    /* Address of the lock (NULL for an unused record) */
+    const void* lock;
+
+    /* The oe_lock_type_t of the lock */
+    uint32_t type;
+    uint32_t reserved;
+
+    /* Number of times the lock was obtained, not counting trylocks */
+    uint64_t acquires;
+
+    /* Number of acquires that found the lock held */
+    uint64_t contended;
+
+    /* Number of times a thread parked on the host while waiting */
+    uint64_t parks;
+
+    /* Total time threads were parked, as reported by the host */
+    uint64_t wait_ns;
+} oe_lock_profile_t;
+
+/**
+ * Gets the contention statistics of the enclave locks.
+ *
+ * The enclave runtime records statistics only when it is built with the
+ * USE_LOCK_PROFILING CMake option. Records are kept per lock address for
+ * up to OE_LOCK_PROFILE_MAX_LOCKS locks, in the order they are first
+ * acquired. A lock may go unrecorded before the table is full when the few
+ * records its address hashes to are taken. A lock that is destroyed and
+ * initialized again at the same address keeps its record.
+ * The records are also visible to the debugger as oe_lock_profiles.
+ *
+ * @param profiles[out] The array that receives the records, ordered by
+ *        decreasing wait time and then by decreasing contended count.
+ * @param count The number of elements of **profiles**.
+ * @param num_profiles[out] The number of records that were written.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if a parameter is NULL.
+ * @returns OE_UNSUPPORTED if the runtime is built without lock profiling.
+ */
+oe_result_t oe_get_lock_profiles(
+    oe_lock_profile_t* profiles,
+    size_t count,
+    size_t* num_profiles);
+
+/**
+ * Prints the contention statistics of the enclave locks to the host.
+ *
+ * This is typically called from an ecall once the workload being profiled
+ * has completed. It does nothing without lock profiling.
+ */
+void oe_dump_lock_profiles(void);
+
+/**
+ * Clears the contention statistics while keeping the recorded locks.
+ *
+ * Counts of acquires that race with the reset may be lost.
+ */
+void oe_reset_lock_profiles(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_LOCKPROFILE_H */
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_MEMORY_RESOURCE_H
+#define _OE_MEMORY_RESOURCE_H
+
+#ifndef __cplusplus
+#error "memory_resource.h may only be included from C++ sources"
+#endif
+
+#include <openenclave/internal/arena.h>
+#include <memory_resource>
+#include <new>
+
+/*
+**==============================================================================
+**
+** Polymorphic memory resources provided by Open Enclave:
+**
+**     oe::pmr::ecall_resource()
+**         Monotonic resource over the per-thread ecall arena. Allocation is a
+**         pointer bump and deallocation is a no-op; all memory is released
+**         when the outermost ecall on the thread returns.
+**
+**     oe::pmr::thread_pool_resource()
+**         Unsynchronized pool resource owned by the calling thread. Freed
+**         blocks are recycled without taking any lock, and the pool returns
+**         its chunks to the enclave heap when the outermost ecall on the
+**         thread returns (as for any other thread_local object).
+**
+**     oe::pmr::heap_pool_resource()
+**         Synchronized pool resource over the enclave heap that is shared by
+**         all threads and lives as long as the enclave.
+**
+**     Containers that use either of the first two resources must be
+**     destroyed before the ecall that created them returns.
+**
+**==============================================================================
+*/
+
+namespace oe
+{
+namespace pmr
+{
+class ecall_buffer_resource : public std::pmr::memory_resource
+{
+  protected:
+    void* do_allocate(size_t bytes, size_t alignment) override
+    {
+        size_t padding = 0;
+        uint8_t* p;
+
+        /* oe_arena_alloc() only guarantees OE_ARENA_ALIGNMENT */
+        if (alignment > OE_ARENA_ALIGNMENT)
+            padding = alignment - OE_ARENA_ALIGNMENT;
+
+        if (bytes == 0)
+            bytes = 1;
+
+        if (bytes > OE_ARENA_MAX_CAPACITY || alignment > OE_ARENA_MAX_CAPACITY)
+            throw std::bad_alloc();
+
+        if (!(p = (uint8_t*)oe_arena_alloc(bytes + padding)))
+            throw std::bad_alloc();
+
+        return p + ((alignment - ((uint64_t)p % alignment)) % alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override
+    {
+        OE_UNUSED(p);
+        OE_UNUSED(bytes);
+        OE_UNUSED(alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const
+        noexcept override
+    {
+        return &other == this;
+    }
+};
+
+inline std::pmr::memory_resource* ecall_resource() noexcept
+{
+    static ecall_buffer_resource resource;
+    return &resource;
+}
+
+inline std::pmr::memory_resource* thread_pool_resource() noexcept
+{
+    static thread_local std::pmr::unsynchronized_pool_resource resource(
+        std::pmr::new_delete_resource());
+    return &resource;
+}
+
+inline std::pmr::memory_resource* heap_pool_resource() noexcept
+{
+    static std::pmr::synchronized_pool_resource resource(
+        std::pmr::new_delete_resource());
+    return &resource;
+}
+
+} // namespace pmr
+} // namespace oe
+
+#endif /* _OE_MEMORY_RESOURCE_H */
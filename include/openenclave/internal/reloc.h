@@ -0,0 +1,107 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_RELOC_H
+#define _OE_RELOC_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include "elf.h"
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Relocation pages:
+**
+**     The relocation pages of an ELF enclave use one of two formats.
+**
+**     The default format is a copy of the .rela.dyn section (an array of
+**     elf64_rela_t entries terminated by zero padding).
+**
+**     The compact format is used when the enclave was signed with the
+**     OE_SGX_CONFIG_FLAGS_COMPACT_RELOCATIONS property. The loader writes
+**     the addend of each aligned R_X86_64_RELATIVE relocation into the image
+**     (so that it is measured with the page it belongs to) and encodes the
+**     relocated addresses RELR-style:
+**
+**         [oe_compact_reloc_header_t]
+**         [uint64_t] * num_relr      RELR words
+**         [elf64_rela_t] * num_rela  all other relocations
+**
+**     An even RELR word is the offset of a relocated address and sets the
+**     cursor to the next word. An odd RELR word is a bitmap: bit i (i >= 1)
+**     relocates the word at cursor + (i - 1) words, then the cursor advances
+**     by 63 words. Relocating a word adds the enclave base address to it.
+**
+**==============================================================================
+*/
+
+/* Never a valid r_offset, so it distinguishes the two formats */
+#define OE_COMPACT_RELOC_MAGIC 0xffffffff4f45524cULL
+
+/* Number of words described by a RELR bitmap word */
+#define OE_RELR_BITMAP_WORDS 63
+
+typedef struct _oe_compact_reloc_header
+{
+    uint64_t magic;
+    uint64_t num_relr;
+    uint64_t num_rela;
+    uint64_t reserved;
+} oe_compact_reloc_header_t;
+
+OE_STATIC_ASSERT(sizeof(oe_compact_reloc_header_t) == 32);
+
+/**
+ * Locates the relocations within the relocation pages.
+ *
+ * Handles both formats. For the default format, **relr** is set to null and
+ * **rela** to the start of the pages; the array ends at the first entry
+ * whose r_offset is zero or after **num_rela** entries.
+ *
+ * @returns false if the pages claim the compact format but are malformed.
+ */
+OE_INLINE bool oe_get_relocations(
+    const void* data,
+    size_t size,
+    const uint64_t** relr,
+    size_t* num_relr,
+    const elf64_rela_t** rela,
+    size_t* num_rela)
+{
+    const oe_compact_reloc_header_t* header;
+    size_t remaining;
+
+    *relr = NULL;
+    *num_relr = 0;
+    *rela = (const elf64_rela_t*)data;
+    *num_rela = size / sizeof(elf64_rela_t);
+
+    header = (const oe_compact_reloc_header_t*)data;
+
+    if (size < sizeof(*header) || header->magic != OE_COMPACT_RELOC_MAGIC)
+        return true;
+
+    remaining = size - sizeof(*header);
+
+    if (header->num_relr > remaining / sizeof(uint64_t))
+        return false;
+
+    remaining -= header->num_relr * sizeof(uint64_t);
+
+    if (header->num_rela > remaining / sizeof(elf64_rela_t))
+        return false;
+
+    *relr = (const uint64_t*)(header + 1);
+    *num_relr = header->num_relr;
+    *rela = (const elf64_rela_t*)(*relr + header->num_relr);
+    *num_rela = header->num_rela;
+
+    return true;
+}
+
+OE_EXTERNC_END
+
+#endif /* _OE_RELOC_H */
@@ -36,6 +36,8 @@ OE_STATIC_ASSERT(sizeof(oe_sgx_load_state_t) == sizeof(unsigned int));
 
 typedef struct _oe_sgx_load_context oe_sgx_load_context_t;
 
+typedef struct _oe_sgx_measure_pipeline oe_sgx_measure_pipeline_t;
+
 struct _oe_sgx_load_context
 {
     oe_sgx_load_type_t type;
@@ -62,6 +64,14 @@ struct _oe_sgx_load_context
 
     /* Hash context used to measure enclave as it is loaded */
     oe_sha256_context_t hash_context;
+
+    /* If non-null, pages are measured into hash_context on a worker thread
+     * while they are being loaded (simulation and measurement modes only) */
+    oe_sgx_measure_pipeline_t* measure_pipeline;
+
+    /* Set after oe_sgx_initialize_load_context() to measure every page on
+     * the loading thread, e.g. to check the pipeline against it */
+    bool measure_inline;
 };
 
 oe_result_t oe_sgx_initialize_load_context(
@@ -561,7 +561,7 @@ oe_thread_data_t* oe_get_thread_data(void);
 
 #define TD_MAGIC 0xc90afe906c5d19a3
 
-#define OE_THREAD_LOCAL_SPACE (3840)
+#define OE_THREAD_LOCAL_SPACE (3752)
 
 typedef struct _callsite Callsite;
 
@@ -602,6 +602,24 @@ typedef struct _td
     /* Simulation mode is active if non-zero */
     uint64_t simulate;
 
+    /* Per-thread ecall arena (see enclave/core/sgx/arena.c) */
+    uint64_t arena_base;
+    uint64_t arena_capacity;
+    uint64_t arena_used;
+    uint64_t arena_peak;
+    uint64_t arena_overflow_count;
+    void* arena_overflow_list;
+
+    /* Per-thread host heap cache (see enclave/core/sgx/hostheap.c) */
+    void* host_heap_cache;
+    uint64_t host_heap_allocs;
+
+    /* Host flags of the current enclave function call and whether it saw
+     * them set (see oe_is_call_cancelled()) */
+    const volatile uint32_t* call_cancelled;
+    const volatile uint32_t* call_expired;
+    uint64_t call_was_cancelled;
+
     /* Reserved for thread-local variables. */
     uint8_t thread_local_data[OE_THREAD_LOCAL_SPACE];
 } td_t;
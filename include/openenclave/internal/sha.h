@@ -66,6 +66,55 @@ oe_result_t oe_sha256_update(
  */
 oe_result_t oe_sha256_final(oe_sha256_context_t* context, OE_SHA256* sha256);
 
+/**
+ * Copies the state of a SHA-256 context
+ *
+ * This function initializes **dest** with the data hashed so far by **src**,
+ * so that a common prefix only needs to be hashed once. Both contexts may be
+ * extended and finalized independently afterwards.
+ *
+ * @param dest handle of context to be initialized
+ * @param src handle of context to be copied
+ *
+ * @return OE_OK upon success
+ */
+oe_result_t oe_sha256_clone(
+    oe_sha256_context_t* dest,
+    const oe_sha256_context_t* src);
+
+/**
+ * Releases the resources held by a SHA-256 context
+ *
+ * This function must be called on every context initialized by
+ * oe_sha256_init() or oe_sha256_clone(), whether or not it was finalized.
+ * It may also be called on a zero-filled context, and more than once.
+ *
+ * @param context handle of context to be released
+ *
+ * @return OE_OK upon success
+ */
+oe_result_t oe_sha256_free(oe_sha256_context_t* context);
+
+/**
+ * Computes the SHA-256 hash of several messages at once
+ *
+ * Messages are processed side by side in SIMD lanes where the CPU supports
+ * it. This is only available inside the enclave.
+ *
+ * @param data The messages (may be null when their size is zero)
+ * @param sizes The size of each message
+ * @param count The number of messages
+ * @param sha256s Array of **count** entries that receives the hashes
+ *
+ * @return OE_OK upon success
+ * @return OE_INVALID_PARAMETER if a parameter is invalid
+ */
+oe_result_t oe_sha256_batch(
+    const void* const* data,
+    const size_t* sizes,
+    size_t count,
+    OE_SHA256* sha256s);
+
 OE_EXTERNC_END
 
 #endif /* _OE_SHA_H */
@@ -42,6 +42,10 @@ OE_EXTERNC_BEGIN
 oe_result_t _handle_oelog_init(uint64_t arg);
 oe_result_t oe_log(log_level_t level, const char* fmt, ...);
 log_level_t get_current_logging_level(void);
+
+/* Sets the logging level and returns the previous one, for example to
+ * silence tests that make many calls which are expected to fail */
+log_level_t set_current_logging_level(log_level_t level);
 OE_EXTERNC_END
 #else
 #include <stdio.h>
@@ -49,6 +53,10 @@ OE_EXTERNC_BEGIN
 oe_result_t oe_log_enclave_init(oe_enclave_t* enclave);
 void oe_log(log_level_t level, const char* fmt, ...);
 log_level_t get_current_logging_level(void);
+
+/* Sets the logging level and returns the previous one, for example to
+ * silence tests that make many calls which are expected to fail */
+log_level_t set_current_logging_level(log_level_t level);
 void log_message(bool is_enclave, oe_log_args_t* args);
 OE_EXTERNC_END
 #endif
@@ -0,0 +1,363 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "channel.h"
+#include <mbedtls/ecdh.h>
+#include <mbedtls/md.h>
+#include <openenclave/enclave.h>
+#include <string.h>
+
+// Label for deriving the session keys.
+static const char CHANNEL_KDF_LABEL[] = "OE remote attestation channel";
+
+// Size of the GCM nonce. It holds the 64-bit sequence number.
+#define CHANNEL_NONCE_SIZE 12
+
+// Clear key material in a way the compiler cannot optimize away.
+static void _zeroize(void* buffer, size_t size)
+{
+    volatile uint8_t* p = (volatile uint8_t*)buffer;
+
+    while (size--)
+        *p++ = 0;
+}
+
+AttestedChannel::AttestedChannel()
+    : m_send_sequence(0), m_receive_sequence(0), m_initialized(false),
+      m_established(false)
+{
+    size_t public_key_size = 0;
+    int res = -1;
+
+    mbedtls_ctr_drbg_init(&m_ctr_drbg_context);
+    mbedtls_entropy_init(&m_entropy_context);
+    mbedtls_ecp_group_init(&m_group);
+    mbedtls_mpi_init(&m_private_key);
+    mbedtls_ecp_point_init(&m_public_key_point);
+    mbedtls_gcm_init(&m_send_context);
+    mbedtls_gcm_init(&m_receive_context);
+
+    // Initialize entropy.
+    res = mbedtls_ctr_drbg_seed(
+        &m_ctr_drbg_context,
+        mbedtls_entropy_func,
+        &m_entropy_context,
+        NULL,
+        0);
+    if (res != 0)
+    {
+        TRACE_ENCLAVE("mbedtls_ctr_drbg_seed failed (%d).", res);
+        goto exit;
+    }
+
+    // Generate an ephemeral ECDH key pair on the NIST P-256 curve. Unlike
+    // an RSA key pair, this takes a single scalar multiplication.
+    res = mbedtls_ecp_group_load(&m_group, MBEDTLS_ECP_DP_SECP256R1);
+    if (res != 0)
+    {
+        TRACE_ENCLAVE("mbedtls_ecp_group_load failed (%d).", res);
+        goto exit;
+    }
+
+    res = mbedtls_ecdh_gen_public(
+        &m_group,
+        &m_private_key,
+        &m_public_key_point,
+        mbedtls_ctr_drbg_random,
+        &m_ctr_drbg_context);
+    if (res != 0)
+    {
+        TRACE_ENCLAVE("mbedtls_ecdh_gen_public failed (%d).", res);
+        goto exit;
+    }
+
+    res = mbedtls_ecp_point_write_binary(
+        &m_group,
+        &m_public_key_point,
+        MBEDTLS_ECP_PF_UNCOMPRESSED,
+        &public_key_size,
+        m_public_key,
+        sizeof(m_public_key));
+    if (res != 0 || public_key_size != sizeof(m_public_key))
+    {
+        TRACE_ENCLAVE("mbedtls_ecp_point_write_binary failed (%d).", res);
+        goto exit;
+    }
+
+    m_initialized = true;
+exit:
+    return;
+}
+
+AttestedChannel::~AttestedChannel()
+{
+    mbedtls_gcm_free(&m_receive_context);
+    mbedtls_gcm_free(&m_send_context);
+    mbedtls_ecp_point_free(&m_public_key_point);
+    mbedtls_mpi_free(&m_private_key);
+    mbedtls_ecp_group_free(&m_group);
+    mbedtls_entropy_free(&m_entropy_context);
+    mbedtls_ctr_drbg_free(&m_ctr_drbg_context);
+}
+
+/**
+ * Derive the session keys from the ECDH shared secret using the counter mode
+ * KDF of NIST SP800-108 with HMAC-SHA256, the same construction that the
+ * Open Enclave runtime uses in oe_kdf_derive_key(). The fixed data is
+ *
+ *     label || 0x00 || context || key_bits
+ *
+ * where the context is the two public keys in ascending order, so that both
+ * enclaves derive the same keys. The first key protects messages sent by the
+ * enclave with the lower public key.
+ */
+bool AttestedChannel::derive_keys(
+    const uint8_t* peer_public_key,
+    const uint8_t* secret,
+    size_t secret_size)
+{
+    bool ret = false;
+    const mbedtls_md_info_t* md_info =
+        mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    mbedtls_md_context_t md_context;
+    uint8_t keys[2 * CHANNEL_KEY_SIZE];
+    const uint8_t* low_key = m_public_key;
+    const uint8_t* high_key = peer_public_key;
+    bool sender_is_low = true;
+    uint8_t key_bits[4];
+    uint8_t zero = 0;
+    int res = -1;
+
+    mbedtls_md_init(&md_context);
+
+    if (memcmp(m_public_key, peer_public_key, sizeof(m_public_key)) > 0)
+    {
+        low_key = peer_public_key;
+        high_key = m_public_key;
+        sender_is_low = false;
+    }
+
+    key_bits[0] = (uint8_t)((8 * sizeof(keys)) >> 24);
+    key_bits[1] = (uint8_t)((8 * sizeof(keys)) >> 16);
+    key_bits[2] = (uint8_t)((8 * sizeof(keys)) >> 8);
+    key_bits[3] = (uint8_t)(8 * sizeof(keys));
+
+    res = mbedtls_md_setup(&md_context, md_info, 1);
+    if (res != 0)
+        goto exit;
+
+    for (uint32_t i = 1; i <= sizeof(keys) / 32; i++)
+    {
+        uint8_t counter[4] = {(uint8_t)(i >> 24),
+                              (uint8_t)(i >> 16),
+                              (uint8_t)(i >> 8),
+                              (uint8_t)i};
+
+        if ((res = mbedtls_md_hmac_starts(&md_context, secret, secret_size)) ||
+            (res = mbedtls_md_hmac_update(
+                 &md_context, counter, sizeof(counter))) ||
+            (res = mbedtls_md_hmac_update(
+                 &md_context,
+                 (const uint8_t*)CHANNEL_KDF_LABEL,
+                 sizeof(CHANNEL_KDF_LABEL) - 1)) ||
+            (res = mbedtls_md_hmac_update(&md_context, &zero, 1)) ||
+            (res = mbedtls_md_hmac_update(
+                 &md_context, low_key, CHANNEL_PUBLIC_KEY_SIZE)) ||
+            (res = mbedtls_md_hmac_update(
+                 &md_context, high_key, CHANNEL_PUBLIC_KEY_SIZE)) ||
+            (res = mbedtls_md_hmac_update(
+                 &md_context, key_bits, sizeof(key_bits))) ||
+            (res = mbedtls_md_hmac_finish(&md_context, keys + (i - 1) * 32)))
+            goto exit;
+    }
+
+    res = mbedtls_gcm_setkey(
+        &m_send_context,
+        MBEDTLS_CIPHER_ID_AES,
+        sender_is_low ? keys : keys + CHANNEL_KEY_SIZE,
+        8 * CHANNEL_KEY_SIZE);
+    if (res != 0)
+        goto exit;
+
+    res = mbedtls_gcm_setkey(
+        &m_receive_context,
+        MBEDTLS_CIPHER_ID_AES,
+        sender_is_low ? keys + CHANNEL_KEY_SIZE : keys,
+        8 * CHANNEL_KEY_SIZE);
+    if (res != 0)
+        goto exit;
+
+    ret = true;
+exit:
+    if (res != 0)
+        TRACE_ENCLAVE("deriving the session keys failed (%d).", res);
+
+    _zeroize(keys, sizeof(keys));
+    mbedtls_md_free(&md_context);
+    return ret;
+}
+
+bool AttestedChannel::establish(
+    const uint8_t* peer_public_key,
+    size_t peer_public_key_size)
+{
+    bool ret = false;
+    mbedtls_ecp_point peer_point;
+    mbedtls_mpi shared_secret;
+    uint8_t secret[32];
+    int res = -1;
+
+    mbedtls_ecp_point_init(&peer_point);
+    mbedtls_mpi_init(&shared_secret);
+
+    if (!m_initialized || m_established ||
+        peer_public_key_size != CHANNEL_PUBLIC_KEY_SIZE)
+        goto exit;
+
+    // Read and validate the peer's public key.
+    res = mbedtls_ecp_point_read_binary(
+        &m_group, &peer_point, peer_public_key, peer_public_key_size);
+    if (res == 0)
+        res = mbedtls_ecp_check_pubkey(&m_group, &peer_point);
+    if (res != 0)
+    {
+        TRACE_ENCLAVE("invalid peer public key (%d).", res);
+        goto exit;
+    }
+
+    res = mbedtls_ecdh_compute_shared(
+        &m_group,
+        &shared_secret,
+        &peer_point,
+        &m_private_key,
+        mbedtls_ctr_drbg_random,
+        &m_ctr_drbg_context);
+    if (res == 0)
+        res = mbedtls_mpi_write_binary(&shared_secret, secret, sizeof(secret));
+    if (res != 0)
+    {
+        TRACE_ENCLAVE("mbedtls_ecdh_compute_shared failed (%d).", res);
+        goto exit;
+    }
+
+    if (!derive_keys(peer_public_key, secret, sizeof(secret)))
+        goto exit;
+
+    m_established = true;
+    ret = true;
+    TRACE_ENCLAVE("attested channel established.");
+exit:
+    _zeroize(secret, sizeof(secret));
+    mbedtls_mpi_free(&shared_secret);
+    mbedtls_ecp_point_free(&peer_point);
+    return ret;
+}
+
+static void _make_nonce(uint64_t sequence, uint8_t nonce[CHANNEL_NONCE_SIZE])
+{
+    memset(nonce, 0, CHANNEL_NONCE_SIZE);
+
+    for (size_t i = 0; i < sizeof(sequence); i++)
+        nonce[CHANNEL_NONCE_SIZE - 1 - i] = (uint8_t)(sequence >> (8 * i));
+}
+
+bool AttestedChannel::seal(
+    const uint8_t* data,
+    size_t data_size,
+    uint8_t* sealed_data,
+    size_t* sealed_data_size)
+{
+    channel_message_header_t header;
+    uint8_t nonce[CHANNEL_NONCE_SIZE];
+    uint8_t* ciphertext = sealed_data + sizeof(header);
+    int res;
+
+    // Each direction has its own key and the sequence number never repeats,
+    // so a nonce is never reused with the same key.
+    if (!m_established || m_send_sequence == UINT64_MAX ||
+        *sealed_data_size < CHANNEL_SEALED_SIZE(data_size))
+        return false;
+
+    header.sequence = m_send_sequence;
+    header.size = data_size;
+    _make_nonce(header.sequence, nonce);
+
+    res = mbedtls_gcm_crypt_and_tag(
+        &m_send_context,
+        MBEDTLS_GCM_ENCRYPT,
+        data_size,
+        nonce,
+        sizeof(nonce),
+        (const uint8_t*)&header,
+        sizeof(header),
+        data,
+        ciphertext,
+        CHANNEL_TAG_SIZE,
+        ciphertext + data_size);
+    if (res != 0)
+    {
+        TRACE_ENCLAVE("mbedtls_gcm_crypt_and_tag failed (%d).", res);
+        return false;
+    }
+
+    memcpy(sealed_data, &header, sizeof(header));
+    *sealed_data_size = CHANNEL_SEALED_SIZE(data_size);
+    m_send_sequence++;
+    return true;
+}
+
+bool AttestedChannel::open(
+    const uint8_t* sealed_data,
+    size_t sealed_data_size,
+    uint8_t* data,
+    size_t* data_size)
+{
+    channel_message_header_t header;
+    uint8_t nonce[CHANNEL_NONCE_SIZE];
+    const uint8_t* ciphertext = sealed_data + sizeof(header);
+    int res;
+
+    if (!m_established || !oe_is_within_enclave(sealed_data, sealed_data_size))
+        return false;
+
+    if (sealed_data_size < CHANNEL_SEALED_SIZE(0))
+        return false;
+
+    memcpy(&header, sealed_data, sizeof(header));
+
+    if (header.size != sealed_data_size - CHANNEL_SEALED_SIZE(0) ||
+        header.size > *data_size)
+        return false;
+
+    // Only accept the next message in sequence.
+    if (header.sequence != m_receive_sequence)
+    {
+        TRACE_ENCLAVE(
+            "unexpected message sequence number %llu.",
+            (unsigned long long)header.sequence);
+        return false;
+    }
+
+    _make_nonce(header.sequence, nonce);
+
+    res = mbedtls_gcm_auth_decrypt(
+        &m_receive_context,
+        header.size,
+        nonce,
+        sizeof(nonce),
+        (const uint8_t*)&header,
+        sizeof(header),
+        ciphertext + header.size,
+        CHANNEL_TAG_SIZE,
+        ciphertext,
+        data);
+    if (res != 0)
+    {
+        TRACE_ENCLAVE("mbedtls_gcm_auth_decrypt failed (%d).", res);
+        return false;
+    }
+
+    *data_size = header.size;
+    m_receive_sequence++;
+    return true;
+}
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef OE_SAMPLES_ATTESTATION_ENC_CHANNEL_H
+#define OE_SAMPLES_ATTESTATION_ENC_CHANNEL_H
+
+#include <openenclave/enclave.h>
+// Includes for mbedtls shipped with oe.
+// Also add the following libraries to your linker command line:
+// -loeenclave -lmbedcrypto -lmbedtls -lmbedx509
+#include <mbedtls/config.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/ecp.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/gcm.h>
+#include "log.h"
+
+// Size of an uncompressed NIST P-256 public key.
+#define CHANNEL_PUBLIC_KEY_SIZE 65
+
+// Size of the AES-256-GCM keys derived for each direction.
+#define CHANNEL_KEY_SIZE 32
+
+// Size of the GCM authentication tag appended to each message.
+#define CHANNEL_TAG_SIZE 16
+
+// Every message sent on the channel starts with this header, which is
+// authenticated (but not encrypted) along with the message.
+typedef struct _channel_message_header
+{
+    uint64_t sequence;
+    uint64_t size;
+} channel_message_header_t;
+
+// Number of bytes needed to seal a message of the given size.
+#define CHANNEL_SEALED_SIZE(SIZE) \
+    (sizeof(channel_message_header_t) + (SIZE) + CHANNEL_TAG_SIZE)
+
+/**
+ * AttestedChannel is a secure channel between two enclaves. Each enclave
+ * generates an ephemeral ECDH key pair on the NIST P-256 curve and binds the
+ * public key to its identity by placing its hash in the report data of its
+ * remote report. Once an enclave has attested the report of its peer, it
+ * establishes the channel with the peer's public key. Both sides then derive
+ * one AES-256-GCM key per direction from the ECDH shared secret, and every
+ * message is protected with symmetric cryptography only.
+ *
+ * Messages carry a sequence number that is authenticated with the message,
+ * so a message that is replayed, reordered or dropped by the host is
+ * rejected.
+ */
+class AttestedChannel
+{
+  private:
+    mbedtls_ctr_drbg_context m_ctr_drbg_context;
+    mbedtls_entropy_context m_entropy_context;
+    mbedtls_ecp_group m_group;
+    mbedtls_mpi m_private_key;
+    mbedtls_ecp_point m_public_key_point;
+    uint8_t m_public_key[CHANNEL_PUBLIC_KEY_SIZE];
+    mbedtls_gcm_context m_send_context;
+    mbedtls_gcm_context m_receive_context;
+    uint64_t m_send_sequence;
+    uint64_t m_receive_sequence;
+    bool m_initialized;
+    bool m_established;
+
+  public:
+    AttestedChannel();
+    ~AttestedChannel();
+
+    /**
+     * Get this enclave's ephemeral public key, which must be bound to the
+     * enclave's report.
+     */
+    const uint8_t* get_public_key() const
+    {
+        return m_public_key;
+    }
+
+    /**
+     * Establish the channel with the public key of the peer enclave. The
+     * caller must have attested the report that binds the peer's public key.
+     */
+    bool establish(const uint8_t* peer_public_key, size_t peer_public_key_size);
+
+    /**
+     * Encrypt and authenticate a message for the peer enclave. The sealed
+     * message is CHANNEL_SEALED_SIZE(data_size) bytes long.
+     */
+    bool seal(
+        const uint8_t* data,
+        size_t data_size,
+        uint8_t* sealed_data,
+        size_t* sealed_data_size);
+
+    /**
+     * Authenticate and decrypt the next message from the peer enclave.
+     * The sealed message must have been copied into enclave memory.
+     */
+    bool open(
+        const uint8_t* sealed_data,
+        size_t sealed_data_size,
+        uint8_t* data,
+        size_t* data_size);
+
+  private:
+    bool derive_keys(
+        const uint8_t* peer_public_key,
+        const uint8_t* secret,
+        size_t secret_size);
+};
+
+#endif // OE_SAMPLES_ATTESTATION_ENC_CHANNEL_H
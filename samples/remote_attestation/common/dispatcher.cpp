@@ -3,11 +3,12 @@
 
 #include "dispatcher.h"
 #include <openenclave/enclave.h>
+#include <string.h>
 
 ecall_dispatcher::ecall_dispatcher(
     const char* name,
     enclave_config_data_t* enclave_config)
-    : m_crypto(NULL), m_attestation(NULL)
+    : m_crypto(NULL), m_attestation(NULL), m_channel(NULL)
 {
     m_enclave_config = enclave_config;
     m_initialized = initialize(name);
@@ -20,6 +21,9 @@ ecall_dispatcher::~ecall_dispatcher()
 
     if (m_attestation)
         delete m_attestation;
+
+    if (m_channel)
+        delete m_channel;
 }
 
 bool ecall_dispatcher::initialize(const char* name)
@@ -67,6 +71,13 @@ bool ecall_dispatcher::initialize(const char* name)
     {
         goto exit;
     }
+
+    // Generate the ephemeral key for the attested channel.
+    m_channel = new AttestedChannel();
+    if (m_channel == NULL)
+    {
+        goto exit;
+    }
     ret = true;
 
 exit:
@@ -77,17 +88,17 @@ exit:
 }
 
 /**
- * Return the public key of this enclave along with the enclave's remote report.
- * The enclave that receives the key will use the remote report to attest this
- * enclave.
+ * Return the ephemeral channel public key of this enclave along with the
+ * enclave's remote report. The enclave that receives the key will use the
+ * remote report to attest this enclave and the integrity of the key.
  */
 int ecall_dispatcher::get_remote_report_with_pubkey(
-    uint8_t** pem_key,
-    size_t* key_size,
+    uint8_t** pubkey,
+    size_t* pubkey_size,
     uint8_t** remote_report,
     size_t* remote_report_size)
 {
-    uint8_t pem_public_key[512];
+    const uint8_t* public_key = NULL;
     uint8_t* report = NULL;
     size_t report_size = 0;
     uint8_t* key_buf = NULL;
@@ -100,12 +111,12 @@ int ecall_dispatcher::get_remote_report_with_pubkey(
         goto exit;
     }
 
-    m_crypto->retrieve_public_key(pem_public_key);
+    public_key = m_channel->get_public_key();
 
     // Generate a remote report for the public key so that the enclave that
     // receives the key can attest this enclave.
     if (m_attestation->generate_remote_report(
-            pem_public_key, sizeof(pem_public_key), &report, &report_size))
+            public_key, CHANNEL_PUBLIC_KEY_SIZE, &report, &report_size))
     {
         // Allocate memory on the host and copy the report over.
         *remote_report = (uint8_t*)oe_host_malloc(report_size);
@@ -118,16 +129,16 @@ int ecall_dispatcher::get_remote_report_with_pubkey(
         *remote_report_size = report_size;
         oe_free_report(report);
 
-        key_buf = (uint8_t*)oe_host_malloc(512);
+        key_buf = (uint8_t*)oe_host_malloc(CHANNEL_PUBLIC_KEY_SIZE);
         if (key_buf == NULL)
         {
             ret = OE_OUT_OF_MEMORY;
             goto exit;
         }
-        memcpy(key_buf, pem_public_key, sizeof(pem_public_key));
+        memcpy(key_buf, public_key, CHANNEL_PUBLIC_KEY_SIZE);
 
-        *pem_key = key_buf;
-        *key_size = sizeof(pem_public_key);
+        *pubkey = key_buf;
+        *pubkey_size = CHANNEL_PUBLIC_KEY_SIZE;
 
         ret = 0;
         TRACE_ENCLAVE("get_remote_report_with_pubkey succeeded");
@@ -151,8 +162,8 @@ exit:
 }
 
 int ecall_dispatcher::verify_report_and_set_pubkey(
-    uint8_t* pem_key,
-    size_t key_size,
+    uint8_t* pubkey,
+    size_t pubkey_size,
     uint8_t* remote_report,
     size_t remote_report_size)
 {
@@ -164,13 +175,11 @@ int ecall_dispatcher::verify_report_and_set_pubkey(
         goto exit;
     }
 
-    // Attest the remote report and accompanying key.
-    if (m_attestation->attest_remote_report(
-            remote_report, remote_report_size, pem_key, key_size))
-    {
-        memcpy(m_crypto->get_the_other_enclave_public_key(), pem_key, key_size);
-    }
-    else
+    // Attest the remote report and accompanying key, then derive the
+    // session keys of the channel from it.
+    if (!m_attestation->attest_remote_report(
+            remote_report, remote_report_size, pubkey, pubkey_size) ||
+        !m_channel->establish(pubkey, pubkey_size))
     {
         TRACE_ENCLAVE("verify_report_and_set_pubkey failed.");
         goto exit;
@@ -184,8 +193,9 @@ exit:
 
 int ecall_dispatcher::generate_encrypted_message(uint8_t** data, size_t* size)
 {
-    uint8_t encrypted_data_buf[1024];
+    uint8_t encrypted_data_buf[CHANNEL_SEALED_SIZE(ENCLAVE_SECRET_DATA_SIZE)];
     size_t encrypted_data_size;
+    uint8_t* host_buf = NULL;
     int ret = 1;
 
     if (m_initialized == false)
@@ -195,25 +205,25 @@ int ecall_dispatcher::generate_encrypted_message(uint8_t** data, size_t* size)
     }
 
     encrypted_data_size = sizeof(encrypted_data_buf);
-    if (m_crypto->Encrypt(
-            m_crypto->get_the_other_enclave_public_key(),
+    if (!m_channel->seal(
             m_enclave_config->enclave_secret_data,
             ENCLAVE_SECRET_DATA_SIZE,
             encrypted_data_buf,
             &encrypted_data_size))
     {
-        uint8_t* host_buf = (uint8_t*)oe_host_malloc(encrypted_data_size);
-        memcpy(host_buf, encrypted_data_buf, encrypted_data_size);
-        TRACE_ENCLAVE(
-            "enclave: generate_encrypted_message: encrypted_data_size = %ld",
-            encrypted_data_size);
-        *data = host_buf;
-        *size = encrypted_data_size;
+        TRACE_ENCLAVE("generate_encrypted_message failed.");
+        goto exit;
     }
-    else
+
+    host_buf = (uint8_t*)oe_host_malloc(encrypted_data_size);
+    if (host_buf == NULL)
     {
+        ret = OE_OUT_OF_MEMORY;
         goto exit;
     }
+    memcpy(host_buf, encrypted_data_buf, encrypted_data_size);
+    *data = host_buf;
+    *size = encrypted_data_size;
     ret = 0;
 exit:
     return ret;
@@ -223,7 +233,7 @@ int ecall_dispatcher::process_encrypted_msg(
     uint8_t* encrypted_data,
     size_t encrypted_data_size)
 {
-    uint8_t data[1024];
+    uint8_t data[ENCLAVE_SECRET_DATA_SIZE];
     size_t data_size = 0;
     int ret = 1;
 
@@ -234,38 +244,24 @@ int ecall_dispatcher::process_encrypted_msg(
     }
 
     data_size = sizeof(data);
-    if (m_crypto->decrypt(
-            encrypted_data, encrypted_data_size, data, &data_size))
+    if (!m_channel->open(encrypted_data, encrypted_data_size, data, &data_size))
     {
-        // This is where the business logic for verifying the data should be.
-        // In this sample, both enclaves start with identical data in
-        // m_enclave_config->enclave_secret_data.
-        // The following checking is to make sure the decrypted values are what
-        // we have expected.
-        TRACE_ENCLAVE("Decrypted data: ");
-        for (uint32_t i = 0; i < data_size; ++i)
-        {
-            printf("%d ", data[i]);
-            if (m_enclave_config->enclave_secret_data[i] != data[i])
-            {
-                printf(
-                    "Expecting [0x%x] but received unexpected value "
-                    "[0x%x]\n ",
-                    m_enclave_config->enclave_secret_data[i],
-                    data[i]);
-                ret = 1;
-                break;
-            }
-        }
-        printf("\n");
+        TRACE_ENCLAVE("Enclave:ecall_dispatcher::process_encrypted_msg failed");
+        goto exit;
     }
-    else
+
+    // This is where the business logic for verifying the data should be.
+    // In this sample, both enclaves start with identical data in
+    // m_enclave_config->enclave_secret_data.
+    // The following checking is to make sure the decrypted values are what
+    // we have expected.
+    if (data_size != ENCLAVE_SECRET_DATA_SIZE ||
+        memcmp(m_enclave_config->enclave_secret_data, data, data_size) != 0)
     {
-        TRACE_ENCLAVE("Enclave:ecall_dispatcher::process_encrypted_msg failed");
+        TRACE_ENCLAVE("Decrypted data does not match the enclave internal "
+                      "secret data");
         goto exit;
     }
-    TRACE_ENCLAVE("Decrypted data matches with the enclave internal secret "
-                  "data: descryption validation succeeded");
     ret = 0;
 exit:
     return ret;
@@ -5,6 +5,7 @@
 #include <openenclave/enclave.h>
 #include <string>
 #include "attestation.h"
+#include "channel.h"
 #include "crypto.h"
 
 using namespace std;
@@ -22,6 +23,7 @@ class ecall_dispatcher
     bool m_initialized;
     Crypto* m_crypto;
     Attestation* m_attestation;
+    AttestedChannel* m_channel;
     string m_name;
     enclave_config_data_t* m_enclave_config;
     unsigned char m_other_enclave_mrsigner[32];
@@ -30,13 +32,13 @@ class ecall_dispatcher
     ecall_dispatcher(const char* name, enclave_config_data_t* enclave_config);
     ~ecall_dispatcher();
     int get_remote_report_with_pubkey(
-        uint8_t** pem_key,
-        size_t* key_size,
+        uint8_t** pubkey,
+        size_t* pubkey_size,
         uint8_t** remote_report,
         size_t* remote_report_size);
     int verify_report_and_set_pubkey(
-        uint8_t* pem_key,
-        size_t key_size,
+        uint8_t* pubkey,
+        size_t pubkey_size,
         uint8_t* remote_report,
         size_t remote_report_size);
     int generate_encrypted_message(uint8_t** data, size_t* size);
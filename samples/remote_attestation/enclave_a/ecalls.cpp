@@ -30,33 +30,34 @@ enclave_config_data_t config_data = {g_enclave_secret_data,
 static ecall_dispatcher dispatcher("Enclave1", &config_data);
 const char* enclave_name = "Enclave1";
 /**
- * Return the public key of this enclave along with the enclave's remote report.
+ * Return the channel public key of this enclave along with the enclave's
+ * remote report.
  * Another enclave can use the remote report to attest the enclave and verify
  * the integrity of the public key.
  */
 int get_remote_report_with_pubkey(
-    uint8_t** pem_key,
-    size_t* key_size,
+    uint8_t** pubkey,
+    size_t* pubkey_size,
     uint8_t** remote_report,
     size_t* remote_report_size)
 {
     TRACE_ENCLAVE("enter get_remote_report_with_pubkey");
     return dispatcher.get_remote_report_with_pubkey(
-        pem_key, key_size, remote_report, remote_report_size);
+        pubkey, pubkey_size, remote_report, remote_report_size);
 }
 
-// Attest and store the public key of another enclave.
+// Attest the public key of another enclave and establish the channel with it.
 int verify_report_and_set_pubkey(
-    uint8_t* pem_key,
-    size_t key_size,
+    uint8_t* pubkey,
+    size_t pubkey_size,
     uint8_t* remote_report,
     size_t remote_report_size)
 {
     return dispatcher.verify_report_and_set_pubkey(
-        pem_key, key_size, remote_report, remote_report_size);
+        pubkey, pubkey_size, remote_report, remote_report_size);
 }
 
-// Encrypt message for another enclave using the public key stored for it.
+// Encrypt message for another enclave using the attested channel.
 int generate_encrypted_message(uint8_t** data, size_t* size)
 {
     return dispatcher.generate_encrypted_message(data, size);
@@ -3,6 +3,7 @@
 
 #include <openenclave/host.h>
 #include <stdio.h>
+#include <chrono>
 #include "remoteattestation_u.h"
 
 oe_enclave_t* create_enclave(const char* enclave_path)
@@ -37,6 +38,47 @@ void terminate_enclave(oe_enclave_t* enclave)
     printf("Host: Enclave successfully terminated.\n");
 }
 
+int measure_throughput(oe_enclave_t* sender, oe_enclave_t* receiver)
+{
+    const size_t message_count = 10000;
+    uint8_t* encrypted_msg = NULL;
+    size_t encrypted_msg_size = 0;
+    oe_result_t result = OE_OK;
+    int ret = 0;
+
+    printf("Host: Sending %zu messages through the channel\n", message_count);
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < message_count; i++)
+    {
+        result = generate_encrypted_message(
+            sender, &ret, &encrypted_msg, &encrypted_msg_size);
+        if ((result != OE_OK) || (ret != 0))
+            break;
+
+        result = process_encrypted_msg(
+            receiver, &ret, encrypted_msg, encrypted_msg_size);
+        free(encrypted_msg);
+        encrypted_msg = NULL;
+        if ((result != OE_OK) || (ret != 0))
+            break;
+    }
+
+    if ((result != OE_OK) || (ret != 0))
+    {
+        printf(
+            "Host: channel throughput test failed. %s\n",
+            oe_result_str(result));
+        return ret ? ret : 1;
+    }
+
+    std::chrono::duration<double> seconds =
+        std::chrono::steady_clock::now() - start;
+    printf(
+        "Host: %.0f messages/sec\n", (double)message_count / seconds.count());
+    return 0;
+}
+
 int main(int argc, const char* argv[])
 {
     oe_enclave_t* enclave_a = NULL;
@@ -45,8 +87,8 @@ int main(int argc, const char* argv[])
     size_t encrypted_msg_size = 0;
     oe_result_t result = OE_OK;
     int ret = 1;
-    uint8_t* pem_key = NULL;
-    size_t pem_key_size = 0;
+    uint8_t* pubkey = NULL;
+    size_t pubkey_size = 0;
     uint8_t* remote_report = NULL;
     size_t remote_report_size = 0;
 
@@ -74,8 +116,8 @@ int main(int argc, const char* argv[])
     result = get_remote_report_with_pubkey(
         enclave_a,
         &ret,
-        &pem_key,
-        &pem_key_size,
+        &pubkey,
+        &pubkey_size,
         &remote_report,
         &remote_report_size);
     if ((result != OE_OK) || (ret != 0))
@@ -87,15 +129,15 @@ int main(int argc, const char* argv[])
             ret = 1;
         goto exit;
     }
-    printf("Host: 1st enclave's public key: \n%s", pem_key);
+    printf("Host: 1st enclave's public key: %zu bytes\n", pubkey_size);
 
     printf("Host: requesting 2nd enclave to attest 1st enclave's the remote "
            "report and the public key\n");
     result = verify_report_and_set_pubkey(
         enclave_b,
         &ret,
-        pem_key,
-        pem_key_size,
+        pubkey,
+        pubkey_size,
         remote_report,
         remote_report_size);
     if ((result != OE_OK) || (ret != 0))
@@ -107,8 +149,8 @@ int main(int argc, const char* argv[])
             ret = 1;
         goto exit;
     }
-    free(pem_key);
-    pem_key = NULL;
+    free(pubkey);
+    pubkey = NULL;
     free(remote_report);
     remote_report = NULL;
 
@@ -117,8 +159,8 @@ int main(int argc, const char* argv[])
     result = get_remote_report_with_pubkey(
         enclave_b,
         &ret,
-        &pem_key,
-        &pem_key_size,
+        &pubkey,
+        &pubkey_size,
         &remote_report,
         &remote_report_size);
     if ((result != OE_OK) || (ret != 0))
@@ -131,15 +173,15 @@ int main(int argc, const char* argv[])
         goto exit;
     }
 
-    printf("Host: 2nd enclave's public key: \n%s", pem_key);
+    printf("Host: 2nd enclave's public key: %zu bytes\n", pubkey_size);
 
     printf("Host: Requesting first enclave to attest 2nd enclave's "
            "remote report and the public key=====\n");
     result = verify_report_and_set_pubkey(
         enclave_a,
         &ret,
-        pem_key,
-        pem_key_size,
+        pubkey,
+        pubkey_size,
         remote_report,
         remote_report_size);
     if ((result != OE_OK) || (ret != 0))
@@ -151,8 +193,8 @@ int main(int argc, const char* argv[])
             ret = 1;
         goto exit;
     }
-    free(pem_key);
-    pem_key = NULL;
+    free(pubkey);
+    pubkey = NULL;
     free(remote_report);
     remote_report = NULL;
 
@@ -214,11 +256,15 @@ int main(int argc, const char* argv[])
     // Free host memory allocated by the enclave.
     free(encrypted_msg);
     encrypted_msg = NULL;
-    ret = 0;
+
+    // Measure the throughput of the channel. Once the channel is established,
+    // each message only costs symmetric crypto and two ECALLs.
+    if ((ret = measure_throughput(enclave_a, enclave_b)) != 0)
+        goto exit;
 
 exit:
-    if (pem_key)
-        free(pem_key);
+    if (pubkey)
+        free(pubkey);
 
     if (remote_report)
         free(remote_report);
@@ -0,0 +1,80 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/arena.h>
+#include <openenclave/internal/tests.h>
+#include "arena_t.h"
+
+void enc_set_arena_capacity(size_t capacity)
+{
+    OE_TEST(oe_arena_set_capacity(capacity) == OE_OK);
+}
+
+size_t enc_arena_alloc(size_t count, size_t size)
+{
+    oe_arena_stats_t stats;
+    uint8_t* prev = NULL;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint8_t* p = (uint8_t*)oe_arena_alloc(size);
+
+        OE_TEST(p != NULL);
+        OE_TEST(((uint64_t)p % OE_ARENA_ALIGNMENT) == 0);
+        OE_TEST(oe_is_within_enclave(p, size));
+
+        /* The previous block must not have been overwritten */
+        if (prev)
+            OE_TEST(prev[0] == (uint8_t)(i - 1) && prev[size - 1] == 0xAA);
+
+        memset(p, 0xAA, size);
+        p[0] = (uint8_t)i;
+        prev = p;
+    }
+
+    uint8_t* zeros = (uint8_t*)oe_arena_calloc(4, size);
+    OE_TEST(zeros != NULL);
+    for (size_t i = 0; i < 4 * size; i++)
+        OE_TEST(zeros[i] == 0);
+
+    OE_TEST(oe_arena_get_stats(&stats) == OE_OK);
+    return stats.used_bytes;
+}
+
+void enc_arena_stats(
+    uint64_t* capacity,
+    uint64_t* used_bytes,
+    uint64_t* overflow_count)
+{
+    oe_arena_stats_t stats;
+
+    OE_TEST(oe_arena_get_stats(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_arena_get_stats(&stats) == OE_OK);
+
+    *capacity = stats.capacity;
+    *used_bytes = stats.used_bytes;
+    *overflow_count = stats.overflow_count;
+}
+
+void enc_arena_across_ocall(void)
+{
+    char* p = (char*)oe_arena_alloc(64);
+
+    OE_TEST(p != NULL);
+    memset(p, 'x', 64);
+
+    OE_TEST(host_noop() == OE_OK);
+
+    for (size_t i = 0; i < 64; i++)
+        OE_TEST(p[i] == 'x');
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    128,  /* StackPageCount */
+    4);   /* TCSCount */
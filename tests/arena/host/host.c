@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "arena_u.h"
+
+#define ARENA_CAPACITY (64 * 1024)
+
+void host_noop(void)
+{
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    uint64_t capacity;
+    uint64_t used_bytes;
+    uint64_t overflow_count;
+    size_t in_use;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if ((result = oe_create_arena_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    /* With the arena disabled, every allocation overflows to the heap */
+    OE_TEST(
+        enc_arena_stats(enclave, &capacity, &used_bytes, &overflow_count) ==
+        OE_OK);
+    OE_TEST(capacity == 0);
+    OE_TEST(used_bytes == 0);
+    OE_TEST(overflow_count > 0);
+
+    OE_TEST(enc_arena_alloc(enclave, &in_use, 16, 100) == OE_OK);
+    OE_TEST(in_use == 0);
+
+    /* Enable the arena */
+    OE_TEST(enc_set_arena_capacity(enclave, ARENA_CAPACITY) == OE_OK);
+
+    OE_TEST(enc_arena_alloc(enclave, &in_use, 16, 100) == OE_OK);
+    OE_TEST(in_use > 16 * 100);
+    OE_TEST(in_use <= ARENA_CAPACITY);
+
+    /* The arena is rewound when the ecall returns: only the marshalling
+     * buffer of this ecall should be in use on entry. */
+    OE_TEST(
+        enc_arena_stats(enclave, &capacity, &used_bytes, &overflow_count) ==
+        OE_OK);
+    OE_TEST(capacity == ARENA_CAPACITY);
+    OE_TEST(used_bytes > 0 && used_bytes < in_use);
+
+    /* Requests larger than the arena overflow to the heap */
+    OE_TEST(enc_arena_alloc(enclave, &in_use, 4, ARENA_CAPACITY) == OE_OK);
+    OE_TEST(in_use <= ARENA_CAPACITY);
+
+    OE_TEST(enc_arena_across_ocall(enclave) == OE_OK);
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    printf("=== passed all tests (arena)\n");
+
+    return 0;
+}
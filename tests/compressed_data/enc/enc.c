@@ -0,0 +1,90 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compressed_data_t.h"
+
+/* Generated by "oesign compress" (see CMakeLists.txt) */
+extern oe_compressed_data_t test_data;
+
+oe_result_t enc_get_data(uint64_t* address)
+{
+    oe_result_t result;
+    const void* data = NULL;
+    size_t size = 0;
+
+    if ((result = oe_get_compressed_data(&test_data, &data, &size)) == OE_OK)
+        *address = (uint64_t)data;
+
+    return result;
+}
+
+oe_result_t enc_check_data(const void* data, size_t size)
+{
+    oe_result_t result;
+    const void* decompressed = NULL;
+    size_t decompressed_size = 0;
+
+    if ((result = oe_get_compressed_data(
+             &test_data, &decompressed, &decompressed_size)) != OE_OK)
+        return result;
+
+    /* Only the compressed bytes are part of the enclave image */
+    OE_TEST(test_data.image_size < size);
+    OE_TEST(oe_is_within_enclave(decompressed, decompressed_size));
+
+    if (decompressed_size != size || memcmp(decompressed, data, size) != 0)
+        return OE_VERIFY_FAILED;
+
+    return OE_OK;
+}
+
+void enc_release_data(void)
+{
+    oe_release_compressed_data(&test_data);
+}
+
+/* An image outside the enclave is not measured, so it is rejected */
+oe_result_t enc_get_host_image(const void* image, size_t image_size)
+{
+    oe_compressed_data_t compressed =
+        OE_COMPRESSED_DATA_INITIALIZER(image, image_size);
+    const void* data = NULL;
+    size_t size = 0;
+
+    return oe_get_compressed_data(&compressed, &data, &size);
+}
+
+/* A corrupt image fails, and keeps failing without decompressing again */
+oe_result_t enc_get_corrupt_image(void)
+{
+    oe_result_t result;
+    uint8_t* image = (uint8_t*)malloc(test_data.image_size);
+    oe_compressed_data_t compressed =
+        OE_COMPRESSED_DATA_INITIALIZER(image, test_data.image_size);
+    const void* data = NULL;
+    size_t size = 0;
+
+    OE_TEST(image != NULL);
+    memcpy(image, test_data.image, test_data.image_size);
+    image[test_data.image_size - 1] ^= 0xff;
+
+    result = oe_get_compressed_data(&compressed, &data, &size);
+    OE_TEST(result != OE_OK && data == NULL && size == 0);
+    OE_TEST(compressed.initialized && compressed.data == NULL);
+    OE_TEST(oe_get_compressed_data(&compressed, &data, &size) == result);
+
+    free(image);
+    return result;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    8);   /* TCSCount */
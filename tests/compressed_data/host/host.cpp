@@ -0,0 +1,101 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "compressed_data_u.h"
+
+#define NUM_THREADS 8
+
+static void _get_data(oe_enclave_t* enclave, uint64_t* address)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_TEST(enc_get_data(enclave, &result, address) == OE_OK);
+    OE_TEST(result == OE_OK);
+}
+
+/* Threads racing on the first call must all see the one published copy */
+static uint64_t _get_data_concurrently(oe_enclave_t* enclave)
+{
+    std::vector<std::thread> threads;
+    uint64_t addresses[NUM_THREADS] = {0};
+
+    for (size_t i = 0; i < NUM_THREADS; i++)
+        threads.push_back(std::thread(_get_data, enclave, &addresses[i]));
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (size_t i = 0; i < NUM_THREADS; i++)
+    {
+        OE_TEST(addresses[i] != 0);
+        OE_TEST(addresses[i] == addresses[0]);
+    }
+
+    return addresses[0];
+}
+
+static void _check_data(oe_enclave_t* enclave, const std::vector<char>& data)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    OE_TEST(
+        enc_check_data(enclave, &result, data.data(), data.size()) == OE_OK);
+    OE_TEST(result == OE_OK);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t address = 0;
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH DATA_FILE\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream file(argv[2], std::ios::binary);
+    OE_TEST(file.good());
+    std::vector<char> data(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    OE_TEST(!data.empty());
+
+    const uint32_t flags = oe_get_create_flags();
+    OE_TEST(
+        oe_create_compressed_data_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) ==
+        OE_OK);
+
+    /* The first use decompresses; later uses return the cached copy */
+    address = _get_data_concurrently(enclave);
+    _check_data(enclave, data);
+    OE_TEST(_get_data_concurrently(enclave) == address);
+
+    /* Released data is decompressed again on the next use */
+    OE_TEST(enc_release_data(enclave) == OE_OK);
+    _get_data_concurrently(enclave);
+    _check_data(enclave, data);
+
+    OE_TEST(
+        enc_get_host_image(enclave, &result, data.data(), data.size()) ==
+        OE_OK);
+    OE_TEST(result == OE_INVALID_PARAMETER);
+
+    OE_TEST(enc_get_corrupt_image(enclave, &result) == OE_OK);
+    OE_TEST(result == OE_VERIFY_FAILED);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (compressed_data)\n");
+
+    return 0;
+}
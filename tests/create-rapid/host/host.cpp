@@ -7,6 +7,7 @@
 #include <openenclave/internal/tests.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <thread>
 #include <vector>
 #include "create_rapid_u.h"
@@ -14,6 +15,7 @@
 #define MAX_ENCLAVES 200
 #define MAX_SIMULTANEOUS_ENCLAVES 32
 #define MAX_THREADS 32
+#define MAX_SHARED_ENCLAVES 100
 
 static void _launch_enclave(const char* path, uint32_t flags, bool call_enclave)
 {
@@ -140,6 +142,142 @@ static void _test_multithreaded(
         thread.join();
 }
 
+// Pss divides each page by the number of times it is mapped, so pages that
+// several instances map from the same shared pages count once in total.
+// VmRSS would count them once per mapping.
+static size_t _get_pss_kb()
+{
+    char line[256];
+    size_t pss = 0;
+    FILE* file = fopen("/proc/self/smaps_rollup", "r");
+
+    OE_TEST(file != NULL);
+
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strncmp(line, "Pss:", 4) == 0)
+            pss = strtoul(line + 4, NULL, 10);
+    }
+
+    fclose(file);
+    return pss;
+}
+
+// Sums the Pss of the mappings of the shared pages
+static size_t _get_shared_pss_kb()
+{
+    char line[512];
+    size_t pss = 0;
+    bool shared = false;
+    FILE* file = fopen("/proc/self/smaps", "r");
+
+    OE_TEST(file != NULL);
+
+    while (fgets(line, sizeof(line), file))
+    {
+        unsigned long start;
+        unsigned long end;
+
+        // Each mapping starts with a line giving its address range
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+            shared = strstr(line, "oe-shared-pages") != NULL;
+        else if (shared && strncmp(line, "Pss:", 4) == 0)
+            pss += strtoul(line + 4, NULL, 10);
+    }
+
+    fclose(file);
+    return pss;
+}
+
+static size_t _count_shared_mappings()
+{
+    char line[512];
+    size_t count = 0;
+    FILE* file = fopen("/proc/self/maps", "r");
+
+    OE_TEST(file != NULL);
+
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strstr(line, "oe-shared-pages"))
+            count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+// In simulation mode, the read-only segments of every instance are mapped
+// from the same shared pages, so each additional instance should only add
+// its writable pages to the resident set.
+//
+// The test asserts that the Pss growth per additional instance is at most
+// the growth for the first instance less its shared pages, plus a tolerance
+// of SHARED_PAGES_TOLERANCE_PERCENT of the growth for the first instance.
+#define SHARED_PAGES_TOLERANCE_PERCENT 10
+
+static void _test_shared_pages(const char* path, uint32_t flags)
+{
+    oe_enclave_t* enclaves[MAX_SHARED_ENCLAVES];
+    size_t pss_before;
+    size_t pss_first = 0;
+    size_t pss_after;
+    size_t shared_kb = 0;
+    size_t first_kb;
+    size_t each_kb;
+
+    if ((flags & OE_ENCLAVE_FLAG_SIMULATE) == 0)
+        return;
+
+    pss_before = _get_pss_kb();
+
+    for (int i = 0; i < MAX_SHARED_ENCLAVES; i++)
+    {
+        oe_result_t result = oe_create_create_rapid_enclave(
+            path, OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclaves[i]);
+
+        if (result != OE_OK)
+            oe_put_err("oe_create_create_rapid_enclave(): result=%u", result);
+
+        int return_value;
+        OE_TEST(test(enclaves[i], &return_value, i) == OE_OK);
+        OE_TEST(return_value == 2 * i);
+
+        if (i == 0)
+        {
+            pss_first = _get_pss_kb();
+            shared_kb = _get_shared_pss_kb();
+        }
+    }
+
+    pss_after = _get_pss_kb();
+
+    // Each instance maps at least one shared segment
+    OE_TEST(_count_shared_mappings() >= MAX_SHARED_ENCLAVES);
+
+    first_kb = pss_first - pss_before;
+    each_kb = (pss_after - pss_first) / (MAX_SHARED_ENCLAVES - 1);
+
+    printf(
+        "=== %d simulated enclaves: Pss grew by %zu KB for the first "
+        "(%zu KB shared) and %zu KB for each other\n",
+        MAX_SHARED_ENCLAVES,
+        first_kb,
+        shared_kb,
+        each_kb);
+
+    OE_TEST(shared_kb > 0 && shared_kb < first_kb);
+    OE_TEST(
+        each_kb <= first_kb - shared_kb +
+                       first_kb * SHARED_PAGES_TOLERANCE_PERCENT / 100);
+
+    for (int i = 0; i < MAX_SHARED_ENCLAVES; i++)
+        OE_TEST(oe_terminate_enclave(enclaves[i]) == OE_OK);
+
+    // The shared pages are released with the last instance
+    OE_TEST(_count_shared_mappings() == 0);
+}
+
 int main(int argc, const char* argv[])
 {
     if (argc != 2)
@@ -162,5 +300,8 @@ int main(int argc, const char* argv[])
     _test_multithreaded(argv[1], flags, false);
     _test_multithreaded(argv[1], flags, true);
 
+    // Test sharing of read-only pages between simulated enclaves.
+    _test_shared_pages(argv[1], flags);
+
     return 0;
 }
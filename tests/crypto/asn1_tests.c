@@ -9,10 +9,14 @@
 #include <openenclave/internal/cert.h>
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/internal/tests.h>
+#include <openenclave/internal/trace.h>
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if !defined(OE_BUILD_ENCLAVE)
+#include <time.h>
+#endif
 #include "readfile.h"
 #include "tests.h"
 
@@ -363,7 +367,401 @@ static void _test_asn1_parsing(void)
     printf("=== passed %s()\n", __FUNCTION__);
 }
 
+/* OIDs of the extensions built by _build_extensions() */
+static const char _BASIC_CONSTRAINTS_OID[] = "2.5.29.19";
+static const char _SGX_OID[] = "1.2.840.113741.1.13.1";
+
+/* Appends a DER element with a single-octet identifier */
+static size_t _put_element(
+    uint8_t* buf,
+    size_t pos,
+    uint8_t identifier,
+    const uint8_t* data,
+    size_t size)
+{
+    buf[pos++] = identifier;
+
+    if (size < 0x80)
+    {
+        buf[pos++] = (uint8_t)size;
+    }
+    else if (size < 0x100)
+    {
+        buf[pos++] = 0x81;
+        buf[pos++] = (uint8_t)size;
+    }
+    else
+    {
+        OE_TEST(size < 0x10000);
+        buf[pos++] = 0x82;
+        buf[pos++] = (uint8_t)(size >> 8);
+        buf[pos++] = (uint8_t)size;
+    }
+
+    memcpy(buf + pos, data, size);
+    return pos + size;
+}
+
+/* Builds an Extensions SEQUENCE with a critical basic constraints extension
+ * followed by an extension whose value is **value** */
+static size_t _build_extensions(
+    uint8_t* buf,
+    size_t buf_size,
+    const uint8_t* value,
+    size_t value_size)
+{
+    static const uint8_t bc_oid[] = {0x55, 0x1d, 0x13};
+    static const uint8_t sgx_oid[] =
+        {0x2a, 0x86, 0x48, 0x86, 0xf8, 0x4d, 0x01, 0x0d, 0x01};
+    static const uint8_t bc_value[] = {0x30, 0x00};
+    static const uint8_t true_value[] = {0xff};
+    uint8_t* ext = (uint8_t*)malloc(buf_size);
+    uint8_t* body = (uint8_t*)malloc(buf_size);
+    size_t body_size = 0;
+    size_t n;
+
+    OE_TEST(ext && body);
+    OE_TEST(value_size + 64 < buf_size);
+
+    n = _put_element(ext, 0, 0x06, bc_oid, sizeof(bc_oid));
+    n = _put_element(ext, n, 0x01, true_value, sizeof(true_value));
+    n = _put_element(ext, n, 0x04, bc_value, sizeof(bc_value));
+    body_size = _put_element(body, body_size, 0x30, ext, n);
+
+    n = _put_element(ext, 0, 0x06, sgx_oid, sizeof(sgx_oid));
+    n = _put_element(ext, n, 0x04, value, value_size);
+    body_size = _put_element(body, body_size, 0x30, ext, n);
+
+    n = _put_element(buf, 0, 0x30, body, body_size);
+
+    free(ext);
+    free(body);
+    return n;
+}
+
+static void _get_sgx_extension(uint8_t* data, size_t* size)
+{
+    oe_cert_t cert;
+
+    OE_TEST(read_cert("../data/asn1_cert.pem", _CERT) == OE_OK);
+    OE_TEST(oe_cert_read_pem(&cert, _CERT, strlen(_CERT) + 1) == OE_OK);
+    OE_TEST(oe_cert_find_extension(&cert, _SGX_OID, data, size) == OE_OK);
+    oe_cert_free(&cert);
+}
+
+static void _test_get_length(void)
+{
+    static const struct
+    {
+        uint8_t der[4];
+        size_t size;
+        oe_result_t result;
+        size_t length;
+    } tests[] = {
+        {{0x02, 0xaa, 0xbb}, 3, OE_OK, 2},
+        {{0x81, 0x80}, 2, OE_FAILURE, 0},       /* runs past the end */
+        {{0x81, 0x05}, 2, OE_FAILURE, 0},       /* not minimal */
+        {{0x82, 0x00, 0x90}, 3, OE_FAILURE, 0}, /* leading zero */
+        {{0x80, 0x00}, 2, OE_FAILURE, 0},       /* indefinite */
+        {{0x83, 0x01}, 2, OE_FAILURE, 0},       /* truncated */
+    };
+
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    for (size_t i = 0; i < OE_COUNTOF(tests); i++)
+    {
+        oe_asn1_t asn1;
+        size_t length = 0;
+
+        oe_asn1_init(&asn1, tests[i].der, tests[i].size);
+        OE_TEST(oe_asn1_get_length(&asn1, &length) == tests[i].result);
+        OE_TEST(length == tests[i].length);
+    }
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+static void _test_extension_index(void)
+{
+    uint8_t value[4096];
+    size_t value_size = sizeof(value);
+    uint8_t der[4096 + 64];
+    size_t der_size;
+    oe_asn1_extensions_t extensions;
+    const oe_asn1_extension_t* extension;
+
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    _get_sgx_extension(value, &value_size);
+    der_size = _build_extensions(der, sizeof(der), value, value_size);
+
+    OE_TEST(oe_asn1_index_extensions(der, der_size, &extensions) == OE_OK);
+    OE_TEST(extensions.count == 2);
+
+    /* Entries point into the DER data */
+    OE_TEST(
+        oe_asn1_find_extension(
+            &extensions, _BASIC_CONSTRAINTS_OID, &extension) == OE_OK);
+    OE_TEST(extension->critical);
+    OE_TEST(extension->size == 2);
+    OE_TEST(extension->data > der && extension->data < der + der_size);
+
+    OE_TEST(
+        oe_asn1_find_extension(&extensions, _SGX_OID, &extension) == OE_OK);
+    OE_TEST(!extension->critical);
+    OE_TEST(extension->size == value_size);
+    OE_TEST(memcmp(extension->data, value, value_size) == 0);
+
+    /* An OID that prefixes an indexed one does not match it */
+    OE_TEST(
+        oe_asn1_find_extension(
+            &extensions, "1.2.840.113741.1.13", &extension) == OE_NOT_FOUND);
+    OE_TEST(
+        oe_asn1_find_extension(&extensions, "not-an-oid", &extension) ==
+        OE_NOT_FOUND);
+
+    OE_TEST(oe_asn1_get_extension(&extensions, 1) != NULL);
+    OE_TEST(oe_asn1_get_extension(&extensions, 2) == NULL);
+    oe_asn1_free_extensions(&extensions);
+    OE_TEST(extensions.count == 0);
+
+    /* Trailing data is rejected */
+    der[der_size] = 0;
+    OE_TEST(
+        oe_asn1_index_extensions(der, der_size + 1, &extensions) ==
+        OE_FAILURE);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+/* Number of extensions in many_extensions.pem, more than fit inline */
+#define MANY_EXTENSIONS 40
+
+/* Builds an Extensions SEQUENCE with extensions 1.2.3.1 to 1.2.3.count,
+ * each with a value of 04 01 NN where NN is the last arc */
+static size_t _build_many_extensions(uint8_t* buf, size_t count)
+{
+    uint8_t body[MANY_EXTENSIONS * 16];
+    size_t body_size = 0;
+
+    for (size_t i = 1; i <= count; i++)
+    {
+        const uint8_t oid[] = {0x2a, 0x03, (uint8_t)i};
+        const uint8_t value[] = {0x04, 0x01, (uint8_t)i};
+        uint8_t ext[16];
+        size_t n;
+
+        n = _put_element(ext, 0, 0x06, oid, sizeof(oid));
+        n = _put_element(ext, n, 0x04, value, sizeof(value));
+        body_size = _put_element(body, body_size, 0x30, ext, n);
+    }
+
+    return _put_element(buf, 0, 0x30, body, body_size);
+}
+
+static void _test_many_extensions(void)
+{
+    static const size_t lookups[] = {1, 31, 32, 33, MANY_EXTENSIONS};
+    uint8_t der[MANY_EXTENSIONS * 16 + 8];
+    size_t der_size;
+    oe_asn1_extensions_t extensions;
+    const oe_asn1_extension_t* extension;
+    oe_cert_t cert;
+
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    /* Entries past the inline ones are indexed too */
+    der_size = _build_many_extensions(der, MANY_EXTENSIONS);
+    OE_TEST(oe_asn1_index_extensions(der, der_size, &extensions) == OE_OK);
+    OE_TEST(extensions.count == MANY_EXTENSIONS);
+    OE_TEST(extensions.overflow != NULL);
+
+    for (size_t i = 0; i < MANY_EXTENSIONS; i++)
+    {
+        extension = oe_asn1_get_extension(&extensions, i);
+        OE_TEST(extension && extension->size == 3);
+        OE_TEST(extension->data[2] == i + 1);
+    }
+
+    OE_TEST(
+        oe_asn1_find_extension(&extensions, "1.2.3.40", &extension) ==
+        OE_OK);
+    OE_TEST(extension->data[2] == 40);
+    OE_TEST(
+        oe_asn1_find_extension(&extensions, "1.2.3.41", &extension) ==
+        OE_NOT_FOUND);
+
+    oe_asn1_free_extensions(&extensions);
+    OE_TEST(extensions.count == 0 && extensions.overflow == NULL);
+
+    /* Exactly the inline capacity does not allocate */
+    der_size = _build_many_extensions(der, OE_ASN1_INLINE_EXTENSIONS);
+    OE_TEST(oe_asn1_index_extensions(der, der_size, &extensions) == OE_OK);
+    OE_TEST(extensions.count == OE_ASN1_INLINE_EXTENSIONS);
+    OE_TEST(extensions.overflow == NULL);
+    oe_asn1_free_extensions(&extensions);
+
+    /* A malformed overflow entry releases the overflow. The last five bytes
+     * are the extnValue of the last extension; make it a NULL instead. */
+    der_size = _build_many_extensions(der, MANY_EXTENSIONS);
+    der[der_size - 5] = 0x05;
+    OE_TEST(
+        oe_asn1_index_extensions(der, der_size, &extensions) == OE_FAILURE);
+    OE_TEST(extensions.count == 0 && extensions.overflow == NULL);
+
+    /* Certificates with that many extensions can still be searched */
+    OE_TEST(read_cert("../data/many_extensions.pem", _CERT) == OE_OK);
+    OE_TEST(oe_cert_read_pem(&cert, _CERT, strlen(_CERT) + 1) == OE_OK);
+
+    for (size_t i = 0; i < OE_COUNTOF(lookups); i++)
+    {
+        char oid[16];
+        uint8_t value[8];
+        size_t value_size = sizeof(value);
+
+        snprintf(oid, sizeof(oid), "1.2.3.%zu", lookups[i]);
+        OE_TEST(
+            oe_cert_find_extension(&cert, oid, value, &value_size) == OE_OK);
+        OE_TEST(value_size == 3);
+        OE_TEST(value[0] == 0x04 && value[1] == 0x01);
+        OE_TEST(value[2] == lookups[i]);
+    }
+
+    oe_cert_free(&cert);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+/* Deterministic generator, so that failures can be reproduced */
+static uint32_t _next_random(uint32_t* state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void _test_fuzz(void)
+{
+    const size_t iterations = 5000;
+    log_level_t log_level;
+    uint8_t value[4096];
+    size_t value_size = sizeof(value);
+    uint8_t der[4096 + 64];
+    uint8_t mutated[sizeof(der)];
+    size_t der_size;
+    uint32_t state = 0x2545f491;
+
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    _get_sgx_extension(value, &value_size);
+    der_size = _build_extensions(der, sizeof(der), value, value_size);
+
+    /* Every rejected input traces its errors */
+    log_level = set_current_logging_level(OE_LOG_LEVEL_NONE);
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        size_t size = der_size;
+        size_t flips = 1 + _next_random(&state) % 4;
+        oe_asn1_extensions_t extensions;
+        oe_asn1_t asn1;
+
+        memcpy(mutated, der, der_size);
+
+        /* Flip a few bytes, with a bias towards the headers near the start */
+        for (size_t j = 0; j < flips; j++)
+        {
+            size_t range = (_next_random(&state) & 1) ? 32 : der_size;
+            mutated[_next_random(&state) % range] ^=
+                (uint8_t)(1 + _next_random(&state) % 255);
+        }
+
+        /* Sometimes truncate as well */
+        if (_next_random(&state) % 4 == 0)
+            size = 1 + _next_random(&state) % der_size;
+
+        /* Malformed input may fail, but every span must stay in bounds */
+        if (oe_asn1_index_extensions(mutated, size, &extensions) == OE_OK)
+        {
+            for (size_t j = 0; j < extensions.count; j++)
+            {
+                const oe_asn1_extension_t* e =
+                    oe_asn1_get_extension(&extensions, j);
+
+                OE_TEST(e->oid >= mutated);
+                OE_TEST(e->oid + e->oid_size <= mutated + size);
+                OE_TEST(e->data >= mutated);
+                OE_TEST(e->data + e->size <= mutated + size);
+            }
+
+            oe_asn1_free_extensions(&extensions);
+        }
+
+        /* The generic readers must not crash on the mutated value either */
+        oe_asn1_init(&asn1, mutated, size);
+        _parse(&asn1);
+    }
+
+    set_current_logging_level(log_level);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+#if !defined(OE_BUILD_ENCLAVE)
+static void _test_parse_rate(void)
+{
+    const size_t iterations = 100000;
+    uint8_t value[4096];
+    size_t value_size = sizeof(value);
+    uint8_t der[4096 + 64];
+    size_t der_size;
+    clock_t start;
+    double seconds;
+
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    _get_sgx_extension(value, &value_size);
+    der_size = _build_extensions(der, sizeof(der), value, value_size);
+
+    start = clock();
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        oe_asn1_extensions_t extensions;
+        const oe_asn1_extension_t* extension;
+        oe_asn1_t asn1;
+
+        OE_TEST(oe_asn1_index_extensions(der, der_size, &extensions) == OE_OK);
+        OE_TEST(
+            oe_asn1_find_extension(&extensions, _SGX_OID, &extension) ==
+            OE_OK);
+
+        oe_asn1_init(&asn1, extension->data, extension->size);
+        OE_TEST(_parse(&asn1) == OE_OK);
+        oe_asn1_free_extensions(&extensions);
+    }
+
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    if (seconds > 0)
+        printf(
+            "%zu bytes: %.0f parses/sec\n",
+            der_size,
+            (double)iterations / seconds);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+#endif
+
 void TestASN1(void)
 {
     _test_asn1_parsing();
+    _test_get_length();
+    _test_extension_index();
+    _test_many_extensions();
+    _test_fuzz();
+#if !defined(OE_BUILD_ENCLAVE)
+    _test_parse_rate();
+#endif
 }
@@ -0,0 +1,95 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/cmac.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include "tests.h"
+
+/* Test vectors from RFC 4493 */
+static const uint8_t _key[] = {0x2b,
+                               0x7e,
+                               0x15,
+                               0x16,
+                               0x28,
+                               0xae,
+                               0xd2,
+                               0xa6,
+                               0xab,
+                               0xf7,
+                               0x15,
+                               0x88,
+                               0x09,
+                               0xcf,
+                               0x4f,
+                               0x3c};
+
+static const uint8_t _message[] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e,
+    0x11, 0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03,
+    0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30,
+    0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19,
+    0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b,
+    0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10};
+
+static const size_t _lengths[] = {0, 16, 40, 64};
+
+static const uint8_t _cmacs[][16] = {
+    {0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28,
+     0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46},
+    {0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44,
+     0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c},
+    {0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30,
+     0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27},
+    {0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92,
+     0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe},
+};
+
+void TestCMAC(void)
+{
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    oe_aes_cmac_context_t context;
+
+    OE_TEST(oe_aes_cmac_init(&context, _key, sizeof(_key)) == OE_OK);
+
+    for (size_t i = 0; i < OE_COUNTOF(_lengths); i++)
+    {
+        const size_t length = _lengths[i];
+        oe_aes_cmac_t expected = {{0}};
+        oe_aes_cmac_t cmac;
+
+        memcpy(expected.impl, _cmacs[i], sizeof(_cmacs[i]));
+
+        /* One-shot with a fresh key */
+        OE_TEST(
+            oe_aes_cmac_sign(_key, sizeof(_key), _message, length, &cmac) ==
+            OE_OK);
+        OE_TEST(oe_secure_aes_cmac_equal(&cmac, &expected));
+
+        /* The same context is reused for every message */
+        OE_TEST(
+            oe_aes_cmac_compute(&context, _message, length, &cmac) == OE_OK);
+        OE_TEST(oe_secure_aes_cmac_equal(&cmac, &expected));
+
+        /* Updates that split blocks in every possible place */
+        for (size_t split = 0; split <= length; split++)
+        {
+            OE_TEST(oe_aes_cmac_update(&context, _message, split) == OE_OK);
+            OE_TEST(
+                oe_aes_cmac_update(
+                    &context, _message + split, length - split) == OE_OK);
+            OE_TEST(oe_aes_cmac_final(&context, &cmac) == OE_OK);
+            OE_TEST(oe_secure_aes_cmac_equal(&cmac, &expected));
+        }
+    }
+
+    OE_TEST(oe_aes_cmac_free(&context) == OE_OK);
+
+    OE_TEST(oe_aes_cmac_init(&context, _key, 32) == OE_UNSUPPORTED);
+    OE_TEST(oe_aes_cmac_init(&context, NULL, 16) == OE_INVALID_PARAMETER);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
@@ -0,0 +1,322 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#if defined(OE_BUILD_ENCLAVE)
+#include <openenclave/enclave.h>
+#endif
+
+#include <openenclave/internal/compress.h>
+#include <openenclave/internal/tests.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tests.h"
+
+/* Larger than the 64K window that LZ4 offsets can reach */
+#define LARGE_SIZE (256 * 1024)
+
+/* Deterministic generator so that host and enclave runs see the same data */
+static uint32_t _next(uint32_t* state)
+{
+    *state = *state * 1103515245 + 12345;
+    return *state >> 8;
+}
+
+static void _fill_random(uint8_t* data, size_t size, uint32_t seed)
+{
+    for (size_t i = 0; i < size; i++)
+        data[i] = (uint8_t)_next(&seed);
+}
+
+/* Text-like data with repeats at many distances */
+static void _fill_text(uint8_t* data, size_t size, uint32_t seed)
+{
+    static const char* words[] = {
+        "enclave ", "measure ", "page ", "heap ", "ecall ", "ocall ", "\n"};
+    size_t i = 0;
+
+    while (i < size)
+    {
+        const char* word = words[_next(&seed) % OE_COUNTOF(words)];
+
+        for (; *word && i < size; word++)
+            data[i++] = (uint8_t)*word;
+    }
+}
+
+/* Compresses and decompresses a buffer, checking that the round trip
+ * restores it and that the block fits oe_lz4_compress_bound() */
+static void _test_round_trip(const uint8_t* data, size_t size)
+{
+    const size_t bound = oe_lz4_compress_bound(size);
+    uint8_t* block = (uint8_t*)malloc(bound);
+    uint8_t* output = (uint8_t*)malloc(size ? size : 1);
+    size_t compressed_size = 0;
+
+    OE_TEST(block && output);
+
+    OE_TEST(
+        oe_lz4_compress(data, size, block, bound, &compressed_size) == OE_OK);
+    OE_TEST(compressed_size > 0 && compressed_size <= bound);
+
+    OE_TEST(oe_lz4_decompress(block, compressed_size, output, size) == OE_OK);
+    OE_TEST(size == 0 || memcmp(output, data, size) == 0);
+
+    free(block);
+    free(output);
+}
+
+static void _test_empty(void)
+{
+    uint8_t block[16];
+    uint8_t* image = NULL;
+    size_t image_size = 0;
+    size_t compressed_size = 0;
+    oe_compressed_header_t header;
+
+    _test_round_trip(NULL, 0);
+
+    /* An empty input is a single token with no literals */
+    OE_TEST(
+        oe_lz4_compress(NULL, 0, block, sizeof(block), &compressed_size) ==
+        OE_OK);
+    OE_TEST(compressed_size == 1 && block[0] == 0);
+
+    /* An empty block is malformed */
+    OE_TEST(oe_lz4_decompress(block, 0, block, 0) == OE_INVALID_PARAMETER);
+
+    /* Empty data round trips through an image too */
+    OE_TEST(oe_compress_image(NULL, 0, &image, &image_size) == OE_OK);
+    OE_TEST(oe_get_compressed_header(image, image_size, &header) == OE_OK);
+    OE_TEST(header.uncompressed_size == 0);
+    OE_TEST(oe_decompress_image(image, image_size, block, 0) == OE_OK);
+    free(image);
+}
+
+static void _test_lengths(void)
+{
+    /* Literal and match lengths on either side of the 15 and 255 steps of
+     * the length encoding */
+    static const size_t sizes[] = {
+        1, 4, 5, 12, 13, 14, 15, 16, 19, 20, 269, 270, 271, 524, 525, 4096};
+    uint8_t* data = (uint8_t*)malloc(LARGE_SIZE);
+
+    OE_TEST(data);
+
+    for (size_t i = 0; i < OE_COUNTOF(sizes); i++)
+    {
+        memset(data, 'a', sizes[i]);
+        _test_round_trip(data, sizes[i]);
+
+        _fill_random(data, sizes[i], (uint32_t)i);
+        _test_round_trip(data, sizes[i]);
+
+        _fill_text(data, sizes[i], (uint32_t)i);
+        _test_round_trip(data, sizes[i]);
+    }
+
+    free(data);
+}
+
+static void _test_incompressible(void)
+{
+    uint8_t* data = (uint8_t*)malloc(LARGE_SIZE);
+    const size_t bound = oe_lz4_compress_bound(LARGE_SIZE);
+    uint8_t* block = (uint8_t*)malloc(bound);
+    size_t compressed_size = 0;
+
+    OE_TEST(data && block);
+
+    /* Random data does not shrink, but still fits the bound exactly */
+    _fill_random(data, LARGE_SIZE, 1);
+    OE_TEST(
+        oe_lz4_compress(data, LARGE_SIZE, block, bound, &compressed_size) ==
+        OE_OK);
+    OE_TEST(compressed_size >= LARGE_SIZE && compressed_size <= bound);
+    _test_round_trip(data, LARGE_SIZE);
+
+    /* A buffer smaller than the output is rejected, not overrun */
+    OE_TEST(
+        oe_lz4_compress(
+            data, LARGE_SIZE, block, LARGE_SIZE / 2, &compressed_size) ==
+        OE_BUFFER_TOO_SMALL);
+
+    free(data);
+    free(block);
+}
+
+static void _test_large(void)
+{
+    uint8_t* data = (uint8_t*)malloc(LARGE_SIZE);
+    size_t compressed_size = 0;
+
+    OE_TEST(data);
+
+    /* Runs and repeats spanning more than the offset window */
+    memset(data, 0, LARGE_SIZE);
+    _test_round_trip(data, LARGE_SIZE);
+
+    _fill_text(data, LARGE_SIZE, 2);
+    _test_round_trip(data, LARGE_SIZE);
+
+    /* Inputs beyond the 32-bit positions of the hash table are rejected
+     * before any of the input is read */
+    OE_TEST(
+        oe_lz4_compress(
+            data,
+            (size_t)OE_UINT32_MAX + 1,
+            data,
+            LARGE_SIZE,
+            &compressed_size) == OE_INVALID_PARAMETER);
+
+    free(data);
+}
+
+/* Failures trace an error each, so the loops below sample positions */
+#define CORRUPT_SAMPLES 16
+#define GUARD_SIZE 64
+#define GUARD_BYTE 0xcc
+
+static void _test_corrupt(void)
+{
+    const size_t size = 4096;
+    const size_t bound = oe_lz4_compress_bound(size);
+    uint8_t* data = (uint8_t*)malloc(size);
+    uint8_t* block = (uint8_t*)malloc(bound);
+    uint8_t* output = (uint8_t*)malloc(size + GUARD_SIZE);
+    size_t compressed_size = 0;
+    size_t stride;
+
+    OE_TEST(data && block && output);
+
+    _fill_text(data, size, 3);
+    OE_TEST(
+        oe_lz4_compress(data, size, block, bound, &compressed_size) == OE_OK);
+    stride = compressed_size / CORRUPT_SAMPLES + 1;
+
+    /* Truncations of the block fail, including dropping the last byte */
+    for (size_t n = 0; n < compressed_size; n += stride)
+        OE_TEST(oe_lz4_decompress(block, n, output, size) != OE_OK);
+
+    OE_TEST(
+        oe_lz4_decompress(block, compressed_size - 1, output, size) != OE_OK);
+
+    /* The block must decompress to exactly the original size */
+    OE_TEST(
+        oe_lz4_decompress(block, compressed_size, output, size - 1) != OE_OK);
+    OE_TEST(
+        oe_lz4_decompress(block, compressed_size, output, size + 1) != OE_OK);
+
+    /* A match offset reaching before the start of the output fails */
+    {
+        const uint8_t bad_offset[] = {0x10, 'a', 0x02, 0x00, 0x00};
+        OE_TEST(
+            oe_lz4_decompress(bad_offset, sizeof(bad_offset), output, 5) ==
+            OE_INVALID_PARAMETER);
+    }
+
+    /* A zero match offset fails */
+    {
+        const uint8_t zero_offset[] = {0x10, 'a', 0x00, 0x00, 0x00};
+        OE_TEST(
+            oe_lz4_decompress(zero_offset, sizeof(zero_offset), output, 5) ==
+            OE_INVALID_PARAMETER);
+    }
+
+    /* A length extension running off the end of the block fails */
+    {
+        const uint8_t bad_length[] = {0xf0, 0xff, 0xff};
+        OE_TEST(
+            oe_lz4_decompress(bad_length, sizeof(bad_length), output, size) ==
+            OE_INVALID_PARAMETER);
+    }
+
+    /* A corrupt block may fail or decompress to wrong data, but it never
+     * writes past the end of the output */
+    memset(output + size, GUARD_BYTE, GUARD_SIZE);
+
+    for (size_t i = 0; i < compressed_size; i += stride)
+    {
+        const uint8_t saved = block[i];
+
+        block[i] ^= 0xa5;
+        oe_lz4_decompress(block, compressed_size, output, size);
+        block[i] = saved;
+
+        for (size_t j = 0; j < GUARD_SIZE; j++)
+            OE_TEST(output[size + j] == GUARD_BYTE);
+    }
+
+    free(data);
+    free(block);
+    free(output);
+}
+
+static void _test_image(void)
+{
+    const size_t size = 8192;
+    uint8_t* data = (uint8_t*)malloc(size);
+    uint8_t* output = (uint8_t*)malloc(size);
+    uint8_t* image = NULL;
+    size_t image_size = 0;
+    oe_compressed_header_t header;
+
+    OE_TEST(data && output);
+
+    _fill_text(data, size, 4);
+    OE_TEST(oe_compress_image(data, size, &image, &image_size) == OE_OK);
+    OE_TEST(oe_get_compressed_header(image, image_size, &header) == OE_OK);
+    OE_TEST(header.uncompressed_size == size);
+    OE_TEST(sizeof(header) + header.compressed_size == image_size);
+
+    OE_TEST(oe_decompress_image(image, image_size, output, size) == OE_OK);
+    OE_TEST(memcmp(output, data, size) == 0);
+
+    /* The destination must be exactly the uncompressed size */
+    OE_TEST(
+        oe_decompress_image(image, image_size, output, size - 1) ==
+        OE_INVALID_PARAMETER);
+
+    /* A truncated image is rejected by the header check */
+    OE_TEST(
+        oe_decompress_image(image, image_size - 1, output, size) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_get_compressed_header(image, sizeof(header) - 1, &header) ==
+        OE_INVALID_PARAMETER);
+
+    /* A corrupt digest is caught after decompression */
+    image[offsetof(oe_compressed_header_t, sha256)] ^= 1;
+    OE_TEST(
+        oe_decompress_image(image, image_size, output, size) ==
+        OE_VERIFY_FAILED);
+    image[offsetof(oe_compressed_header_t, sha256)] ^= 1;
+
+    /* A bad magic is rejected */
+    image[0] ^= 1;
+    OE_TEST(
+        oe_get_compressed_header(image, image_size, &header) ==
+        OE_INVALID_PARAMETER);
+    image[0] ^= 1;
+
+    OE_TEST(oe_decompress_image(image, image_size, output, size) == OE_OK);
+
+    free(image);
+    free(data);
+    free(output);
+}
+
+void TestCompress(void)
+{
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    _test_empty();
+    _test_lengths();
+    _test_incompressible();
+    _test_large();
+    _test_corrupt();
+    _test_image();
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
@@ -0,0 +1,217 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/copyin.h>
+#include <openenclave/internal/hmac.h>
+#include <openenclave/internal/sha.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+#include "tests.h"
+
+/* AES-GCM test case 4 from the GCM specification (AES-128, 60 bytes) */
+static const uint8_t _gcm_key[] = {0xfe,
+                                   0xff,
+                                   0xe9,
+                                   0x92,
+                                   0x86,
+                                   0x65,
+                                   0x73,
+                                   0x1c,
+                                   0x6d,
+                                   0x6a,
+                                   0x8f,
+                                   0x94,
+                                   0x67,
+                                   0x30,
+                                   0x83,
+                                   0x08};
+
+static const uint8_t _gcm_iv[] =
+    {0xca, 0xfe, 0xba, 0xbe, 0xfa, 0xce, 0xdb, 0xad, 0xde, 0xca, 0xf8, 0x88};
+
+static const uint8_t _gcm_aad[] = {0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad, 0xbe,
+                                   0xef, 0xfe, 0xed, 0xfa, 0xce, 0xde, 0xad,
+                                   0xbe, 0xef, 0xab, 0xad, 0xda, 0xd2};
+
+static const uint8_t _gcm_plaintext[] = {
+    0xd9, 0x31, 0x32, 0x25, 0xf8, 0x84, 0x06, 0xe5, 0xa5, 0x59, 0x09, 0xc5,
+    0xaf, 0xf5, 0x26, 0x9a, 0x86, 0xa7, 0xa9, 0x53, 0x15, 0x34, 0xf7, 0xda,
+    0x2e, 0x4c, 0x30, 0x3d, 0x8a, 0x31, 0x8a, 0x72, 0x1c, 0x3c, 0x0c, 0x95,
+    0x95, 0x68, 0x09, 0x53, 0x2f, 0xcf, 0x0e, 0x24, 0x49, 0xa6, 0xb5, 0x25,
+    0xb1, 0x6a, 0xed, 0xf5, 0xaa, 0x0d, 0xe6, 0x57, 0xba, 0x63, 0x7b, 0x39};
+
+static const uint8_t _gcm_ciphertext[] = {
+    0x42, 0x83, 0x1e, 0xc2, 0x21, 0x77, 0x74, 0x24, 0x4b, 0x72, 0x21, 0xb7,
+    0x84, 0xd0, 0xd4, 0x9c, 0xe3, 0xaa, 0x21, 0x2f, 0x2c, 0x02, 0xa4, 0xe0,
+    0x35, 0xc1, 0x7e, 0x23, 0x29, 0xac, 0xa1, 0x2e, 0x21, 0xd5, 0x14, 0xb2,
+    0x54, 0x66, 0x93, 0x1c, 0x7d, 0x8f, 0x6a, 0x5a, 0xac, 0x84, 0xaa, 0x05,
+    0x1b, 0xa3, 0x0b, 0x39, 0x6a, 0x0a, 0xac, 0x97, 0x3d, 0x58, 0xe0, 0x91};
+
+static const uint8_t _gcm_tag[] = {0x5b,
+                                   0xc9,
+                                   0x4f,
+                                   0xbc,
+                                   0x32,
+                                   0x21,
+                                   0xa5,
+                                   0xdb,
+                                   0x94,
+                                   0xfa,
+                                   0xe9,
+                                   0x5a,
+                                   0xe7,
+                                   0x12,
+                                   0x1a,
+                                   0x47};
+
+static void* _host_copy(const void* data, size_t size)
+{
+    void* p = oe_host_malloc(size);
+    OE_TEST(p != NULL);
+    memcpy(p, data, size);
+    return p;
+}
+
+static void _test_sha256(void)
+{
+    size_t size = strlen(ALPHABET);
+    void* src = _host_copy(ALPHABET, size);
+    char dest[32];
+    OE_SHA256 hash = {0};
+
+    OE_TEST(oe_copy_in_sha256(dest, src, size, &hash) == OE_OK);
+    OE_TEST(memcmp(dest, ALPHABET, size) == 0);
+    OE_TEST(memcmp(&hash, &ALPHABET_HASH, sizeof(OE_SHA256)) == 0);
+
+    /* The source must be host memory and the destination enclave memory */
+    OE_TEST(
+        oe_copy_in_sha256(dest, dest, size, &hash) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_copy_in_sha256(src, src, size, &hash) == OE_INVALID_PARAMETER);
+
+    oe_host_free(src);
+}
+
+static void _test_sha256_chunks(void)
+{
+    /* Spans several chunks and ends with a partial one */
+    const size_t size = 3 * OE_COPY_IN_CHUNK_SIZE + 100;
+    uint8_t* data = (uint8_t*)malloc(size);
+    uint8_t* dest = (uint8_t*)malloc(size);
+    oe_sha256_context_t ctx = {0};
+    OE_SHA256 expected = {0};
+    OE_SHA256 hash = {0};
+
+    OE_TEST(data != NULL && dest != NULL);
+
+    for (size_t i = 0; i < size; i++)
+        data[i] = (uint8_t)(i * 7);
+
+    oe_sha256_init(&ctx);
+    oe_sha256_update(&ctx, data, size);
+    oe_sha256_final(&ctx, &expected);
+
+    void* src = _host_copy(data, size);
+
+    OE_TEST(oe_copy_in_sha256(dest, src, size, &hash) == OE_OK);
+    OE_TEST(memcmp(dest, data, size) == 0);
+    OE_TEST(memcmp(&hash, &expected, sizeof(OE_SHA256)) == 0);
+
+    oe_host_free(src);
+    free(dest);
+    free(data);
+}
+
+static void _test_hmac_sha256(void)
+{
+    size_t size = strlen(ALPHABET);
+    void* src = _host_copy(ALPHABET, size);
+    char dest[32];
+    OE_SHA256 hmac = {0};
+
+    OE_TEST(
+        oe_copy_in_hmac_sha256(
+            dest, src, size, ALPHABET_KEY, ALPHABET_KEY_SIZE, &hmac) == OE_OK);
+    OE_TEST(memcmp(dest, ALPHABET, size) == 0);
+    OE_TEST(memcmp(&hmac, &ALPHABET_HMAC, sizeof(OE_SHA256)) == 0);
+
+    oe_host_free(src);
+}
+
+static void _test_aes_gcm_decrypt(void)
+{
+    size_t size = sizeof(_gcm_ciphertext);
+    uint8_t* src = (uint8_t*)_host_copy(_gcm_ciphertext, size);
+    uint8_t dest[sizeof(_gcm_ciphertext)];
+    uint8_t tag[sizeof(_gcm_tag)];
+
+    OE_TEST(
+        oe_copy_in_aes_gcm_decrypt(
+            dest,
+            src,
+            size,
+            _gcm_key,
+            sizeof(_gcm_key),
+            _gcm_iv,
+            sizeof(_gcm_iv),
+            _gcm_aad,
+            sizeof(_gcm_aad),
+            _gcm_tag,
+            sizeof(_gcm_tag)) == OE_OK);
+    OE_TEST(memcmp(dest, _gcm_plaintext, size) == 0);
+
+    /* A wrong tag is rejected and no plaintext is released */
+    memcpy(tag, _gcm_tag, sizeof(tag));
+    tag[0] ^= 1;
+
+    OE_TEST(
+        oe_copy_in_aes_gcm_decrypt(
+            dest,
+            src,
+            size,
+            _gcm_key,
+            sizeof(_gcm_key),
+            _gcm_iv,
+            sizeof(_gcm_iv),
+            _gcm_aad,
+            sizeof(_gcm_aad),
+            tag,
+            sizeof(tag)) == OE_VERIFY_FAILED);
+
+    for (size_t i = 0; i < size; i++)
+        OE_TEST(dest[i] == 0);
+
+    /* So is tampered ciphertext */
+    src[size / 2] ^= 1;
+
+    OE_TEST(
+        oe_copy_in_aes_gcm_decrypt(
+            dest,
+            src,
+            size,
+            _gcm_key,
+            sizeof(_gcm_key),
+            _gcm_iv,
+            sizeof(_gcm_iv),
+            _gcm_aad,
+            sizeof(_gcm_aad),
+            _gcm_tag,
+            sizeof(_gcm_tag)) == OE_VERIFY_FAILED);
+
+    oe_host_free(src);
+}
+
+void TestCopyIn(void)
+{
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    _test_sha256();
+    _test_sha256_chunks();
+    _test_hmac_sha256();
+    _test_aes_gcm_decrypt();
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
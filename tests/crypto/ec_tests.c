@@ -17,6 +17,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#if !defined(OE_BUILD_ENCLAVE)
+#include <time.h>
+#endif
 #include "hash.h"
 #include "readfile.h"
 #include "tests.h"
@@ -26,6 +29,8 @@
  * _SGX_CERT use as a ec_cert_crl_distribution.pem
  * _CERT_WITHOUT_EXTENSIONS use as a Leafec.crt.pem
  * _CHAIN use as a Certificate chain organized from leaf-to-root
+ * _LEAF_DER use as a Leafec.crt.der
+ * _CHAIN_DER use as a ec_chain.der
  * _PRIVATE_KEY use as a Rootec.key.pem
  * _PUBLIC_KEY use as a Rootec.public.key
  * _SIGNATURE use as a test_ec_signature
@@ -42,6 +47,12 @@ static char _CERT_WITHOUT_EXTENSIONS[max_cert_size];
 
 /* Certificate chain organized from leaf-to-root */
 static char _CHAIN[max_cert_chains_size];
+
+/* The leaf and the whole chain above in DER format */
+static uint8_t _LEAF_DER[max_cert_size];
+static size_t _LEAF_DER_SIZE;
+static uint8_t _CHAIN_DER[max_cert_chains_size];
+static size_t _CHAIN_DER_SIZE;
 static char _PRIVATE_KEY[max_key_size];
 static char _PUBLIC_KEY[max_key_size];
 static uint8_t _SIGNATURE[max_sign_size];
@@ -657,6 +668,124 @@ static void _test_cert_chain_read()
     printf("=== passed %s()\n", __FUNCTION__);
 }
 
+static bool _cert_keys_equal(oe_cert_t* cert1, oe_cert_t* cert2)
+{
+    oe_ec_public_key_t key1;
+    oe_ec_public_key_t key2;
+    bool equal = false;
+
+    OE_TEST(oe_cert_get_ec_public_key(cert1, &key1) == OE_OK);
+    OE_TEST(oe_cert_get_ec_public_key(cert2, &key2) == OE_OK);
+    OE_TEST(oe_ec_public_key_equal(&key1, &key2, &equal) == OE_OK);
+
+    oe_ec_public_key_free(&key1);
+    oe_ec_public_key_free(&key2);
+    return equal;
+}
+
+static void _test_cert_chain_read_der()
+{
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    oe_cert_chain_t pem_chain;
+    oe_cert_chain_t der_chain;
+    oe_cert_t leaf;
+    size_t pem_length;
+    size_t der_length;
+
+    OE_TEST(
+        oe_cert_chain_read_pem(&pem_chain, _CHAIN, strlen(_CHAIN) + 1) ==
+        OE_OK);
+    OE_TEST(
+        oe_cert_chain_read_der(&der_chain, _CHAIN_DER, _CHAIN_DER_SIZE) ==
+        OE_OK);
+
+    /* The DER chain must be the same chain, in the same order */
+    OE_TEST(oe_cert_chain_get_length(&pem_chain, &pem_length) == OE_OK);
+    OE_TEST(oe_cert_chain_get_length(&der_chain, &der_length) == OE_OK);
+    OE_TEST(pem_length == 3);
+    OE_TEST(der_length == pem_length);
+
+    for (size_t i = 0; i < der_length; i++)
+    {
+        oe_cert_t pem_cert;
+        oe_cert_t der_cert;
+
+        OE_TEST(oe_cert_chain_get_cert(&pem_chain, i, &pem_cert) == OE_OK);
+        OE_TEST(oe_cert_chain_get_cert(&der_chain, i, &der_cert) == OE_OK);
+        OE_TEST(_cert_keys_equal(&pem_cert, &der_cert));
+
+        oe_cert_free(&pem_cert);
+        oe_cert_free(&der_cert);
+    }
+
+    /* A single DER certificate verifies against either chain */
+    OE_TEST(oe_cert_read_der(&leaf, _LEAF_DER, _LEAF_DER_SIZE) == OE_OK);
+    OE_TEST(oe_cert_verify(&leaf, &der_chain, NULL, 0, NULL) == OE_OK);
+    OE_TEST(oe_cert_verify(&leaf, &pem_chain, NULL, 0, NULL) == OE_OK);
+    oe_cert_free(&leaf);
+
+    oe_cert_chain_free(&pem_chain);
+    oe_cert_chain_free(&der_chain);
+
+    /* Trailing or truncated data is rejected */
+    OE_TEST(oe_cert_read_der(&leaf, _CHAIN_DER, _CHAIN_DER_SIZE) != OE_OK);
+    OE_TEST(
+        oe_cert_chain_read_der(&der_chain, _CHAIN_DER, _CHAIN_DER_SIZE - 1) !=
+        OE_OK);
+    OE_TEST(
+        oe_cert_chain_read_der(&der_chain, _CHAIN_DER, 0) ==
+        OE_INVALID_PARAMETER);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+
+#if !defined(OE_BUILD_ENCLAVE)
+static void _test_cert_chain_parse_time()
+{
+    const size_t iterations = 1000;
+    clock_t start;
+    double pem_seconds;
+    double der_seconds;
+
+    printf("=== begin %s()\n", __FUNCTION__);
+
+    start = clock();
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        oe_cert_chain_t chain;
+
+        OE_TEST(
+            oe_cert_chain_read_pem(&chain, _CHAIN, strlen(_CHAIN) + 1) ==
+            OE_OK);
+        oe_cert_chain_free(&chain);
+    }
+
+    pem_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    start = clock();
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        oe_cert_chain_t chain;
+
+        OE_TEST(
+            oe_cert_chain_read_der(&chain, _CHAIN_DER, _CHAIN_DER_SIZE) ==
+            OE_OK);
+        oe_cert_chain_free(&chain);
+    }
+
+    der_seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf(
+        "chain of 3: PEM %.1f us, DER %.1f us per parse\n",
+        pem_seconds * 1e6 / (double)iterations,
+        der_seconds * 1e6 / (double)iterations);
+
+    printf("=== passed %s()\n", __FUNCTION__);
+}
+#endif
+
 typedef struct _extension
 {
     const char* oid;
@@ -908,6 +1037,18 @@ void TestEC()
             "../data/Intermediateec.crt.pem",
             "../data/Rootec.crt.pem",
             _CHAIN) == OE_OK);
+    OE_TEST(
+        read_der(
+            "../data/Leafec.crt.der",
+            _LEAF_DER,
+            sizeof(_LEAF_DER),
+            &_LEAF_DER_SIZE) == OE_OK);
+    OE_TEST(
+        read_der(
+            "../data/ec_chain.der",
+            _CHAIN_DER,
+            sizeof(_CHAIN_DER),
+            &_CHAIN_DER_SIZE) == OE_OK);
     OE_TEST(read_key("../data/Rootec.key.pem", _PRIVATE_KEY) == OE_OK);
     OE_TEST(read_key("../data/Rootec.public.key", _PUBLIC_KEY) == OE_OK);
     OE_TEST(
@@ -938,4 +1079,8 @@ void TestEC()
     _test_cert_methods();
     _test_key_from_bytes();
     _test_cert_chain_read();
+    _test_cert_chain_read_der();
+#if !defined(OE_BUILD_ENCLAVE)
+    _test_cert_chain_parse_time();
+#endif
 }
@@ -179,6 +179,191 @@ static void _test_key_gen(void)
     }
 }
 
+static void _test_key_derive(void)
+{
+    uint8_t key[32];
+    uint8_t fixed_data[60];
+    uint8_t derived_key[64];
+    uint8_t key_expected[64];
+    oe_kdf_key_t kdf_key;
+
+    for (size_t i = 0; i < sizeof(KEY_TESTS) / sizeof(KEY_TESTS[0]); i++)
+    {
+        hex_to_buf(KEY_TESTS[i].key, key, sizeof(key));
+        hex_to_buf(KEY_TESTS[i].data, fixed_data, sizeof(fixed_data));
+        hex_to_buf(
+            KEY_TESTS[i].derived_key, key_expected, sizeof(key_expected));
+
+        OE_TEST(
+            oe_kdf_key_init(
+                OE_KDF_HMAC_SHA256_CTR, key, sizeof(key), &kdf_key) == OE_OK);
+
+        /* The prepared key can be used for several derivations */
+        for (size_t j = 0; j < 2; j++)
+        {
+            memset(derived_key, 0, sizeof(derived_key));
+            OE_TEST(
+                oe_kdf_key_derive(
+                    &kdf_key,
+                    fixed_data,
+                    sizeof(fixed_data),
+                    derived_key,
+                    KEY_TESTS[i].output_size) == OE_OK);
+
+            OE_TEST(
+                memcmp(
+                    derived_key, key_expected, KEY_TESTS[i].output_size) ==
+                0);
+        }
+
+        OE_TEST(oe_kdf_key_free(&kdf_key) == OE_OK);
+    }
+}
+
+static void _test_key_derive_many(void)
+{
+    const size_t count = sizeof(KEY_TESTS) / sizeof(KEY_TESTS[0]);
+    const size_t key_size = 40;
+    uint8_t key[100];
+    uint8_t fixed_data[sizeof(KEY_TESTS) / sizeof(KEY_TESTS[0])][60];
+    const uint8_t* fixed_data_ptrs[sizeof(fixed_data) / sizeof(fixed_data[0])];
+    size_t fixed_data_sizes[sizeof(fixed_data) / sizeof(fixed_data[0])];
+    uint8_t derived_keys[sizeof(fixed_data) / sizeof(fixed_data[0]) * 40];
+    uint8_t key_expected[40];
+    oe_kdf_key_t kdf_key;
+
+    /* Longer than a HMAC block, so that the key is hashed first */
+    for (size_t i = 0; i < sizeof(key); i++)
+        key[i] = (uint8_t)i;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        hex_to_buf(KEY_TESTS[i].data, fixed_data[i], sizeof(fixed_data[i]));
+        fixed_data_ptrs[i] = fixed_data[i];
+        fixed_data_sizes[i] = sizeof(fixed_data[i]) - i;
+    }
+
+    /* A null label derives the same key as empty fixed data */
+    fixed_data_ptrs[0] = NULL;
+
+    OE_TEST(
+        oe_kdf_key_init(
+            OE_KDF_HMAC_SHA256_CTR, key, sizeof(key), &kdf_key) == OE_OK);
+
+    OE_TEST(
+        oe_kdf_key_derive_many(
+            &kdf_key,
+            fixed_data_ptrs,
+            fixed_data_sizes,
+            count,
+            derived_keys,
+            key_size) == OE_OK);
+
+    /* Each key matches a separate derivation */
+    for (size_t i = 0; i < count; i++)
+    {
+        OE_TEST(
+            oe_kdf_derive_key(
+                OE_KDF_HMAC_SHA256_CTR,
+                key,
+                sizeof(key),
+                fixed_data_ptrs[i],
+                fixed_data_ptrs[i] ? fixed_data_sizes[i] : 0,
+                key_expected,
+                key_size) == OE_OK);
+
+        OE_TEST(
+            memcmp(derived_keys + i * key_size, key_expected, key_size) == 0);
+    }
+
+    OE_TEST(oe_kdf_key_free(&kdf_key) == OE_OK);
+}
+
+#if defined(OE_BUILD_ENCLAVE)
+static void _test_cache(void)
+{
+    const char* labels[] = {"tenant-1", "tenant-2", "tenant-3"};
+    uint8_t key[32];
+    uint8_t derived_key[32];
+    uint8_t key_expected[32];
+    oe_kdf_key_t kdf_key;
+    oe_kdf_cache_t* cache = NULL;
+
+    hex_to_buf(NIST_KEY_3, key, sizeof(key));
+    OE_TEST(
+        oe_kdf_key_init(
+            OE_KDF_HMAC_SHA256_CTR, key, sizeof(key), &kdf_key) == OE_OK);
+
+    /* Two entries for three labels, so that entries get evicted */
+    OE_TEST(oe_kdf_cache_create(0, &cache) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_kdf_cache_create(2, &cache) == OE_OK);
+
+    for (size_t round = 0; round < 3; round++)
+    {
+        for (size_t i = 0; i < OE_COUNTOF(labels); i++)
+        {
+            const uint8_t* label = (const uint8_t*)labels[i];
+            size_t label_size = strlen(labels[i]);
+
+            OE_TEST(
+                oe_kdf_key_derive(
+                    &kdf_key,
+                    label,
+                    label_size,
+                    key_expected,
+                    sizeof(key_expected)) == OE_OK);
+
+            memset(derived_key, 0, sizeof(derived_key));
+            OE_TEST(
+                oe_kdf_cache_derive_key(
+                    cache,
+                    1,
+                    &kdf_key,
+                    label,
+                    label_size,
+                    derived_key,
+                    sizeof(derived_key)) == OE_OK);
+            OE_TEST(
+                memcmp(derived_key, key_expected, sizeof(derived_key)) == 0);
+
+            /* A hit returns the same key */
+            memset(derived_key, 0, sizeof(derived_key));
+            OE_TEST(
+                oe_kdf_cache_derive_key(
+                    cache,
+                    1,
+                    &kdf_key,
+                    label,
+                    label_size,
+                    derived_key,
+                    sizeof(derived_key)) == OE_OK);
+            OE_TEST(
+                memcmp(derived_key, key_expected, sizeof(derived_key)) == 0);
+
+            /* A shorter key for the same label is a separate entry */
+            OE_TEST(
+                oe_kdf_cache_derive_key(
+                    cache,
+                    1,
+                    &kdf_key,
+                    label,
+                    label_size,
+                    derived_key,
+                    16) == OE_OK);
+            OE_TEST(
+                oe_kdf_key_derive(
+                    &kdf_key, label, label_size, key_expected, 16) == OE_OK);
+            OE_TEST(memcmp(derived_key, key_expected, 16) == 0);
+        }
+
+        OE_TEST(oe_kdf_cache_evict_key(cache, 1) == OE_OK);
+    }
+
+    OE_TEST(oe_kdf_cache_destroy(cache) == OE_OK);
+    OE_TEST(oe_kdf_key_free(&kdf_key) == OE_OK);
+}
+#endif
+
 // Test compution of KDF over multiple NIST test strings.
 void TestKDF(void)
 {
@@ -187,6 +372,11 @@ void TestKDF(void)
     // Run a test creating custom fixed data.
     _test_create_fixed();
     _test_key_gen();
+    _test_key_derive();
+    _test_key_derive_many();
+#if defined(OE_BUILD_ENCLAVE)
+    _test_cache();
+#endif
 
     printf("=== passed %s()\n", __FUNCTION__);
 }
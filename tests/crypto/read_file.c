@@ -99,6 +99,28 @@ oe_result_t read_crl(char* filename, uint8_t* crl, size_t* crl_size)
     return OE_OK;
 }
 
+oe_result_t read_der(
+    char* filename,
+    uint8_t* der,
+    size_t max_der_size,
+    size_t* der_size)
+{
+    size_t len_der = 0;
+    FILE* dfp = fopen(filename, "rb");
+
+    if (dfp != NULL)
+    {
+        len_der = fread(der, sizeof(char), max_der_size, dfp);
+    }
+    else
+    {
+        return OE_FAILURE;
+    }
+    *der_size = len_der;
+    fclose(dfp);
+    return OE_OK;
+}
+
 oe_result_t read_dates(char* filename, oe_datetime_t* time)
 {
     size_t len_date = 0;
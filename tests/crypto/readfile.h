@@ -34,6 +34,12 @@ oe_result_t read_chains(
 
 oe_result_t read_crl(char* filename, uint8_t* crl, size_t* crl_size);
 
+oe_result_t read_der(
+    char* filename,
+    uint8_t* der,
+    size_t max_der_size,
+    size_t* der_size);
+
 oe_result_t read_dates(char* filename, oe_datetime_t* time);
 
 oe_result_t read_mod(char* filename, uint8_t* mod, size_t* mod_size);
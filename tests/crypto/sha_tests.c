@@ -23,6 +23,34 @@ void TestSHA(void)
     oe_sha256_update(&ctx, ALPHABET, strlen(ALPHABET));
     oe_sha256_final(&ctx, &hash);
     OE_TEST(memcmp(&hash, &ALPHABET_HASH, sizeof(OE_SHA256)) == 0);
+    OE_TEST(oe_sha256_free(&ctx) == OE_OK);
+
+    /* A clone continues from the state of the original */
+    {
+        const size_t half = strlen(ALPHABET) / 2;
+        oe_sha256_context_t clone = {0};
+
+        OE_TEST(oe_sha256_init(&ctx) == OE_OK);
+        OE_TEST(oe_sha256_update(&ctx, ALPHABET, half) == OE_OK);
+        OE_TEST(oe_sha256_clone(&clone, &ctx) == OE_OK);
+
+        /* The original is independent of the clone */
+        OE_TEST(oe_sha256_update(&ctx, "x", 1) == OE_OK);
+        OE_TEST(oe_sha256_free(&ctx) == OE_OK);
+
+        OE_TEST(
+            oe_sha256_update(
+                &clone, ALPHABET + half, strlen(ALPHABET) - half) == OE_OK);
+        OE_TEST(oe_sha256_final(&clone, &hash) == OE_OK);
+        OE_TEST(memcmp(&hash, &ALPHABET_HASH, sizeof(OE_SHA256)) == 0);
+        OE_TEST(oe_sha256_free(&clone) == OE_OK);
+
+        /* Freeing again, or freeing a zero-filled context, is harmless */
+        OE_TEST(oe_sha256_free(&clone) == OE_OK);
+        memset(&clone, 0, sizeof(clone));
+        OE_TEST(oe_sha256_free(&clone) == OE_OK);
+        OE_TEST(oe_sha256_free(NULL) == OE_INVALID_PARAMETER);
+    }
 
     printf("=== passed %s()\n", __FUNCTION__);
 }
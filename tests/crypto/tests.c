@@ -13,7 +13,12 @@ void TestAll()
     TestRdrand();
     TestRSA();
 #endif
+    TestCompress();
     TestHMAC();
     TestKDF();
     TestSHA();
+#if defined(OE_BUILD_ENCLAVE)
+    TestCMAC();
+    TestCopyIn();
+#endif
 }
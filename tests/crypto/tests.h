@@ -5,6 +5,9 @@
 #define _TESTS_CRYPTO_TESTS_H
 
 void TestASN1(void);
+void TestCopyIn(void);
+void TestCMAC(void);
+void TestCompress(void);
 void TestCRL(void);
 void TestEC(void);
 void TestKDF(void);
@@ -0,0 +1,150 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/sgxsign.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../../host/sgx/debugsigstruct.h"
+#include "../../host/signkey.h"
+
+#define ATTRIBUTES (SGX_FLAGS_INITTED | SGX_FLAGS_DEBUG | SGX_FLAGS_MODE64BIT)
+
+static double _get_sigstruct(
+    const OE_SHA256* mrenclave,
+    uint16_t product_id,
+    sgx_sigstruct_t* sigstruct,
+    bool expect_cached)
+{
+    auto start = std::chrono::steady_clock::now();
+    bool cached;
+
+    OE_TEST(
+        oe_sgx_get_debug_sigstruct(
+            mrenclave, ATTRIBUTES, product_id, 1, sigstruct, &cached) ==
+        OE_OK);
+    OE_TEST(cached == expect_cached);
+
+    std::chrono::duration<double, std::micro> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+/* Flips a bit of the persisted copy of a SIGSTRUCT's signature */
+static void _corrupt_signature(
+    const std::string& path,
+    const sgx_sigstruct_t* sigstruct)
+{
+    std::vector<char> data;
+
+    {
+        std::ifstream file(path, std::ios::binary);
+        OE_TEST(file.good());
+        data.assign(
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+    }
+
+    const char* signature = (const char*)sigstruct->signature;
+    auto it = std::search(
+        data.begin(),
+        data.end(),
+        signature,
+        signature + sizeof(sigstruct->signature));
+    OE_TEST(it != data.end());
+    *it ^= 1;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), (std::streamsize)data.size());
+    OE_TEST(file.good());
+}
+
+int main()
+{
+    std::string path = "/tmp/oe_debug_sigstruct_" +
+                       std::to_string((unsigned long)getpid()) + ".cache";
+    OE_SHA256 mrenclave;
+    sgx_sigstruct_t first;
+    sgx_sigstruct_t second;
+    sgx_sigstruct_t other;
+    sgx_sigstruct_t expected;
+    double sign_us;
+    double cached_us;
+
+    unlink(path.c_str());
+    setenv(OE_DEBUG_SIGSTRUCT_CACHE_ENV, path.c_str(), 1);
+    memset(&mrenclave, 0x11, sizeof(mrenclave));
+
+    /* Only the first creation pays for the signature */
+    sign_us = _get_sigstruct(&mrenclave, 1, &first, false);
+    cached_us = _get_sigstruct(&mrenclave, 1, &second, true);
+    OE_TEST(memcmp(&first, &second, sizeof(first)) == 0);
+
+    /* The cached SIGSTRUCT is the one the debug key produces */
+    OE_TEST(
+        oe_sgx_sign_enclave(
+            &mrenclave,
+            ATTRIBUTES,
+            1,
+            1,
+            OE_DEBUG_SIGN_KEY,
+            OE_DEBUG_SIGN_KEY_SIZE,
+            &expected) == OE_OK);
+    OE_TEST(
+        memcmp(
+            first.enclavehash,
+            expected.enclavehash,
+            sizeof(first.enclavehash)) == 0);
+    OE_TEST(
+        memcmp(first.modulus, expected.modulus, sizeof(first.modulus)) == 0);
+    OE_TEST(first.attributes.flags == ATTRIBUTES);
+    OE_TEST(first.isvprodid == 1 && first.isvsvn == 1);
+
+    /* Other signed properties need their own SIGSTRUCT */
+    _get_sigstruct(&mrenclave, 2, &other, false);
+    OE_TEST(other.isvprodid == 2);
+    _get_sigstruct(&mrenclave, 1, &second, true);
+
+    /* A new process would find the SIGSTRUCTs in the persisted file */
+    oe_sgx_clear_debug_sigstruct_cache();
+    _get_sigstruct(&mrenclave, 1, &second, true);
+    OE_TEST(memcmp(&first, &second, sizeof(first)) == 0);
+
+    /* The file is replaced by renaming, so no temporary file is left */
+    OE_TEST(
+        access(
+            (path + "." + std::to_string(getpid()) + ".tmp").c_str(),
+            F_OK) != 0);
+
+    /* The signature is not checked when a SIGSTRUCT is loaded, so a damaged
+     * record must be caught by its checksum and signed again */
+    _corrupt_signature(path, &first);
+    oe_sgx_clear_debug_sigstruct_cache();
+    _get_sigstruct(&mrenclave, 1, &second, false);
+    OE_TEST(
+        memcmp(second.modulus, expected.modulus, sizeof(second.modulus)) ==
+        0);
+    OE_TEST(second.isvprodid == 1);
+    _get_sigstruct(&mrenclave, 2, &other, true);
+
+    /* Without the file, SIGSTRUCTs only live as long as the process */
+    unsetenv(OE_DEBUG_SIGSTRUCT_CACHE_ENV);
+    oe_sgx_clear_debug_sigstruct_cache();
+    _get_sigstruct(&mrenclave, 1, &second, false);
+
+    printf("sign: %.0f us, cached: %.1f us\n", sign_us, cached_us);
+
+    unlink(path.c_str());
+
+    printf("=== passed all tests (debug_sigstruct)\n");
+    return 0;
+}
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/calls.h>
+#include "ecall_cancel_t.h"
+
+/* Runs until cancelled or for the given number of iterations */
+uint64_t spin(uint64_t max_iterations)
+{
+    uint64_t i;
+
+    for (i = 0; i < max_iterations && !oe_is_call_cancelled(); i++)
+        ;
+
+    return i;
+}
+
+/* Completes without ever checking for cancellation */
+int work(void)
+{
+    return 42;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    2);   /* TCSCount */
@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include "../../../host/sgx/deadline.h"
+#include "ecall_cancel_u.h"
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/* Iterations that would run for hours if cancellation did not work */
+#define FOREVER (1ULL << 48)
+
+#define TIMEOUT_MS 50
+
+static uint64_t _elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+/* Arms a deadline and waits for the watchdog to expire it */
+static void _expire_deadline()
+{
+    oe_deadline_t deadline;
+
+    OE_TEST(oe_deadline_start(&deadline, TIMEOUT_MS) == OE_OK);
+
+    while (!deadline.expired)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    oe_deadline_stop(&deadline);
+}
+
+static void _test_watchdog_shutdown()
+{
+    _expire_deadline();
+    oe_deadline_shutdown();
+    oe_deadline_shutdown();
+
+    /* The next deadline starts the watchdog again */
+    _expire_deadline();
+}
+
+#if defined(__linux__)
+/* The child has no watchdog thread and must still see deadlines expire */
+static void _test_watchdog_fork()
+{
+    int status;
+
+    _expire_deadline();
+
+    pid_t pid = fork();
+    OE_TEST(pid >= 0);
+
+    if (pid == 0)
+    {
+        /* Fail rather than hang if nothing expires the deadline */
+        alarm(10);
+        _expire_deadline();
+        _exit(0);
+    }
+
+    OE_TEST(waitpid(pid, &status, 0) == pid);
+    OE_TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+#endif
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    uint64_t iterations = 0;
+    int ret = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    OE_TEST(
+        oe_create_ecall_cancel_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) ==
+        OE_OK);
+
+    /* Without options, calls are never cancelled */
+    OE_TEST(spin(enclave, &iterations, 1000) == OE_OK);
+    OE_TEST(iterations == 1000);
+
+    /* A cancelled token stops calls that poll it... */
+    {
+        oe_cancellation_token_t token = OE_CANCELLATION_TOKEN_INITIALIZER;
+        oe_call_options_t options = {&token, 0};
+
+        oe_cancel(&token);
+        OE_TEST(oe_set_call_options(&options) == OE_OK);
+        OE_TEST(spin(enclave, &iterations, FOREVER) == OE_CANCELED);
+
+        /* ...but not those that do not */
+        OE_TEST(work(enclave, &ret) == OE_OK);
+        OE_TEST(ret == 42);
+    }
+
+    /* Another thread may cancel a running call */
+    {
+        oe_cancellation_token_t token = OE_CANCELLATION_TOKEN_INITIALIZER;
+        oe_call_options_t options = {&token, 0};
+        std::thread canceller([&token]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(TIMEOUT_MS));
+            oe_cancel(&token);
+        });
+
+        OE_TEST(oe_set_call_options(&options) == OE_OK);
+        OE_TEST(spin(enclave, &iterations, FOREVER) == OE_CANCELED);
+        canceller.join();
+    }
+
+    /* Calls are cancelled once their deadline passes */
+    {
+        oe_call_options_t options = {NULL, TIMEOUT_MS};
+        auto start = std::chrono::steady_clock::now();
+
+        OE_TEST(oe_set_call_options(&options) == OE_OK);
+        OE_TEST(spin(enclave, &iterations, FOREVER) == OE_CANCELED);
+        OE_TEST(_elapsed_ms(start) >= TIMEOUT_MS);
+
+        /* The deadline applies to each call separately */
+        OE_TEST(spin(enclave, &iterations, 1000) == OE_OK);
+        OE_TEST(iterations == 1000);
+    }
+
+    /* Removing the options restores uncancellable calls */
+    OE_TEST(oe_set_call_options(NULL) == OE_OK);
+    OE_TEST(spin(enclave, &iterations, 1000) == OE_OK);
+    OE_TEST(iterations == 1000);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    _test_watchdog_shutdown();
+#if defined(__linux__)
+    _test_watchdog_fork();
+#endif
+
+    printf("=== passed all tests (ecall_cancel)\n");
+
+    return 0;
+}
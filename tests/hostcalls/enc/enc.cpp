@@ -3,6 +3,7 @@
 
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/hostheap.h>
 #include <openenclave/internal/tests.h>
 #include "hostcalls_t.h"
 
@@ -71,6 +72,121 @@ void test_host_free(void_ptr in_ptr)
     oe_host_free(in_ptr);
 }
 
+void test_host_heap()
+{
+    const size_t count = 1000;
+    void* blocks[count];
+    oe_host_heap_stats_t before;
+    oe_host_heap_stats_t after;
+
+    /* Nothing, not even OCALL buffers, uses the host heap by default */
+    OE_TEST(oe_host_heap_get_stats(&before) == OE_OK);
+    OE_TEST(before.num_chunks == 0);
+
+    OE_TEST(oe_host_heap_enable(OE_HOST_HEAP_CHUNK_SIZE) == OE_OK);
+    OE_TEST(oe_host_heap_get_stats(&before) == OE_OK);
+    OE_TEST(before.num_chunks >= 1);
+
+    /* Small blocks come from the host heap */
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t size = 1 + (i * 37) % OE_HOST_HEAP_MAX_BLOCK_SIZE;
+
+        blocks[i] = oe_host_malloc(size);
+        OE_TEST(blocks[i] != NULL);
+        OE_TEST(oe_is_outside_enclave(blocks[i], size));
+        memset(blocks[i], (int)i, size);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t size = 1 + (i * 37) % OE_HOST_HEAP_MAX_BLOCK_SIZE;
+        uint8_t* p = (uint8_t*)blocks[i];
+
+        OE_TEST(p[0] == (uint8_t)i && p[size - 1] == (uint8_t)i);
+    }
+
+    OE_TEST(oe_host_heap_get_stats(&after) == OE_OK);
+    OE_TEST(after.num_allocs == before.num_allocs + count);
+
+    for (size_t i = 0; i < count; i++)
+        oe_host_free(blocks[i]);
+
+    /* Freed blocks are reused from the thread's cache */
+    OE_TEST(oe_host_heap_get_stats(&before) == OE_OK);
+    blocks[0] = oe_host_malloc(64);
+    OE_TEST(blocks[0] != NULL);
+    OE_TEST(oe_host_heap_get_stats(&after) == OE_OK);
+    OE_TEST(after.num_cache_hits == before.num_cache_hits + 1);
+
+    /* Resizing within the size class keeps the block */
+    OE_TEST(oe_host_realloc(blocks[0], 60) == blocks[0]);
+    OE_TEST(oe_host_realloc(blocks[0], 64) == blocks[0]);
+
+    /* Growing beyond the size class moves the contents */
+    memset(blocks[0], 0x5a, 64);
+    blocks[0] = oe_host_realloc(blocks[0], 2 * OE_HOST_HEAP_MAX_BLOCK_SIZE);
+    OE_TEST(blocks[0] != NULL);
+    OE_TEST(((uint8_t*)blocks[0])[63] == 0x5a);
+    oe_host_free(blocks[0]);
+
+    /* Large blocks still use an OCALL */
+    OE_TEST(oe_host_heap_get_stats(&before) == OE_OK);
+    blocks[0] = oe_host_malloc(OE_HOST_HEAP_MAX_BLOCK_SIZE + 1);
+    OE_TEST(blocks[0] != NULL);
+    OE_TEST(oe_host_heap_get_stats(&after) == OE_OK);
+    OE_TEST(after.num_allocs == before.num_allocs);
+    oe_host_free(blocks[0]);
+
+    /* Reallocating to zero releases the block */
+    blocks[0] = oe_host_malloc(16);
+    OE_TEST(oe_host_realloc(blocks[0], 0) == NULL);
+}
+
+void test_host_alloc_benchmark(size_t size, size_t iterations)
+{
+    const size_t batch = 8;
+    void* blocks[batch];
+
+    for (size_t i = 0; i < iterations; i += batch)
+    {
+        for (size_t j = 0; j < batch; j++)
+            OE_TEST((blocks[j] = oe_host_malloc(size)) != NULL);
+
+        for (size_t j = 0; j < batch; j++)
+            oe_host_free(blocks[j]);
+    }
+}
+
+void test_host_heap_free_all()
+{
+    oe_host_heap_stats_t stats;
+    void* ptr;
+
+    /* Leave a block in this thread's cache */
+    OE_TEST((ptr = oe_host_malloc(64)) != NULL);
+    oe_host_free(ptr);
+
+    /* Releasing the heap resets this thread's cache and counters */
+    oe_host_heap_free_all();
+    OE_TEST(oe_host_heap_get_stats(&stats) == OE_OK);
+    OE_TEST(stats.num_chunks == 0);
+    OE_TEST(stats.num_allocs == 0);
+    OE_TEST(stats.num_cache_hits == 0);
+
+    /* Later allocations use an OCALL instead of donating another chunk */
+    OE_TEST((ptr = oe_host_malloc(64)) != NULL);
+    OE_TEST(oe_is_outside_enclave(ptr, 64));
+    OE_TEST(oe_host_heap_get_stats(&stats) == OE_OK);
+    OE_TEST(stats.num_chunks == 0);
+    OE_TEST(stats.num_allocs == 0);
+    oe_host_free(ptr);
+
+    OE_TEST(oe_host_heap_enable(OE_HOST_HEAP_CHUNK_SIZE) == OE_OUT_OF_MEMORY);
+    OE_TEST(oe_host_heap_get_stats(&stats) == OE_OK);
+    OE_TEST(stats.num_chunks == 0);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
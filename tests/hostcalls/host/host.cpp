@@ -4,6 +4,7 @@
 #include <openenclave/host.h>
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/tests.h>
+#include <chrono>
 #include <cstring>
 #include "hostcalls_u.h"
 
@@ -181,6 +182,41 @@ static void _test_host_strndup(oe_enclave_t* enclave)
     OE_TEST(test_host_free(enclave, out_str) == OE_OK);
 }
 
+static void _run_host_alloc_benchmark(
+    oe_enclave_t* enclave,
+    const char* name,
+    size_t size)
+{
+    const size_t iterations = 100000;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    OE_TEST(test_host_alloc_benchmark(enclave, size, iterations) == OE_OK);
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    /* Each iteration is one oe_host_malloc() and one oe_host_free() */
+    printf(
+        "%s: %zu-byte host allocations: %.0f ops/sec\n",
+        name,
+        size,
+        2.0 * iterations / seconds);
+}
+
+static void _test_host_heap(oe_enclave_t* enclave)
+{
+    _run_host_alloc_benchmark(enclave, "ocall", 64);
+
+    OE_TEST(test_host_heap(enclave) == OE_OK);
+
+    _run_host_alloc_benchmark(enclave, "host heap", 64);
+    _run_host_alloc_benchmark(enclave, "host heap", 4096);
+    _run_host_alloc_benchmark(enclave, "host heap (too large)", 65536);
+
+    /* Releases the host heap as termination does, so run last */
+    OE_TEST(test_host_heap_free_all(enclave) == OE_OK);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -203,6 +239,9 @@ int main(int argc, const char* argv[])
     _test_host_realloc(enclave);
     _test_host_strndup(enclave);
 
+    /* Enables the host heap, so run last */
+    _test_host_heap(enclave);
+
     oe_terminate_enclave(enclave);
 
     printf("=== passed all tests (%s)\n", argv[0]);
@@ -0,0 +1,302 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../host/sgx/launchtoken.h"
+
+/* Envelope tag of a GetLaunchToken message (field 3, length delimited) */
+#define GET_LAUNCH_TOKEN_TAG 0x1A
+
+static std::atomic<uint32_t> _requests(0);
+
+static bool _read_all(int sock, void* data, size_t size)
+{
+    uint8_t* p = (uint8_t*)data;
+
+    while (size)
+    {
+        ssize_t n = read(sock, p, size);
+
+        if (n <= 0)
+            return false;
+
+        p += n;
+        size -= (size_t)n;
+    }
+
+    return true;
+}
+
+static void _put_varint(std::vector<uint8_t>& buf, uint32_t x)
+{
+    while (x >= 0x80)
+    {
+        buf.push_back((uint8_t)(x | 0x80));
+        x >>= 7;
+    }
+
+    buf.push_back((uint8_t)x);
+}
+
+/* Answers each GetLaunchToken request with a token filled with its number */
+static void _serve_request(int sock)
+{
+    uint32_t size;
+    std::vector<uint8_t> request;
+    std::vector<uint8_t> message;
+    std::vector<uint8_t> envelope;
+
+    if (!_read_all(sock, &size, sizeof(size)))
+        return;
+
+    request.resize(size);
+    if (!size || !_read_all(sock, request.data(), size) ||
+        request[0] != GET_LAUNCH_TOKEN_TAG)
+        return;
+
+    uint32_t number = ++_requests;
+
+    /* Field 1: error code, field 2: launch token */
+    message.push_back(0x08);
+    _put_varint(message, 0);
+    message.push_back(0x12);
+    _put_varint(message, sizeof(sgx_launch_token_t));
+    message.insert(message.end(), sizeof(sgx_launch_token_t), (uint8_t)number);
+
+    envelope.push_back(GET_LAUNCH_TOKEN_TAG);
+    _put_varint(envelope, (uint32_t)message.size());
+    envelope.insert(envelope.end(), message.begin(), message.end());
+
+    size = (uint32_t)envelope.size();
+    OE_TEST(write(sock, &size, sizeof(size)) == sizeof(size));
+    OE_TEST(write(sock, envelope.data(), size) == (ssize_t)size);
+}
+
+static void _serve(int listener)
+{
+    int sock;
+
+    while ((sock = accept(listener, NULL, NULL)) >= 0)
+    {
+        _serve_request(sock);
+        close(sock);
+    }
+}
+
+static void _make_sigstruct(sgx_sigstruct_t* sigstruct, uint8_t mrenclave)
+{
+    memset(sigstruct, 0, sizeof(*sigstruct));
+    memset(sigstruct->enclavehash, mrenclave, sizeof(sigstruct->enclavehash));
+    memset(sigstruct->modulus, 0xAB, sizeof(sigstruct->modulus));
+}
+
+/* Gets a token and checks where it came from and which request issued it */
+static void _get_token(
+    const sgx_sigstruct_t* sigstruct,
+    uint64_t flags,
+    bool refresh,
+    bool expect_cached,
+    uint32_t expect_number)
+{
+    sgx_attributes_t attributes = {flags, 0x7};
+    sgx_launch_token_t token;
+    bool cached;
+
+    OE_TEST(
+        oe_sgx_get_launch_token(
+            sigstruct, &attributes, refresh, &token, &cached) == OE_OK);
+    OE_TEST(cached == expect_cached);
+
+    for (size_t i = 0; i < sizeof(token.contents); i++)
+        OE_TEST(token.contents[i] == (uint8_t)expect_number);
+}
+
+/* Number of enclaves and rounds per writer in _test_concurrent_writers */
+#define WRITER_ENCLAVES 16
+#define WRITER_ROUNDS 50
+
+static void _check_token(const sgx_launch_token_t* token)
+{
+    for (size_t i = 1; i < sizeof(token->contents); i++)
+        OE_TEST(token->contents[i] == token->contents[0]);
+}
+
+/* Reloads the cache file every round and refreshes the tokens of its own
+ * enclaves, saving the file for each of them */
+static void _write_tokens(int writer)
+{
+    sgx_attributes_t attributes = {0x4, 0x7};
+    sgx_sigstruct_t sigstruct;
+    sgx_launch_token_t token;
+
+    for (int round = 0; round < WRITER_ROUNDS; round++)
+    {
+        oe_sgx_clear_launch_token_cache();
+
+        for (int i = 0; i < WRITER_ENCLAVES; i++)
+        {
+            _make_sigstruct(&sigstruct, (uint8_t)(0x20 * (writer + 1) + i));
+            OE_TEST(
+                oe_sgx_get_launch_token(
+                    &sigstruct, &attributes, false, &token, NULL) == OE_OK);
+            _check_token(&token);
+            OE_TEST(
+                oe_sgx_get_launch_token(
+                    &sigstruct, &attributes, true, &token, NULL) == OE_OK);
+        }
+    }
+}
+
+/* Two processes loading and rewriting the cache file at the same time only
+ * ever see whole tokens, and leave no temporary files behind */
+static void _test_concurrent_writers(const std::string& cache_path)
+{
+    sgx_attributes_t attributes = {0x4, 0x7};
+    sgx_sigstruct_t sigstruct;
+    sgx_launch_token_t token;
+    pid_t pids[2];
+    int status[2];
+    size_t cached_count = 0;
+
+    for (int writer = 0; writer < 2; writer++)
+    {
+        OE_TEST((pids[writer] = fork()) >= 0);
+
+        if (pids[writer] == 0)
+        {
+            _write_tokens(writer);
+            _exit(0);
+        }
+    }
+
+    /* Wait for both before checking, as a writer needs this process to
+     * answer its AESM requests */
+    for (int writer = 0; writer < 2; writer++)
+        OE_TEST(waitpid(pids[writer], &status[writer], 0) == pids[writer]);
+
+    for (int writer = 0; writer < 2; writer++)
+    {
+        std::string temp_path =
+            cache_path + "." + std::to_string(pids[writer]) + ".tmp";
+
+        OE_TEST(WIFEXITED(status[writer]) && WEXITSTATUS(status[writer]) == 0);
+        OE_TEST(access(temp_path.c_str(), F_OK) != 0);
+    }
+
+    /* The last writer to finish saved all of its tokens. A token may come
+     * from the file or from AESM, but it is never a mix of two tokens. */
+    oe_sgx_clear_launch_token_cache();
+
+    for (int writer = 0; writer < 2; writer++)
+    {
+        for (int i = 0; i < WRITER_ENCLAVES; i++)
+        {
+            bool cached;
+
+            _make_sigstruct(&sigstruct, (uint8_t)(0x20 * (writer + 1) + i));
+            OE_TEST(
+                oe_sgx_get_launch_token(
+                    &sigstruct, &attributes, false, &token, &cached) == OE_OK);
+            _check_token(&token);
+            cached_count += cached;
+        }
+    }
+
+    OE_TEST(cached_count >= WRITER_ENCLAVES);
+}
+
+int main()
+{
+    std::string prefix = "/tmp/oe_launch_token_" + std::to_string(getpid());
+    std::string socket_path = prefix + ".sock";
+    std::string cache_path = prefix + ".cache";
+    sgx_sigstruct_t sigstruct1;
+    sgx_sigstruct_t sigstruct2;
+    struct sockaddr_un addr;
+    int listener;
+
+    /* Start a stand-in AESM service */
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(socket_path.c_str());
+    unlink(cache_path.c_str());
+
+    OE_TEST((listener = socket(AF_UNIX, SOCK_STREAM, 0)) >= 0);
+    OE_TEST(bind(listener, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    OE_TEST(listen(listener, 4) == 0);
+
+    std::thread server(_serve, listener);
+
+    setenv("OE_AESM_SOCKET", socket_path.c_str(), 1);
+    setenv(OE_LAUNCH_TOKEN_CACHE_ENV, cache_path.c_str(), 1);
+
+    _make_sigstruct(&sigstruct1, 1);
+    _make_sigstruct(&sigstruct2, 2);
+
+    /* Only the first creation of an enclave asks AESM for a token */
+    _get_token(&sigstruct1, 0x4, false, false, 1);
+    _get_token(&sigstruct1, 0x4, false, true, 1);
+    OE_TEST(_requests == 1);
+
+    /* Other attributes or another enclave need their own token */
+    _get_token(&sigstruct1, 0x6, false, false, 2);
+    _get_token(&sigstruct2, 0x4, false, false, 3);
+    _get_token(&sigstruct1, 0x6, false, true, 2);
+    OE_TEST(_requests == 3);
+
+    /* A refresh replaces the cached token */
+    _get_token(&sigstruct1, 0x4, true, false, 4);
+    _get_token(&sigstruct1, 0x4, false, true, 4);
+    OE_TEST(_requests == 4);
+
+    /* A new process would find the tokens in the persisted file */
+    oe_sgx_clear_launch_token_cache();
+    _get_token(&sigstruct1, 0x4, false, true, 4);
+    _get_token(&sigstruct2, 0x4, false, true, 3);
+    OE_TEST(_requests == 4);
+
+    _test_concurrent_writers(cache_path);
+
+    /* Without the file, tokens only live as long as the process */
+    unsetenv(OE_LAUNCH_TOKEN_CACHE_ENV);
+    oe_sgx_clear_launch_token_cache();
+    {
+        uint32_t number = _requests + 1;
+        _get_token(&sigstruct1, 0x4, false, false, number);
+        OE_TEST(_requests == number);
+    }
+
+    /* Failures to reach AESM are reported and nothing is cached */
+    {
+        sgx_attributes_t attributes = {0x8, 0x7};
+        sgx_launch_token_t token;
+
+        setenv("OE_AESM_SOCKET", (prefix + ".none").c_str(), 1);
+        OE_TEST(
+            oe_sgx_get_launch_token(
+                &sigstruct1, &attributes, false, &token, NULL) == OE_FAILURE);
+    }
+
+    shutdown(listener, SHUT_RDWR);
+    close(listener);
+    server.join();
+
+    unlink(socket_path.c_str());
+    unlink(cache_path.c_str());
+
+    printf("=== passed all tests (launch_token)\n");
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/lockprofile.h>
+#include <openenclave/internal/thread.h>
+#include "lock_profile_t.h"
+
+static oe_mutex_t _hot = OE_MUTEX_INITIALIZER;
+static oe_mutex_t _quiet = OE_MUTEX_INITIALIZER;
+static oe_lock_profile_t _profiles[OE_LOCK_PROFILE_MAX_LOCKS];
+
+/* Holds the hot lock until the host sets *release */
+void hold_lock(int* held, volatile int* release)
+{
+    oe_mutex_lock(&_hot);
+    __atomic_store_n(held, 1, __ATOMIC_SEQ_CST);
+
+    while (!*release)
+        __builtin_ia32_pause();
+
+    oe_mutex_unlock(&_hot);
+}
+
+void take_lock(int* entering)
+{
+    __atomic_store_n(entering, 1, __ATOMIC_SEQ_CST);
+    oe_mutex_lock(&_hot);
+    oe_mutex_unlock(&_hot);
+}
+
+void take_quiet_lock(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        oe_mutex_lock(&_quiet);
+        oe_mutex_unlock(&_quiet);
+    }
+}
+
+/* Gets the acquires, contended, parks and wait_ns counts of a lock */
+oe_result_t get_profile(int hot, uint64_t* stats)
+{
+    const void* lock = hot ? &_hot : &_quiet;
+    size_t count;
+    oe_result_t result;
+
+    result = oe_get_lock_profiles(
+        _profiles, OE_LOCK_PROFILE_MAX_LOCKS, &count);
+
+    if (result != OE_OK)
+        return result;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (_profiles[i].lock == lock)
+        {
+            if (_profiles[i].type != OE_LOCK_TYPE_MUTEX)
+                return OE_UNEXPECTED;
+
+            stats[0] = _profiles[i].acquires;
+            stats[1] = _profiles[i].contended;
+            stats[2] = _profiles[i].parks;
+            stats[3] = _profiles[i].wait_ns;
+            return OE_OK;
+        }
+    }
+
+    return OE_NOT_FOUND;
+}
+
+void dump_profiles(void)
+{
+    oe_dump_lock_profiles();
+}
+
+void reset_profiles(void)
+{
+    oe_reset_lock_profiles();
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    3);   /* TCSCount */
@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include "lock_profile_u.h"
+
+#define QUIET_ACQUIRES 100
+
+enum
+{
+    ACQUIRES,
+    CONTENDED,
+    PARKS,
+    WAIT_NS
+};
+
+static void _hold_lock(oe_enclave_t* enclave, int* held, int* release)
+{
+    OE_TEST(hold_lock(enclave, held, release) == OE_OK);
+}
+
+static void _take_lock(oe_enclave_t* enclave, int* entering)
+{
+    OE_TEST(take_lock(enclave, entering) == OE_OK);
+}
+
+static void _wait_for(int* flag)
+{
+    while (!__atomic_load_n(flag, __ATOMIC_SEQ_CST))
+        std::this_thread::yield();
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t stats[4];
+    int held = 0;
+    int release = 0;
+    int entering = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    OE_TEST(
+        oe_create_lock_profile_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) ==
+        OE_OK);
+
+    /* Uncontended acquires are counted without ever parking */
+    OE_TEST(take_quiet_lock(enclave, QUIET_ACQUIRES) == OE_OK);
+    OE_TEST(get_profile(enclave, &result, 0, stats) == OE_OK);
+
+    if (result == OE_UNSUPPORTED)
+    {
+        printf("=== skipped lock profiling tests (USE_LOCK_PROFILING=OFF)\n");
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+        return 0;
+    }
+
+    OE_TEST(result == OE_OK);
+    OE_TEST(stats[ACQUIRES] == QUIET_ACQUIRES);
+    OE_TEST(stats[CONTENDED] == 0);
+    OE_TEST(stats[PARKS] == 0);
+    OE_TEST(stats[WAIT_NS] == 0);
+
+    /* A thread that finds the lock held parks until it is released */
+    {
+        std::thread holder(_hold_lock, enclave, &held, &release);
+        _wait_for(&held);
+
+        std::thread taker(_take_lock, enclave, &entering);
+        _wait_for(&entering);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        __atomic_store_n(&release, 1, __ATOMIC_SEQ_CST);
+
+        holder.join();
+        taker.join();
+    }
+
+    OE_TEST(get_profile(enclave, &result, 1, stats) == OE_OK);
+    OE_TEST(result == OE_OK);
+    OE_TEST(stats[ACQUIRES] == 2);
+    OE_TEST(stats[CONTENDED] == 1);
+    OE_TEST(stats[PARKS] >= 1);
+    OE_TEST(stats[WAIT_NS] > 0);
+
+    OE_TEST(dump_profiles(enclave) == OE_OK);
+
+    /* A reset clears the counts but keeps the locks */
+    OE_TEST(reset_profiles(enclave) == OE_OK);
+    OE_TEST(get_profile(enclave, &result, 1, stats) == OE_OK);
+    OE_TEST(result == OE_OK);
+    OE_TEST(stats[ACQUIRES] == 0);
+    OE_TEST(stats[WAIT_NS] == 0);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (lock_profile)\n");
+
+    return 0;
+}
@@ -0,0 +1,7 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+/* Initialized data, so that the image has pages of varied contents */
+const uint8_t data[4 * OE_PAGE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8};
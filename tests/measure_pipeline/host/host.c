@@ -0,0 +1,155 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/load.h>
+#include <openenclave/internal/sgxcreate.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../../../host/sgx/enclave.h"
+#include "../../../host/sgx/sgxmeasure.h"
+
+#define NUM_PAGES (3 * OE_SGX_MEASURE_PIPELINE_DEPTH + 5)
+#define BASE 0x100000
+
+/* Measures the same pages inline and through the pipeline */
+static void _test_pages(void)
+{
+    static uint8_t pages[NUM_PAGES][OE_PAGE_SIZE];
+    oe_sha256_context_t inline_context;
+    oe_sha256_context_t pipeline_context;
+    oe_sgx_measure_pipeline_t* pipeline = NULL;
+    OE_SHA256 inline_hash;
+    OE_SHA256 pipeline_hash;
+    oe_result_t result;
+
+    srand(1);
+
+    for (size_t i = 0; i < NUM_PAGES; i++)
+    {
+        for (size_t j = 0; j < OE_PAGE_SIZE; j++)
+            pages[i][j] = (uint8_t)rand();
+    }
+
+    OE_TEST(oe_sha256_init(&inline_context) == OE_OK);
+    OE_TEST(oe_sha256_init(&pipeline_context) == OE_OK);
+
+    /* Hosts without the pipeline always measure inline */
+    result = oe_sgx_measure_pipeline_start(&pipeline_context, &pipeline);
+
+    if (result == OE_UNSUPPORTED)
+    {
+        printf("=== skipped measurement pipeline tests (unsupported)\n");
+        return;
+    }
+
+    OE_TEST(result == OE_OK);
+
+    for (size_t i = 0; i < NUM_PAGES; i++)
+    {
+        const uint64_t addr = BASE + i * OE_PAGE_SIZE;
+        const uint64_t flags =
+            (i % 3 ? SGX_SECINFO_REG | SGX_SECINFO_R : SGX_SECINFO_TCS);
+        const bool extend = (i % 5 != 0);
+
+        OE_TEST(
+            oe_sgx_measure_load_enclave_data(
+                &inline_context,
+                BASE,
+                addr,
+                (uint64_t)pages[i],
+                flags,
+                extend) == OE_OK);
+        OE_TEST(
+            oe_sgx_measure_pipeline_load_enclave_data(
+                pipeline, BASE, addr, (uint64_t)pages[i], flags, extend) ==
+            OE_OK);
+
+        /* The pipeline copies the page, so the source may be reused */
+        memset(pages[i], 0xDD, OE_PAGE_SIZE);
+    }
+
+    OE_TEST(oe_sgx_measure_pipeline_finish(pipeline) == OE_OK);
+    OE_TEST(
+        oe_sgx_measure_initialize_enclave(&inline_context, &inline_hash) ==
+        OE_OK);
+    OE_TEST(
+        oe_sgx_measure_initialize_enclave(&pipeline_context, &pipeline_hash) ==
+        OE_OK);
+    OE_TEST(memcmp(&inline_hash, &pipeline_hash, sizeof(OE_SHA256)) == 0);
+
+    /* Invalid pages are rejected before they are queued */
+    OE_TEST(oe_sha256_init(&pipeline_context) == OE_OK);
+    OE_TEST(
+        oe_sgx_measure_pipeline_start(&pipeline_context, &pipeline) == OE_OK);
+    OE_TEST(
+        oe_sgx_measure_pipeline_load_enclave_data(
+            pipeline, BASE, BASE - 1, (uint64_t)pages[0], 1, true) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(oe_sgx_measure_pipeline_finish(pipeline) == OE_OK);
+}
+
+/* Gets the MRENCLAVE of the image measured inline or through the pipeline */
+static void _measure_image(
+    const char* path,
+    const oe_sgx_enclave_properties_t* properties,
+    bool measure_inline,
+    OE_SHA256* mrenclave)
+{
+    oe_sgx_load_context_t context;
+    oe_enclave_t enclave;
+
+    OE_TEST(
+        oe_sgx_initialize_load_context(
+            &context,
+            OE_SGX_LOAD_TYPE_MEASURE,
+            properties->config.attributes) == OE_OK);
+    context.measure_inline = measure_inline;
+
+    OE_TEST(oe_sgx_build_enclave(&context, path, NULL, &enclave) == OE_OK);
+    *mrenclave = enclave.hash;
+
+    free(enclave.path);
+    oe_sgx_cleanup_load_context(&context);
+}
+
+/* Both ways of loading the image give the MRENCLAVE it was signed with */
+static void _test_image(const char* path)
+{
+    oe_enclave_image_t oeimage;
+    oe_sgx_enclave_properties_t properties;
+    const sgx_sigstruct_t* sigstruct;
+    OE_SHA256 inline_hash;
+    OE_SHA256 pipeline_hash;
+
+    OE_TEST(oe_load_enclave_image(path, &oeimage) == OE_OK);
+    OE_TEST(
+        oe_sgx_load_enclave_properties(
+            &oeimage, OE_INFO_SECTION_NAME, &properties) == OE_OK);
+    oe_unload_enclave_image(&oeimage);
+
+    _measure_image(path, &properties, true, &inline_hash);
+    _measure_image(path, &properties, false, &pipeline_hash);
+    OE_TEST(memcmp(&inline_hash, &pipeline_hash, sizeof(OE_SHA256)) == 0);
+
+    sigstruct = (const sgx_sigstruct_t*)properties.sigstruct;
+    OE_TEST(
+        memcmp(sigstruct->enclavehash, &inline_hash, sizeof(OE_SHA256)) == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    _test_pages();
+    _test_image(argv[1]);
+
+    printf("=== passed all tests (measure_pipeline)\n");
+    return 0;
+}
@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/arena.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/tests.h>
+#include "nested_ecall_t.h"
+
+int enable_nested_ecalls(uint32_t max_depth)
+{
+    OE_TEST(oe_arena_set_capacity(4096) == OE_OK);
+    return (int)oe_set_max_nested_ecall_depth(max_depth);
+}
+
+/* Calls back into the enclave through the host until depth reaches target */
+int nest(int depth, int target)
+{
+    int ret = depth;
+
+    if (depth < target && host_nest(&ret, depth + 1, target) != OE_OK)
+        return -1;
+
+    return ret;
+}
+
+int repeat(int count)
+{
+    int ret = -1;
+
+    if (host_repeat(&ret, count) != OE_OK)
+        return -1;
+
+    return ret;
+}
+
+void probe(uint64_t* stack_address, uint64_t* arena_used)
+{
+    volatile int local = 0;
+    oe_arena_stats_t stats;
+
+    OE_TEST(oe_arena_alloc(64) != NULL);
+    OE_TEST(oe_arena_get_stats(&stats) == OE_OK);
+
+    *stack_address = (uint64_t)&local;
+    *arena_used = stats.used_bytes;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    2);   /* TCSCount */
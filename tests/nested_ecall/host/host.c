@@ -0,0 +1,118 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "nested_ecall_u.h"
+
+/* Far more nested ecalls than the enclave stack could hold if each one
+ * leaked its frame */
+#define REPEAT_COUNT 10000
+
+static oe_enclave_t* _enclave;
+static oe_result_t _last_result;
+
+int host_nest(int depth, int target)
+{
+    int ret = -1;
+
+    if ((_last_result = nest(_enclave, &ret, depth, target)) != OE_OK)
+        return -1;
+
+    return ret;
+}
+
+/* Nested ecalls made during the same ocall must all start from the same
+ * stack pointer and arena position */
+int host_repeat(int count)
+{
+    uint64_t first_stack_address = 0;
+    uint64_t first_arena_used = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint64_t stack_address;
+        uint64_t arena_used;
+
+        OE_TEST(probe(_enclave, &stack_address, &arena_used) == OE_OK);
+
+        if (i == 0)
+        {
+            first_stack_address = stack_address;
+            first_arena_used = arena_used;
+        }
+
+        OE_TEST(stack_address == first_stack_address);
+        OE_TEST(arena_used == first_arena_used);
+    }
+
+    return count;
+}
+
+static int _enable(uint32_t max_depth)
+{
+    int ret = -1;
+
+    OE_TEST(enable_nested_ecalls(_enclave, &ret, max_depth) == OE_OK);
+    return ret;
+}
+
+static int _nest(int target)
+{
+    int ret = -1;
+
+    _last_result = OE_OK;
+    OE_TEST(nest(_enclave, &ret, 0, target) == OE_OK);
+    return ret;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    int ret = -1;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    OE_TEST(
+        (result = oe_create_nested_ecall_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &_enclave)) ==
+        OE_OK);
+
+    /* Nested ecalls are rejected by default */
+    OE_TEST(_nest(0) == 0);
+    OE_TEST(_nest(1) == -1);
+    OE_TEST(_last_result == OE_REENTRANT_ECALL);
+
+    /* The depth is bounded */
+    OE_TEST(_enable(OE_MAX_NESTED_ECALL_DEPTH + 1) == OE_INVALID_PARAMETER);
+    OE_TEST(_enable(3) == OE_OK);
+
+    OE_TEST(_nest(1) == 1);
+    OE_TEST(_nest(3) == 3);
+    OE_TEST(_last_result == OE_OK);
+
+    OE_TEST(_nest(4) == -1);
+    OE_TEST(_last_result == OE_REENTRANT_ECALL);
+
+    /* Nested ecalls release their stack and arena memory when they return */
+    OE_TEST(repeat(_enclave, &ret, REPEAT_COUNT) == OE_OK);
+    OE_TEST(ret == REPEAT_COUNT);
+
+    /* The enclave may opt out again */
+    OE_TEST(_enable(0) == OE_OK);
+    OE_TEST(_nest(1) == -1);
+    OE_TEST(_last_result == OE_REENTRANT_ECALL);
+
+    oe_terminate_enclave(_enclave);
+
+    printf("=== passed all tests (nested_ecall)\n");
+
+    return 0;
+}
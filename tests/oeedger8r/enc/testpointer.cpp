@@ -4,8 +4,10 @@
 #include "../edltestutils.h"
 
 #include <openenclave/enclave.h>
+#include <openenclave/internal/sha.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
+#include <string.h>
 #include <algorithm>
 #include "all_t.h"
 
@@ -1551,3 +1553,28 @@ void ecall_size_attribute_all_types(
     unsigned long long unsigned_long_long_size)
 {
 }
+
+static void compute_sha256(const void* data, size_t size, OE_SHA256* sha256)
+{
+    oe_sha256_context_t context;
+    OE_TEST(oe_sha256_init(&context) == OE_OK);
+    OE_TEST(oe_sha256_update(&context, data, size) == OE_OK);
+    OE_TEST(oe_sha256_final(&context, sha256) == OE_OK);
+}
+
+void ecall_pointer_sha256(
+    const uint8_t* data,
+    size_t data_size,
+    uint8_t* digest)
+{
+    OE_SHA256 sha256;
+
+    if (!data)
+        return;
+
+    // The buffer has been copied into the enclave and digest describes it.
+    OE_TEST(oe_is_within_enclave(data, data_size));
+    OE_TEST(oe_is_within_enclave(digest, sizeof(sha256)));
+    compute_sha256(data, data_size, &sha256);
+    OE_TEST(memcmp(digest, sha256.buf, sizeof(sha256)) == 0);
+}
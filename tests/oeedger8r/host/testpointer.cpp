@@ -4,7 +4,9 @@
 #include "../edltestutils.h"
 
 #include <openenclave/host.h>
+#include <openenclave/internal/sha.h>
 #include <openenclave/internal/tests.h>
+#include <string.h>
 #include <algorithm>
 #include "all_u.h"
 
@@ -160,6 +162,41 @@ static void test_ecall_pointer_fun(oe_enclave_t* enclave, F ecall_pointer_fun)
             psize) == OE_OK);
 }
 
+static void compute_sha256(const void* data, size_t size, OE_SHA256* sha256)
+{
+    oe_sha256_context_t context;
+    OE_TEST(oe_sha256_init(&context) == OE_OK);
+    OE_TEST(oe_sha256_update(&context, data, size) == OE_OK);
+    OE_TEST(oe_sha256_final(&context, sha256) == OE_OK);
+}
+
+static void test_ecall_pointer_sha256(oe_enclave_t* enclave)
+{
+    // Span several copy-in chunks and end on a partial one.
+    static uint8_t data[3 * 4096 + 100];
+    uint8_t digest[32] = {0};
+    OE_SHA256 expected;
+
+    for (size_t i = 0; i < sizeof(data); ++i)
+        data[i] = (uint8_t)(i * 7);
+
+    compute_sha256(data, sizeof(data), &expected);
+    OE_TEST(
+        ecall_pointer_sha256(enclave, data, sizeof(data), digest) == OE_OK);
+    OE_TEST(memcmp(digest, expected.buf, sizeof(digest)) == 0);
+
+    // Empty buffers hash like any other.
+    compute_sha256(data, 0, &expected);
+    OE_TEST(ecall_pointer_sha256(enclave, data, 0, digest) == OE_OK);
+    OE_TEST(memcmp(digest, expected.buf, sizeof(digest)) == 0);
+
+    // The digest is required whenever there is data to hash.
+    OE_TEST(
+        ecall_pointer_sha256(enclave, data, sizeof(data), NULL) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(ecall_pointer_sha256(enclave, NULL, 0, digest) == OE_OK);
+}
+
 void test_pointer_edl_ecalls(oe_enclave_t* enclave)
 {
     test_ecall_pointer_fun<char>(enclave, ecall_pointer_char);
@@ -194,6 +231,8 @@ void test_pointer_edl_ecalls(oe_enclave_t* enclave)
     test_ecall_pointer_fun<unsigned long long>(
         enclave, ecall_pointer_unsigned_long_long);
 
+    test_ecall_pointer_sha256(enclave);
+
     OE_TEST(ecall_pointer_assert_all_called(enclave) == OE_OK);
     printf("=== test_pointer_edl_ecalls passed\n");
 }
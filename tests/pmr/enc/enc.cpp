@@ -0,0 +1,193 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/arena.h>
+#include <openenclave/internal/memory_resource.h>
+#include <openenclave/internal/tests.h>
+#include <map>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "pmr_t.h"
+
+/* Number of elements inserted into each container by the workload */
+#define WORKLOAD_SIZE 1000
+
+void enc_set_arena_capacity(size_t capacity)
+{
+    OE_TEST(oe_arena_set_capacity(capacity) == OE_OK);
+}
+
+static void _test_monotonic_buffer_resource()
+{
+    alignas(16) char buffer[1024];
+    std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer));
+    std::pmr::vector<int> vector(&resource);
+
+    vector.reserve(16);
+    OE_TEST((char*)vector.data() == buffer);
+
+    /* Once the buffer is exhausted, chunks come from the upstream */
+    vector.reserve(1024);
+    OE_TEST(
+        (char*)vector.data() < buffer ||
+        (char*)vector.data() >= buffer + sizeof(buffer));
+
+    vector.clear();
+    vector.shrink_to_fit();
+    resource.release();
+
+    OE_TEST(resource.allocate(16) == buffer);
+    OE_TEST(resource.upstream_resource() == std::pmr::get_default_resource());
+}
+
+static void _test_pool_resources()
+{
+    std::pmr::pool_options options;
+
+    options.max_blocks_per_chunk = 0;
+    options.largest_required_pool_block = 100;
+
+    std::pmr::unsynchronized_pool_resource unsynchronized(options);
+    std::pmr::synchronized_pool_resource synchronized(options);
+
+    /* Options are normalized to the values actually used */
+    OE_TEST(unsynchronized.options().max_blocks_per_chunk > 0);
+    OE_TEST(unsynchronized.options().largest_required_pool_block >= 100);
+
+    std::pmr::memory_resource* resources[] = {&unsynchronized, &synchronized};
+
+    /* Freed blocks are recycled */
+    for (std::pmr::memory_resource* r : resources)
+    {
+        void* p = r->allocate(48);
+        r->deallocate(p, 48);
+        OE_TEST(r->allocate(48) == p);
+        r->deallocate(p, 48);
+
+        /* Large and over-aligned blocks bypass the pools */
+        p = r->allocate(64 * 1024, 256);
+        OE_TEST((uint64_t)p % 256 == 0);
+        r->deallocate(p, 64 * 1024, 256);
+    }
+
+    std::pmr::map<int, std::pmr::string> map(&unsynchronized);
+
+    for (int i = 0; i < 100; i++)
+        map[i] = std::pmr::string(64, (char)('a' + i % 26));
+
+    /* Elements propagate the allocator of their container */
+    OE_TEST(map[10].get_allocator().resource() == &unsynchronized);
+    OE_TEST(map[10] == std::pmr::string(64, 'k'));
+
+    map.clear();
+    unsynchronized.release();
+    synchronized.release();
+}
+
+static void _test_oe_resources()
+{
+    oe_arena_stats_t before;
+    oe_arena_stats_t after;
+
+    /* The ecall resource carves blocks from the arena */
+    oe_arena_get_stats(&before);
+    {
+        std::pmr::vector<uint64_t> vector(oe::pmr::ecall_resource());
+
+        vector.resize(1000);
+        oe_arena_get_stats(&after);
+        OE_TEST(
+            after.used_bytes >= before.used_bytes + 1000 * sizeof(uint64_t));
+    }
+
+    OE_TEST((uint64_t)oe::pmr::ecall_resource()->allocate(8, 64) % 64 == 0);
+
+    /* The thread pool is the same object for the whole ecall */
+    std::pmr::memory_resource* pool = oe::pmr::thread_pool_resource();
+    void* p = pool->allocate(32);
+
+    OE_TEST(pool == oe::pmr::thread_pool_resource());
+    pool->deallocate(p, 32);
+    OE_TEST(pool->allocate(32) == p);
+    pool->deallocate(p, 32);
+
+    std::pmr::string string(
+        "a string that does not fit the small string buffer",
+        oe::pmr::heap_pool_resource());
+
+    OE_TEST(
+        string.get_allocator().resource() == oe::pmr::heap_pool_resource());
+    OE_TEST(
+        !oe::pmr::ecall_resource()->is_equal(*oe::pmr::heap_pool_resource()));
+}
+
+void enc_test_memory_resources()
+{
+    _test_monotonic_buffer_resource();
+    _test_pool_resources();
+    _test_oe_resources();
+}
+
+template <typename Map, typename Vector, typename... Args>
+static uint64_t _run_workload(size_t iterations, Args... args)
+{
+    uint64_t checksum = 0;
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        Map map(args...);
+        Vector vector(args...);
+        uint32_t key = (uint32_t)i;
+
+        for (uint32_t j = 0; j < WORKLOAD_SIZE; j++)
+        {
+            key = key * 1103515245 + 12345;
+            map[key % 4096] += j;
+            vector.push_back(key);
+        }
+
+        for (const auto& pair : map)
+            checksum += pair.first * pair.second;
+
+        for (uint32_t value : vector)
+            checksum ^= value;
+    }
+
+    return checksum;
+}
+
+uint64_t enc_run_workload(workload_resource resource, size_t iterations)
+{
+    typedef std::map<uint32_t, uint64_t> map_t;
+    typedef std::vector<uint32_t> vector_t;
+    typedef std::pmr::map<uint32_t, uint64_t> pmr_map_t;
+    typedef std::pmr::vector<uint32_t> pmr_vector_t;
+
+    switch (resource)
+    {
+        case WORKLOAD_DEFAULT:
+            return _run_workload<map_t, vector_t>(iterations);
+        case WORKLOAD_ECALL:
+            return _run_workload<pmr_map_t, pmr_vector_t>(
+                iterations, oe::pmr::ecall_resource());
+        case WORKLOAD_THREAD_POOL:
+            return _run_workload<pmr_map_t, pmr_vector_t>(
+                iterations, oe::pmr::thread_pool_resource());
+        case WORKLOAD_HEAP_POOL:
+            return _run_workload<pmr_map_t, pmr_vector_t>(
+                iterations, oe::pmr::heap_pool_resource());
+    }
+
+    OE_TEST(false);
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    8192, /* HeapPageCount */
+    128,  /* StackPageCount */
+    2);   /* TCSCount */
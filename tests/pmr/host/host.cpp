@@ -0,0 +1,85 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <chrono>
+#include "pmr_u.h"
+
+/* Large enough for the ecall resource to serve a whole workload ecall */
+#define ARENA_CAPACITY (16 * 1024 * 1024)
+
+#define NUM_ECALLS 20
+#define ITERATIONS_PER_ECALL 100
+
+static uint64_t _run_workload(
+    oe_enclave_t* enclave,
+    workload_resource resource,
+    const char* name)
+{
+    uint64_t checksum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < NUM_ECALLS; i++)
+    {
+        uint64_t value = 0;
+
+        OE_TEST(
+            enc_run_workload(enclave, &value, resource, ITERATIONS_PER_ECALL) ==
+            OE_OK);
+        checksum += value;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    printf(
+        "%s: %.0f map/vector workloads/sec\n",
+        name,
+        NUM_ECALLS * ITERATIONS_PER_ECALL / seconds);
+
+    return checksum;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if ((result = oe_create_pmr_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    OE_TEST(enc_set_arena_capacity(enclave, ARENA_CAPACITY) == OE_OK);
+
+    OE_TEST(enc_test_memory_resources(enclave) == OE_OK);
+
+    /* Every resource must produce the same containers */
+    uint64_t checksum = _run_workload(enclave, WORKLOAD_DEFAULT, "default");
+
+    OE_TEST(_run_workload(enclave, WORKLOAD_ECALL, "ecall") == checksum);
+    OE_TEST(
+        _run_workload(enclave, WORKLOAD_THREAD_POOL, "thread pool") ==
+        checksum);
+    OE_TEST(
+        _run_workload(enclave, WORKLOAD_HEAP_POOL, "heap pool") == checksum);
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    printf("=== passed all tests (pmr)\n");
+
+    return 0;
+}
@@ -1,12 +1,67 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <openenclave/corelibc/stdio.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/tests.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include "print_t.h"
 
+/* Checks that oe_snprintf() formats numbers exactly like snprintf() */
+static void _test_format_numbers()
+{
+    const int64_t values[] = {0,
+                              1,
+                              9,
+                              10,
+                              99,
+                              100,
+                              101,
+                              12345,
+                              1000000,
+                              INT_MAX,
+                              INT_MIN,
+                              UINT_MAX,
+                              -1,
+                              -10,
+                              -99,
+                              1234567890123456789,
+                              INT64_MAX,
+                              INT64_MIN};
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        const int64_t x = values[i];
+        char oe[64];
+        char ref[64];
+
+#define CHECK_FORMAT(FORMAT, VALUE)                         \
+    do                                                      \
+    {                                                       \
+        oe_snprintf(oe, sizeof(oe), FORMAT, VALUE);         \
+        snprintf(ref, sizeof(ref), FORMAT, VALUE);          \
+        OE_TEST(strcmp(oe, ref) == 0);                      \
+    } while (0)
+
+        CHECK_FORMAT("%d", (int)x);
+        CHECK_FORMAT("%u", (unsigned int)x);
+        CHECK_FORMAT("%x", (unsigned int)x);
+        CHECK_FORMAT("%X", (unsigned int)x);
+        CHECK_FORMAT("%o", (unsigned int)x);
+        CHECK_FORMAT("%lld", (long long)x);
+        CHECK_FORMAT("%llu", (unsigned long long)x);
+        CHECK_FORMAT("%llx", (unsigned long long)x);
+        CHECK_FORMAT("%lX", (unsigned long)x);
+        CHECK_FORMAT("%zu", (size_t)x);
+
+#undef CHECK_FORMAT
+    }
+}
+
 int enclave_test_print()
 {
     size_t n;
@@ -50,6 +105,8 @@ int enclave_test_print()
         oe_host_write(1, str, sizeof(str) - 1);
     }
 
+    _test_format_numbers();
+
     return 0;
 }
 
@@ -0,0 +1,270 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../../host/sgx/quoteservice.h"
+
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define QUOTE_SIZE 64
+
+static std::mutex _gate_mutex;
+static std::condition_variable _gate_cond;
+static bool _gate_open = true;
+
+static std::atomic<size_t> _calls(0);
+static std::atomic<size_t> _active(0);
+static std::atomic<size_t> _max_active(0);
+
+/* Returns the report data as the quote, once the gate is open */
+static oe_result_t _stub_provider(
+    const sgx_report_t* sgx_report,
+    uint8_t* quote,
+    size_t* quote_size)
+{
+    size_t active = ++_active;
+    size_t max_active = _max_active;
+
+    while (active > max_active &&
+           !_max_active.compare_exchange_weak(max_active, active))
+        ;
+
+    {
+        std::unique_lock<std::mutex> lock(_gate_mutex);
+        _gate_cond.wait(lock, [] { return _gate_open; });
+    }
+
+    _calls++;
+    _active--;
+
+    if (*quote_size < QUOTE_SIZE)
+    {
+        *quote_size = QUOTE_SIZE;
+        return OE_BUFFER_TOO_SMALL;
+    }
+
+    *quote_size = QUOTE_SIZE;
+    memcpy(quote, sgx_report->body.report_data.field, QUOTE_SIZE);
+    return OE_OK;
+}
+
+static void _set_gate(bool open)
+{
+    std::lock_guard<std::mutex> lock(_gate_mutex);
+    _gate_open = open;
+    _gate_cond.notify_all();
+}
+
+static oe_quote_service_stats_t _get_stats()
+{
+    oe_quote_service_stats_t stats;
+    oe_quote_service_get_stats(&stats);
+    return stats;
+}
+
+/* Waits until the service reaches the state checked by the predicate */
+template <typename Predicate>
+static void _wait_for(Predicate predicate)
+{
+    for (size_t i = 0; i < 10000; i++)
+    {
+        oe_quote_service_stats_t stats = _get_stats();
+
+        if (predicate(stats))
+            return;
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    OE_TEST("timed out waiting for the quote service" == NULL);
+}
+
+static void _make_report(sgx_report_t* report, uint8_t value)
+{
+    memset(report, 0, sizeof(*report));
+    memset(report->body.report_data.field, value, QUOTE_SIZE);
+}
+
+static void _get_quote(uint8_t value)
+{
+    sgx_report_t report;
+    uint8_t quote[QUOTE_SIZE] = {0};
+    size_t quote_size = sizeof(quote);
+
+    _make_report(&report, value);
+    OE_TEST(
+        oe_quote_service_get_quote(&report, quote, &quote_size) == OE_OK);
+    OE_TEST(quote_size == QUOTE_SIZE);
+
+    for (size_t i = 0; i < QUOTE_SIZE; i++)
+        OE_TEST(quote[i] == value);
+}
+
+static void _test_get_quote()
+{
+    sgx_report_t report;
+    uint8_t quote[QUOTE_SIZE / 2];
+    size_t quote_size = sizeof(quote);
+
+    _get_quote(1);
+
+    /* The required size is reported back as with sgx_get_quote() */
+    _make_report(&report, 2);
+    OE_TEST(
+        oe_quote_service_get_quote(&report, quote, &quote_size) ==
+        OE_BUFFER_TOO_SMALL);
+    OE_TEST(quote_size == QUOTE_SIZE);
+
+    OE_TEST(
+        oe_quote_service_get_quote(NULL, quote, &quote_size) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(
+        oe_quote_service_get_quote(&report, quote, NULL) ==
+        OE_INVALID_PARAMETER);
+}
+
+static void _test_deduplication()
+{
+    const size_t followers = 5;
+    oe_quote_service_stats_t before = _get_stats();
+    size_t calls = _calls;
+    std::vector<std::thread> threads;
+
+    _set_gate(false);
+
+    /* Wait until the first request is inside the provider */
+    threads.emplace_back(_get_quote, 3);
+    _wait_for([&](const oe_quote_service_stats_t& stats) {
+        return stats.busy_workers == 1;
+    });
+
+    for (size_t i = 0; i < followers; i++)
+        threads.emplace_back(_get_quote, 3);
+
+    _wait_for([&](const oe_quote_service_stats_t& stats) {
+        return stats.deduplicated == before.deduplicated + followers;
+    });
+
+    _set_gate(true);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    /* Every caller got the quote, but only one was generated */
+    OE_TEST(_calls == calls + 1);
+    OE_TEST(_get_stats().completed == before.completed + 1);
+}
+
+static void _test_backpressure()
+{
+    const size_t blocked = 2;
+    const size_t count =
+        OE_QUOTE_SERVICE_WORKERS + OE_QUOTE_SERVICE_QUEUE_SIZE + blocked;
+    oe_quote_service_stats_t before = _get_stats();
+    size_t calls = _calls;
+    std::vector<std::thread> threads;
+
+    _max_active = 0;
+    _set_gate(false);
+
+    /* Distinct reports so that nothing is deduplicated */
+    for (size_t i = 0; i < count; i++)
+        threads.emplace_back(_get_quote, (uint8_t)(0x10 + i));
+
+    _wait_for([&](const oe_quote_service_stats_t& stats) {
+        return stats.busy_workers == OE_QUOTE_SERVICE_WORKERS &&
+               stats.queue_depth == OE_QUOTE_SERVICE_QUEUE_SIZE &&
+               stats.queue_full_waits >= before.queue_full_waits + blocked;
+    });
+
+    _set_gate(true);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    oe_quote_service_stats_t after = _get_stats();
+
+    OE_TEST(_calls == calls + count);
+    OE_TEST(_max_active <= OE_QUOTE_SERVICE_WORKERS);
+    OE_TEST(after.max_queue_depth == OE_QUOTE_SERVICE_QUEUE_SIZE);
+    OE_TEST(after.queue_depth == 0);
+    OE_TEST(after.busy_workers == 0);
+    OE_TEST(after.requests == before.requests + count);
+    OE_TEST(after.completed == before.completed + count);
+}
+
+static void _test_shutdown()
+{
+    oe_quote_service_stats_t before = _get_stats();
+
+    _get_quote(4);
+    oe_quote_service_shutdown();
+    oe_quote_service_shutdown();
+
+    /* The next request starts the workers again */
+    _get_quote(5);
+    _get_quote(6);
+
+    oe_quote_service_stats_t after = _get_stats();
+
+    OE_TEST(after.busy_workers == 0);
+    OE_TEST(after.queue_depth == 0);
+    OE_TEST(after.completed == before.completed + 3);
+}
+
+#if defined(__linux__)
+/* The child has none of the parent's workers and must still get quotes */
+static void _test_fork()
+{
+    int status;
+
+    _get_quote(7);
+
+    pid_t pid = fork();
+    OE_TEST(pid >= 0);
+
+    if (pid == 0)
+    {
+        /* Fail rather than hang if the child waits for a missing worker */
+        alarm(10);
+        _get_quote(8);
+        _get_quote(9);
+        _exit(_get_stats().busy_workers == 0 ? 0 : 1);
+    }
+
+    OE_TEST(waitpid(pid, &status, 0) == pid);
+    OE_TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    _get_quote(10);
+}
+#endif
+
+int main()
+{
+    oe_quote_service_set_provider(_stub_provider);
+
+    _test_get_quote();
+    _test_deduplication();
+    _test_backpressure();
+    _test_shutdown();
+#if defined(__linux__)
+    _test_fork();
+#endif
+
+    oe_quote_service_set_provider(NULL);
+
+    printf("=== passed all tests (quote_service)\n");
+    return 0;
+}
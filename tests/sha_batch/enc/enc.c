@@ -0,0 +1,202 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/hmac.h>
+#include <openenclave/internal/sha.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sha_batch_t.h"
+
+#define NUM_MESSAGES 100
+
+static const uint8_t _key[] = "0123456789abcdef";
+
+/* Longer than a block, so it is hashed before use */
+static uint8_t _long_key[100];
+
+static uint8_t* _records;
+static size_t _record_size;
+static size_t _record_count;
+
+static void _hmac(
+    const uint8_t* key,
+    size_t keysize,
+    const void* data,
+    size_t size,
+    OE_SHA256* hmac)
+{
+    oe_hmac_sha256_context_t ctx;
+
+    OE_TEST(oe_hmac_sha256_init(&ctx, key, keysize) == OE_OK);
+    OE_TEST(oe_hmac_sha256_update(&ctx, data, size) == OE_OK);
+    OE_TEST(oe_hmac_sha256_final(&ctx, hmac) == OE_OK);
+    OE_TEST(oe_hmac_sha256_free(&ctx) == OE_OK);
+}
+
+static void _sha256(const void* data, size_t size, OE_SHA256* sha256)
+{
+    oe_sha256_context_t ctx;
+
+    OE_TEST(oe_sha256_init(&ctx) == OE_OK);
+    OE_TEST(oe_sha256_update(&ctx, data, size) == OE_OK);
+    OE_TEST(oe_sha256_final(&ctx, sha256) == OE_OK);
+}
+
+void enc_test_batch_hashes()
+{
+    static uint8_t buffer[NUM_MESSAGES * 3];
+    const void* data[NUM_MESSAGES];
+    size_t sizes[NUM_MESSAGES];
+    const oe_hmac_sha256_key_t* keys[NUM_MESSAGES];
+    oe_hmac_sha256_key_t key;
+    oe_hmac_sha256_key_t long_key;
+    OE_SHA256 results[NUM_MESSAGES];
+    OE_SHA256 expected;
+
+    for (size_t i = 0; i < sizeof(buffer); i++)
+        buffer[i] = (uint8_t)(i * 31);
+
+    memset(_long_key, 0xa5, sizeof(_long_key));
+
+    OE_TEST(oe_hmac_sha256_key_init(&key, _key, sizeof(_key)) == OE_OK);
+    OE_TEST(
+        oe_hmac_sha256_key_init(&long_key, _long_key, sizeof(_long_key)) ==
+        OE_OK);
+
+    /* Sizes cover empty messages, every padding boundary and several
+     * blocks, and differ within each group of lanes */
+    for (size_t i = 0; i < NUM_MESSAGES; i++)
+    {
+        sizes[i] = i * 3;
+        data[i] = sizes[i] ? buffer : NULL;
+        keys[i] = i % 3 ? &key : &long_key;
+    }
+
+    OE_TEST(oe_sha256_batch(data, sizes, NUM_MESSAGES, results) == OE_OK);
+
+    for (size_t i = 0; i < NUM_MESSAGES; i++)
+    {
+        _sha256(buffer, sizes[i], &expected);
+        OE_TEST(memcmp(&results[i], &expected, sizeof(expected)) == 0);
+    }
+
+    OE_TEST(
+        oe_hmac_sha256_batch(keys, data, sizes, NUM_MESSAGES, results) ==
+        OE_OK);
+
+    for (size_t i = 0; i < NUM_MESSAGES; i++)
+    {
+        if (i % 3)
+            _hmac(_key, sizeof(_key), buffer, sizes[i], &expected);
+        else
+            _hmac(_long_key, sizeof(_long_key), buffer, sizes[i], &expected);
+
+        OE_TEST(memcmp(&results[i], &expected, sizeof(expected)) == 0);
+    }
+
+    /* A single message takes the scalar path */
+    OE_TEST(
+        oe_hmac_sha256_batch(keys + 1, data + 50, sizes + 50, 1, results) ==
+        OE_OK);
+    _hmac(_key, sizeof(_key), buffer, sizes[50], &expected);
+    OE_TEST(memcmp(&results[0], &expected, sizeof(expected)) == 0);
+
+    OE_TEST(oe_sha256_batch(NULL, NULL, 0, NULL) == OE_OK);
+    OE_TEST(oe_sha256_batch(data, sizes, 1, NULL) == OE_INVALID_PARAMETER);
+    data[1] = NULL;
+    OE_TEST(
+        oe_sha256_batch(data, sizes, 2, results) == OE_INVALID_PARAMETER);
+    keys[0] = NULL;
+    OE_TEST(
+        oe_hmac_sha256_batch(keys, data, sizes, 1, results) ==
+        OE_INVALID_PARAMETER);
+
+    OE_TEST(oe_hmac_sha256_key_free(&key) == OE_OK);
+    OE_TEST(oe_hmac_sha256_key_free(&long_key) == OE_OK);
+}
+
+void enc_prepare_records(size_t record_size, size_t count)
+{
+    free(_records);
+
+    OE_TEST((_records = (uint8_t*)malloc(record_size * count)) != NULL);
+
+    for (size_t i = 0; i < record_size * count; i++)
+        _records[i] = (uint8_t)(i * 7);
+
+    _record_size = record_size;
+    _record_count = count;
+}
+
+static uint64_t _checksum(const OE_SHA256* hmacs, size_t count)
+{
+    uint64_t checksum = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t x;
+        memcpy(&x, hmacs[i].buf, sizeof(x));
+        checksum ^= x;
+    }
+
+    return checksum;
+}
+
+uint64_t enc_hmac_records(enum hash_mode mode)
+{
+    const void* data[NUM_MESSAGES];
+    size_t sizes[NUM_MESSAGES];
+    const oe_hmac_sha256_key_t* keys[NUM_MESSAGES];
+    OE_SHA256 hmacs[NUM_MESSAGES];
+    oe_hmac_sha256_key_t key;
+    uint64_t checksum = 0;
+
+    OE_TEST(oe_hmac_sha256_key_init(&key, _key, sizeof(_key)) == OE_OK);
+
+    for (size_t i = 0; i < NUM_MESSAGES; i++)
+    {
+        sizes[i] = _record_size;
+        keys[i] = &key;
+    }
+
+    /* Verify records NUM_MESSAGES at a time, as a caller would */
+    for (size_t i = 0; i < _record_count; i += NUM_MESSAGES)
+    {
+        size_t n = _record_count - i;
+
+        if (n > NUM_MESSAGES)
+            n = NUM_MESSAGES;
+
+        for (size_t j = 0; j < n; j++)
+        {
+            const uint8_t* record = _records + (i + j) * _record_size;
+
+            if (mode == HASH_BATCH)
+                data[j] = record;
+            else
+                _hmac(_key, sizeof(_key), record, _record_size, &hmacs[j]);
+        }
+
+        if (mode == HASH_BATCH)
+        {
+            OE_TEST(
+                oe_hmac_sha256_batch(keys, data, sizes, n, hmacs) == OE_OK);
+        }
+
+        checksum += _checksum(hmacs, n);
+    }
+
+    OE_TEST(oe_hmac_sha256_key_free(&key) == OE_OK);
+
+    return checksum;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    4096, /* HeapPageCount */
+    128,  /* StackPageCount */
+    1);   /* TCSCount */
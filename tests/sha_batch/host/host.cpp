@@ -0,0 +1,77 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <chrono>
+#include "sha_batch_u.h"
+
+#define RECORDS_PER_ECALL 10000
+#define NUM_ECALLS 20
+
+static uint64_t _run(oe_enclave_t* enclave, hash_mode mode, size_t size)
+{
+    uint64_t checksum = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    for (size_t i = 0; i < NUM_ECALLS; i++)
+    {
+        uint64_t value = 0;
+
+        OE_TEST(enc_hmac_records(enclave, &value, mode) == OE_OK);
+        checksum += value;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    printf(
+        "%4zu B records, %s: %.0f records/sec\n",
+        size,
+        mode == HASH_BATCH ? "batch    " : "streaming",
+        NUM_ECALLS * RECORDS_PER_ECALL / seconds);
+
+    return checksum;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    const size_t record_sizes[] = {64, 256, 1024};
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if ((result = oe_create_sha_batch_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    OE_TEST(enc_test_batch_hashes(enclave) == OE_OK);
+
+    /* Both modes must produce the same HMACs */
+    for (size_t size : record_sizes)
+    {
+        OE_TEST(
+            enc_prepare_records(enclave, size, RECORDS_PER_ECALL) == OE_OK);
+        OE_TEST(
+            _run(enclave, HASH_STREAMING, size) ==
+            _run(enclave, HASH_BATCH, size));
+    }
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    printf("=== passed all tests (sha_batch)\n");
+
+    return 0;
+}
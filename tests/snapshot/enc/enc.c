@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include "snapshot_t.h"
+
+static int _counter;
+static int* _host_memory;
+
+/* Initialization that clones should not have to repeat */
+__attribute__((constructor)) static void _initialize(void)
+{
+    _counter = 100;
+}
+
+int increment(void)
+{
+    return ++_counter;
+}
+
+void keep_host_memory(int value)
+{
+    if ((_host_memory = (int*)oe_host_malloc(sizeof(int))))
+        *_host_memory = value;
+}
+
+/* Returns the value in the host memory and frees it */
+int release_host_memory(void)
+{
+    int value = -1;
+
+    if (_host_memory)
+    {
+        value = *_host_memory;
+        oe_host_free(_host_memory);
+        _host_memory = NULL;
+    }
+
+    return value;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    2);   /* TCSCount */
@@ -0,0 +1,82 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "snapshot_u.h"
+
+#define NUM_CLONES 3
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    oe_enclave_snapshot_t* snapshot = NULL;
+    int ret = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    OE_TEST(
+        oe_create_snapshot_enclave(
+            argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave) == OE_OK);
+
+    /* Only simulated enclaves can be snapshotted */
+    if (!(flags & OE_ENCLAVE_FLAG_SIMULATE))
+    {
+        OE_TEST(oe_snapshot_enclave(enclave, &snapshot) == OE_UNSUPPORTED);
+        OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+        printf("=== passed all tests (snapshot)\n");
+        return 0;
+    }
+
+    OE_TEST(increment(enclave, &ret) == OE_OK);
+    OE_TEST(ret == 101);
+    OE_TEST(keep_host_memory(enclave, 7) == OE_OK);
+
+    /* The snapshot consumes the enclave */
+    OE_TEST(oe_snapshot_enclave(enclave, &snapshot) == OE_OK);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_INVALID_PARAMETER);
+
+    for (int i = 0; i < NUM_CLONES; i++)
+    {
+        oe_enclave_t* clone = NULL;
+        oe_enclave_t* other = NULL;
+
+        OE_TEST(oe_clone_enclave(snapshot, &clone) == OE_OK);
+
+        /* Only one clone may occupy the address range at a time */
+        OE_TEST(oe_clone_enclave(snapshot, &other) == OE_BUSY);
+        OE_TEST(other == NULL);
+        OE_TEST(oe_free_enclave_snapshot(snapshot) == OE_BUSY);
+
+        /* Each clone starts from the snapshotted state... */
+        OE_TEST(increment(clone, &ret) == OE_OK);
+        OE_TEST(ret == 102);
+        OE_TEST(increment(clone, &ret) == OE_OK);
+        OE_TEST(ret == 103);
+
+        /* ...including the host memory it refers to */
+        OE_TEST(release_host_memory(clone, &ret) == OE_OK);
+        OE_TEST(ret == 7);
+        OE_TEST(release_host_memory(clone, &ret) == OE_OK);
+        OE_TEST(ret == -1);
+
+        /* Clones allocate and free host memory of their own as usual */
+        OE_TEST(keep_host_memory(clone, i) == OE_OK);
+        OE_TEST(release_host_memory(clone, &ret) == OE_OK);
+        OE_TEST(ret == i);
+        OE_TEST(keep_host_memory(clone, i) == OE_OK);
+
+        OE_TEST(oe_terminate_enclave(clone) == OE_OK);
+    }
+
+    OE_TEST(oe_free_enclave_snapshot(snapshot) == OE_OK);
+
+    printf("=== passed all tests (snapshot)\n");
+    return 0;
+}
@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <string.h>
+#include "stack_usage_t.h"
+
+/* Uses at least depth * FRAME_SIZE bytes of stack */
+#define FRAME_SIZE 1024
+
+static volatile size_t _sink;
+
+void recurse(size_t depth)
+{
+    volatile char frame[FRAME_SIZE];
+
+    memset((char*)frame, (int)depth, sizeof(frame));
+
+    if (depth > 1)
+        recurse(depth - 1);
+
+    _sink += frame[depth % sizeof(frame)];
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    256,  /* StackPageCount */
+    2);   /* TCSCount */
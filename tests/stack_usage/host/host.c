@@ -0,0 +1,71 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/defs.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "../../../host/sgx/stackusage.h"
+#include "stack_usage_u.h"
+
+#define FRAME_SIZE 1024
+#define STACK_PAGE_COUNT 256
+
+static uint64_t _get_max_used(oe_enclave_t* enclave)
+{
+    oe_sgx_stack_usage_t usage;
+
+    OE_TEST(oe_sgx_get_stack_usage(enclave, &usage) == OE_OK);
+    OE_TEST(usage.stack_size == STACK_PAGE_COUNT * OE_PAGE_SIZE);
+    OE_TEST(usage.num_stacks == 2);
+    OE_TEST(usage.max_used <= usage.stack_size);
+    OE_TEST(usage.max_used == usage.used[0] || usage.max_used == usage.used[1]);
+
+    return usage.max_used;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    uint64_t initial;
+    uint64_t used;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    OE_TEST(
+        (result = oe_create_stack_usage_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) ==
+        OE_OK);
+
+    /* Enclave initialization already used some stack */
+    initial = _get_max_used(enclave);
+    OE_TEST(initial > 0);
+
+    /* The high-water mark follows the deepest call */
+    OE_TEST(recurse(enclave, 16) == OE_OK);
+    used = _get_max_used(enclave);
+    OE_TEST(used >= 16 * FRAME_SIZE);
+
+    OE_TEST(recurse(enclave, 64) == OE_OK);
+    OE_TEST(_get_max_used(enclave) >= 64 * FRAME_SIZE);
+    OE_TEST(_get_max_used(enclave) > used);
+    used = _get_max_used(enclave);
+
+    /* ...and stays there when later calls are shallower */
+    OE_TEST(recurse(enclave, 1) == OE_OK);
+    OE_TEST(_get_max_used(enclave) == used);
+
+    OE_TEST(oe_sgx_get_stack_usage(enclave, NULL) == OE_INVALID_PARAMETER);
+
+    oe_terminate_enclave(enclave);
+
+    printf("=== passed all tests (stack_usage)\n");
+
+    return 0;
+}
@@ -0,0 +1,327 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/print.h>
+#include <openenclave/internal/time.h>
+#include "string_t.h"
+
+#define PAGE_SIZE 4096
+#define MAX_OFFSET 16
+#define MAX_LENGTH 80
+
+#define CHECK(COND)                                                    \
+    do                                                                 \
+    {                                                                  \
+        if (!(COND))                                                   \
+        {                                                              \
+            oe_host_printf(                                            \
+                "%s(%d): failed: %s\n", __FILE__, __LINE__, #COND);    \
+            return -1;                                                 \
+        }                                                              \
+    } while (0)
+
+/* Strings end at the last byte of a page, where an unaligned over-read would
+ * run into the next page */
+static OE_ALIGNED(PAGE_SIZE) char _page1[PAGE_SIZE];
+static OE_ALIGNED(PAGE_SIZE) char _page2[PAGE_SIZE];
+static char _haystack[PAGE_SIZE];
+
+/*
+**==============================================================================
+**
+** Byte-at-a-time reference implementations:
+**
+**==============================================================================
+*/
+
+static size_t _byte_strlen(const char* s)
+{
+    const char* p = s;
+
+    while (*p)
+        p++;
+
+    return (size_t)(p - s);
+}
+
+static int _byte_strcmp(const char* s1, const char* s2)
+{
+    while (*s1 && *s1 == *s2)
+    {
+        s1++;
+        s2++;
+    }
+
+    return *(const unsigned char*)s1 - *(const unsigned char*)s2;
+}
+
+static char* _byte_strchr(const char* s, int c)
+{
+    for (; *s; s++)
+    {
+        if (*(const unsigned char*)s == (unsigned char)c)
+            return (char*)s;
+    }
+
+    return (unsigned char)c ? NULL : (char*)s;
+}
+
+static char* _byte_strstr(const char* haystack, const char* needle)
+{
+    size_t hlen = _byte_strlen(haystack);
+    size_t nlen = _byte_strlen(needle);
+
+    if (nlen > hlen)
+        return NULL;
+
+    for (size_t i = 0; i < hlen - nlen + 1; i++)
+    {
+        if (memcmp(haystack + i, needle, nlen) == 0)
+            return (char*)haystack + i;
+    }
+
+    return NULL;
+}
+
+static int _sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+/* Places a string of the given length so that it ends at the end of page */
+static char* _make_string(char* page, size_t length, char first)
+{
+    char* s = page + PAGE_SIZE - length - 1;
+
+    for (size_t i = 0; i < length; i++)
+        s[i] = (char)(first + (char)(i % 26));
+
+    s[length] = '\0';
+    return s;
+}
+
+/*
+**==============================================================================
+**
+** Tests:
+**
+**==============================================================================
+*/
+
+static int _test_strlen(void)
+{
+    for (size_t length = 0; length < MAX_LENGTH; length++)
+    {
+        const char* s = _make_string(_page1, length, 'a');
+
+        CHECK(oe_strlen(s) == length);
+
+        for (size_t offset = 0; offset < MAX_OFFSET; offset++)
+        {
+            char* t = _page2 + offset;
+
+            memset(t, 'x', length);
+            t[length] = '\0';
+            CHECK(oe_strlen(t) == length);
+        }
+    }
+
+    return 0;
+}
+
+static int _test_strcmp(void)
+{
+    for (size_t length = 0; length < MAX_LENGTH; length++)
+    {
+        char* s1 = _make_string(_page1, length, 'a');
+
+        for (size_t offset = 0; offset < MAX_OFFSET; offset++)
+        {
+            /* Equally and differently aligned copies of s1 */
+            char* s2 = _page2 + offset;
+
+            memcpy(s2, s1, length + 1);
+            CHECK(oe_strcmp(s1, s2) == 0);
+
+            /* A difference at each position, including non-ASCII bytes */
+            for (size_t i = 0; i <= length; i++)
+            {
+                char saved = s2[i];
+                const char bytes[] = {'\0', 'A', 'z', (char)0x80, (char)0xFF};
+
+                for (size_t j = 0; j < OE_COUNTOF(bytes); j++)
+                {
+                    s2[i] = bytes[j];
+                    CHECK(
+                        _sign(oe_strcmp(s1, s2)) ==
+                        _sign(_byte_strcmp(s1, s2)));
+                    CHECK(
+                        _sign(oe_strcmp(s2, s1)) ==
+                        _sign(_byte_strcmp(s2, s1)));
+                }
+
+                s2[i] = saved;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int _test_strchr(void)
+{
+    for (size_t length = 0; length < MAX_LENGTH; length++)
+    {
+        const char* s = _make_string(_page1, length, 'a');
+        const int chars[] = {'a', 'm', 'z', '\0', 0x80, 'a' + 256};
+
+        for (size_t i = 0; i < OE_COUNTOF(chars); i++)
+        {
+            const char* expected = _byte_strchr(s, chars[i]);
+            const char* end = expected ? expected : s + length;
+
+            CHECK(oe_strchr(s, chars[i]) == expected);
+            CHECK(oe_strchrnul(s, chars[i]) == end);
+        }
+    }
+
+    return 0;
+}
+
+static int _test_strstr(void)
+{
+    const char* needles[] = {"",
+                             "a",
+                             "abc",
+                             "xyz",
+                             "abcdefghijklmnopqrstuvwxyzab",
+                             "zabcdefgh",
+                             "aab",
+                             "not present"};
+
+    for (size_t length = 0; length < MAX_LENGTH; length++)
+    {
+        const char* haystack = _make_string(_page1, length, 'a');
+
+        for (size_t i = 0; i < OE_COUNTOF(needles); i++)
+        {
+            CHECK(
+                oe_strstr(haystack, needles[i]) ==
+                _byte_strstr(haystack, needles[i]));
+        }
+    }
+
+    /* Partial matches that run into the end of the haystack */
+    CHECK(oe_strstr("aaaab", "aab") != NULL);
+    CHECK(oe_strstr("aaaa", "aab") == NULL);
+    CHECK(oe_strstr("ab", "abc") == NULL);
+
+    return 0;
+}
+
+int test_string(void)
+{
+    if (_test_strlen() != 0 || _test_strcmp() != 0 || _test_strchr() != 0 ||
+        _test_strstr() != 0)
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+**==============================================================================
+**
+** Benchmark:
+**
+**==============================================================================
+*/
+
+/* Keeps the compiler from discarding the results of the benchmarked calls */
+static volatile size_t _sink;
+
+static void _report(
+    const char* name,
+    size_t length,
+    uint64_t byte_msec,
+    uint64_t word_msec)
+{
+    oe_host_printf(
+        "%-8s length=%-5zu byte-at-a-time=%-6llu ms word-at-a-time=%llu ms\n",
+        name,
+        length,
+        (unsigned long long)byte_msec,
+        (unsigned long long)word_msec);
+}
+
+static void _benchmark(size_t length, size_t total_bytes)
+{
+    const size_t iterations = total_bytes / (length + 1);
+    char* s1 = _make_string(_page1, length, 'a');
+    char* s2 = _make_string(_page2, length, 'a');
+    uint64_t start;
+    uint64_t old;
+
+    /* Text that ends with a delimiter, as searched for by parsers */
+    memcpy(_haystack, s1, length + 1);
+    memcpy(_haystack + length - 2, "\r\n", 2);
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += _byte_strlen(s1);
+    old = oe_get_time() - start;
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += oe_strlen(s1);
+    _report("strlen", length, old, oe_get_time() - start);
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += (size_t)_byte_strcmp(s1, s2);
+    old = oe_get_time() - start;
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += (size_t)oe_strcmp(s1, s2);
+    _report("strcmp", length, old, oe_get_time() - start);
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += (size_t)_byte_strchr(s1, '#');
+    old = oe_get_time() - start;
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += (size_t)oe_strchr(s1, '#');
+    _report("strchr", length, old, oe_get_time() - start);
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += (size_t)_byte_strstr(_haystack, "\r\n");
+    old = oe_get_time() - start;
+
+    start = oe_get_time();
+    for (size_t i = 0; i < iterations; i++)
+        _sink += (size_t)oe_strstr(_haystack, "\r\n");
+    _report("strstr", length, old, oe_get_time() - start);
+}
+
+void benchmark_string(size_t total_bytes)
+{
+    const size_t lengths[] = {16, 64, 256, 1024, PAGE_SIZE - 1};
+
+    for (size_t i = 0; i < OE_COUNTOF(lengths); i++)
+        _benchmark(lengths[i], total_bytes);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    1024, /* StackPageCount */
+    2);   /* TCSCount */
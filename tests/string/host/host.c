@@ -0,0 +1,39 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "string_u.h"
+
+/* Number of bytes each routine scans in the benchmark */
+#define BENCHMARK_TOTAL_BYTES (64 * 1024 * 1024)
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    int return_value = -1;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    OE_TEST(
+        (result = oe_create_string_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) == OE_OK);
+
+    OE_TEST(test_string(enclave, &return_value) == OE_OK);
+    OE_TEST(return_value == 0);
+
+    OE_TEST(benchmark_string(enclave, BENCHMARK_TOTAL_BYTES) == OE_OK);
+
+    oe_terminate_enclave(enclave);
+
+    printf("=== passed all tests (string)\n");
+
+    return 0;
+}
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include "tcs_pool_t.h"
+
+/* Holds a TCS until the host sets *stop */
+void busy_wait(int* entered, volatile int* stop)
+{
+    __atomic_add_fetch(entered, 1, __ATOMIC_SEQ_CST);
+
+    while (!*stop)
+        __builtin_ia32_pause();
+}
+
+int health_check(void)
+{
+    return 1;
+}
+
+int control(void)
+{
+    return 2;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    4);   /* TCSCount */
@@ -0,0 +1,184 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "../../../host/sgx/enclave.h"
+#include "tcs_pool_u.h"
+
+#define TCS_COUNT 4
+
+static oe_result_t _create(
+    const char* path,
+    const oe_sgx_create_config_t* config,
+    oe_enclave_t** enclave)
+{
+    return oe_create_tcs_pool_enclave(
+        path,
+        OE_ENCLAVE_TYPE_SGX,
+        oe_get_create_flags(),
+        config,
+        config ? sizeof(*config) : 0,
+        enclave);
+}
+
+static void _busy_wait(oe_enclave_t* enclave, int* entered, int* stop)
+{
+    OE_TEST(busy_wait(enclave, entered, stop) == OE_OK);
+}
+
+/* Occupies count TCSs with ecalls that run until stopped */
+static void _saturate(
+    oe_enclave_t* enclave,
+    size_t count,
+    int* entered,
+    int* stop,
+    std::vector<std::thread>& threads)
+{
+    *entered = 0;
+    *stop = 0;
+
+    for (size_t i = 0; i < count; i++)
+        threads.push_back(std::thread(_busy_wait, enclave, entered, stop));
+
+    while (__atomic_load_n(entered, __ATOMIC_SEQ_CST) != (int)count)
+        std::this_thread::yield();
+}
+
+static void _release(int* stop, std::vector<std::thread>& threads)
+{
+    __atomic_store_n(stop, 1, __ATOMIC_SEQ_CST);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    threads.clear();
+}
+
+/* Counts the mappings of pages shared between simulated enclaves */
+static size_t _count_shared_mappings()
+{
+    char line[512];
+    size_t count = 0;
+    FILE* file = fopen("/proc/self/maps", "r");
+
+    if (!file)
+        return 0;
+
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strstr(line, "oe-shared-pages"))
+            count++;
+    }
+
+    fclose(file);
+    return count;
+}
+
+/* The configurations are rejected after the image is built, so each failed
+ * creation must also release the enclave memory and its shared pages */
+static void _test_invalid_configs(const char* path)
+{
+    oe_enclave_t* enclave = NULL;
+    const uint32_t ids[] = {fcn_id_health_check, fcn_id_health_check};
+    oe_sgx_tcs_pool_t pools[2] = {{1, ids, 1}, {1, ids + 1, 1}};
+    oe_sgx_create_config_t config = {pools, 1};
+
+    /* The size must match the configuration structure */
+    OE_TEST(
+        oe_create_tcs_pool_enclave(
+            path,
+            OE_ENCLAVE_TYPE_SGX,
+            oe_get_create_flags(),
+            &config,
+            1,
+            &enclave) == OE_INVALID_PARAMETER);
+
+    /* At least one TCS must stay unreserved */
+    pools[0].num_tcs = TCS_COUNT;
+    OE_TEST(_create(path, &config, &enclave) == OE_INVALID_PARAMETER);
+
+    /* A function belongs to a single pool */
+    pools[0].num_tcs = 1;
+    config.num_tcs_pools = 2;
+    OE_TEST(_create(path, &config, &enclave) == OE_INVALID_PARAMETER);
+
+    config.num_tcs_pools = OE_SGX_MAX_TCS_POOLS + 1;
+    OE_TEST(_create(path, &config, &enclave) == OE_INVALID_PARAMETER);
+
+    OE_TEST(enclave == NULL);
+    OE_TEST(_count_shared_mappings() == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    const uint32_t health_ids[] = {fcn_id_health_check};
+    const uint32_t control_ids[] = {fcn_id_control};
+    const oe_sgx_tcs_pool_t pools[] = {{1, health_ids, 1},
+                                       {1, control_ids, 1}};
+    const oe_sgx_create_config_t config = {pools, 2};
+    const uint32_t busy_ids[] = {fcn_id_busy_wait};
+    const oe_sgx_tcs_pool_t busy_pool = {1, busy_ids, 1};
+    const oe_sgx_create_config_t busy_config = {&busy_pool, 1};
+    std::vector<std::thread> threads;
+    int entered = 0;
+    int stop = 0;
+    int ret = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    _test_invalid_configs(argv[1]);
+
+    /* Without pools, a burst of ecalls starves all others */
+    OE_TEST(_create(argv[1], NULL, &enclave) == OE_OK);
+    _saturate(enclave, TCS_COUNT, &entered, &stop, threads);
+    OE_TEST(health_check(enclave, &ret) == OE_OUT_OF_THREADS);
+    _release(&stop, threads);
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    /* Reserve one TCS for health checks and one for control calls */
+    OE_TEST(_create(argv[1], &config, &enclave) == OE_OK);
+
+    /* The pools take the last bindings, the first pool the very last one */
+    OE_TEST(enclave->num_bindings == TCS_COUNT);
+    OE_TEST(enclave->tcs_pools[0] == 0);
+    OE_TEST(enclave->tcs_pools[1] == 0);
+    OE_TEST(enclave->tcs_pools[2] == 2);
+    OE_TEST(enclave->tcs_pools[3] == 1);
+
+    /* Other ecalls only get the two unreserved TCSs */
+    _saturate(enclave, TCS_COUNT - 2, &entered, &stop, threads);
+    OE_TEST(busy_wait(enclave, &entered, &stop) == OE_OUT_OF_THREADS);
+
+    /* ...while each pool still gets in */
+    OE_TEST(health_check(enclave, &ret) == OE_OK);
+    OE_TEST(ret == 1);
+    OE_TEST(control(enclave, &ret) == OE_OK);
+    OE_TEST(ret == 2);
+
+    _release(&stop, threads);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    /* Pooled ecalls fall back to unreserved TCSs once their pool is busy */
+    OE_TEST(_create(argv[1], &busy_config, &enclave) == OE_OK);
+    _saturate(enclave, TCS_COUNT, &entered, &stop, threads);
+    OE_TEST(busy_wait(enclave, &entered, &stop) == OE_OUT_OF_THREADS);
+    OE_TEST(health_check(enclave, &ret) == OE_OUT_OF_THREADS);
+    _release(&stop, threads);
+
+    OE_TEST(oe_terminate_enclave(enclave) == OE_OK);
+
+    printf("=== passed all tests (tcs_pool)\n");
+
+    return 0;
+}
@@ -346,6 +346,10 @@ let get_cast_to_mem_type (ptype, decl) =
         sprintf "/* foreign array of type %s */ void* " (get_tystr t)
       else get_tystr t
 
+(** [sha256] parameters are copied in by the enclave itself and so are
+    never marshalled. *)
+let is_sha256_param (ptr_attr : ptr_attr) = ptr_attr.pa_sha256 <> None
+
 (** Prepare [input_buffer]. *)
 let oe_prepare_input_buffer (os : out_channel) (fd : func_decl)
     (alloc_func : string) =
@@ -360,9 +364,11 @@ let oe_prepare_input_buffer (os : out_channel) (fd : func_decl)
           if ptr_attr.pa_chkptr then
             match ptr_attr.pa_direction with
             | PtrIn | PtrInOut ->
-                let size = oe_get_param_size (ptype, decl, "_args.") in
-                fprintf os "    if (%s) OE_ADD_SIZE(_input_buffer_size, %s);\n"
-                  decl.identifier size
+                if not (is_sha256_param ptr_attr) then
+                  let size = oe_get_param_size (ptype, decl, "_args.") in
+                  fprintf os
+                    "    if (%s) OE_ADD_SIZE(_input_buffer_size, %s);\n"
+                    decl.identifier size
             | _ -> ()
           else ()
       | _ -> () )
@@ -411,8 +417,9 @@ let oe_prepare_input_buffer (os : out_channel) (fd : func_decl)
             let tystr = get_cast_to_mem_type (ptype, decl) in
             match ptr_attr.pa_direction with
             | PtrIn ->
-                fprintf os "    OE_WRITE_IN_PARAM(%s, %s, %s);\n"
-                  decl.identifier size tystr
+                if not (is_sha256_param ptr_attr) then
+                  fprintf os "    OE_WRITE_IN_PARAM(%s, %s, %s);\n"
+                    decl.identifier size tystr
             | PtrInOut ->
                 fprintf os "    OE_WRITE_IN_OUT_PARAM(%s, %s, %s);\n"
                   decl.identifier size tystr
@@ -618,8 +625,9 @@ let oe_gen_ecall_function (os : out_channel) (fd : func_decl) =
             let tystr = get_cast_to_mem_type (ptype, decl) in
             match ptr_attr.pa_direction with
             | PtrIn ->
-                fprintf os "    OE_SET_IN_POINTER(%s, %s, %s);\n"
-                  decl.identifier size tystr
+                if not (is_sha256_param ptr_attr) then
+                  fprintf os "    OE_SET_IN_POINTER(%s, %s, %s);\n"
+                    decl.identifier size tystr
             | PtrInOut ->
                 fprintf os "    OE_SET_IN_OUT_POINTER(%s, %s, %s);\n"
                   decl.identifier size tystr
@@ -652,6 +660,33 @@ let oe_gen_ecall_function (os : out_channel) (fd : func_decl) =
       | _ -> () )
     fd.plist ;
   fprintf os "\n" ;
+  (* Copy [sha256] parameters from the host, hashing them on the way in.
+     This needs the digest pointers set up above. *)
+  let sha256_params =
+    List.filter
+      (fun (ptype, _) ->
+        match ptype with
+        | PTPtr (_, ptr_attr) -> is_sha256_param ptr_attr
+        | _ -> false )
+      fd.plist
+  in
+  if sha256_params <> [] then (
+    fprintf os "    /* Copy in and hash sha256 parameters */\n" ;
+    List.iter
+      (fun (ptype, decl) ->
+        match ptype with
+        | PTPtr (_, {pa_sha256= Some digest; _}) ->
+            let size = oe_get_param_size (ptype, decl, "pargs_in->") in
+            let tystr = get_cast_to_mem_type (ptype, decl) in
+            let dtype, ddecl =
+              List.find (fun (_, d) -> d.identifier = digest) fd.plist
+            in
+            let digest_size = oe_get_param_size (dtype, ddecl, "pargs_in->") in
+            fprintf os "    OE_COPY_IN_SHA256_POINTER(%s, %s, %s, %s, %s);\n"
+              decl.identifier size tystr digest digest_size
+        | _ -> () )
+      sha256_params ;
+    fprintf os "\n" ) ;
   (* Check for null terminators in string parameters *)
   fprintf os "    /* Check that in/in-out strings are null terminated */\n" ;
   List.iter
@@ -82,6 +82,7 @@ type ptr_attr = {
   pa_iswstr     : bool;
   pa_rdonly     : bool;       (* If the pointer is 'const' qualified *)
   pa_chkptr     : bool;       (* Whether to generate code to check pointer *)
+  pa_sha256     : string option; (* Parameter that receives the SHA-256 *)
 }
 
 (* parameter type *)
@@ -17,6 +17,7 @@
 static const char* arg0;
 int oedump(const char*);
 int oesign(const char*, const char*, const char*);
+int oecompress(const char*, const char*, const char*);
 
 OE_PRINTF_FORMAT(1, 2)
 void Err(const char* format, ...)
@@ -120,6 +121,7 @@ typedef struct _config_file_options
     uint64_t num_tcs;
     uint16_t product_id;
     uint16_t security_version;
+    bool compact_relocations;
 } ConfigFileOptions;
 
 #define CONFIG_FILE_OPTIONS_INITIALIZER                                 \
@@ -127,6 +129,7 @@ typedef struct _config_file_options
         .debug = false, .num_heap_pages = OE_UINT64_MAX,                \
         .num_stack_pages = OE_UINT64_MAX, .num_tcs = OE_UINT64_MAX,     \
         .product_id = OE_UINT16_MAX, .security_version = OE_UINT16_MAX, \
+        .compact_relocations = false,                                   \
     }
 
 /* Check whether the .conf file is missing required options */
@@ -281,6 +284,19 @@ static int _load_config_file(const char* path, ConfigFileOptions* options)
 
             options->security_version = n;
         }
+        else if (strcmp(str_ptr(&lhs), "CompactRelocations") == 0)
+        {
+            uint64_t value;
+
+            // CompactRelocations must be 0 or 1
+            if (str_u64(&rhs, &value) != 0 || (value > 1))
+            {
+                Err("%s(%zu): bad value for 'CompactRelocations'", path, line);
+                goto done;
+            }
+
+            options->compact_relocations = (bool)value;
+        }
         else
         {
             Err("%s(%zu): unknown setting: %s", path, line, str_ptr(&rhs));
@@ -453,6 +469,10 @@ void _merge_config_file_options(
     /* If NumTCS option is present */
     if (options->num_tcs != OE_UINT64_MAX)
         properties->header.size_settings.num_tcs = options->num_tcs;
+
+    /* CompactRelocations option is present */
+    if (options->compact_relocations)
+        properties->config.flags |= OE_SGX_CONFIG_FLAGS_COMPACT_RELOCATIONS;
 }
 
 static const char _usage_gen[] =
@@ -462,6 +482,7 @@ static const char _usage_gen[] =
     "    sign  -  Sign the specified enclave.\n"
     "    dump  -  Print out the Open Enclave metadata for the specified "
     "enclave.\n"
+    "    compress  -  Compress read-only data for embedding in an enclave.\n"
     "\n"
     "For help with a specific command, enter \"%s <command> --help\"\n";
 
@@ -492,6 +513,9 @@ static const char _usage_sign[] =
     "        NumStackPages - the number of stack pages for this enclave\n"
     "        NumTCS - the number of thread control structures for this "
     "enclave\n"
+    "        CompactRelocations - whether to store relocations in the "
+    "compact\n"
+    "            format (1), which is faster to apply, or not (0)\n"
     "\n"
     "    The configuration file contains simple NAME=VALUE entries. For "
     "example:\n"
@@ -517,6 +541,26 @@ static const char _usage_dump[] =
     "    This option dumps the oeinfo and signature information of an "
     "enclave\n";
 
+static const char _usage_compress[] =
+    "Usage: %s compress {--input | -i} INPUT_FILE {--output | -o} "
+    "OUTPUT_FILE {--name | -n} NAME\n"
+    "\n"
+    "Where:\n"
+    "    INPUT_FILE -- path of the data file to compress\n"
+    "    OUTPUT_FILE -- path of the C source file to generate\n"
+    "    NAME -- name of the generated oe_compressed_data_t variable\n"
+    "\n"
+    "Description:\n"
+    "    This utility compresses INPUT_FILE into a file named after\n"
+    "    OUTPUT_FILE with a .bin extension, and writes a C source file that\n"
+    "    assembles it into the .oecompressed section of the enclave. The\n"
+    "    .bin file must be kept for as long as OUTPUT_FILE is compiled. Only\n"
+    "    the compressed bytes are loaded and measured. Inside the enclave,\n"
+    "    oe_get_compressed_data(&NAME, ...), declared in\n"
+    "    <openenclave/enclave.h>, decompresses the data into the heap on\n"
+    "    first use and verifies its SHA-256 digest.\n"
+    "\n";
+
 int oesign(const char* enclave, const char* conffile, const char* keyfile)
 {
     int ret = 1;
@@ -766,6 +810,82 @@ done:
     return ret;
 }
 
+int compress_parser(int argc, const char* argv[])
+{
+    int ret = 0;
+    const char* input = NULL;
+    const char* output = NULL;
+    const char* name = NULL;
+
+    const struct option long_options[] = {
+        {"help", no_argument, NULL, 'h'},
+        {"input", required_argument, NULL, 'i'},
+        {"output", required_argument, NULL, 'o'},
+        {"name", required_argument, NULL, 'n'},
+        {NULL, 0, NULL, 0},
+    };
+    const char short_options[] = "hi:o:n:";
+
+    int c;
+    do
+    {
+        c = getopt_long(
+            argc, (char* const*)argv, short_options, long_options, NULL);
+        if (c == -1)
+        {
+            // all the command-line options are parsed
+            break;
+        }
+
+        switch (c)
+        {
+            case 'h':
+                fprintf(stderr, _usage_compress, argv[0]);
+                goto done;
+            case 'i':
+                input = optarg;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'n':
+                name = optarg;
+                break;
+            case ':':
+                // Missing option argument
+                ret = 1;
+                goto done;
+            case '?':
+            default:
+                // Invalid option
+                ret = 1;
+                goto done;
+        }
+    } while (1);
+
+    if (input == NULL)
+    {
+        Err("Input file flag is missing");
+        ret = 1;
+    }
+    if (output == NULL)
+    {
+        Err("Output file flag is missing");
+        ret = 1;
+    }
+    if (name == NULL)
+    {
+        Err("Name flag is missing");
+        ret = 1;
+    }
+    if (!ret)
+        ret = oecompress(input, output, name);
+
+done:
+
+    return ret;
+}
+
 int arg_handler(int argc, const char* argv[])
 {
     int ret = 1;
@@ -773,6 +893,8 @@ int arg_handler(int argc, const char* argv[])
         ret = dump_parser(argc, argv);
     else if ((strcmp(argv[1], "sign") == 0))
         ret = sign_parser(argc, argv);
+    else if ((strcmp(argv[1], "compress") == 0))
+        ret = compress_parser(argc, argv);
     else
     {
         fprintf(stderr, _usage_gen, argv[0], argv[0]);
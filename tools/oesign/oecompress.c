@@ -0,0 +1,242 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <ctype.h>
+#include <openenclave/internal/compress.h>
+#include <openenclave/internal/files.h>
+#include <openenclave/internal/raise.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+
+static char* get_fullpath(const char* path)
+{
+    char* fullpath = (char*)calloc(1, MAX_PATH);
+    if (fullpath)
+    {
+        DWORD length = GetFullPathName(path, MAX_PATH, fullpath, NULL);
+
+        // If function failed, deallocate and return zero.
+        if (length == 0)
+        {
+            free(fullpath);
+            fullpath = NULL;
+        }
+    }
+    return fullpath;
+}
+
+#else
+
+#define get_fullpath(path) realpath(path, NULL)
+
+#endif
+
+void Err(const char* format, ...);
+
+/* The name must be usable as a C identifier */
+static bool _valid_name(const char* name)
+{
+    if (!name || !*name || isdigit((unsigned char)*name))
+        return false;
+
+    for (const char* p = name; *p; p++)
+    {
+        if (!isalnum((unsigned char)*p) && *p != '_')
+            return false;
+    }
+
+    return true;
+}
+
+/* Write the compressed image as a binary file, which the generated source
+ * includes with .incbin, so that large images do not have to be compiled */
+static int _write_image(const char* path, const uint8_t* image, size_t size)
+{
+    int ret = 1;
+    FILE* os = NULL;
+
+    if (!(os = fopen(path, "wb")))
+    {
+        Err("failed to open: %s", path);
+        goto done;
+    }
+
+    if (fwrite(image, 1, size, os) != size || fflush(os) != 0)
+    {
+        Err("failed to write: %s", path);
+        goto done;
+    }
+
+    ret = 0;
+
+done:
+    if (os)
+        fclose(os);
+
+    return ret;
+}
+
+/* Write a string of the assembler, quoted as part of a C string literal */
+static void _write_asm_string(FILE* os, const char* str)
+{
+    fprintf(os, "\\\"");
+
+    for (const char* p = str; *p; p++)
+    {
+        if (*p == '\\' || *p == '"')
+            fprintf(os, "\\\\\\");
+
+        fputc(*p, os);
+    }
+
+    fprintf(os, "\\\"");
+}
+
+/* Write a C source file that defines the oe_compressed_data_t descriptor
+ * NAME and assembles the image file into the compressed data section */
+static int _write_source(
+    const char* path,
+    const char* input,
+    const char* name,
+    const char* image_path,
+    size_t image_size)
+{
+    int ret = 1;
+    FILE* os = NULL;
+
+    if (!(os = fopen(path, "w")))
+    {
+        Err("failed to open: %s", path);
+        goto done;
+    }
+
+    fprintf(os, "// Generated by oesign compress from %s\n", input);
+    fprintf(os, "// Do not edit.\n\n");
+    fprintf(os, "#include <openenclave/enclave.h>\n\n");
+    fprintf(os, "__asm__(\n");
+    fprintf(
+        os,
+        "    \".pushsection \" OE_COMPRESSED_SECTION_NAME \", "
+        "\\\"a\\\"\\n\"\n");
+    fprintf(os, "    \".balign 16\\n\"\n");
+    fprintf(os, "    \".globl _%s_image\\n\"\n", name);
+    fprintf(os, "    \".hidden _%s_image\\n\"\n", name);
+    fprintf(os, "    \"_%s_image:\\n\"\n", name);
+    fprintf(os, "    \".incbin ");
+    _write_asm_string(os, image_path);
+    fprintf(os, "\\n\"\n");
+    fprintf(os, "    \".popsection\\n\");\n\n");
+    fprintf(os, "extern const uint8_t _%s_image[];\n\n", name);
+    fprintf(
+        os,
+        "oe_compressed_data_t %s =\n"
+        "    OE_COMPRESSED_DATA_INITIALIZER(_%s_image, %zu);\n",
+        name,
+        name,
+        image_size);
+
+    if (ferror(os))
+    {
+        Err("failed to write: %s", path);
+        goto done;
+    }
+
+    ret = 0;
+
+done:
+    if (os)
+        fclose(os);
+
+    return ret;
+}
+
+/* The image file is named after the source file, with a .bin extension */
+static char* _get_image_path(const char* output)
+{
+    size_t length = strlen(output);
+    char* path;
+
+    if (length > 2 && strcmp(output + length - 2, ".c") == 0)
+        length -= 2;
+
+    if (!(path = (char*)malloc(length + sizeof(".bin"))))
+        return NULL;
+
+    memcpy(path, output, length);
+    memcpy(path + length, ".bin", sizeof(".bin"));
+
+    return path;
+}
+
+int oecompress(const char* input, const char* output, const char* name)
+{
+    int ret = 1;
+    oe_result_t result;
+    void* data = NULL;
+    size_t size = 0;
+    uint8_t* image = NULL;
+    size_t image_size = 0;
+    char* image_path = NULL;
+    char* image_fullpath = NULL;
+
+    if (!_valid_name(name))
+    {
+        Err("invalid name (must be a C identifier): %s", name);
+        goto done;
+    }
+
+    if (__oe_load_file(input, 0, &data, &size) != OE_OK || size == 0)
+    {
+        Err("failed to load file: %s", input);
+        goto done;
+    }
+
+    if ((result = oe_compress_image(data, size, &image, &image_size)) != OE_OK)
+    {
+        Err("oe_compress_image(): result=%s (%u)",
+            oe_result_str(result),
+            result);
+        goto done;
+    }
+
+    if (!(image_path = _get_image_path(output)))
+    {
+        Err("out of memory");
+        goto done;
+    }
+
+    if (_write_image(image_path, image, image_size) != 0)
+        goto done;
+
+    /* The assembler resolves relative paths against its working directory */
+    if (!(image_fullpath = get_fullpath(image_path)))
+    {
+        Err("failed to get the full path of: %s", image_path);
+        goto done;
+    }
+
+    if (_write_source(output, input, name, image_fullpath, image_size) != 0)
+        goto done;
+
+    printf(
+        "Compressed %s: %zu -> %zu bytes (%s, %s)\n",
+        input,
+        size,
+        image_size,
+        output,
+        image_path);
+
+    ret = 0;
+
+done:
+    free(data);
+    free(image);
+    free(image_path);
+    free(image_fullpath);
+
+    return ret;
+}
@@ -190,6 +190,10 @@ void dump_enclave_properties(const oe_sgx_enclave_properties_t* props)
 
     printf("num_tcs=%llu\n", OE_LLU(props->header.size_settings.num_tcs));
 
+    bool compact_relocations =
+        props->config.flags & OE_SGX_CONFIG_FLAGS_COMPACT_RELOCATIONS;
+    printf("compact_relocations=%u\n", compact_relocations);
+
     sigstruct = (const sgx_sigstruct_t*)props->sigstruct;
 
     printf("mrenclave=");